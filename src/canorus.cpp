@@ -25,6 +25,7 @@
 #include "score/sheet.h"
 #include "core/settings.h"
 #include "core/undo.h"
+#include "core/edittransaction.h"
 #include "control/helpctl.h"
 
 // define private static members
@@ -35,7 +36,6 @@ CAMidiDevice *CACanorus::_midiDevice;
 CAUndo *CACanorus::_undo;
 CAHelpCtl *CACanorus::_help;
 QList<QString> CACanorus::_recentDocumentList;
-QHash<QString, int> CACanorus::_fetaMap;
 
 /*!
 	Add all search paths.
@@ -189,8 +189,26 @@ void CACanorus::initAutoRecovery() {
 	_autoRecovery = new CAAutoRecovery();
 }
 
+static bool createTransactionUndo( CADocument *document, const QString& text ) {
+	if ( !CACanorus::undo()->containsUndoStack(document) )
+		return false;
+
+	CACanorus::undo()->createUndoCommand( document, text );
+	return true;
+}
+
+static void pushTransactionUndo( CADocument* ) {
+	CACanorus::undo()->pushUndoCommand();
+}
+
+/*!
+	Creates the undo stacks manager and sets the undo hooks of the edit transactions to it.
+
+	\sa CAEditTransaction::setUndoHooks()
+*/
 void CACanorus::initUndo() {
 	_undo = new CAUndo();
+	CAEditTransaction::setUndoHooks( createTransactionUndo, pushTransactionUndo );
 }
 
 void CACanorus::initFonts() {
@@ -201,15 +219,6 @@ void CACanorus::initFonts() {
 	QFontDatabase::addApplicationFont(QFileInfo("fonts:CenturySchL-BoldItal.ttf").absoluteFilePath());
 	QFontDatabase::addApplicationFont(QFileInfo("fonts:FreeSans.ttf").absoluteFilePath());
 	QFontDatabase::addApplicationFont(QFileInfo("fonts:Emmentaler-14.ttf").absoluteFilePath());
-	// populate glyph->codepoint map using generated list
-	#include "fonts/fetaList.cxx"
-}
-
-/*!
-	Returns codepoint for an Feta (Emmentaler) glyph by its name.
- */
-int CACanorus::fetaCodepoint(const QString& name) {
-	return _fetaMap[name];
 }
 
 void CACanorus::initHelp() {
@@ -44,8 +44,6 @@ public:
 	static void parseOpenFileArguments(int argc, char *argv[]);
 	static void cleanUp();
 
-	static int  fetaCodepoint(const QString& name);
-
 	inline static const QList<CAMainWin*>& mainWinList() { return _mainWinList; }
 	inline static void addMainWin( CAMainWin *w ) { _mainWinList << w; }
 	inline static void removeMainWin(CAMainWin *w) { _mainWinList.removeAll(w); }
@@ -89,7 +87,6 @@ private:
 	static CASettings *_settings;
 	static CAUndo *_undo;
 	static QList<QString> _recentDocumentList;
-	static QHash<QString, int> _fetaMap;
 
 	// Playback output
 	static CAMidiDevice *_midiDevice;
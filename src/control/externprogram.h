@@ -35,16 +35,20 @@ public:
 	void inline setParamDelimiter( QString oDelimiter = " " )
 	{ _oParamDelimiter = oDelimiter; }
 
+	inline const QString &getProgramName() { return _oProgramName; }
+	inline const QString &getProgramPath() { return _oProgramPath; }
 	inline const QStringList &getParameters() { return _oParameters; }
 	inline bool getRunning()
 	{ return _poExternProgram->state() == QProcess::Running; }
 	inline const QString &getParamDelimiter() { return _oParamDelimiter; }
 	int getExitState();
+	inline int getExitCode() { return _poExternProgram->exitCode(); }
 
 	void addParameter( const QString &roParam, bool bAddDelimiter = true );
 	inline void clearParameters() { _oParameters.clear(); }
 	bool execProgram( const QString &roCwd = "." );
 	inline bool waitForFinished ( int iMSecs ) { return _poExternProgram->waitForFinished( iMSecs ); }
+	inline void kill() { _poExternProgram->kill(); }
 
 signals:
 	void nextOutput( const QByteArray &roData );
@@ -29,18 +29,26 @@ void CAMainWinProgressCtl::on_updateTimer_timeout() {
 			_updateTimer->stop();
 
 			delete _file;
+			_file = 0;
 		}
 	}
 }
 
+/*!
+	Asks the file operation to stop and removes the progress bar without waiting for the thread.
+	The file is deleted once its thread has finished.
+*/
 void CAMainWinProgressCtl::on_cancelButton_clicked(bool) {
 	if (_file) {
-		_file->exit();
+		_file->cancel();
 		restoreStatusBar();
 		_updateTimer->stop();
 
-		_file->wait();
-		delete _file;
+		connect( _file, SIGNAL(finished()), _file, SLOT(deleteLater()) );
+		if ( _file->isFinished() ) {
+			_file->deleteLater(); // finished before the connection, safe to call twice
+		}
+		_file = 0;
 	}
 }
 
@@ -15,6 +15,8 @@
 #include <QMessageBox>
 
 #include "core/settings.h"
+#include "core/typesetter.h"
+#include "layout/scorerenderer.h"
 #include "ui/mainwin.h"
 #include "export/svgexport.h"
 #include "control/printctl.h"
@@ -54,6 +56,10 @@ void CAPrintCtl::on_uiPrintDirectly_triggered() {
 
 void CAPrintCtl::printDocument()
 {
+	if ( CACanorus::settings()->typesetter()==CATypesetter::Canorus ) {
+		printNative();
+		return;
+	}
 	QDir oPath( QDir::tempPath() );
 	QFile oTempFile( oPath.absolutePath ()+"/print.svg" );
 	QString oTempFileName( oPath.absolutePath ()+"/print.svg" );
@@ -105,3 +111,38 @@ void CAPrintCtl::printSVG( int iExitCode )
 		oPainter.end();
 	}
 }
+
+/*!
+	Prints the current sheet using the built-in renderer without running the typesetter.
+	Unlike the LilyPond output, the sheet is split to as many pages as needed.
+*/
+void CAPrintCtl::printNative()
+{
+	if ( !_poMainWin->currentSheet() ) {
+		return;
+	}
+
+	QPrinter oPrinter( QPrinterInfo::defaultPrinter(), QPrinter::HighResolution );
+	oPrinter.setFullPage(true);
+	QPrintDialog oPrintDlg(&oPrinter);
+	if( _showDialog && !oPrintDlg.exec() ) {
+		return;
+	}
+
+	CAScoreRenderer oRenderer( _poMainWin->currentSheet() );
+	QRectF oPageRect( 0, 0, oPrinter.width(), oPrinter.height() );
+	oRenderer.paginate( oPageRect.size() );
+
+	QPainter oPainter;
+	if ( !oPainter.begin( &oPrinter ) ) {
+		QMessageBox::critical( _poMainWin, tr("Error while printing"), tr("Unable to start printing.") );
+		return;
+	}
+	for (int i=0; i<oRenderer.pageCount(); i++) {
+		if ( i ) {
+			oPrinter.newPage();
+		}
+		oRenderer.renderPage( &oPainter, i, oPageRect );
+	}
+	oPainter.end();
+}
@@ -37,6 +37,7 @@ protected slots:
 
 protected:
 	void printDocument();
+	void printNative();
 
 	CAMainWin   *_poMainWin;
 	CASVGExport *_poSVGExport;
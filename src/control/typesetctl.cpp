@@ -6,6 +6,24 @@
 */
 
 // Includes
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRunnable>
+#include <QThreadPool>
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
+
 #include "export/export.h"
 #include "control/externprogram.h"
 #include "control/typesetctl.h"
@@ -19,9 +37,21 @@
 	If the typesetter does not support creation of pdf files another process can
 	be started to do the conversion.
 
+	The typesetter output is cached. The key is a hash of the exported source, the typesetter
+	program, its version and its options. If the same source was already typeset with the same options,
+	runTypesetter() copies the output files from the cache and finishes immediately without
+	starting the typesetter. Previews of unchanged sheets are shown instantly this way and when
+	exporting the sheets one by one, only the changed sheets are typeset again. The cache is
+	stored in the per-user cachePath() and keeps at most CACHE_SIZE files. The typesetter version
+	is queried in the background by queryVersion(), the output isn't cached until it is known.
+
 	Constructor:
 */
 
+const int CATypesetCtl::CACHE_SIZE = 64;
+
+static const char *CACHE_EXTENSIONS[] = { "pdf", "svg", "ps", 0 }; // output files stored in the cache
+
 CATypesetCtl::CATypesetCtl()
 {
 	_poTypesetter = new CAExternProgram;
@@ -30,8 +60,14 @@ CATypesetCtl::CATypesetCtl()
 	_poOutputFile = 0;
 	_bPDFConversion = false;
 	_bOutputFileNameFirst = false;
+	_bCacheEnabled = true;
+	_bFromCache = false;
+	_bFinished = false;
+	_bKilled = false;
+	_iExitCode = 0;
 	connect( _poTypesetter, SIGNAL( programExited( int ) ), this, SLOT( typsetterExited( int ) ) );
 	connect( _poTypesetter, SIGNAL( nextOutput( const QByteArray & ) ), this, SLOT( rcvTypesetterOutput( const QByteArray & ) ) );
+	connect( _poConvPS2PDF, SIGNAL( programExited( int ) ), this, SLOT( pdfConverted( int ) ) );
 }
 
 // Destructor
@@ -229,15 +265,277 @@ void CATypesetCtl::exportSheet( CASheet *poSheet )
 	This method runs the typesetter. Make sure that all the
 	required name, path and parameters are set
 
+	Returns false, if the typesetter could not be started.
+
 	\sa setTypesetter( const QString &roProgramName, const QString &roProgramPath )
 */
-void CATypesetCtl::runTypesetter()
+bool CATypesetCtl::runTypesetter()
 {
+	_bFromCache = false;
+	_bFinished = false;
+	_bKilled = false;
+	_oCacheKey = ( _bCacheEnabled ? cacheKey() : QString() );
+	if( !_oCacheKey.isEmpty() && restoreFromCache( _oCacheKey ) )
+	{
+		_bFromCache = true;
+		_bFinished = true;
+		_iExitCode = 0;
+		emit typesetterFinished( 0 );
+		return true;
+	}
+
 	// Only add output file name as first parameter file name if it is needed
 	if( false == _bOutputFileNameFirst )
 		_poTypesetter->addParameter( _oOutputFileName, false );
 	if( !_poTypesetter->execProgram() )
+	{
 	  qCritical("TypesetCtl: Running typesetter failed!");
+	  _bFinished = true;
+	  _iExitCode = -1;
+	  return false;
+	}
+	return true;
+}
+
+/*!
+	Returns the directory where the typesetter output is cached.
+
+	The directory is in the cache location of the current user, so other users cannot read
+	or replace the cached output. If there is no such location, the user name is added to the
+	directory in the temporary path.
+*/
+QString CATypesetCtl::cachePath()
+{
+#if QT_VERSION >= 0x050000
+	QString oCacheDir = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+#else
+	QString oCacheDir = QDesktopServices::storageLocation( QDesktopServices::CacheLocation );
+#endif
+	if( !oCacheDir.isEmpty() )
+		return oCacheDir+"/typeset";
+
+	QProcessEnvironment oEnv = QProcessEnvironment::systemEnvironment();
+	QString oUser = oEnv.value( "USER", oEnv.value( "USERNAME" ) );
+	return QDir::tempPath()+"/canorus-typeset-cache-"+oUser;
+}
+
+/*!
+	Returns the full path of the given \a roProgram. Programs without a path are looked up in
+	the PATH environment variable. Returns an empty string, if the program was not found.
+*/
+static QString findProgram( const QString &roProgram )
+{
+	if( QFileInfo( roProgram ).isAbsolute() )
+		return QFileInfo( roProgram ).exists() ? roProgram : QString();
+
+#ifdef Q_OS_WIN
+	QStringList oDirs = QProcessEnvironment::systemEnvironment().value( "PATH" ).split( ';' );
+	QStringList oNames = QStringList() << roProgram << roProgram+".exe";
+#else
+	QStringList oDirs = QProcessEnvironment::systemEnvironment().value( "PATH" ).split( ':' );
+	QStringList oNames = QStringList() << roProgram;
+#endif
+	for( int i=0; i<oDirs.size(); i++ )
+		for( int j=0; j<oNames.size() && !oDirs[i].isEmpty(); j++ )
+		{
+			QFileInfo oInfo( QDir( oDirs[i] ).filePath( oNames[j] ) );
+			if( oInfo.isFile() && oInfo.isExecutable() )
+				return oInfo.absoluteFilePath();
+		}
+	return QString();
+}
+
+/*!
+	Versions of the typesetter programs by their full path, see CATypesetCtl::queryVersion().
+*/
+struct CAProgramVersion
+{
+	QDateTime  oModified; // modification time of the program file when it was queried
+	QByteArray oVersion;  // output of "--version"
+	bool       bPending;  // is the query still running
+};
+
+static QMutex oVersionMutex;
+static QHash< QString, CAProgramVersion > oVersions;
+
+/*!
+	Runs "program --version" in a worker thread and stores its output to the program versions.
+*/
+class CAVersionQuery : public QRunnable
+{
+public:
+	CAVersionQuery( const QString &roPath ) : _oPath( roPath ) { }
+	void run();
+
+private:
+	QString _oPath;
+};
+
+void CAVersionQuery::run()
+{
+	QProcess oProcess;
+	oProcess.start( _oPath, QStringList() << "--version" );
+	QByteArray oVersion;
+	if( oProcess.waitForFinished( 10000 ) )
+		oVersion = oProcess.readAllStandardOutput();
+	else
+	{
+		oProcess.kill();
+		oProcess.waitForFinished( 1000 );
+	}
+
+	QMutexLocker oLocker( &oVersionMutex );
+	oVersions[_oPath].oVersion = oVersion;
+	oVersions[_oPath].bPending = false;
+}
+
+/*!
+	Starts querying the version of the program at the full path \a roPath in the background,
+	unless it is already known or being queried. It is queried again only when the program file
+	was modified.
+*/
+static void startVersionQuery( const QString &roPath )
+{
+	QDateTime oModified = QFileInfo( roPath ).lastModified();
+
+	QMutexLocker oLocker( &oVersionMutex );
+	QHash< QString, CAProgramVersion >::const_iterator it = oVersions.constFind( roPath );
+	if( it!=oVersions.constEnd() && ( it.value().bPending || it.value().oModified==oModified ) )
+		return;
+
+	CAProgramVersion oVersion;
+	oVersion.oModified = oModified;
+	oVersion.bPending = true;
+	oVersions[roPath] = oVersion;
+	QThreadPool::globalInstance()->start( new CAVersionQuery( roPath ) );
+}
+
+/*!
+	Starts querying the version of the given typesetter program \a roProgram in the background.
+	The version is part of the cache key, so upgrading the typesetter doesn't reuse the output
+	of the old version.
+
+	Starting the typesetter takes a while, so this is called when the settings are loaded or
+	changed and cacheKey() never waits for the result.
+*/
+void CATypesetCtl::queryVersion( const QString &roProgram )
+{
+	QString oPath = findProgram( roProgram );
+	if( !oPath.isEmpty() )
+		startVersionQuery( oPath );
+}
+
+/*!
+	Sets \a roVersion to the modification time and the output of "--version" of the given
+	\a roProgram or to an empty array, if the program was not found.
+
+	Returns false, if the version is not known yet. The query is started in that case.
+
+	\sa CATypesetCtl::queryVersion()
+*/
+static bool programVersion( const QString &roProgram, QByteArray &roVersion )
+{
+	roVersion.clear();
+	QString oPath = findProgram( roProgram );
+	if( oPath.isEmpty() )
+		return true;
+	startVersionQuery( oPath ); // only when not known yet or modified
+
+	QMutexLocker oLocker( &oVersionMutex );
+	const CAProgramVersion &roProgramVersion = oVersions[oPath];
+	if( roProgramVersion.bPending )
+		return false;
+
+	roVersion = roProgramVersion.oModified.toString( Qt::ISODate ).toUtf8() + "\n" + roProgramVersion.oVersion;
+	return true;
+}
+
+/*!
+	Returns the hash of the exported source, the typesetter program, its version and its
+	parameters or an empty string, if the exported file cannot be read or the typesetter version
+	is not known yet. The output is not cached in that case.
+	The temporary file name is not part of the key as it is different on each run.
+*/
+QString CATypesetCtl::cacheKey()
+{
+	QFile oSource( _oOutputFileName );
+	if( _oOutputFileName.isEmpty() || !oSource.open( QIODevice::ReadOnly ) )
+		return QString();
+
+	QString oProgram = _poTypesetter->getProgramName();
+	if( !_poTypesetter->getProgramPath().isEmpty() )
+		oProgram = _poTypesetter->getProgramPath()+"/"+oProgram;
+
+	QByteArray oVersion;
+	if( !programVersion( oProgram, oVersion ) )
+		return QString();
+
+	QCryptographicHash oHash( QCryptographicHash::Sha1 );
+	oHash.addData( oSource.readAll() );
+	oHash.addData( _poTypesetter->getProgramPath().toUtf8() );
+	oHash.addData( _poTypesetter->getProgramName().toUtf8() );
+	oHash.addData( oVersion );
+	QStringList oParams = _poTypesetter->getParameters();
+	for( int i=0; i<oParams.size(); i++ )
+	{
+		oHash.addData( QString(oParams[i]).remove( _oOutputFileName ).toUtf8() );
+		oHash.addData( "\n", 1 );
+	}
+	return QString( oHash.result().toHex() );
+}
+
+/*!
+	Copies the cached output files of the given \a roKey next to the exported file.
+	Returns true, if any output was found in the cache.
+*/
+bool CATypesetCtl::restoreFromCache( const QString &roKey )
+{
+	QDir oDir( cachePath() );
+	bool bFound = false;
+	for( int i=0; CACHE_EXTENSIONS[i]; i++ )
+	{
+		QString oCached = oDir.filePath( roKey+"."+CACHE_EXTENSIONS[i] );
+		if( !QFile::exists( oCached ) )
+			continue;
+		QString oTarget = _oOutputFileName+"."+CACHE_EXTENSIONS[i];
+		QFile::remove( oTarget );
+		if( QFile::copy( oCached, oTarget ) )
+			bFound = true;
+	}
+	return bFound;
+}
+
+/*!
+	Stores the output files of the finished typesetter to the cache under the given \a roKey.
+	The oldest files are removed, if the cache contains more than CACHE_SIZE files.
+*/
+void CATypesetCtl::storeToCache( const QString &roKey )
+{
+	QDir oDir( cachePath() );
+	if( !oDir.exists() )
+	{
+		if( !oDir.mkpath( "." ) )
+		{
+			qWarning("TypesetCtl: Could not create the cache directory %s", qPrintable( cachePath() ) );
+			return;
+		}
+		// only the current user may read and replace the cached output
+		QFile::setPermissions( cachePath(), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner );
+	}
+
+	for( int i=0; CACHE_EXTENSIONS[i]; i++ )
+	{
+		QString oOutput = _oOutputFileName+"."+CACHE_EXTENSIONS[i];
+		if( !QFile::exists( oOutput ) )
+			continue;
+		QString oCached = oDir.filePath( roKey+"."+CACHE_EXTENSIONS[i] );
+		QFile::remove( oCached );
+		QFile::copy( oOutput, oCached );
+	}
+
+	QFileInfoList oFiles = oDir.entryInfoList( QDir::Files, QDir::Time ); // newest first
+	for( int i=CACHE_SIZE; i<oFiles.size(); i++ )
+		QFile::remove( oFiles[i].absoluteFilePath() );
 }
 
 /*!
@@ -245,6 +543,7 @@ void CATypesetCtl::runTypesetter()
 
 	Currently neither progress nor output messages are supported
 	when doing this conversion step. Only startup failures are handled.
+	The output is cached by pdfConverted() once the conversion finished.
 */
 bool CATypesetCtl::createPDF()
 {
@@ -268,13 +567,29 @@ void CATypesetCtl::rcvTypesetterOutput( const QByteArray &roData )
 	or until msecs milliseconds have passed.
 
 	Returns true if the process finished; otherwise returns false (if the operation timed
-	out or if an error occurred).
+	out or if an error occurred). Returns true immediately, if the output was taken from
+	the cache.
 */
 bool CATypesetCtl::waitForFinished ( int iMSecs )
 {
+	if( _bFromCache )
+		return true;
 	return _poTypesetter->waitForFinished( iMSecs );
 }
 
+/*!
+	Kills the running typesetter and the postscript to pdf conversion.
+
+	The run finishes with the exit code -1 and its output is neither converted nor cached.
+	Use waitForFinished() to wait for the processes to exit.
+*/
+void CATypesetCtl::kill()
+{
+	_bKilled = true;
+	_poTypesetter->kill();
+	_poConvPS2PDF->kill();
+}
+
 /*!
 	Send the exit code of the finished typesetter to a connected slot.
 
@@ -288,6 +603,8 @@ bool CATypesetCtl::waitForFinished ( int iMSecs )
 */
 void CATypesetCtl::typsetterExited( int iExitCode )
 {
+	if( _bKilled )
+		iExitCode = -1; // the output is incomplete
 	if( iExitCode != 0 )
 	  qCritical("TypesetCtl: Typesetter finished with code %d",iExitCode);
 	else if( _bPDFConversion )
@@ -295,5 +612,23 @@ void CATypesetCtl::typsetterExited( int iExitCode )
 		if( !createPDF() )
 	  	  qCritical("TypesetCtl: Creating pdf file failed!");
 	}
+	else if( !_oCacheKey.isEmpty() )
+		storeToCache( _oCacheKey );
+	_bFinished = true;
+	_iExitCode = iExitCode;
 	emit typesetterFinished( iExitCode );
 }
+
+/*!
+	Stores the output to the cache, when the conversion from postscript to pdf started by
+	typsetterExited() finished successfully with the given \a iExitCode.
+
+	\sa createPDF()
+*/
+void CATypesetCtl::pdfConverted( int iExitCode )
+{
+	if( iExitCode != 0 || _bKilled )
+	  qCritical("TypesetCtl: Converting to pdf finished with code %d",iExitCode);
+	else if( !_oCacheKey.isEmpty() )
+		storeToCache( _oCacheKey );
+}
@@ -36,15 +36,23 @@ public:
 	virtual void setTSetOption( const QVariant &roName, const QVariant &roValue, bool bSpace = false, bool bShortParam = true );
 	inline void setPDFConversion( bool bConversion ) { _bPDFConversion = bConversion; }
 	inline void setExporter( CAExport *poExport ) { _poExport = poExport ; }
+	inline void setCacheEnabled( bool bCache ) { _bCacheEnabled = bCache; }
 	// Attention: .pdf automatically added and removed if it was added internally
 	void exportDocument( CADocument *poDoc );
 	void exportSheet( CASheet *poSheet );
-	void runTypesetter();
+	bool runTypesetter();
 
 	inline bool getPDFConversion() { return _bPDFConversion; }
 	inline CAExport *getExporter() { return _poExport; }
 	inline QString getTempFilePath() { return _oOutputFileName; }
+	inline bool getCacheEnabled() { return _bCacheEnabled; }
+	inline bool isFromCache() { return _bFromCache; }
+	inline bool isFinished() { return _bFinished; }
+	inline int getExitCode() { return _iExitCode; }
+	static QString cachePath();
+	static void queryVersion( const QString &roProgram );
 	bool waitForFinished ( int iMSecs );
+	void kill();
 
 signals:
 	void nextOutput( const QByteArray &roData );
@@ -54,9 +62,13 @@ signals:
 protected slots:
 	void rcvTypesetterOutput( const QByteArray &roData );
 	void typsetterExited( int iExitCode );
+	void pdfConverted( int iExitCode );
 
 protected:
 	bool createPDF();
+	QString cacheKey();
+	bool restoreFromCache( const QString &roKey );
+	void storeToCache( const QString &roKey );
 
 	CAExternProgram    *_poTypesetter;      // Transforms exported file to pdf / postscript
 	CAExternProgram    *_poConvPS2PDF;   // Transforms postscripts files to pdf if needed
@@ -67,6 +79,14 @@ protected:
 	QString                    _oOutputFileName; // Output file name for pdf (temporary file deletes it on close)
 	bool                        _bPDFConversion;  // Do a conversion from postscript to pdf
 	bool                        _bOutputFileNameFirst; // File name as first parameter ? (Default: No)
+	bool                        _bCacheEnabled;   // Reuse the output of the same source and options (Default: Yes)
+	bool                        _bFromCache;      // Was the output of the last run taken from the cache
+	bool                        _bFinished;       // Did the last run finish
+	bool                        _bKilled;         // Was the last run killed
+	int                         _iExitCode;       // Exit code of the last finished run
+	QString                    _oCacheKey;       // Hash of the exported source and options of the last run
+
+	static const int            CACHE_SIZE;       // Maximum number of files kept in the cache
 };
 
 #endif // _TYPESET_CTL_H_
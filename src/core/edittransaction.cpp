@@ -0,0 +1,451 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QSet>
+#include <QPair>
+
+#include "core/edittransaction.h"
+#ifndef SWIGCPP
+#include "canorus.h"
+#endif
+
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/playable.h"
+#include "score/note.h"
+#include "score/clef.h"
+#include "score/lyricscontext.h"
+#include "score/functionmarkcontext.h"
+#include "score/figuredbasscontext.h"
+
+/*!
+	\class CAEditTransaction
+	\brief Batch of structural changes applied to the document at once
+
+	Inserting or removing music elements one by one requires the voices to be synchronized,
+	undo command to be created and the GUI to be rebuilt after every element. This is slow when
+	generating lots of elements, eg. in plugins or when pasting.
+
+	CAEditTransaction queues the insertions and removals and applies them in a single pass when
+	commit() is called. The edits of each voice are applied as a batch: the insertions first and
+	the removals after them, each followed by a single update of the times of the following
+	elements. After the edits are applied, each affected staff is synchronized once, lyrics of the
+	affected voices and function marks and figured bass of the affected sheets are reposited, a
+	single undo command is created for the whole transaction and only the affected sheet is
+	rebuilt.
+
+	The undo command is created by the hooks set by setUndoHooks(). Canorus sets them to its undo
+	stack, other hosts of the scripting modules may set their own.
+
+	Pass a null document, if the caller creates the undo command and rebuilds the GUI itself,
+	eg. when the edits are only a part of a larger change or are done by an import filter in its
+	own thread.
+
+	Use:
+	1) Create a CAEditTransaction for the document.
+	2) Queue changes by calling append(), insert() and remove().
+	3) Apply the changes by calling commit() or discard them by calling rollback().
+	   The changes are never applied implicitly. Uncommitted changes are discarded when the
+	   transaction is destroyed. The transaction never destroys the queued elements, the caller
+	   keeps their ownership until they are inserted.
+
+	\sa CAVoice::insert(), CAStaff::synchronizeVoices(), CAUndo
+*/
+
+CAEditTransaction::CACreateUndoHook CAEditTransaction::_createUndoHook = 0;
+CAEditTransaction::CAPushUndoHook CAEditTransaction::_pushUndoHook = 0;
+
+/*!
+	Creates a new empty transaction on the given \a document.
+	\a text is used as the undo command description.
+*/
+CAEditTransaction::CAEditTransaction( CADocument *document, const QString text ) {
+	_document = document;
+	_text = text;
+	_committed = false;
+}
+
+/*!
+	Destroys the transaction and discards any uncommitted changes.
+
+	\sa rollback()
+*/
+CAEditTransaction::~CAEditTransaction() {
+	rollback();
+}
+
+void CAEditTransaction::addEdit( CAEditType type, CAVoice *voice, CAMusElement *eltAfter, CAMusElement *elt, bool addToChord ) {
+	CAEdit e;
+	e.type = type;
+	e.voice = voice;
+	e.eltAfter = eltAfter;
+	e.elt = elt;
+	e.addToChord = addToChord;
+
+	_editList << e;
+}
+
+/*!
+	Queues appending of the \a elt at the end of the \a voice.
+
+	\sa CAVoice::append()
+*/
+void CAEditTransaction::append( CAVoice *voice, CAMusElement *elt, bool addToChord ) {
+	addEdit( Append, voice, 0, elt, addToChord );
+}
+
+/*!
+	Queues insertion of the \a elt before \a eltAfter in the \a voice.
+
+	\sa CAVoice::insert()
+*/
+void CAEditTransaction::insert( CAVoice *voice, CAMusElement *eltAfter, CAMusElement *elt, bool addToChord ) {
+	addEdit( Insert, voice, eltAfter, elt, addToChord );
+}
+
+/*!
+	Queues removal of the \a elt. The element is not destroyed, the caller takes its ownership
+	after commit().
+*/
+void CAEditTransaction::remove( CAMusElement *elt ) {
+	addEdit( Remove, 0, 0, elt, false );
+}
+
+/*!
+	Sets the hooks called by commit() to create the undo command before the changes are applied
+	and to push it after.
+
+	\a createUndo is called with the document and the undo text and returns True, if an undo
+	command was created. \a pushUndo is only called in that case. Pass null hooks to disable undo.
+*/
+void CAEditTransaction::setUndoHooks( CACreateUndoHook createUndo, CAPushUndoHook pushUndo ) {
+	_createUndoHook = createUndo;
+	_pushUndoHook = pushUndo;
+}
+
+/*!
+	Applies all the queued changes.
+
+	The insertions of each voice are applied before its removals. The elements queued for removal
+	are removed from their voices and contexts, but not destroyed.
+
+	Returns True, if all the changes were successfully applied; otherwise False.
+	Returns False, if the transaction was already committed.
+*/
+bool CAEditTransaction::commit() {
+	if ( _committed ) {
+		return false;
+	}
+	_committed = true;
+
+	if ( _editList.isEmpty() ) {
+		return true;
+	}
+
+	bool undo = ( _document && _createUndoHook && _createUndoHook( _document, _text ) );
+
+	bool res = true;
+	QList<CAStaff*> staffList;   // staffs to synchronize
+	QList<CAVoice*> voiceList;   // voices to apply the edits to and to reposit syllables of
+	QList<CASheet*> sheetList;   // sheets to reposit function marks and figured bass of and to rebuild
+	QHash< CAVoice*, QList<CAEdit> > insertions; // queued insertions per voice
+	QHash< CAVoice*, QList<CAEdit> > removals;   // queued removals per voice
+
+	for (int i=0; i<_editList.size(); i++) {
+		const CAEdit& e = _editList[i];
+		if ( !e.elt ) {
+			res = false;
+			continue;
+		}
+
+		CAVoice *voice = e.voice;
+		CAContext *context = e.elt->context();
+		if ( e.type==Remove ) {
+			if ( e.elt->isPlayable() ) {
+				voice = static_cast<CAPlayable*>(e.elt)->voice();
+			} else if ( context && context->contextType()==CAContext::Staff &&
+			            static_cast<CAStaff*>(context)->voiceList().size() ) {
+				voice = static_cast<CAStaff*>(context)->voiceList().first(); // shared signs are removed from all the voices
+			}
+		}
+		if ( voice ) {
+			context = voice->staff();
+			if ( !voiceList.contains(voice) )
+				voiceList << voice;
+		}
+
+		if ( context && context->contextType()==CAContext::Staff && !staffList.contains(static_cast<CAStaff*>(context)) )
+			staffList << static_cast<CAStaff*>(context);
+		if ( context && context->sheet() && !sheetList.contains(context->sheet()) )
+			sheetList << context->sheet();
+
+		if ( e.type!=Remove ) {
+			if ( voice )
+				insertions[voice] << e;
+			else
+				res = false;
+		} else if ( voice ) {
+			removals[voice] << e;
+		} else if ( !context || !context->remove( e.elt ) ) {
+			res = false;
+		}
+	}
+
+	_editList.clear();
+
+	for (int i=0; i<voiceList.size(); i++) {
+		if ( insertions.contains(voiceList[i]) && !applyInsertions( voiceList[i], insertions[voiceList[i]] ) )
+			res = false;
+	}
+
+	for (int i=0; i<voiceList.size(); i++) {
+		if ( removals.contains(voiceList[i]) && !applyRemovals( voiceList[i], removals[voiceList[i]] ) )
+			res = false;
+	}
+
+	for (int i=0; i<staffList.size(); i++) {
+		staffList[i]->synchronizeVoices();
+	}
+
+	for (int i=0; i<voiceList.size(); i++) {
+		for (int j=0; j<voiceList[i]->lyricsContextList().size(); j++) {
+			voiceList[i]->lyricsContextList()[j]->repositSyllables();
+		}
+	}
+
+	for (int i=0; i<sheetList.size(); i++) {
+		for (int j=0; j<sheetList[i]->contextList().size(); j++) {
+			CAContext *context = sheetList[i]->contextList()[j];
+			if ( context->contextType()==CAContext::FunctionMarkContext ) {
+				static_cast<CAFunctionMarkContext*>(context)->repositFunctions();
+			} else if ( context->contextType()==CAContext::FiguredBassContext ) {
+				static_cast<CAFiguredBassContext*>(context)->repositFiguredBassMarks();
+			}
+		}
+	}
+
+	if ( undo && _pushUndoHook ) {
+		_pushUndoHook( _document );
+	}
+
+#ifndef SWIGCPP
+	if ( _document ) {
+		if ( sheetList.size()==1 ) {
+			CACanorus::rebuildUI( _document, sheetList.first() );
+		} else {
+			CACanorus::rebuildUI( _document );
+		}
+	}
+#endif
+
+	return res;
+}
+
+/*!
+	Discards all the queued changes.
+
+	The queued elements are not destroyed. Elements queued for insertion are not part of the
+	document and remain owned by the caller.
+*/
+void CAEditTransaction::rollback() {
+	_editList.clear();
+}
+
+/*!
+	Inserts the queued \a edits to the \a voice in a single pass.
+
+	The times of the following elements are not updated after each insertion. An element inserted
+	in front of another one gets the current time of that element instead, so the voice stays
+	sorted and the elements can still be found. When all the elements are inserted, the elements
+	between the insertions are shifted one by one and the rest of the voice by a single
+	CAVoice::updateTimes().
+
+	Notes added to chords are inserted last, because the chords can only be told apart once the
+	times are updated.
+
+	Returns True, if all the elements were inserted; otherwise False.
+
+	\sa CAVoice::insert(), CAVoice::append()
+*/
+bool CAEditTransaction::applyInsertions( CAVoice *voice, const QList<CAEdit>& edits ) {
+	bool res = true;
+	QSet<CAMusElement*> inserted;            // all inserted elements
+	QSet<CAMusElement*> shifting;            // inserted playables the following elements are shifted for
+	int minTime = 0, maxTime = 0;            // old times of the shifting elements
+	QList< QPair<CANote*, CANote*> > chords; // notes to add to chords and their reference notes
+	QHash<CAMusElement*, CANote*> chordRefs; // reference notes of the notes to add to chords
+	CAClef *clef = 0;                        // first inserted clef
+
+	for (int i=0; i<edits.size(); i++) {
+		CAMusElement *elt = edits[i].elt;
+		CAMusElement *eltAfter = ( edits[i].type==Append ? 0 : edits[i].eltAfter );
+		if ( chordRefs.contains(eltAfter) ) // the note isn't in the voice yet
+			eltAfter = chordRefs[eltAfter];
+
+		bool toChord = ( edits[i].addToChord && elt->musElementType()==CAMusElement::Note );
+		if ( toChord && edits[i].type==Append ) {
+			eltAfter = voice->lastMusElement();
+			toChord = ( eltAfter && eltAfter->musElementType()==CAMusElement::Note );
+			if ( !toChord )
+				eltAfter = 0;
+		} else if ( toChord ) {
+			toChord = ( eltAfter && eltAfter->musElementType()==CAMusElement::Note );
+		}
+
+		// eltAfter should always be the first note in the chord, not counting the notes inserted in front of it
+		if ( edits[i].type==Insert && eltAfter && eltAfter->musElementType()==CAMusElement::Note && !inserted.contains(eltAfter) ) {
+			QList<CANote*> chord = static_cast<CANote*>(eltAfter)->getChord();
+			for (int j=0; j<chord.size(); j++) {
+				if ( !inserted.contains(chord[j]) ) {
+					eltAfter = chord[j];
+					break;
+				}
+			}
+		}
+
+		if ( toChord ) {
+			if ( voice->indexOf(eltAfter)==-1 ) {
+				res = false;
+			} else {
+				chords << qMakePair( static_cast<CANote*>(elt), static_cast<CANote*>(eltAfter) );
+				chordRefs[elt] = static_cast<CANote*>(eltAfter);
+			}
+			continue;
+		}
+
+		elt->setTimeStart( eltAfter?eltAfter->timeStart():voice->lastTimeEnd() );
+		if ( !voice->insertMusElement( eltAfter, elt ) ) {
+			res = false;
+			continue;
+		}
+
+		inserted << elt;
+		if ( eltAfter && elt->isPlayable() ) {
+			minTime = shifting.size() ? qMin( minTime, elt->timeStart() ) : elt->timeStart();
+			maxTime = shifting.size() ? qMax( maxTime, elt->timeStart() ) : elt->timeStart();
+			shifting << elt;
+		}
+		if ( !clef && elt->musElementType()==CAMusElement::Clef )
+			clef = static_cast<CAClef*>(elt);
+	}
+
+	if ( shifting.size() ) {
+		// find the last shifting element, the inserted elements share the time of the element after them
+		const QList<CAMusElement*>& list = voice->musElementList();
+		int first = voice->lowerBoundIndex( minTime );
+		int last = first;
+		for (int i=voice->lowerBoundIndex( maxTime ); i<list.size() && list[i]->timeStart()==maxTime; i++) {
+			if ( shifting.contains(list[i]) )
+				last = i;
+		}
+
+		int shift = 0;
+		for (int i=first; i<=last; i++) {
+			CAMusElement *elt = list[i];
+			if ( shift )
+				voice->shiftTime( elt, shift );
+			if ( shifting.contains(elt) )
+				shift += elt->timeLength();
+		}
+
+		voice->updateTimes( last+1, shift, true );
+	}
+
+	for (int i=0; i<chords.size(); i++) {
+		if ( !voice->addNoteToChord( chords[i].first, chords[i].second ) )
+			res = false;
+	}
+
+	// calculate note positions in staff when inserting a new clef
+	if ( clef ) {
+		const QList<CAMusElement*>& list = voice->musElementList();
+		for (int i=voice->indexOf(clef)+1; i<list.size(); i++) {
+			if ( list[i]->musElementType()==CAMusElement::Note )
+				static_cast<CANote*>(list[i])->setDiatonicPitch( static_cast<CANote*>(list[i])->diatonicPitch() );
+		}
+	}
+
+	return res;
+}
+
+/*!
+	Removes the queued \a edits from the \a voice in a single pass.
+
+	Removing a playable leaves a gap in the times. The gap is remembered by the element following
+	the removed one, or carried over to the next element, if that one is removed as well. The
+	voice stays sorted meanwhile and the elements can still be found. The gaps are closed at the
+	end by shifting the elements between them one by one and the rest of the voice by a single
+	CAVoice::updateTimes().
+
+	Elements in tuplets are removed by CAVoice::remove(), because removing the tuplet changes the
+	times of its other elements.
+
+	Returns True, if all the elements were removed; otherwise False.
+
+	\sa CAVoice::remove()
+*/
+bool CAEditTransaction::applyRemovals( CAVoice *voice, const QList<CAEdit>& edits ) {
+	bool res = true;
+	QHash<CAMusElement*, int> gaps; // time removed in front of the element
+
+	for (int i=0; i<edits.size(); i++) {
+		CAMusElement *elt = edits[i].elt;
+
+		if ( elt->isPlayable() && static_cast<CAPlayable*>(elt)->tuplet() ) {
+			closeGaps( voice, gaps );
+			if ( !voice->remove( elt ) )
+				res = false;
+			continue;
+		}
+
+		if ( voice->indexOf(elt)==-1 ) {
+			res = false;
+			continue;
+		}
+
+		int gap = gaps.take( elt ); // the gap in front of the removed element moves to the next one
+		int idx;
+		if ( voice->removeMusElement( elt, idx ) )
+			gap += elt->timeLength();
+
+		if ( gap && idx<voice->musElementList().size() )
+			gaps[ voice->musElementList()[idx] ] += gap;
+	}
+
+	closeGaps( voice, gaps );
+
+	return res;
+}
+
+/*!
+	Shifts back the elements of the \a voice for the \a gaps in front of them left by
+	applyRemovals() and clears the \a gaps.
+*/
+void CAEditTransaction::closeGaps( CAVoice *voice, QHash<CAMusElement*, int>& gaps ) {
+	if ( gaps.isEmpty() )
+		return;
+
+	const QList<CAMusElement*>& list = voice->musElementList();
+	int first = list.size(), last = -1;
+	for (QHash<CAMusElement*, int>::const_iterator it=gaps.constBegin(); it!=gaps.constEnd(); it++) {
+		int idx = voice->indexOf( it.key() );
+		first = qMin( first, idx );
+		last = qMax( last, idx );
+	}
+
+	int shift = 0;
+	for (int i=first; i<last; i++) {
+		shift -= gaps.value( list[i] );
+		if ( shift )
+			voice->shiftTime( list[i], shift );
+	}
+
+	voice->updateTimes( last, shift - gaps.value( list[last] ), true );
+	gaps.clear();
+}
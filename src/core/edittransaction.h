@@ -0,0 +1,72 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef EDITTRANSACTION_H_
+#define EDITTRANSACTION_H_
+
+#include <QList>
+#include <QHash>
+#include <QString>
+
+class CADocument;
+class CASheet;
+class CAVoice;
+class CAMusElement;
+
+class CAEditTransaction {
+public:
+	typedef bool (*CACreateUndoHook)( CADocument*, const QString& );
+	typedef void (*CAPushUndoHook)( CADocument* );
+
+	CAEditTransaction( CADocument *document, const QString text=QString() );
+	~CAEditTransaction();
+
+	inline CADocument *document() { return _document; }
+	inline const QString text() { return _text; }
+
+	void append( CAVoice *voice, CAMusElement *elt, bool addToChord=false );
+	void insert( CAVoice *voice, CAMusElement *eltAfter, CAMusElement *elt, bool addToChord=false );
+	void remove( CAMusElement *elt );
+
+	bool commit();
+	void rollback();
+
+	inline bool isEmpty() { return _editList.isEmpty(); }
+	inline bool isCommitted() { return _committed; }
+
+	static void setUndoHooks( CACreateUndoHook createUndo, CAPushUndoHook pushUndo );
+
+private:
+	enum CAEditType {
+		Append,
+		Insert,
+		Remove
+	};
+
+	struct CAEdit {
+		CAEditType type;
+		CAVoice *voice;
+		CAMusElement *eltAfter;
+		CAMusElement *elt;
+		bool addToChord;
+	};
+
+	void addEdit( CAEditType type, CAVoice *voice, CAMusElement *eltAfter, CAMusElement *elt, bool addToChord );
+	bool applyInsertions( CAVoice *voice, const QList<CAEdit>& edits );
+	bool applyRemovals( CAVoice *voice, const QList<CAEdit>& edits );
+	void closeGaps( CAVoice *voice, QHash<CAMusElement*, int>& gaps );
+
+	static CACreateUndoHook _createUndoHook;
+	static CAPushUndoHook _pushUndoHook;
+
+	CADocument *_document;
+	QString _text;
+	QList<CAEdit> _editList; // queued edits in order of creation
+	bool _committed;
+};
+
+#endif /* EDITTRANSACTION_H_ */
@@ -22,6 +22,9 @@
 	defined by the filter. Waiting for the thread to be finished can be implemented by calling QThread::wait()
 	or by catching the signals emitted by children import and export classes.
 
+	The operation is cancelled by calling cancel(). Filters which run for a long time poll isCancelled()
+	and stop as soon as possible, the thread still has to finish before the filter can be deleted.
+
 	\sa CAImport, CAExport
 */
 
@@ -31,6 +34,7 @@ CAFile::CAFile() : QThread() {
 	setStream( 0 );
 	setFile( 0 );
 	_deleteStream = false;
+	_cancelled = false;
 }
 
 /*!
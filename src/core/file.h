@@ -21,6 +21,8 @@ public:
 	inline const int status() { return _status; }
 	inline const int progress() { return _progress; }
 	virtual const QString readableStatus() = 0;
+	inline void cancel() { _cancelled = true; }
+	inline bool isCancelled() { return _cancelled; }
 	void setStreamFromFile( const QString filename );
 	void setStreamToFile( const QString filename );
 	void setStreamFromDevice( QIODevice* device );
@@ -45,6 +47,7 @@ private:
 	QTextStream *_stream;
 	QFile *_file;
 	bool _deleteStream;	 // whether to delete stream when destroyed.
+	volatile bool _cancelled; // set by the user, polled by the filter in its thread
 };
 
 #endif /* FILE_H_ */
@@ -9,7 +9,9 @@
 
 #include "core/notechecker.h"
 #include "score/sheet.h"
+#include "score/sheetcolumns.h"
 #include "score/staff.h"
+#include "score/measuretable.h"
 #include "score/playablelength.h"
 #include "score/timesignature.h"
 #include "score/barline.h"
@@ -22,6 +24,9 @@
 	This class is spell checker that provides tools for checking potential
 	"typing" errors made by the user such as too little notes not filling the bar
 	and similar.
+
+	Checks of single elements scan the columns of the sheet (see CASheetColumns)
+	instead of walking the music elements of every voice.
 */
 
 CANoteChecker::CANoteChecker() {
@@ -39,36 +44,34 @@ void CANoteChecker::checkSheet(CASheet *sheet) {
 	// check for incomplete bars
 	QList<CAStaff*> staffs = sheet->staffList();
 	for (int i=0; i<staffs.size(); i++) {
-		QList<CAMusElement*> timeSigs = staffs[i]->timeSignatureRefs();
-		QList<CAMusElement*> barlines = staffs[i]->barlineRefs();
-		
-		if (!timeSigs.size()) {
-			continue;
-		}
-		
-		int lastTimeSigIdx = 0;
-		int lastTimeSigRequiredDuration = static_cast<CATimeSignature*>(timeSigs[lastTimeSigIdx])->barDuration();
-		int lastBarlineTime = -1;
-		for (int j=0; j<barlines.size(); j++) {
-			if (static_cast<CABarline*>(barlines[j])->barlineType()==CABarline::Dotted) {
+		CAMeasureTable *measures = staffs[i]->measureTable();
+		for (int j=0; j<measures->measureCount(); j++) {
+			const CAMeasureTable::CAMeasure& m = measures->measure(j);
+			if (!m.barline || !m.timeSignature) {
 				continue;
 			}
 
-			if (((lastTimeSigIdx+1)<timeSigs.size()) && barlines[j]->timeStart()>timeSigs[lastTimeSigIdx]->timeStart() ) {
-				// go to next time sig
-				lastTimeSigIdx++;
-				lastTimeSigRequiredDuration = static_cast<CATimeSignature*>(timeSigs[lastTimeSigIdx])->barDuration();
-			}
-			
 			// check the bar duration.
 			// If first bar is partial, the length should be shorter or equal to time sig.
-			if ((lastBarlineTime == -1 && barlines[j]->timeStart()>lastTimeSigRequiredDuration) ||
-				(lastBarlineTime != -1 && barlines[j]->timeStart()!=lastBarlineTime+lastTimeSigRequiredDuration)) {
-				CANoteCheckerError *nce = new CANoteCheckerError(barlines[j], QObject::tr("Bar duration incorrect."));
+			int requiredDuration = m.timeSignature->barDuration();
+			if ((j==0 && m.timeEnd-m.timeStart>requiredDuration) ||
+				(j!=0 && m.timeEnd-m.timeStart!=requiredDuration)) {
+				CANoteCheckerError *nce = new CANoteCheckerError(m.barline, QObject::tr("Bar duration incorrect."));
 				sheet->addNoteCheckerError(nce);
 			}
-			
-			lastBarlineTime = barlines[j]->timeStart();
+		}
+	}
+
+	// check for notes which can't be played.
+	// The checker is called right after the edit, before the document version is increased.
+	sheet->invalidateColumns();
+	QSharedPointer<const CASheetColumns> columns = sheet->columns();
+	const QVector<unsigned char>& types = columns->typeColumn();
+	const QVector<short>& pitches = columns->midiPitchColumn();
+	for (int i=0; i<columns->size(); i++) {
+		if (types[i]==CAMusElement::Note && (pitches[i]<0 || pitches[i]>127)) {
+			CANoteCheckerError *nce = new CANoteCheckerError(columns->elementColumn()[i], QObject::tr("Note out of the MIDI range."));
+			sheet->addNoteCheckerError(nce);
 		}
 	}
 }
@@ -8,6 +8,7 @@
 #include <QDebug>
 
 #include "core/settings.h"
+#include "control/typesetctl.h"
 #ifndef SWIGCPP
 #include "canorus.h"
 #endif
@@ -33,6 +34,7 @@ const bool   CASettings::DEFAULT_LOCK_SCROLL_PLAYBACK = true; // scroll while pl
 const bool   CASettings::DEFAULT_ANIMATED_SCROLL = true;
 const bool   CASettings::DEFAULT_ANTIALIASING = true;
 const bool   CASettings::DEFAULT_SHOW_RULER = true;
+const int    CASettings::DEFAULT_LAZY_LAYOUT_BARS = 16;
 const QColor CASettings::DEFAULT_BACKGROUND_COLOR = QColor(255, 255, 240);
 const QColor CASettings::DEFAULT_FOREGROUND_COLOR = Qt::black;
 const QColor CASettings::DEFAULT_SELECTION_COLOR = Qt::red;
@@ -58,6 +60,14 @@ const QString                        CASettings::DEFAULT_TYPESETTER_LOCATION = "
 const bool                           CASettings::DEFAULT_USE_SYSTEM_TYPESETTER = true;
 const QString                        CASettings::DEFAULT_PDF_VIEWER_LOCATION = "";
 const bool                           CASettings::DEFAULT_USE_SYSTEM_PDF_VIEWER = true;
+const int                            CASettings::DEFAULT_TYPESETTER_JOBS = 1;
+#ifdef Q_OS_WIN64
+const QString                        CASettings::DEFAULT_PDF_MERGER_LOCATION = "gswin64c"; // console ghostscript, shipped with LilyPond
+#elif defined(Q_OS_WIN)
+const QString                        CASettings::DEFAULT_PDF_MERGER_LOCATION = "gswin32c";
+#else
+const QString                        CASettings::DEFAULT_PDF_MERGER_LOCATION = "gs"; // ghostscript, shipped with LilyPond
+#endif
 
 /*!
 	\class CASettings
@@ -155,6 +165,7 @@ void CASettings::writeSettings() {
 	setValue( "appearance/selectedcontextcolor", selectedContextColor() );
 	setValue( "appearance/hiddenelementscolor",hiddenElementsColor() );
 	setValue( "appearance/disabledelementscolor", disabledElementsColor() );
+	setValue( "appearance/lazylayoutbars", lazyLayoutBars() );
 #endif
 	setValue( "rtmidi/midioutport", midiOutPort() );
 	setValue( "rtmidi/midiinport", midiInPort() );
@@ -166,6 +177,8 @@ void CASettings::writeSettings() {
 	setValue( "printing/usesystemdefaulttypesetter", useSystemDefaultTypesetter() );
 	setValue( "printing/pdfviewerlocation", pdfViewerLocation() );
 	setValue( "printing/usesystemdefaultpdfviewer", useSystemDefaultPdfViewer() );
+	setValue( "printing/typesetterjobs", typesetterJobs() );
+	setValue( "printing/pdfmergerlocation", pdfMergerLocation() );
 
 	sync();
 }
@@ -288,6 +301,11 @@ int CASettings::readSettings() {
 	else
 		setShowRuler( DEFAULT_SHOW_RULER );
 
+	if ( contains("appearance/lazylayoutbars") )
+		setLazyLayoutBars( value("appearance/lazylayoutbars").toInt() );
+	else
+		setLazyLayoutBars( DEFAULT_LAZY_LAYOUT_BARS );
+
 #endif
 	// Playback settings
 	if ( contains("rtmidi/midiinport")
@@ -352,6 +370,9 @@ int CASettings::readSettings() {
 	else
 		setUseSystemDefaultTypesetter( DEFAULT_USE_SYSTEM_TYPESETTER );
 
+	// the typesetter version is part of the typesetter cache key
+	CATypesetCtl::queryVersion( useSystemDefaultTypesetter() ? DEFAULT_TYPESETTER_LOCATION : typesetterLocation() );
+
 	if ( contains("printing/pdfviewerlocation") )
 		setPdfViewerLocation( value("printing/pdfviewerlocation").toString() );
 	else
@@ -362,6 +383,16 @@ int CASettings::readSettings() {
 	else
 		setUseSystemDefaultPdfViewer( DEFAULT_USE_SYSTEM_PDF_VIEWER );
 
+	if ( contains("printing/typesetterjobs") )
+		setTypesetterJobs( value("printing/typesetterjobs").toInt() );
+	else
+		setTypesetterJobs( DEFAULT_TYPESETTER_JOBS );
+
+	if ( contains("printing/pdfmergerlocation") )
+		setPdfMergerLocation( value("printing/pdfmergerlocation").toString() );
+	else
+		setPdfMergerLocation( DEFAULT_PDF_MERGER_LOCATION );
+
 	return settingsPage;
 
 	// Action / Command settings
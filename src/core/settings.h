@@ -84,6 +84,9 @@ public:
 	inline bool showRuler() { return _showRuler; }
 	inline void setShowRuler( bool b ) { _showRuler = b; }
 	static const bool DEFAULT_SHOW_RULER;
+	inline int lazyLayoutBars() { return _lazyLayoutBars; }
+	inline void setLazyLayoutBars( int b ) { _lazyLayoutBars = b; }
+	static const int DEFAULT_LAZY_LAYOUT_BARS;
 	inline QColor backgroundColor() { return _backgroundColor; }
 	inline void setBackgroundColor( QColor backgroundColor ) { _backgroundColor = backgroundColor; }
 	static const QColor DEFAULT_BACKGROUND_COLOR;
@@ -141,6 +144,12 @@ public:
 	inline bool useSystemDefaultPdfViewer() { return _useSystemDefaultPdfViewer; }
 	void setUseSystemDefaultPdfViewer( bool s ) { _useSystemDefaultPdfViewer= s; }
 	static const bool DEFAULT_USE_SYSTEM_PDF_VIEWER;
+	inline int typesetterJobs() { return _typesetterJobs; }
+	void setTypesetterJobs( int j ) { _typesetterJobs = j; }
+	static const int DEFAULT_TYPESETTER_JOBS;
+	inline QString pdfMergerLocation() { return _pdfMergerLocation; }
+	void setPdfMergerLocation( QString ml ) { _pdfMergerLocation = ml; }
+	static const QString DEFAULT_PDF_MERGER_LOCATION;
 
 	///////////////////////////////
 	// Action / Command settings //
@@ -197,6 +206,7 @@ private:
 	bool   _animatedScroll;
 	bool   _antiAliasing;
 	bool   _showRuler;
+	int    _lazyLayoutBars; // number of bars laid out at once ahead of the viewport, 0 lays out the whole sheet
 	QColor _backgroundColor;
 	QColor _foregroundColor;
 	QColor _selectionColor;
@@ -221,6 +231,8 @@ private:
 	bool                           _useSystemDefaultTypesetter;
 	QString                        _pdfViewerLocation;
 	bool                           _useSystemDefaultPdfViewer;
+	int                            _typesetterJobs;    // concurrent typesetter processes for multi-sheet documents, 1 typesets the whole document at once, 0 uses all the processors
+	QString                        _pdfMergerLocation; // program merging the typeset sheets into a single pdf
 
 /*
 % To adjust the size of notes and fonts in points, it can be done like this:
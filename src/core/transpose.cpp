@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
 */
 
+#include <QVector>
+
 #include "core/transpose.h"
 
 #include "score/staff.h"
@@ -116,18 +118,87 @@ void CATranspose::transposeByKeySig( CADiatonicKey from, CADiatonicKey to, int d
 	If the interval quantity is negative, elements are transposed down.
  */
 void CATranspose::transposeByInterval( CAInterval interval ) {
+	transpose( interval, true, false, 0 );
+}
+
+/*!
+	Changes note accidentals dependent on \a type:
+	1) If type==1, sharps -> flats
+	2) If type==-1, flats -> sharps
+	3) if type==0, invert
+
+	This function also changes Key signatures dependent on \a type, if their
+	number of accidentals is greater or equal than 5 or lesser or equal than -5.
+*/
+void CATranspose::reinterpretAccidentals( int type ) {
+	transpose( CAInterval( CAInterval::Perfect, CAInterval::Prime ), false, true, type );
+}
+
+/*!
+	Transposes the music elements by the given \a interval and reinterprets the accidentals
+	of the transposed notes and key signatures dependent on \a type in the same pass.
+
+	\sa transposeByInterval(), reinterpretAccidentals()
+*/
+void CATranspose::transposeAndReinterpret( CAInterval interval, int type ) {
+	transpose( interval, true, true, type );
+}
+
+/*!
+	Table of pitch changes for the note names inside the octave.
+
+	The result of adding an interval to the diatonic pitch only depends on the note name inside
+	the octave. The interval is added to the 7 note names when the table is created and the
+	table is then applied to any number of notes.
+*/
+struct CAPitchTable {
+	CAPitchTable( CAInterval i ) : interval(i) {
+		for (int n=0; n<7; n++) {
+			CADiatonicPitch base( n+28, 0 ); // any octave with non-negative note names
+			CADiatonicPitch p = base + interval;
+			noteNameDelta[n] = p.noteName() - base.noteName();
+			accsDelta[n] = p.accs();
+		}
+	}
+
+	inline CADiatonicPitch apply( CADiatonicPitch p ) const {
+		if ( p.noteName()<0 ) {
+			return p + interval; // the table only covers non-negative note names
+		}
+
+		int n = p.noteName()%7;
+		return CADiatonicPitch( p.noteName()+noteNameDelta[n], p.accs()+accsDelta[n] );
+	}
+
+	CAInterval interval;
+	int noteNameDelta[7];
+	int accsDelta[7];
+};
+
+/*!
+	Transposes the elements by the given \a interval, if \a doTranspose is True, and then
+	reinterprets the accidentals, if \a doReinterpret is True. See reinterpretAccidentals()
+	for \a type.
+
+	Notes are gathered into an array first. New pitches are computed in a single pass using the
+	precomputed tables and only the changed notes are written back.
+*/
+void CATranspose::transpose( CAInterval interval, bool doTranspose, bool doReinterpret, int type ) {
+	QVector<CANote*> notes;
+	QVector<CAKeySignature*> keySigs;
+	QVector<CAFunctionMark*> functionMarks;
+	notes.reserve( _elements.size() );
+
 	foreach ( CAMusElement *elt, _elements ) {
 		switch ( elt->musElementType() ) {
-		case CAMusElement::Note: {
-			CADiatonicPitch newPitch = static_cast<CANote*>(elt)->diatonicPitch() + interval;
-			static_cast<CANote*>(elt)->setDiatonicPitch( newPitch );
+		case CAMusElement::Note:
+			notes << static_cast<CANote*>(elt);
 			break;
-		}
 		case CAMusElement::KeySignature:
-			static_cast<CAKeySignature*>(elt)->setDiatonicKey( static_cast<CAKeySignature*>(elt)->diatonicKey() + interval );
+			keySigs << static_cast<CAKeySignature*>(elt);
 			break;
 		case CAMusElement::FunctionMark:
-			static_cast<CAFunctionMark*>(elt)->setKey( static_cast<CAFunctionMark*>(elt)->key() + interval );
+			functionMarks << static_cast<CAFunctionMark*>(elt);
 			break;
 		case CAMusElement::MidiNote: // ToDo
 		case CAMusElement::Clef: // ToDo
@@ -143,57 +214,58 @@ void CATranspose::transposeByInterval( CAInterval interval ) {
 			break;
 		}
 	}
-}
 
-/*!
-	Changes note accidentals dependent on \a type:
-	1) If type==1, sharps -> flats
-	2) If type==-1, flats -> sharps
-	3) if type==0, invert
+	const CAPitchTable transposeTable( interval );
+	const CAPitchTable sharpsToFlats( CAInterval(-2, 2) );
+	const CAPitchTable flatsToSharps( CAInterval(-2, -2) );
 
-	This function also changes Key signatures dependent on \a type, if their
-	number of accidentals is greater or equal than 5 or lesser or equal than -5.
-*/
-void CATranspose::reinterpretAccidentals( int type ) {
-	foreach ( CAMusElement *elt, _elements ) {
-		switch ( elt->musElementType() ) {
-		case CAMusElement::Note: {
-			CANote *note = static_cast<CANote*>(elt);
-			CADiatonicPitch newPitch = static_cast<CANote*>(elt)->diatonicPitch();
-			if ( type >= 0 && note->diatonicPitch().accs() > 0 ) {
-				newPitch = static_cast<CANote*>(elt)->diatonicPitch() + CAInterval(-2, 2);
+	// notes
+	QVector<CADiatonicPitch> pitches( notes.size() );
+	for (int i=0; i<notes.size(); i++) {
+		pitches[i] = notes[i]->diatonicPitch();
+	}
+
+	for (int i=0; i<pitches.size(); i++) {
+		CADiatonicPitch p = pitches[i];
+		if ( doTranspose ) {
+			p = transposeTable.apply( p );
+		}
+		if ( doReinterpret ) {
+			if ( type >= 0 && p.accs() > 0 ) {
+				p = sharpsToFlats.apply( p );
 			} else
-			if ( type <= 0 && note->diatonicPitch().accs() < 0 ) {
-				newPitch = static_cast<CANote*>(elt)->diatonicPitch() - CAInterval(-2, 2);
+			if ( type <= 0 && p.accs() < 0 ) {
+				p = flatsToSharps.apply( p );
 			}
-			note->setDiatonicPitch( newPitch );
-			break;
 		}
-		case CAMusElement::KeySignature: {
-			CAKeySignature *keySig = static_cast<CAKeySignature*>(elt);
-			CADiatonicKey newDiatonicKey = keySig->diatonicKey();
-			if ( type >= 0 && keySig->diatonicKey().numberOfAccs() >= 5 ) {
-				newDiatonicKey = CADiatonicKey(keySig->diatonicKey().diatonicPitch()+CAInterval(-2,2), keySig->diatonicKey().gender() );
+		pitches[i] = p;
+	}
+
+	for (int i=0; i<notes.size(); i++) {
+		if ( pitches[i] != notes[i]->diatonicPitch() ) {
+			notes[i]->setDiatonicPitch( pitches[i] );
+		}
+	}
+
+	// key signatures
+	for (int i=0; i<keySigs.size(); i++) {
+		CADiatonicKey key = keySigs[i]->diatonicKey();
+		if ( doTranspose ) {
+			key = key + interval;
+		}
+		if ( doReinterpret ) {
+			if ( type >= 0 && key.numberOfAccs() >= 5 ) {
+				key = CADiatonicKey( sharpsToFlats.apply( key.diatonicPitch() ), key.gender() );
 			} else
-			if ( type <= 0 && keySig->diatonicKey().numberOfAccs() <= -5 ) {
-				newDiatonicKey = CADiatonicKey(keySig->diatonicKey().diatonicPitch()-CAInterval(-2,2), keySig->diatonicKey().gender() );
+			if ( type <= 0 && key.numberOfAccs() <= -5 ) {
+				key = CADiatonicKey( flatsToSharps.apply( key.diatonicPitch() ), key.gender() );
 			}
-			keySig->setDiatonicKey( newDiatonicKey );
-			break;
-		}
-		case CAMusElement::MidiNote:
-		case CAMusElement::Clef:
-		case CAMusElement::FunctionMark:
-		case CAMusElement::FiguredBassMark:
-		case CAMusElement::Rest:
-		case CAMusElement::Barline:
-		case CAMusElement::TimeSignature:
-		case CAMusElement::Slur:
-		case CAMusElement::Tuplet:
-		case CAMusElement::Syllable:
-		case CAMusElement::Mark:
-		case CAMusElement::Undefined:
-			break;
 		}
+		keySigs[i]->setDiatonicKey( key );
+	}
+
+	// function marks
+	for (int i=0; doTranspose && i<functionMarks.size(); i++) {
+		functionMarks[i]->setKey( functionMarks[i]->key() + interval );
 	}
 }
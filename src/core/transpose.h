@@ -32,12 +32,15 @@ public:
 	void transposeByInterval( CAInterval );
 	void transposeByKeySig( CADiatonicKey from, CADiatonicKey to, int direction );
 	void reinterpretAccidentals( int type );
+	void transposeAndReinterpret( CAInterval interval, int type );
 
 	void addSheet( CASheet *s );
 	void addContext( CAContext *context );
 	void addMusElement( CAMusElement *musElt) { _elements << musElt; }
 
 private:
+	void transpose( CAInterval interval, bool doTranspose, bool doReinterpret, int type );
+
 	QSet<CAMusElement*> _elements;
 };
 
@@ -11,7 +11,8 @@
 class CATypesetter {
 public:
 	enum CATypesetterType { // used for storing the default typesetter in settings
-		LilyPond = 1
+		LilyPond = 1,
+		Canorus = 2   // native renderer, see CAScoreRenderer
 	};
 
 	CATypesetter();
@@ -15,6 +15,7 @@
 #include "score/document.h"
 #include "score/sheet.h"
 #include "score/staff.h"
+#include "score/measuretable.h"
 #include "score/voice.h"
 #include "score/mark.h"
 #include "score/articulation.h"
@@ -515,16 +516,14 @@ void CALilyPondExport::doAnacrusisCheck(CATimeSignature *time) {
 				}
 
 				int oneBar = time->beats()*beatNoteLen;
+				CAMeasureTable *measures = curVoice()->staff()->measureTable();
 				int barlen = 0;
-				for (int i=0; i<curVoice()->musElementList().size(); i++) {
-					if (curVoice()->musElementList()[i]->isPlayable()) {
-						barlen += curVoice()->musElementList()[i]->timeLength();
-					}
-					// if it's a whole bar or beyond no upbeat (probably a staff without barlines)
-					if (barlen >= oneBar) return;
-
-					if (curVoice()->musElementList()[i]->musElementType() == CAMusElement::Barline) break;
+				if (measures->measureCount()) {
+					barlen = measures->measure(0).timeEnd - measures->measure(0).timeStart;
 				}
+				// if it's a whole bar or beyond no upbeat (probably a staff without barlines)
+				if (barlen >= oneBar) return;
+
 				CAPlayableLength res = CAPlayableLength( CAPlayableLength::HundredTwentyEighth );
 				out() << "\\partial "
 				<<res.musicLength()
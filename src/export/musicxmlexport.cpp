@@ -17,6 +17,7 @@
 #include "score/sheet.h"
 #include "score/context.h"
 #include "score/staff.h"
+#include "score/measuretable.h"
 #include "score/voice.h"
 #include "score/note.h"
 #include "score/rest.h"
@@ -114,62 +115,51 @@ void CAMusicXmlExport::exportSheetImpl(CASheet *sheet) {
 
 /*!
  * Exports the given staff to the provided DOM part element.
+ * Measures are taken from the staff measure table.
  */
 void CAMusicXmlExport::exportStaffImpl(CAStaff* staff, QDomElement& xmlPart) {
-	int measureNumber = 1;
-	int voicesFinished=0;
-	
 	QList<CAVoice*> voiceList = staff->voiceList();
-	int *curIndex = new int[voiceList.size()]; // frontline of exported elements
-	for (int i=0; i<voiceList.size(); i++) { curIndex[i]=0; }
+	CAMeasureTable *measures = staff->measureTable();
 	
-	while (voicesFinished < voiceList.size()) {
+	for (int i=0; i<measures->measureCount(); i++) {
 		// write the measure content
 		QDomElement xmlMeasure = _xmlDoc->createElement("measure");
-		xmlMeasure.setAttribute("number",measureNumber);
+		xmlMeasure.setAttribute("number",i+1);
 		
-		exportMeasure(voiceList, curIndex, xmlMeasure);
+		const CAMeasureTable::CAMeasure& measure = measures->measure(i);
+		exportMeasure(voiceList, measure.startIndex, measure.endIndex, xmlMeasure);
 		
 		xmlPart.appendChild(xmlMeasure);
+	}
+	
+	if (!measures->measureCount()) {
+		// empty staff, the part should contain at least one measure
+		QDomElement xmlMeasure = _xmlDoc->createElement("measure");
+		xmlMeasure.setAttribute("number",1);
 		
-		// check the end of staff
-		voicesFinished=0;
-		for (int i=0; i<voiceList.size(); i++) {
-			if (curIndex[i]>=voiceList[i]->musElementList().size()-1) {
-				// voice is finished, if a final barline is reached (curIndex=size()-1)
-				// or, if a final note is reached and there is no barline afterwards (curIndex=size())
-				voicesFinished++;
-			}
-		}
+		QVector<int> emptyRange(voiceList.size(), 0);
+		exportMeasure(voiceList, emptyRange, emptyRange, xmlMeasure);
 		
-		measureNumber++;
+		xmlPart.appendChild(xmlMeasure);
 	}
 }
 
 /*!
- * Exports the voice elements at provided indices to the given DOM measure
- * element.
+ * Exports the voice elements in the index ranges [startIndex, endIndex) to
+ * the given DOM measure element.
  */
-void CAMusicXmlExport::exportMeasure(QList<CAVoice*>& voiceList, int *curIndex, QDomElement& xmlMeasure) {
+void CAMusicXmlExport::exportMeasure(QList<CAVoice*>& voiceList, const QVector<int>& startIndex, const QVector<int>& endIndex, QDomElement& xmlMeasure) {
 	QList<CAMusElement*> attributeChanges;
 	
-	// find the target barline which closes the measure
-	// since barlines are common to all voices, scanning the first voice suffices
-	// meanwhile, remember any clef/key/time changes
-	CABarline *targetBarline = 0;
-	int j=curIndex[0]+1;
-	while (j<voiceList[0]->musElementList().size() &&
-			voiceList[0]->musElementList()[j]->musElementType()!=CAMusElement::Barline ) {
-		CAMusElement::CAMusElementType t = voiceList[0]->musElementList()[j-1]->musElementType();
+	// remember any clef/key/time changes
+	// since signs are common to all voices, scanning the first voice suffices
+	for (int j=0; voiceList.size() && j<endIndex[0]-startIndex[0]; j++) {
+		CAMusElement *elt = voiceList[0]->musElementList()[startIndex[0]+j];
+		CAMusElement::CAMusElementType t = elt->musElementType();
 		
 		if (t==CAMusElement::Clef || t==CAMusElement::TimeSignature || t==CAMusElement::KeySignature) {
-			attributeChanges << voiceList[0]->musElementList()[j-1];
+			attributeChanges << elt;
 		}
-		j++;
-	}
-	
-	if (j<voiceList[0]->musElementList().size()) {
-		targetBarline = static_cast<CABarline*>(voiceList[0]->musElementList()[j]);
 	}
 
 	// check for attributes changes in the first pass
@@ -215,10 +205,9 @@ void CAMusicXmlExport::exportMeasure(QList<CAVoice*>& voiceList, int *curIndex,
 	// export notes and rests
 	for (int i=0; i<voiceList.size(); i++) {
 		CAVoice *v = voiceList[i];
-		while (curIndex[i]<v->musElementList().size() &&
-		       v->musElementList()[curIndex[i]]!=targetBarline) {
-			if (v->musElementList()[curIndex[i]]->isPlayable()) {
-				CAMusElement *elt = v->musElementList()[curIndex[i]];
+		for (int j=startIndex[i]; j<endIndex[i]; j++) {
+			if (v->musElementList()[j]->isPlayable()) {
+				CAMusElement *elt = v->musElementList()[j];
 				QDomElement xmlNote = _xmlDoc->createElement("note");
 				
 				QDomElement xmlDuration = _xmlDoc->createElement("duration");
@@ -246,7 +235,6 @@ void CAMusicXmlExport::exportMeasure(QList<CAVoice*>& voiceList, int *curIndex,
 				}
 				xmlMeasure.appendChild(xmlNote);
 			}
-			curIndex[i]++;
 		}
 	}
 }
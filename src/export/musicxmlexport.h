@@ -8,6 +8,8 @@
 #ifndef MUSICXMLEXPORT_H_
 #define MUSICXMLEXPORT_H_
 
+#include <QVector>
+
 #include "export/export.h"
 
 class CAContext;
@@ -34,7 +36,7 @@ public:
 private:
 	void exportSheetImpl(CASheet *s);
 	void exportStaffImpl( CAStaff*, QDomElement& );
-	void exportMeasure( QList<CAVoice*>&, int*, QDomElement& );
+	void exportMeasure( QList<CAVoice*>&, const QVector<int>&, const QVector<int>&, QDomElement& );
 	
 	void exportClef(CAClef*, QDomElement&);
 	void exportTimeSig(CATimeSignature*, QDomElement&);
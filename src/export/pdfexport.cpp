@@ -6,13 +6,24 @@
 */
 
 // Includes
+#include <QPainter>
+#include <QPrinter>
+#include <QThread>
+
 #include "export/lilypondexport.h"
 #include "control/typesetctl.h"
+#include "control/externprogram.h"
 #include "export/pdfexport.h"
 #ifndef SWIGCPP
 #include "canorus.h" // needed for settings()
 #endif
 #include "core/settings.h"
+#include "core/typesetter.h"
+#ifndef SWIGCPP
+#include "layout/scorerenderer.h"
+#endif
+#include "score/document.h"
+#include "score/sheet.h"
 
 /*!
 	\class CAPDFExport
@@ -24,6 +35,17 @@
 	\endcode
 
 	\a textStream is usually the file stream or the content of the score source view widget.
+
+	If the Canorus typesetter is selected in the settings, the sheets are painted directly by
+	CAScoreRenderer instead of running LilyPond.
+
+	Documents with more than one sheet can be typeset in the job mode. Each sheet is exported
+	to its own LilyPond file and up to typesetterJobs() LilyPond processes run concurrently.
+	The resulting PDF files are merged by the PDF merger program (ghostscript by default)
+	into the destination file. The progress is updated after each typeset sheet. The job mode
+	is used if typesetterJobs() is not 1.
+
+	Cancelling the export kills the running typesetters and the PDF merger.
 */
 
 /*!
@@ -34,6 +56,11 @@ CAPDFExport::CAPDFExport( QTextStream *stream )
  : CAExport(stream)
 {
 	_poTypesetCtl = 0;
+#ifndef SWIGCPP
+	_iTypesetterJobs = CACanorus::settings()->typesetterJobs();
+#else
+	_iTypesetterJobs = CASettings::DEFAULT_TYPESETTER_JOBS;
+#endif
 }
 
 // Destructor
@@ -46,16 +73,26 @@ CAPDFExport::~CAPDFExport()
 	_poTypesetCtl = 0;
 }
 
-void CAPDFExport::startExport()
+/*!
+	Creates the typesetter control with the LilyPond exporter.
+	The caller takes the ownership of both.
+*/
+CATypesetCtl *CAPDFExport::createTypesetCtl()
 {
- 	_poTypesetCtl = new CATypesetCtl();
+ 	CATypesetCtl *poTypesetCtl = new CATypesetCtl();
 	// For now we support only lilypond export
 #ifndef SWIGCPP
-	_poTypesetCtl->setTypesetter( (CACanorus::settings()->useSystemDefaultTypesetter())?(CASettings::DEFAULT_TYPESETTER_LOCATION):(CACanorus::settings()->typesetterLocation()) );
+	poTypesetCtl->setTypesetter( (CACanorus::settings()->useSystemDefaultTypesetter())?(CASettings::DEFAULT_TYPESETTER_LOCATION):(CACanorus::settings()->typesetterLocation()) );
 #else
-	_poTypesetCtl->setTypesetter( CASettings::DEFAULT_TYPESETTER_LOCATION );
+	poTypesetCtl->setTypesetter( CASettings::DEFAULT_TYPESETTER_LOCATION );
 #endif
-	_poTypesetCtl->setExporter( new CALilyPondExport() );
+	poTypesetCtl->setExporter( new CALilyPondExport() );
+	return poTypesetCtl;
+}
+
+void CAPDFExport::startExport()
+{
+ 	_poTypesetCtl = createTypesetCtl();
 	// Put lilypond output to console, could be shown on a canorus console later
 	connect( _poTypesetCtl, SIGNAL( nextOutput( const QByteArray & ) ), this, SLOT( outputTypsetterOutput( const QByteArray & ) ) );
 	connect( _poTypesetCtl, SIGNAL( typesetterFinished( int ) ), this, SLOT( pdfFinished( int ) ) );
@@ -83,6 +120,16 @@ void CAPDFExport::exportDocumentImpl(CADocument *poDoc)
 		//TODO: no sheets, raise an error
 		return;
 	}
+#ifndef SWIGCPP // scripting modules are built without the layout engine
+	if ( CACanorus::settings()->typesetter()==CATypesetter::Canorus ) {
+		renderNative( poDoc->sheetList() );
+		return;
+	}
+#endif
+	if ( poDoc->sheetList().size() > 1 && _iTypesetterJobs != 1 ) {
+		typesetSheets( poDoc->sheetList(), (_iTypesetterJobs > 0) ? _iTypesetterJobs : qMax( QThread::idealThreadCount(), 1 ) );
+		return;
+	}
  	// We cannot create the typesetter instance (a QProcess in the end)
 	// in the constructor as it's parent would be in a different thread!
 	startExport();
@@ -99,6 +146,12 @@ void CAPDFExport::exportDocumentImpl(CADocument *poDoc)
 */
 void CAPDFExport::exportSheetImpl(CASheet *poSheet)
 {
+#ifndef SWIGCPP
+	if ( CACanorus::settings()->typesetter()==CATypesetter::Canorus ) {
+		renderNative( QList<CASheet*>() << poSheet );
+		return;
+	}
+#endif
  	// We cannot create the typesetter instance (a QProcess in the end)
 	// in the constructor as it's parent would be in a different thread!
 	startExport();
@@ -124,10 +177,161 @@ void CAPDFExport::runTypesetter()
 		file()->unsetError();
 	}
 	_poTypesetCtl->runTypesetter(); // create pdf
-	// as we are not in the main thread wait until we are finished
-	if( _poTypesetCtl->waitForFinished( -1 ) == false ) {
-		qWarning("PDFExport: Typesetter %s was not finished","lilypond");
+	// as we are not in the main thread wait until we are finished or cancelled
+	while( !_poTypesetCtl->isFinished() ) {
+		if( isCancelled() ) {
+			_poTypesetCtl->kill();
+			_poTypesetCtl->waitForFinished( -1 );
+			break;
+		}
+		_poTypesetCtl->waitForFinished( 50 );
+	}
+}
+
+#ifndef SWIGCPP
+/*!
+	Paints the given \a sheets to the PDF file using the built-in renderer. Each sheet starts
+	on a new page.
+*/
+void CAPDFExport::renderNative( const QList<CASheet*>& sheets )
+{
+	QPrinter oPrinter( QPrinter::HighResolution );
+	oPrinter.setOutputFormat( QPrinter::PdfFormat );
+	oPrinter.setOutputFileName( file()->fileName() );
+	oPrinter.setFullPage( true );
+	oPrinter.setCreator( "Canorus" );
+	if ( sheets[0]->document() ) {
+		oPrinter.setDocName( sheets[0]->document()->title() );
+	}
+
+	QPainter oPainter;
+	if ( !oPainter.begin( &oPrinter ) ) {
+		qCritical("PDFExport: Could not write the pdf file %s", qPrintable( file()->fileName() ) );
+		setStatus( -1 );
+		emit pdfIsFinished( -1 );
+		return;
+	}
+
+	QRectF oPageRect( 0, 0, oPrinter.width(), oPrinter.height() );
+	bool bFirstPage = true;
+	for (int i=0; i<sheets.size(); i++) {
+		CAScoreRenderer oRenderer( sheets[i] );
+		oRenderer.paginate( oPageRect.size() );
+		for (int j=0; j<oRenderer.pageCount(); j++) {
+			if ( !bFirstPage ) {
+				oPrinter.newPage();
+			}
+			bFirstPage = false;
+			oRenderer.renderPage( &oPainter, j, oPageRect );
+		}
+	}
+	oPainter.end();
+
+	setStatus( 0 );
+	emit pdfIsFinished( 0 );
+}
+#endif
+
+/*!
+	Typesets each of the given \a sheets by its own LilyPond process with at most \a iJobs
+	processes running at once and merges the resulting PDFs into the destination file.
+	Sheets which were not changed since the last run are taken from the typesetter cache.
+*/
+void CAPDFExport::typesetSheets( const QList<CASheet*>& sheets, int iJobs )
+{
+	QList<CATypesetCtl*> oCtlList;
+	QList<CATypesetCtl*> oRunningList;
+	QStringList oPdfList;
+	int iNext = 0;
+	int iDone = 0;
+	int iExitCode = 0;
+	setProgress( 0 );
+
+	while ( (iNext < sheets.size() && !iExitCode) || !oRunningList.isEmpty() ) {
+		// Kill the running typesetters when cancelled, they are removed below once they exit
+		if ( isCancelled() && !iExitCode ) {
+			for( int i=0; i<oRunningList.size(); i++ ) {
+				oRunningList[i]->kill();
+			}
+			iExitCode = -1;
+		}
+
+		// Start the next sheets until the limit is reached, stop on the first error
+		while ( iNext < sheets.size() && !iExitCode && oRunningList.size() < iJobs ) {
+			CATypesetCtl *poCtl = createTypesetCtl();
+			connect( poCtl, SIGNAL( nextOutput( const QByteArray & ) ), this, SLOT( outputTypsetterOutput( const QByteArray & ) ), Qt::DirectConnection );
+			oCtlList << poCtl;
+			poCtl->exportSheet( sheets[iNext++] );
+			poCtl->setTSetOption( QString("o"), poCtl->getTempFilePath() );
+			oPdfList << poCtl->getTempFilePath()+".pdf";
+			poCtl->runTypesetter();
+			oRunningList << poCtl;
+		}
+
+		// The processes belong to this thread, so they are only polled inside waitForFinished()
+		for( int i=0; i<oRunningList.size(); i++ ) {
+			CATypesetCtl *poCtl = oRunningList[i];
+			if ( !poCtl->isFinished() ) {
+				poCtl->waitForFinished( 50 );
+			}
+			if ( poCtl->isFinished() ) {
+				if ( poCtl->getExitCode() ) {
+					iExitCode = poCtl->getExitCode();
+				}
+				oRunningList.removeAt( i-- );
+				setProgress( 100*(++iDone) / (sheets.size()+1) ); // last step is merging
+			}
+		}
+	}
+
+	if ( !iExitCode ) {
+		iExitCode = mergePDFs( oPdfList );
+	}
+
+	// Remove temporary files
+	for( int i=0; i<oCtlList.size(); i++ ) {
+		QString oTempPath = oCtlList[i]->getTempFilePath();
+		QFile::remove( oTempPath+".pdf" );
+		QFile::remove( oTempPath+".ps" ); // not every typesetter leaves postscript files behind
+		QFile::remove( oTempPath );
+		delete oCtlList[i]->getExporter();
+		delete oCtlList[i];
+	}
+
+	setProgress( 100 );
+	setStatus( iExitCode );
+	emit pdfIsFinished( iExitCode );
+}
+
+/*!
+	Merges the PDF files \a roFiles into the destination file using the PDF merger program.
+	Returns the exit code of the merger or -1, if it was cancelled.
+*/
+int CAPDFExport::mergePDFs( const QStringList &roFiles )
+{
+	CAExternProgram oMerger;
+#ifndef SWIGCPP
+	oMerger.setProgramName( CACanorus::settings()->pdfMergerLocation() );
+#else
+	oMerger.setProgramName( CASettings::DEFAULT_PDF_MERGER_LOCATION );
+#endif
+	oMerger.setParameters( QStringList() << "-dBATCH" << "-dNOPAUSE" << "-q" << "-sDEVICE=pdfwrite"
+	                                     << QString("-sOutputFile=")+file()->fileName() << roFiles );
+	if( !oMerger.execProgram() )
+	{
+		qCritical("PDFExport: Could not run the pdf merger");
+		return -1;
+	}
+	while( !oMerger.waitForFinished( 50 ) && oMerger.getRunning() ) {
+		if( isCancelled() ) {
+			oMerger.kill();
+			oMerger.waitForFinished( -1 );
+			return -1;
+		}
 	}
+	if( oMerger.getExitCode() )
+		qCritical("PDFExport: PDF merger finished with code %d", oMerger.getExitCode() );
+	return oMerger.getExitCode();
 }
 
 /*!
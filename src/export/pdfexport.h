@@ -9,13 +9,15 @@
 #define PDFEXPORT_H_
 
 // Includes
+#include <QList>
+#include <QStringList>
+
 #include "export/export.h"
 
 // Forward declarations
 class CATypesetCtl;
 
 // PDF Export class doing lilypond export internally
-// !! exportDocument does not support threading !!
 class CAPDFExport : public CAExport {
 #ifndef SWIG
 	Q_OBJECT
@@ -26,6 +28,8 @@ public:
 	~CAPDFExport();
 
 	QString getTempFilePath();
+	inline void setTypesetterJobs( int iJobs ) { _iTypesetterJobs = iJobs; }
+	inline int typesetterJobs() { return _iTypesetterJobs; }
 #ifndef SWIG
 signals:
 	void pdfIsFinished( int iExitCode );
@@ -40,9 +44,14 @@ private:
 	void exportDocumentImpl(CADocument *doc);
 	void exportSheetImpl(CASheet *poSheet);
 	void runTypesetter();
+	void renderNative( const QList<CASheet*>& sheets );
+	CATypesetCtl *createTypesetCtl();
+	void typesetSheets( const QList<CASheet*>& sheets, int iJobs );
+	int mergePDFs( const QStringList &roFiles );
 
 protected:
 	CATypesetCtl *_poTypesetCtl;
+	int           _iTypesetterJobs; // Concurrent typesetters for multi-sheet documents, 1 typesets the whole document at once, 0 uses all the processors
 #endif
 };
 
@@ -6,6 +6,9 @@
 */
 
 // Includes
+#include <QPainter>
+#include <QSvgGenerator>
+
 #include "export/lilypondexport.h"
 #include "control/typesetctl.h"
 #include "export/svgexport.h"
@@ -13,6 +16,12 @@
 #include "canorus.h" // needed for settings()
 #endif
 #include "core/settings.h"
+#include "core/typesetter.h"
+#ifndef SWIGCPP
+#include "layout/scorerenderer.h"
+#endif
+#include "score/document.h"
+#include "score/sheet.h"
 
 /*!
 	\class CASVGExport
@@ -24,6 +33,10 @@
 	\endcode
 
 	\a textStream is usually the file stream or the content of the score source view widget.
+
+	If the Canorus typesetter is selected in the settings, the sheets are painted directly by
+	CAScoreRenderer instead of running LilyPond. All the pages are put below each other into a
+	single SVG image.
 */
 
 /*!
@@ -84,6 +97,12 @@ void CASVGExport::exportDocumentImpl(CADocument *poDoc)
 		//TODO: no sheets, raise an error
 		return;
 	}
+#ifndef SWIGCPP // scripting modules are built without the layout engine
+	if ( CACanorus::settings()->typesetter()==CATypesetter::Canorus ) {
+		renderNative( poDoc->sheetList() );
+		return;
+	}
+#endif
 	// We cannot create the typesetter instance (a QProcess in the end)
 	// in the constructor as it's parent would be in a different thread!
 	startExport();
@@ -100,6 +119,12 @@ void CASVGExport::exportDocumentImpl(CADocument *poDoc)
 */
 void CASVGExport::exportSheetImpl(CASheet *poSheet)
 {
+#ifndef SWIGCPP
+	if ( CACanorus::settings()->typesetter()==CATypesetter::Canorus ) {
+		renderNative( QList<CASheet*>() << poSheet );
+		return;
+	}
+#endif
  	// We cannot create the typesetter instance (a QProcess in the end)
 	// in the constructor as it's parent would be in a different thread!
 	startExport();
@@ -132,6 +157,47 @@ void CASVGExport::runTypesetter()
 	}
 }
 
+#ifndef SWIGCPP
+/*!
+	Paints the given \a sheets to the SVG file using the built-in renderer. The pages of all the
+	sheets are put below each other.
+*/
+void CASVGExport::renderNative( const QList<CASheet*>& sheets )
+{
+	const QSize oPageSize( 794, 1123 ); // A4 at 96 dpi
+
+	QList<CAScoreRenderer*> oRendererList;
+	int iPageCount = 0;
+	for (int i=0; i<sheets.size(); i++) {
+		CAScoreRenderer *poRenderer = new CAScoreRenderer( sheets[i] );
+		poRenderer->paginate( oPageSize );
+		iPageCount += poRenderer->pageCount();
+		oRendererList << poRenderer;
+	}
+
+	QSvgGenerator oGenerator;
+	oGenerator.setOutputDevice( file() );
+	oGenerator.setSize( QSize( oPageSize.width(), oPageSize.height()*qMax(iPageCount, 1) ) );
+	oGenerator.setViewBox( QRect( 0, 0, oPageSize.width(), oPageSize.height()*qMax(iPageCount, 1) ) );
+	if ( sheets[0]->document() ) {
+		oGenerator.setTitle( sheets[0]->document()->title() );
+	}
+
+	QPainter oPainter( &oGenerator );
+	int iPage = 0;
+	for (int i=0; i<oRendererList.size(); i++) {
+		for (int j=0; j<oRendererList[i]->pageCount(); j++, iPage++) {
+			oRendererList[i]->renderPage( &oPainter, j, QRectF( QPointF(0, iPage*oPageSize.height()), oPageSize ) );
+		}
+	}
+	oPainter.end();
+	qDeleteAll( oRendererList );
+
+	setStatus( 0 );
+	emit svgIsFinished( 0 );
+}
+#endif
+
 /*!
 	Show the output \a roOutput of the typesetter on the console
 */
@@ -9,6 +9,8 @@
 #define SVGEXPORT_H_
 
 // Includes
+#include <QList>
+
 #include "export/export.h"
 
 // Forward declarations
@@ -41,6 +43,7 @@ private:
 	void exportDocumentImpl(CADocument *doc);
 	void exportSheetImpl(CASheet *poSheet);
 	void runTypesetter();
+	void renderNative( const QList<CASheet*>& sheets );
 
 protected:
 	CATypesetCtl *_poTypesetCtl;
@@ -500,7 +500,7 @@ CAMusElement* CAMidiImport::getOrCreateKeySignature( int time, int voiceIndex, C
 
 		_actualKeySignatureIndex++;
 		if ( staff->keySignatureRefs().size() < _actualKeySignatureIndex+1 ) {
-			staff->keySignatureRefs() << new CAKeySignature( _allChannelsKeySignatures[_actualKeySignatureIndex]->diatonicKey(), staff, time );
+			staff->addSignRef( new CAKeySignature( _allChannelsKeySignatures[_actualKeySignatureIndex]->diatonicKey(), staff, time ) );
 		}
 		return staff->keySignatureRefs()[_actualKeySignatureIndex];
 	}
@@ -517,7 +517,7 @@ CAMusElement* CAMidiImport::getOrCreateTimeSignature( int time, int voiceIndex,
 		_actualTimeSignatureIndex = 0;
 		int top = _allChannelsTimeSignatures[_actualTimeSignatureIndex]->_top;
 		int bottom = _allChannelsTimeSignatures[_actualTimeSignatureIndex]->_bottom;
-		staff->timeSignatureRefs() << new CATimeSignature( top, bottom, staff, 0 );
+		staff->addSignRef( new CATimeSignature( top, bottom, staff, time ) );
 //		std::cout<<"                             neue Timesig at "<<time<<", there are "
 //																<<_allChannelsTimeSignatures.size()
 //																<<std::endl;
@@ -534,7 +534,7 @@ CAMusElement* CAMidiImport::getOrCreateTimeSignature( int time, int voiceIndex,
 			} else {
 				int top = _allChannelsTimeSignatures[_actualTimeSignatureIndex]->_top;
 				int bottom = _allChannelsTimeSignatures[_actualTimeSignatureIndex]->_bottom;
-				staff->timeSignatureRefs() << new CATimeSignature( top, bottom, staff, 0 );
+				staff->addSignRef( new CATimeSignature( top, bottom, staff, time ) );
 //				std::cout<<"                             new Timesig at "<<time<<", there are "
 //																<<_allChannelsTimeSignatures.size()
 //																<<std::endl;
@@ -559,7 +559,7 @@ void CAMidiImport::writeMidiChannelEventsToVoice_New( int channel, int voiceInde
 	QList<CANote *> noteList;
 	CARest *rest;
 	QList<CANote *> previousNotes;	// for sluring
-	QList<CAPlayableLength> lenList;	// work list when splitting notes and rests at barlines
+	CAPlayableLength::CALengthArray lenList;	// work list when splitting notes and rests at barlines
 	CATimeSignature *ts = 0;
 	CABarline *b = 0;
 	int time = 0;			// current time in the loop, only increasing, for tracking notes and rests
@@ -615,7 +615,7 @@ void CAMidiImport::writeMidiChannelEventsToVoice_New( int channel, int voiceInde
 			b = static_cast<CABarline*>( voice->previousByType( CAMusElement::Barline, voice->lastMusElement()));
 
 			lenList.clear();
-			lenList << CAPlayableLength::matchToBars( length, voice->lastTimeEnd(), b, ts, 4, getNextKeySignatureTime() );
+			CAPlayableLength::matchToBars( length, voice->lastTimeEnd(), b, ts, lenList, 4, getNextKeySignatureTime() );
 
 			for (int j=0; j<lenList.size(); j++) {
 				rest = new CARest( CARest::Normal, lenList[j], voice, 0, -1 );
@@ -676,7 +676,7 @@ void CAMidiImport::writeMidiChannelEventsToVoice_New( int channel, int voiceInde
 			b = static_cast<CABarline*>( voice->previousByType( CAMusElement::Barline, voice->lastMusElement()));
 
 			lenList.clear();
-			lenList << CAPlayableLength::matchToBars( length, voice->lastTimeEnd(), b, ts, 4, getNextKeySignatureTime() );
+			CAPlayableLength::matchToBars( length, voice->lastTimeEnd(), b, ts, lenList, 4, getNextKeySignatureTime() );
 
 
 			for (int j=0; j<lenList.size();j++) {
@@ -8,23 +8,15 @@
 #include <QPen>
 #include <QRect>
 #include <QVector>	// needed for RtMidi send message
+#include <QMutexLocker>
 
 #include <iostream>
 
 #include "interface/playback.h"
 #include "interface/mididevice.h"
 #include "score/sheet.h"
-#include "score/staff.h"
-#include "score/context.h"
-#include "score/barline.h"
 #include "score/note.h"
 #include "score/voice.h"
-#include "score/mark.h"
-#include "score/dynamic.h"
-#include "score/instrumentchange.h"
-#include "score/tempo.h"
-#include "score/timesignature.h"
-#include "score/keysignature.h"
 
 /*!
 	\class CAPlayback
@@ -45,12 +37,17 @@
 	The playbackFinished() signal is emitted once playback has finished or stopped.
 
 	If you want to immediately play only given elements (eg. when inserting notes), call playImmediately().
+
+	Playback never reads the live sheet which is being edited in the GUI thread meanwhile. A snapshot of
+	the sheet is taken when the sheet is set instead (see CASheetSnapshot). Currently played notes are
+	published back to the GUI thread as indices of the snapshot events, call curPlaying() or
+	curPlayingElements() to get them.
 */
 
 CAPlayback::CAPlayback( CASheet *s, CAMidiDevice *m ) {
 	initPlayback();
 
-	_sheet = s;
+	setSheet( s );
 	_midiDevice = m;
 	_playSelectionOnly = false;
 }
@@ -83,7 +80,6 @@ void CAPlayback::initPlayback() {
 	_midiDevice = 0;
 	_playSelectionOnly = false;
 	_initTimeStart = 0;
-	_sleepFactor = 1.0; // set by tempo to determine the miliseconds for sleep
 
 	connect(this, SIGNAL(finished()), SLOT(stopNow()));
 }
@@ -104,11 +100,93 @@ CAPlayback::~CAPlayback() {
 		delete [] _streamIdx;
 }
 
+/*!
+	Sets the sheet to be played and takes its snapshot.
+	Call this from the thread owning the sheet before the playback is started.
+*/
+void CAPlayback::setSheet( CASheet *s ) {
+	_sheet = s;
+	if ( s ) {
+		_snapshot = s->snapshot();
+	} else {
+		_snapshot.clear();
+	}
+}
+
+/*!
+	Returns the indices of the currently played notes in the snapshot of the sheet.
+
+	The notes are published by the playback thread. This function only copies them, so it can be
+	called any number of times from any thread and always returns the last published notes.
+	Notes played immediately are not part of the snapshot and are not returned.
+
+	\sa curPlayingElements()
+*/
+QList<CASheetSnapshot::CAEventIndex> CAPlayback::curPlaying() {
+	QMutexLocker locker( &_publishedMutex );
+	return _publishedPlaying;
+}
+
+/*!
+	Returns the music elements of the currently played notes.
+	Call this from the thread owning the sheet.
+
+	The elements are found in the live sheet by their indices in the snapshot, so a note destroyed
+	meanwhile is never returned, even if another element reused its memory. No notes are returned
+	once the document was changed after the playback started.
+
+	\sa curPlaying(), CASheetSnapshot::liveElement()
+*/
+QList<CAMusElement*> CAPlayback::curPlayingElements() {
+	QList<CAMusElement*> elts;
+	if ( !_snapshot ) {
+		return elts;
+	}
+
+	QList<CASheetSnapshot::CAEventIndex> playing = curPlaying();
+	for (int i=0; i<playing.size(); i++) {
+		CAMusElement *elt = _snapshot->liveElement( _sheet, playing[i] );
+		if ( elt ) {
+			elts << elt;
+		}
+	}
+
+	return elts;
+}
+
+/*!
+	Publishes the currently played notes from the playback thread.
+	The list is built before locking, so the GUI thread never holds up the playback for long.
+*/
+void CAPlayback::publishCurPlaying() {
+	QList<CASheetSnapshot::CAEventIndex> list;
+	for (int i=0; i<_curPlaying.size(); i++) {
+		if ( _curPlaying[i].event->type==CAMusElement::Note && _curPlaying[i].index.stream!=-1 ) {
+			list << _curPlaying[i].index;
+		}
+	}
+
+	QMutexLocker locker( &_publishedMutex );
+	_publishedPlaying.swap( list );
+}
+
 /*!
 	Immediately plays the given \a elts.
+	Notes are read when calling this function, so the elements can be changed afterwards.
  */
 void CAPlayback::playImmediately( QList<CAMusElement*> elts, int port ) {
-	_selection << elts;
+	_selectionMutex.lock();
+	for (int i=0; i<elts.size(); i++) {
+		if ( elts[i]->musElementType()==CAMusElement::Note ) {
+			CASheetSnapshot::CAStream s;
+			CAVoice *voice = static_cast<CANote*>(elts[i])->voice();
+			s.midiChannel = voice->midiChannel();
+			s.midiProgram = voice->midiProgram();
+			s.eventList << CASheetSnapshot::createEvent( elts[i] );
+			_selection << s;
+		}
+	}
+	_selectionMutex.unlock();
 
 	midiDevice()->openOutputPort( port );
 
@@ -123,16 +201,14 @@ void CAPlayback::run() {
 		return;
 	}
 
-	// list of all the music element lists (ie. streams) taken from all the contexts
-	QList< QList<CAMusElement*> > stream;
 	QVector<unsigned char> message;	// midi 3-byte message sent to midi device
 
 	// initializes all the streams, indices, repeat barlines etc.
-	if ( !streamList().size() ) {
-		initStreams( sheet() );
+	if ( _snapshot && !_streamIdx ) {
+		initStreams();
 	}
 
-	if ( !streamList().size() )
+	if ( !_snapshot || !streamList().size() )
 		stop();
 	else
 		setStop(false);
@@ -141,15 +217,14 @@ void CAPlayback::run() {
 	int mSeconds=0;           // actual song time, used when creating a midi file
 	while (!_stop || _curPlaying.size()) {	// at stop true: enter to switch all notes off
 		for (int i=0; i<_curPlaying.size(); i++) {
-			if ( _stop || _curPlaying[i]->timeEnd() <= _curTime ) {
+			if ( _stop || _curPlaying[i].event->timeEnd <= _curTime ) {
 				// note off
-				CANote *note = dynamic_cast<CANote*>(_curPlaying[i]);
-				if (note) {
-					message << (128 + note->voice()->midiChannel()); // note off
-					message << ( CADiatonicPitch::diatonicPitchToMidiPitch(note->diatonicPitch()) + note->voice()->midiPitchOffset() );
+				const CASheetSnapshot::CAEvent *e = _curPlaying[i].event;
+				if (e->type==CAMusElement::Note) {
+					message << (128 + e->midiChannel); // note off
+					message << ( e->midiPitch );
 					message << (127);
-					if ((note->musElementType()!=CAMusElement::Rest ) &&		// first because rest has no tie
-							!(note->tieStart() && note->tieStart()->noteEnd()) )
+					if ( e->noteOff )
 						midiDevice()->send(message, _curTime);
 					message.clear();
 				}
@@ -165,65 +240,54 @@ void CAPlayback::run() {
 
 		minLength = -1;
 		for (int i=0; i<streamList().size(); i++) {
-
 			while ( streamAt(i).size() > streamIdx(i) &&
-			        streamAt(i).at(streamIdx(i))->timeStart() == _curTime
+			        streamAt(i).at(streamIdx(i)).timeStart == _curTime
 			      ) {
+				const CASheetSnapshot::CAEvent *e = &streamAt(i).at(streamIdx(i));
 
 				// check if a rest carries a tempo mark
-				CAMusElement *me = streamAt(i).at(streamIdx(i));
-				if (me->musElementType()==CAMusElement::Rest) {
-				    for (int j=0; j<me->markList().size(); j++) {
-				    	if ( me->markList()[j]->markType()==CAMark::Tempo ) {
-				    		CATempo *tempo = static_cast<CATempo*>(me->markList()[j]);
-		    				midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, tempo->bpm(), 0, 0);
-						}
-					}
-
+				if (e->type==CAMusElement::Rest && e->tempoBpm!=-1) {
+					midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, e->tempoBpm, 0, 0);
 				}
 
 				// note on
+				if (e->type==CAMusElement::Note) {
+					// send dynamic information
+					if ( e->volume!=-1 ) {
+						message << (176 + e->midiChannel); // set volume
+						message << (CAMidiDevice::Midi_Ctl_Volume /* 7 */ );
+						message << qRound(127 * e->volume/100.0);
+						midiDevice()->send(message, _curTime);
+						message.clear();
+					}
+					if ( e->instrument!=-1 ) {
+						message << (192 + e->midiChannel); // change program
+						message << static_cast<unsigned char>(e->instrument);
+						midiDevice()->send(message, _curTime);
+						message.clear();
+					}
+					if ( e->tempoBpm!=-1 ) {
+						midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, e->tempoBpm, 0, 0);
+					}
 
-				CANote *note = dynamic_cast<CANote*>(streamAt(i).at(streamIdx(i)));
-				if (note) {
-				    QVector<unsigned char> message;
-
-				    // send dynamic information
-				    for (int j=0; j<note->markList().size(); j++) {
-				    	if ( note->markList()[j]->markType()==CAMark::Dynamic ) {
-				    		message << (176 + note->voice()->midiChannel()); // set volume
-				    		message << (CAMidiDevice::Midi_Ctl_Volume /* 7 */ );
-				    		message << qRound(127 * static_cast<CADynamic*>(note->markList()[j])->volume()/100.0);
-				    		midiDevice()->send(message, _curTime);
-				    		message.clear();
-				    	} else
-				    	if ( note->markList()[j]->markType()==CAMark::InstrumentChange ) {
-							message << (192 + note->voice()->midiChannel()); // change program
-							message << static_cast<unsigned char>(static_cast<CAInstrumentChange*>(note->markList()[j])->instrument());
-							midiDevice()->send(message, _curTime);
-							message.clear();
-				    	} else
-				    	if ( note->markList()[j]->markType()==CAMark::Tempo ) {
-				    		updateSleepFactor( static_cast<CATempo*>(note->markList()[j]) );
-				    		CATempo *tempo = static_cast<CATempo*>(note->markList()[j]);
-		    				midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, tempo->bpm(), 0, 0);
-				    	}
-				    }
-
-					message << (144 + note->voice()->midiChannel()); // note on
-					message << ( CADiatonicPitch::diatonicPitchToMidiPitch(note->diatonicPitch()) + note->voice()->midiPitchOffset() );
+					message << (144 + e->midiChannel); // note on
+					message << ( e->midiPitch );
 					message << (127);
-					if ( !note->tieEnd() )
+					if ( e->noteOn )
 						midiDevice()->send(message, _curTime);
 					message.clear();
 				}
 
-				if (streamAt(i).at(streamIdx(i))->isPlayable()) {
-					_curPlaying << static_cast<CAPlayable*>(streamAt(i).at(streamIdx(i)));
+				if (e->type==CAMusElement::Note || e->type==CAMusElement::Rest) {
+					CAPlayingEvent p;
+					p.event = e;
+					p.index.stream = i;
+					p.index.event = streamIdx(i);
+					_curPlaying << p;
 				}
 
 				int delta;
-				if ( (delta = (streamAt(i).at(streamIdx(i))->timeEnd() - _curTime)) < minLength
+				if ( (delta = (e->timeEnd - _curTime)) < minLength
 				    ||
 				     minLength==-1
 				   )
@@ -236,43 +300,37 @@ void CAPlayback::run() {
 			// last playables in the stream - _curPlaying is otherwise always set!
 			// pre-last pass, set minLength to their timeLengths to stop the notes
 			for (int j=0; j<_curPlaying.size(); j++) {
-				if ((_curPlaying[j]->timeEnd() - _curTime) < minLength || minLength==-1)
-					minLength =_curPlaying[j]->timeEnd() - _curTime;
+				if ((_curPlaying[j].event->timeEnd - _curTime) < minLength || minLength==-1)
+					minLength =_curPlaying[j].event->timeEnd - _curTime;
 			}
 		}
 
+		publishCurPlaying();
+
 		if (minLength==-1) {
 			// last pass, notes indices are at the ends and no notes are played anymore
 			setStop(true);
 		}
 
 		if (minLength!=-1) {
-			mSeconds += qRound(minLength*_sleepFactor);
+			// tempo map of the sheet takes care of the tempo marks and ritardandos
+			int ms = _snapshot->timeLengthToMs( _curTime, minLength );
+			mSeconds += ms;
 
 			if ( midiDevice()->isRealTime() )
-				msleep( qRound(minLength*_sleepFactor) );
+				msleep( ms );
 
 			_curTime += minLength;
 		}
 	}
 
 	_curPlaying.clear();
+	publishCurPlaying();
 	stop();
 }
 
 /*!
-	Calculates the sleep factor for the given tempo \a t.
-	If \a t is null, it does nothing.
- */
-void CAPlayback::updateSleepFactor( CATempo *t ) {
-	if (t) {
-		_sleepFactor = 60000.0 /
-		              ( CAPlayableLength::playableLengthToTimeLength( t->beat() ) * t->bpm() );
-	}
-}
-
-/*!
-	Private function for immediately playing the music elements in _selection.
+	Private function for immediately playing the notes in _selection.
 	This function ends when all the notes in _selection queue are played.
 	_selection queue might be refilled during the playback by calling playImmediately().
 
@@ -281,63 +339,70 @@ void CAPlayback::updateSleepFactor( CATempo *t ) {
  */
 void CAPlayback::playSelectionImpl() {
 	QVector<unsigned char> message;
+	QList<CASheetSnapshot::CAStream> playing; // currently playing notes, one stream per note
 	QList<int> timeEnds;       // time ends when the notes should turned off
 	int waitTime = 16;
 	int curTime = 0;
 
-	while (_selection.size() || _curPlaying.size()) {
+	_selectionMutex.lock();
+	while (_selection.size() || playing.size()) {
 		while (_selection.size()) {
-			if ( _selection[0]->musElementType()!=CAMusElement::Note ) {
-				_selection.takeFirst();
-				continue;
-			}
-
-			CANote *note = static_cast<CANote*>(_selection.takeFirst());
+			CASheetSnapshot::CAStream s = _selection.takeFirst();
+			const CASheetSnapshot::CAEvent& e = s.eventList.first();
 
 			// Note ON
-			message << (192 + note->voice()->midiChannel()); // change program
-			message << (note->voice()->midiProgram());
+			message << (192 + s.midiChannel); // change program
+			message << (s.midiProgram);
 			midiDevice()->send(message, _curTime);
 			message.clear();
 
-			message << (176 + note->voice()->midiChannel()); // set volume
+			message << (176 + s.midiChannel); // set volume
 			message << (7);
 			message << (100);
 			midiDevice()->send(message, _curTime);
 			message.clear();
 
-			message << (144 + note->voice()->midiChannel()); // note on
-			message << ( CADiatonicPitch::diatonicPitchToMidiPitch(note->diatonicPitch()) + note->voice()->midiPitchOffset() );
+			message << (144 + s.midiChannel); // note on
+			message << ( e.midiPitch );
 			message << (127);
 			midiDevice()->send(message, _curTime);
 			message.clear();
 
-			_curPlaying << note;
-			timeEnds << curTime + note->timeLength()*4;
+			playing << s;
+			timeEnds << curTime + (e.timeEnd - e.timeStart)*4;
 		}
+		_selectionMutex.unlock();
 
-		for (int i=0; i<_curPlaying.size(); i++) {
+		_curPlaying.clear();
+		for (int i=0; i<playing.size(); i++) {
 			if (curTime >= timeEnds[i] || _stop) {
 				// Note OFF
-				if (_curPlaying[i]->musElementType()==CAMusElement::Note) {
-					CANote *note = static_cast<CANote*>(_curPlaying[i]);
-
-					message << (128 + note->voice()->midiChannel()); // note off
-					message << ( CADiatonicPitch::diatonicPitchToMidiPitch(note->diatonicPitch()) + note->voice()->midiPitchOffset() );
-					message << (127);
-					midiDevice()->send(message, _curTime);
-					message.clear();
-				}
+				message << (128 + playing[i].midiChannel); // note off
+				message << ( playing[i].eventList.first().midiPitch );
+				message << (127);
+				midiDevice()->send(message, _curTime);
+				message.clear();
 
 				timeEnds.removeAt(i);
-				_curPlaying.removeAt(i);
+				playing.removeAt(i);
 				i--;
+			} else {
+				CAPlayingEvent p;
+				p.event = &playing[i].eventList.first();
+				p.index.stream = -1; // not part of the snapshot
+				p.index.event = -1;
+				_curPlaying << p;
 			}
 		}
+		publishCurPlaying();
+		_curPlaying.clear();
 
 		msleep( waitTime );
 		curTime += waitTime;
+
+		_selectionMutex.lock();
 	}
+	_selectionMutex.unlock();
 
 	stop();
 	// output ports are closed in MainWin
@@ -374,29 +439,21 @@ void CAPlayback::stopNow()
 }
 
 /*!
-	Generates streams (elements lists) of playable elements (notes, rests) from the given sheet.
+	Initializes the streams of the sheet snapshot and sends the initial program and volume of each voice.
 */
-void CAPlayback::initStreams( CASheet *sheet ) {
-	for (int i=0; i < sheet->contextList().size(); i++) {
-		if (sheet->contextList()[i]->contextType() == CAContext::Staff) {
-			CAStaff *staff = static_cast<CAStaff*>(sheet->contextList()[i]);
-			// add all the voices lists to the common list stream
-			for (int j=0; j < staff->voiceList().size(); j++) {
-				_streamList << staff->voiceList()[j]->musElementList();
-
-				QVector<unsigned char> message;
-				message << (192 + staff->voiceList()[j]->midiChannel()); // change program
-				message << (staff->voiceList()[j]->midiProgram());
-				midiDevice()->send(message, _curTime);
-				message.clear();
-
-				message << (176 + staff->voiceList()[j]->midiChannel()); // set volume
-				message << (7);
-				message << (100);
-				midiDevice()->send(message, _curTime);
-				message.clear();
-			}
-		}
+void CAPlayback::initStreams() {
+	QVector<unsigned char> message;
+	for (int i=0; i<streamList().size(); i++) {
+		message << (192 + streamList()[i].midiChannel); // change program
+		message << (streamList()[i].midiProgram);
+		midiDevice()->send(message, _curTime);
+		message.clear();
+
+		message << (176 + streamList()[i].midiChannel); // set volume
+		message << (7);
+		message << (100);
+		midiDevice()->send(message, _curTime);
+		message.clear();
 	}
 	_streamIdx = new int[streamList().size()];
 	_lastRepeatOpenIdx = new int[streamList().size()];
@@ -409,10 +466,6 @@ void CAPlayback::initStreams( CASheet *sheet ) {
 		_repeating = false;
 		loopUntilPlayable(i, true); // ignore repeats
 	}
-
-	if (_sheet) {
-		updateSleepFactor( _sheet->getTempo(getInitTimeStart()) );
-	}
 }
 
 
@@ -423,37 +476,28 @@ void CAPlayback::initStreams( CASheet *sheet ) {
 void CAPlayback::loopUntilPlayable( int i, bool ignoreRepeats ) {
 	for (int j=streamIdx(i);
 	     j<streamAt(i).size() &&
-	     streamAt(i).at(j)->timeStart() <= _curTime &&
-	     (streamAt(i).at(j)->timeStart() != _curTime ||
-	      !(streamAt(i).at(j)->musElementType()==CAMusElement::Note) ||
-	      (static_cast<CANote*>(streamAt(i).at(j))->isFirstInChord())
+	     streamAt(i).at(j).timeStart <= _curTime &&
+	     (streamAt(i).at(j).timeStart != _curTime ||
+	      !(streamAt(i).at(j).type==CAMusElement::Note) ||
+	      (streamAt(i).at(j).firstInChord)
 	     );
 	     streamIdx(i) = j++) {
 
-		if ( streamAt(i).at(j)->musElementType()==CAMusElement::TimeSignature ) {
+		const CASheetSnapshot::CAEvent& e = streamAt(i).at(j);
 
-			int beats = static_cast<CATimeSignature*>(streamAt(i).at(j))->beats();
-			int beat = static_cast<CATimeSignature*>(streamAt(i).at(j))->beat();
-			//std::cout<<"  exportiere Time Signature    "<<_curTime<<" mit "<<beats<<"/"<<beat<<std::endl;
-		    midiDevice()->sendMetaEvent( _curTime, CAMidiDevice::Meta_Timesig, beats, beat, 0 );
+		if ( e.type==CAMusElement::TimeSignature ) {
+			//std::cout<<"  exportiere Time Signature    "<<_curTime<<" mit "<<e.beats<<"/"<<e.beat<<std::endl;
+		    midiDevice()->sendMetaEvent( _curTime, CAMidiDevice::Meta_Timesig, e.beats, e.beat, 0 );
 		}
-		if ( streamAt(i).at(j)->musElementType()==CAMusElement::KeySignature ) {
-			//int key = (static_cast<CAKeySignature*>(streamAt(i).at(j)))->diatonicKey()->numberOfAccs();
-			CAKeySignature *ks = dynamic_cast<CAKeySignature*>(streamAt(i).at(j));
-			CADiatonicKey dk = ks->diatonicKey();
-			int key = dk.numberOfAccs();
-			int minor = dk.gender() == CADiatonicKey::Minor ? 1 : 0;
-		    midiDevice()->sendMetaEvent( _curTime, CAMidiDevice::Meta_Keysig, key, minor, 0 );
+		if ( e.type==CAMusElement::KeySignature ) {
+		    midiDevice()->sendMetaEvent( _curTime, CAMidiDevice::Meta_Keysig, e.keyAccs, e.minor ? 1 : 0, 0 );
 		}
 
-		if ( streamAt(i).at(j)->musElementType()==CAMusElement::Barline &&
-		     static_cast<CABarline*>(streamAt(i).at(j))->barlineType()==CABarline::RepeatOpen
-		   ) {
+		if ( e.type==CAMusElement::Barline && e.repeatOpen ) {
 			lastRepeatOpenIdx(i) = j;
 		}
 
-		if ( streamAt(i).at(j)->musElementType()==CAMusElement::Barline &&
-		     static_cast<CABarline*>(streamAt(i).at(j))->barlineType()==CABarline::RepeatClose &&
+		if ( e.type==CAMusElement::Barline && e.repeatClose &&
 		     !ignoreRepeats ) {
 			if (!_repeating) {
 				// set the new index in ALL streams
@@ -461,7 +505,7 @@ void CAPlayback::loopUntilPlayable( int i, bool ignoreRepeats ) {
 					streamIdx(k) = lastRepeatOpenIdx(k)+1;
 				}
 
-				_curTime = streamAt(i).at(streamIdx(i))->timeStart();
+				_curTime = streamAt(i).at(streamIdx(i)).timeStart;
 				j = streamIdx(i);
 				_repeating = true;
 			}
@@ -469,6 +513,7 @@ void CAPlayback::loopUntilPlayable( int i, bool ignoreRepeats ) {
 	}
 
 	// last element if non-playable is exception - increase the index counter
-	if (streamIdx(i)==streamAt(i).size()-1 && !streamAt(i).at(streamIdx(i))->isPlayable())
+	if (streamIdx(i)==streamAt(i).size()-1 &&
+	    streamAt(i).at(streamIdx(i)).type!=CAMusElement::Note && streamAt(i).at(streamIdx(i)).type!=CAMusElement::Rest)
 		streamIdx(i)++;
 }
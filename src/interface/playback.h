@@ -10,6 +10,10 @@
 
 #include <QThread>
 #include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+
+#include "score/sheetsnapshot.h"
 
 class CAMidiDevice;
 class CASheet;
@@ -36,8 +40,9 @@ public:
 	inline void setInitTimeStart(int t) { _initTimeStart = t; }
 	inline CAMidiDevice *midiDevice() { return _midiDevice; }
 	inline CASheet *sheet() { return _sheet; }
-	inline void setSheet( CASheet *s ) { _sheet = s; }
-	inline QList<CAPlayable*>& curPlaying() { return _curPlaying; }
+	void setSheet( CASheet *s );
+	QList<CASheetSnapshot::CAEventIndex> curPlaying();
+	QList<CAMusElement*> curPlayingElements();
 
 #ifndef SWIG
 public slots:
@@ -53,13 +58,13 @@ signals:
 
 private:
 	void initPlayback();
-	void initStreams( CASheet *sheet );
+	void initStreams();
 	void loopUntilPlayable( int i, bool ignoreRepeats=false );
 	void playSelectionImpl();
-	void updateSleepFactor( CATempo *t );
+	void publishCurPlaying();
 
-	inline QList<CAMusElement*>& streamAt(int idx) { return _streamList[idx]; }
-	inline const QList< QList<CAMusElement*> >& streamList() { return _streamList; }
+	inline const QVector<CASheetSnapshot::CAEvent>& streamAt(int idx) { return _snapshot->streamList()[idx].eventList; }
+	inline const QVector<CASheetSnapshot::CAStream>& streamList() { return _snapshot->streamList(); }
 	inline int& streamIdx( int i ) { return _streamIdx[i]; }
 	inline int& lastRepeatOpenIdx( int i ) { return _lastRepeatOpenIdx[i]; }
 
@@ -67,6 +72,7 @@ private:
 	inline void setStopLock(bool lock) { _stopLock = lock; }
 
 	CASheet *_sheet;
+	QSharedPointer<const CASheetSnapshot> _snapshot; // content of the sheet being played
 
 	CAMidiDevice *_midiDevice;
 	inline void setMidiDevice( CAMidiDevice *d ) { _midiDevice = d; }
@@ -76,13 +82,19 @@ private:
 	bool _stopLock;
 
 	bool _playSelectionOnly;
-	QList<CAMusElement*> _selection;
+	QList<CASheetSnapshot::CAStream> _selection; // notes to play immediately, one stream per note
+	QMutex _selectionMutex;
 
 	int _initTimeStart;
-	float _sleepFactor;
 
-	QList< QList<CAMusElement*> > _streamList;
-	QList<CAPlayable*> _curPlaying;	// list of currently playing notes and rests
+	struct CAPlayingEvent {
+		const CASheetSnapshot::CAEvent *event;
+		CASheetSnapshot::CAEventIndex index; // stream -1 for the notes played immediately
+	};
+
+	QList<CAPlayingEvent> _curPlaying;	// list of currently playing notes and rests
+	QList<CASheetSnapshot::CAEventIndex> _publishedPlaying; // notes published by the playback thread for curPlaying()
+	QMutex _publishedMutex; // guards _publishedPlaying
 	int *_streamIdx;
 	bool _repeating;
 	int *_lastRepeatOpenIdx;
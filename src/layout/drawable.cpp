@@ -6,6 +6,7 @@
 */
 
 #include <QPainter>
+#include <QHash>
 
 #include "layout/drawable.h"
 #include "layout/drawablemuselement.h"
@@ -20,6 +21,26 @@ CADrawable::CADrawable(double x, double y)
    _hScalable(false), _vScalable(false) {
 }
 
+/*!
+	Returns the glyph name -> codepoint map of the Feta (Emmentaler) font.
+*/
+static QHash<QString, int> createFetaMap() {
+	QHash<QString, int> _fetaMap;
+	// populate glyph->codepoint map using generated list
+	#include "fonts/fetaList.cxx"
+	return _fetaMap;
+}
+
+/*!
+	Returns codepoint for an Feta (Emmentaler) glyph by its name.
+	The map is created on the first call and is read-only afterwards, so the glyphs can be
+	looked up from any thread.
+*/
+int CADrawable::fetaCodepoint( const QString& name ) {
+	static const QHash<QString, int> fetaMap = createFetaMap();
+	return fetaMap.value( name );
+}
+
 CADrawable* CADrawable::clone() {
 	// We only reach CADrawable::clone() if this is a CADrawableMusElement, otherwise CADrawableContext::clone() will be called (this is a non-pure virtual function).
 	return static_cast<CADrawableMusElement*>(this)->clone();
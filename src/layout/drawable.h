@@ -10,6 +10,11 @@
 
 #include <QRect>
 #include <QColor>
+#include <QString>
+
+#include <cstddef>
+
+#include "score/muselementpool.h"
 
 class QPainter;
 
@@ -45,9 +50,15 @@ public:
 
 	CADrawable( double x, double y );	// x and y position of an element in absolute world units
 	virtual ~CADrawable() { }
+
+	static inline void *operator new( std::size_t size ) { return CAMusElementPool::drawablePool()->allocate( size ); }
+	static inline void operator delete( void *p, std::size_t size ) { CAMusElementPool::drawablePool()->release( p, size ); }
+
 	virtual void draw(QPainter *p, const CADrawSettings s) = 0;
 	virtual CADrawable *clone();
 
+	static int fetaCodepoint( const QString& name );
+
 	void drawHScaleHandles( QPainter *p, const CADrawSettings s );
 	void drawVScaleHandles( QPainter *p, const CADrawSettings s );
 
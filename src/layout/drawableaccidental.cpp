@@ -12,7 +12,6 @@
 #include "score/muselement.h"
 #include "layout/drawablecontext.h"
 #include "layout/drawableclef.h"
-#include "canorus.h"
 
 /*!
 	Default constructor.
@@ -28,7 +27,7 @@ CADrawableAccidental::CADrawableAccidental(signed char accs, CAMusElement *musEl
  	setDrawableMusElementType( DrawableAccidental );
  	setSelectable( false );
 
- 	setWidth( 8 );
+ 	setWidth( accidentalWidth( 0 ) );
  	setHeight( 14 );
  	_accs = accs;
 
@@ -44,7 +43,7 @@ CADrawableAccidental::CADrawableAccidental(signed char accs, CAMusElement *musEl
  	} else if (accs==-2) {
   		setYPos( y - height()/2 - 5 );
  		setXPos( x );
- 		setWidth( 12 );
+ 		setWidth( accidentalWidth( accs ) );
  	}
 
  	_centerX = x;
@@ -54,6 +53,20 @@ CADrawableAccidental::CADrawableAccidental(signed char accs, CAMusElement *musEl
 CADrawableAccidental::~CADrawableAccidental() {
 }
 
+void CADrawableAccidental::moveBy( double dx, double dy ) {
+	CADrawableMusElement::moveBy( dx, dy );
+	_centerX += dx;
+	_centerY += dy;
+}
+
+/*!
+	Returns the width of the accidental \a accs. The layout engine spaces the notes by it before
+	the drawable accidentals are created.
+*/
+double CADrawableAccidental::accidentalWidth( signed char accs ) {
+	return ( accs==-2 ? 12 : 8 );
+}
+
 void CADrawableAccidental::draw(QPainter *p, CADrawSettings s) {
 	QFont font("Emmentaler");
 	font.setPixelSize(qRound(34*s.z));
@@ -62,19 +75,19 @@ void CADrawableAccidental::draw(QPainter *p, CADrawSettings s) {
 
 	switch (_accs) {
 		case 0:
-			p->drawText(s.x, s.y + qRound(height()/2*s.z), QString(CACanorus::fetaCodepoint("accidentals.natural")));
+			p->drawText(s.x, s.y + qRound(height()/2*s.z), QString(CADrawable::fetaCodepoint("accidentals.natural")));
 			break;
 		case 1:
-			p->drawText(s.x, s.y + qRound((height()/2 + 0.3)*s.z), QString(CACanorus::fetaCodepoint("accidentals.sharp")));
+			p->drawText(s.x, s.y + qRound((height()/2 + 0.3)*s.z), QString(CADrawable::fetaCodepoint("accidentals.sharp")));
 			break;
 		case -1:
-			p->drawText(s.x, s.y + qRound((height()/2 + 5)*s.z), QString(CACanorus::fetaCodepoint("accidentals.flat")));
+			p->drawText(s.x, s.y + qRound((height()/2 + 5)*s.z), QString(CADrawable::fetaCodepoint("accidentals.flat")));
 			break;
 		case 2:
-			p->drawText(s.x, s.y + qRound(height()/2*s.z), QString(CACanorus::fetaCodepoint("accidentals.doublesharp")));
+			p->drawText(s.x, s.y + qRound(height()/2*s.z), QString(CADrawable::fetaCodepoint("accidentals.doublesharp")));
 			break;
 		case -2:
-			p->drawText(s.x, s.y + qRound((height()/2 + 5)*s.z), QString(CACanorus::fetaCodepoint("accidentals.flatflat")));
+			p->drawText(s.x, s.y + qRound((height()/2 + 5)*s.z), QString(CADrawable::fetaCodepoint("accidentals.flatflat")));
 			break;
 	}
 }
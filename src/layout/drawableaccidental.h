@@ -16,6 +16,9 @@ class CADrawableAccidental : public CADrawableMusElement {
 		~CADrawableAccidental();
 		void draw(QPainter *p, CADrawSettings s);
 		CADrawableAccidental *clone(CADrawableContext* newContext = 0);
+		void moveBy( double dx, double dy );
+
+		static double accidentalWidth( signed char accs );
 
 	private:
 		signed char _accs;
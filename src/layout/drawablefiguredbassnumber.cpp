@@ -8,7 +8,6 @@
 #include "layout/drawablefiguredbassnumber.h"
 #include "layout/drawablefiguredbasscontext.h"
 #include "score/figuredbassmark.h"
-#include "canorus.h"
 #include <QPen>
 #include <QPainter>
 
@@ -37,19 +36,19 @@ void CADrawableFiguredBassNumber::draw(QPainter *p, const CADrawSettings s) {
 	QString accs;
 	if (figuredBassMark()->accs().contains(_number)) {
 		if (figuredBassMark()->accs()[_number]==-2) {
-			accs += QString(CACanorus::fetaCodepoint("accidentals.flatflat"));
+			accs += QString(CADrawable::fetaCodepoint("accidentals.flatflat"));
 		} else
 		if (figuredBassMark()->accs()[_number]==-1) {
-			accs += QString(CACanorus::fetaCodepoint("accidentals.flat"));
+			accs += QString(CADrawable::fetaCodepoint("accidentals.flat"));
 		} else
 		if (figuredBassMark()->accs()[_number]==0) {
-			accs += QString(CACanorus::fetaCodepoint("accidentals.natural"));
+			accs += QString(CADrawable::fetaCodepoint("accidentals.natural"));
 		} else
 		if (figuredBassMark()->accs()[_number]==1) {
-			accs += QString(CACanorus::fetaCodepoint("accidentals.sharp"));
+			accs += QString(CADrawable::fetaCodepoint("accidentals.sharp"));
 		} else
 		if (figuredBassMark()->accs()[_number]==2) {
-			accs += QString(CACanorus::fetaCodepoint("accidentals.doublesharp"));
+			accs += QString(CADrawable::fetaCodepoint("accidentals.doublesharp"));
 		}
 	}
 
@@ -6,6 +6,7 @@
 */
 
 #include <QFont>
+#include <QImage>
 #include <QPainter>
 
 #include "layout/drawablemark.h"
@@ -26,7 +27,6 @@
 #include "score/ritardando.h"
 #include "score/crescendo.h"
 #include "score/repeatmark.h"
-#include "canorus.h"
 
 const double CADrawableMark::DEFAULT_TEXT_SIZE = 16;
 const double CADrawableMark::DEFAULT_PIXMAP_SIZE = 25;
@@ -49,7 +49,7 @@ CADrawableMark::CADrawableMark( CAMark *mark, CADrawableContext *dContext, doubl
 	setDrawableMusElementType( CADrawableMusElement::DrawableMark );
 	_tempoNote = 0;
 	_tempoDNote = 0;
-	_pixmap = 0;
+	_image = 0;
 
 	switch (mark->markType()) {
 	case CAMark::Text: {
@@ -70,7 +70,6 @@ CADrawableMark::CADrawableMark( CAMark *mark, CADrawableContext *dContext, doubl
 		int textWidth = fm.width( static_cast<CABookMark*>(this->mark())->text() );
 		setWidth( DEFAULT_PIXMAP_SIZE + textWidth );
 		setHeight( qRound(DEFAULT_TEXT_SIZE) );
-		_pixmap = new QPixmap( "images:mark/bookmark.svg" );
 		break;
 	}
 	case CAMark::Dynamic: {
@@ -106,7 +105,6 @@ CADrawableMark::CADrawableMark( CAMark *mark, CADrawableContext *dContext, doubl
 		font.setPixelSize( qRound(DEFAULT_TEXT_SIZE) );
 		QFontMetrics fm(font);
 
-		_pixmap = new QPixmap( "images:mark/instrumentchange.svg" );
 		int textWidth = fm.width( CAMidiDevice::instrumentName( static_cast<CAInstrumentChange*>(this->mark())->instrument() ) );
 		setWidth( DEFAULT_PIXMAP_SIZE + textWidth ); // set minimum text width at least 11 points
 		setHeight( qRound(DEFAULT_TEXT_SIZE) );
@@ -162,10 +160,29 @@ CADrawableMark::CADrawableMark( CAMark *mark, CADrawableContext *dContext, doubl
 	}
 }
 
+/*!
+	Returns the icon of the bookmark or instrument change.
+
+	The image is loaded on the first draw. An image is used instead of a pixmap, because the
+	drawable marks are also created and painted outside the GUI thread (eg. by the layout
+	engine workers and the native PDF/SVG export).
+*/
+QImage *CADrawableMark::image() {
+	if ( !_image ) {
+		if ( mark()->markType()==CAMark::BookMark ) {
+			_image = new QImage( "images:mark/bookmark.svg" );
+		} else {
+			_image = new QImage( "images:mark/instrumentchange.svg" );
+		}
+	}
+
+	return _image;
+}
+
 CADrawableMark::~CADrawableMark() {
 	if ( _tempoDNote ) delete _tempoDNote;
 	if ( _tempoNote ) delete _tempoNote;
-	if ( _pixmap ) delete _pixmap;
+	if ( _image ) delete _image;
 }
 
 void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
@@ -203,7 +220,7 @@ void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
 		font.setPixelSize( qRound(DEFAULT_TEXT_SIZE*s.z) );
 		p->setFont(font);
 
-		p->drawPixmap( s.x, s.y, _pixmap->scaled(qRound(DEFAULT_PIXMAP_SIZE*s.z), qRound(DEFAULT_PIXMAP_SIZE*s.z) ) );
+		p->drawImage( s.x, s.y, image()->scaled(qRound(DEFAULT_PIXMAP_SIZE*s.z), qRound(DEFAULT_PIXMAP_SIZE*s.z) ) );
 		p->drawText( s.x+qRound((DEFAULT_PIXMAP_SIZE+1)*s.z), s.y+qRound(height()*s.z), static_cast<CAText*>(mark())->text() );
 		break;
 	}
@@ -218,7 +235,7 @@ void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
 		break;
 	}
 	case CAMark::InstrumentChange: {
-		p->drawPixmap( s.x, s.y, _pixmap->scaled(qRound(DEFAULT_PIXMAP_SIZE*s.z), qRound(DEFAULT_PIXMAP_SIZE*s.z) ) );
+		p->drawImage( s.x, s.y, image()->scaled(qRound(DEFAULT_PIXMAP_SIZE*s.z), qRound(DEFAULT_PIXMAP_SIZE*s.z) ) );
 		QFont font("FreeSans");
 		font.setItalic( true );
 		font.setPixelSize( qRound(DEFAULT_TEXT_SIZE*s.z) );
@@ -239,10 +256,10 @@ void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
 		int x = qRound(s.x + (width()*s.z)*0.4);
 		int y = qRound(s.y + (inverted?0:(height()*s.z)));
 		switch ( static_cast<CAFermata*>(mark())->fermataType() ) {
-			case CAFermata::NormalFermata: p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.ufermata")+inverted) ); break;
-			case CAFermata::ShortFermata: p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.ushortfermata")+inverted) ); break;
-			case CAFermata::LongFermata: p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.ulongfermata")+inverted) ); break;
-			case CAFermata::VeryLongFermata: p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.uverylongfermata")+inverted) ); break;
+			case CAFermata::NormalFermata: p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.ufermata")+inverted) ); break;
+			case CAFermata::ShortFermata: p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.ushortfermata")+inverted) ); break;
+			case CAFermata::LongFermata: p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.ulongfermata")+inverted) ); break;
+			case CAFermata::VeryLongFermata: p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.uverylongfermata")+inverted) ); break;
 		}
 		break;
 	}
@@ -286,11 +303,11 @@ void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
 		p->setFont(font);
 		switch ( static_cast<CARepeatMark*>(mark())->repeatMarkType() ) {
 			case CARepeatMark::Segno:
-			case CARepeatMark::DalSegno:   p->drawText( s.x, s.y, QString(CACanorus::fetaCodepoint("scripts.segno")) ); break;
+			case CARepeatMark::DalSegno:   p->drawText( s.x, s.y, QString(CADrawable::fetaCodepoint("scripts.segno")) ); break;
 			case CARepeatMark::Coda:
-			case CARepeatMark::DalCoda:    p->drawText( s.x, s.y, QString(CACanorus::fetaCodepoint("scripts.coda")) ); break;
+			case CARepeatMark::DalCoda:    p->drawText( s.x, s.y, QString(CADrawable::fetaCodepoint("scripts.coda")) ); break;
 			case CARepeatMark::VarCoda:
-			case CARepeatMark::DalVarCoda: p->drawText( s.x, s.y, QString(CACanorus::fetaCodepoint("scripts.varcoda")) ); break;
+			case CARepeatMark::DalVarCoda: p->drawText( s.x, s.y, QString(CADrawable::fetaCodepoint("scripts.varcoda")) ); break;
 			case CARepeatMark::Volta: break;
 			case CARepeatMark::Undefined:
 				fprintf(stderr,"Warning: CADrawableMark::draw - Unhandled RM-Type %d",static_cast<CARepeatMark*>(mark())->repeatMarkType());
@@ -320,8 +337,8 @@ void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
 		QFont font("Emmentaler");
 		font.setPixelSize( qRound(DEFAULT_TEXT_SIZE*1.6*s.z) );
 		p->setFont(font);
-		p->drawText( s.x, s.y+qRound(height()*s.z), QString(CACanorus::fetaCodepoint("pedal.Ped")) );
-		p->drawText( s.x+qRound((width()-10)*s.z), s.y+qRound(height()*s.z), QString(CACanorus::fetaCodepoint("pedal.*")) );
+		p->drawText( s.x, s.y+qRound(height()*s.z), QString(CADrawable::fetaCodepoint("pedal.Ped")) );
+		p->drawText( s.x+qRound((width()-10)*s.z), s.y+qRound(height()*s.z), QString(CADrawable::fetaCodepoint("pedal.*")) );
 
 		break;
 	}
@@ -333,32 +350,32 @@ void CADrawableMark::draw(QPainter *p, CADrawSettings s) {
 		int x = s.x + qRound((width()/2.0)*s.z);
 		int y = s.y + qRound(height()*s.z);
 		switch ( static_cast<CAArticulation*>(mark())->articulationType() ) {
-			case CAArticulation::Accent:        p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.sforzato")) ); break;
-			case CAArticulation::Marcato:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.umarcato")) ); break;
-			case CAArticulation::Staccatissimo: p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.ustaccatissimo")) ); break;
-			case CAArticulation::Espressivo:    p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.espr")) ); break;
-			case CAArticulation::Staccato:      p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.staccato")) ); break;
-			case CAArticulation::Tenuto:        p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.tenuto")) ); break;
-			case CAArticulation::Portato:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.uportato")) ); break;
-			case CAArticulation::UpBow:         p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.upbow")) ); break;
-			case CAArticulation::DownBow:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.downbow")) ); break;
-			case CAArticulation::Flageolet:     p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.flageolet")) ); break;
-			case CAArticulation::Open:          p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.open")) ); break;
-			case CAArticulation::Stopped:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.stopped")) ); break;
-			case CAArticulation::Turn:          p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.turn")) ); break;
-			case CAArticulation::ReverseTurn:   p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.reverseturn")) ); break;
-			case CAArticulation::Trill:         p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.trill")) ); break;
-			case CAArticulation::Prall:         p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.prall")) ); break;
-			case CAArticulation::Mordent:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.mordent")) ); break;
-			case CAArticulation::PrallPrall:    p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.prallprall")) ); break;
-			case CAArticulation::PrallMordent:  p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.prallmordent")) ); break;
-			case CAArticulation::UpPrall:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.upprall")) ); break;
-			case CAArticulation::DownPrall:     p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.downprall")) ); break;
-			case CAArticulation::UpMordent:     p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.upmordent")) ); break;
-			case CAArticulation::DownMordent:   p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.downmordent")) ); break;
-			case CAArticulation::PrallDown:     p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.pralldown")) ); break;
-			case CAArticulation::PrallUp:       p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.prallup")) ); break;
-			case CAArticulation::LinePrall:     p->drawText( x, y, QString(CACanorus::fetaCodepoint("scripts.lineprall")) ); break;
+			case CAArticulation::Accent:        p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.sforzato")) ); break;
+			case CAArticulation::Marcato:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.umarcato")) ); break;
+			case CAArticulation::Staccatissimo: p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.ustaccatissimo")) ); break;
+			case CAArticulation::Espressivo:    p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.espr")) ); break;
+			case CAArticulation::Staccato:      p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.staccato")) ); break;
+			case CAArticulation::Tenuto:        p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.tenuto")) ); break;
+			case CAArticulation::Portato:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.uportato")) ); break;
+			case CAArticulation::UpBow:         p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.upbow")) ); break;
+			case CAArticulation::DownBow:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.downbow")) ); break;
+			case CAArticulation::Flageolet:     p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.flageolet")) ); break;
+			case CAArticulation::Open:          p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.open")) ); break;
+			case CAArticulation::Stopped:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.stopped")) ); break;
+			case CAArticulation::Turn:          p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.turn")) ); break;
+			case CAArticulation::ReverseTurn:   p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.reverseturn")) ); break;
+			case CAArticulation::Trill:         p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.trill")) ); break;
+			case CAArticulation::Prall:         p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.prall")) ); break;
+			case CAArticulation::Mordent:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.mordent")) ); break;
+			case CAArticulation::PrallPrall:    p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.prallprall")) ); break;
+			case CAArticulation::PrallMordent:  p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.prallmordent")) ); break;
+			case CAArticulation::UpPrall:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.upprall")) ); break;
+			case CAArticulation::DownPrall:     p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.downprall")) ); break;
+			case CAArticulation::UpMordent:     p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.upmordent")) ); break;
+			case CAArticulation::DownMordent:   p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.downmordent")) ); break;
+			case CAArticulation::PrallDown:     p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.pralldown")) ); break;
+			case CAArticulation::PrallUp:       p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.prallup")) ); break;
+			case CAArticulation::LinePrall:     p->drawText( x, y, QString(CADrawable::fetaCodepoint("scripts.lineprall")) ); break;
 			case CAArticulation::Undefined:
 				fprintf(stderr,"Warning: CADrawableMark::draw - Unhandled A-Type %d",static_cast<CAArticulation*>(mark())->articulationType());
 				break;
@@ -377,6 +394,17 @@ CADrawableMark* CADrawableMark::clone( CADrawableContext* newContext ) {
 	return new CADrawableMark( mark(), newContext?newContext:drawableContext(), xPos(), yPos() );
 }
 
+/*!
+	Moves the mark and the note of the tempo mark by \a dx, \a dy.
+*/
+void CADrawableMark::moveBy( double dx, double dy ) {
+	CADrawableMusElement::moveBy( dx, dy );
+	if ( _tempoDNote ) {
+		_tempoDNote->setDrawableContext( drawableContext() );
+		_tempoDNote->moveBy( dx, dy );
+	}
+}
+
 /*!
 	Converts the list of fingers to Emmentaler string.
 */
@@ -386,15 +414,15 @@ QString CADrawableMark::fingerListToString( const QList<CAFingering::CAFingerNum
 		if (list[i]>0 && list[i]<6)
 			text += QString::number(list[i]);
 		else if (list[i]==CAFingering::Thumb)
-			text += QString(CACanorus::fetaCodepoint("scripts.thumb"));
+			text += QString(CADrawable::fetaCodepoint("scripts.thumb"));
 		else if (list[i]==CAFingering::LHeel)
-			text += QString(CACanorus::fetaCodepoint("scripts.upedalheel"));
+			text += QString(CADrawable::fetaCodepoint("scripts.upedalheel"));
 		else if (list[i]==CAFingering::RHeel)
-			text += QString(CACanorus::fetaCodepoint("scripts.dpedalheel"));
+			text += QString(CADrawable::fetaCodepoint("scripts.dpedalheel"));
 		else if (list[i]==CAFingering::LToe)
-			text += QString(CACanorus::fetaCodepoint("scripts.upedaltoe"));
+			text += QString(CADrawable::fetaCodepoint("scripts.upedaltoe"));
 		else if (list[i]==CAFingering::RToe)
-			text += QString(CACanorus::fetaCodepoint("scripts.dpedaltoe"));
+			text += QString(CADrawable::fetaCodepoint("scripts.dpedaltoe"));
 	}
 
 	return text;
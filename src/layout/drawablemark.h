@@ -23,6 +23,7 @@ public:
 
 	void draw( QPainter *p, CADrawSettings s );
 	CADrawableMark *clone( CADrawableContext* newContext = 0 );
+	void moveBy( double dx, double dy );
 	inline CAMark *mark() { return static_cast<CAMark*>(musElement()); }
 
 	inline void setRehersalMarkNumber( int n ) { _rehersalMarkNumber = n; }
@@ -33,9 +34,11 @@ public:
 private:
 	static const double DEFAULT_TEXT_SIZE;
 	static const double DEFAULT_PIXMAP_SIZE;
+	QImage *image();
+
 	CANote         *_tempoNote;
 	CADrawableNote *_tempoDNote;
-	QPixmap        *_pixmap;
+	QImage         *_image;
 	int             _rehersalMarkNumber;
 };
 
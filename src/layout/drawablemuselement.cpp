@@ -12,4 +12,38 @@ CADrawableMusElement::CADrawableMusElement(CAMusElement *m, CADrawableContext *d
  	setDrawableType( CADrawable::DrawableMusElement );
 	_musElement = m;
 	_drawableContext = drawableContext;
+	_anchorX = x;
+	_anchorY = y;
 }
+
+/*!
+	Moves the element to the drawable \a context and the position \a x, \a y given the same way
+	as to the constructor. The layout uses it to reuse the drawable elements of the previous
+	layout whose music elements weren't changed.
+
+	\sa moveBy(), CALayout::takeRecycled()
+*/
+void CADrawableMusElement::moveTo( CADrawableContext *context, double x, double y ) {
+	setDrawableContext( context );
+	moveBy( x-_anchorX, y-_anchorY );
+	_anchorX = x;
+	_anchorY = y;
+}
+
+/*!
+	Moves the element by \a dx, \a dy. Subclasses with their own coordinates or child elements
+	move them as well.
+*/
+void CADrawableMusElement::moveBy( double dx, double dy ) {
+	setXPos( xPos()+dx );
+	setYPos( yPos()+dy );
+}
+
+/*!
+	\fn bool CADrawableMusElement::canReuse()
+	Returns True, if the element still looks the same as its unchanged music element would be
+	drawn now. Elements depending on their surroundings (eg. the stem direction of a note)
+	return False, if those changed.
+
+	\sa moveTo()
+*/
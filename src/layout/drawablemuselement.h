@@ -40,6 +40,10 @@ class CADrawableMusElement : public CADrawable {
 		void setDrawableContext(CADrawableContext *context) { _drawableContext = context; }
 		virtual CADrawableMusElement* clone(CADrawableContext* newContext = 0) = 0;
 
+		void moveTo( CADrawableContext *context, double x, double y );
+		virtual void moveBy( double dx, double dy );
+		virtual bool canReuse() { return true; }
+
 	protected:
 		void setDrawableMusElementType( CADrawableMusElementType t ) { _drawableMusElementType = t; }
 
@@ -47,6 +51,8 @@ class CADrawableMusElement : public CADrawable {
 		CADrawableContext *_drawableContext;
 		CAMusElement *_musElement;
 		bool _selectable;
+		double _anchorX; // position given to the constructor
+		double _anchorY;
 };
 
 #endif /* DRAWABLEMUSELEMENT_H_ */
@@ -13,7 +13,6 @@
 #include "layout/drawableaccidental.h"
 #include "score/voice.h"
 #include "score/staff.h"
-#include "canorus.h"
 
 const double CADrawableNote::HUNDREDTWENTYEIGHTH_STEM_LENGTH = 50;
 const double CADrawableNote::SIXTYFOURTH_STEM_LENGTH = 43;
@@ -48,28 +47,28 @@ CADrawableNote::CADrawableNote(CANote *n, CADrawableContext *drawableContext, do
 	case CAPlayableLength::Quarter:
 		_noteHeadGlyphName = "noteheads.s2";
 		_penWidth = 1.2;
-		setWidth( 11 );
+		setWidth( noteHeadWidth( CAPlayableLength::Quarter ) );
 		setHeight( 10 );
 		break;
 
 	case CAPlayableLength::Half:
 		_noteHeadGlyphName = "noteheads.s1";
 		_penWidth = 1.3;
-		setWidth( 12 );
+		setWidth( noteHeadWidth( CAPlayableLength::Half ) );
 		setHeight( 10 );
 		break;
 
 	case CAPlayableLength::Whole:
 		_noteHeadGlyphName = "noteheads.s0";
 		_penWidth = 0;
-		setWidth( 17 );
+		setWidth( noteHeadWidth( CAPlayableLength::Whole ) );
 		setHeight( 8 );
 		break;
 
 	case CAPlayableLength::Breve:
 		_noteHeadGlyphName = "noteheads.sM1";
 		_penWidth = 0;
-		setWidth( 18 );
+		setWidth( noteHeadWidth( CAPlayableLength::Breve ) );
 		setHeight( 8 );
 		break;
 	case CAPlayableLength::Undefined:
@@ -124,11 +123,7 @@ CADrawableNote::CADrawableNote(CANote *n, CADrawableContext *drawableContext, do
 
 	_noteHeadWidth = width();
 
-	if (n->playableLength().dotted()) {
-		setWidth( width()+3 );
-		for (int i=0; i<n->playableLength().dotted(); i++)
-			setWidth( width()+2 );
-	}
+	setWidth( noteWidth( n ) );
 
 	_shadowNote = shadowNote;
 
@@ -138,6 +133,37 @@ CADrawableNote::CADrawableNote(CANote *n, CADrawableContext *drawableContext, do
 CADrawableNote::~CADrawableNote() {
 }
 
+/*!
+	Returns the width of the notehead of the given \a length.
+*/
+double CADrawableNote::noteHeadWidth( CAPlayableLength::CAMusicLength length ) {
+	switch (length) {
+	case CAPlayableLength::Half:
+		return 12;
+	case CAPlayableLength::Whole:
+		return 17;
+	case CAPlayableLength::Breve:
+		return 18;
+	case CAPlayableLength::Undefined:
+		return 0;
+	default:
+		return 11;
+	}
+}
+
+/*!
+	Returns the width of the drawable instance of the \a note including the dots.
+	The layout engine spaces the notes by it before their drawable instances are created.
+*/
+double CADrawableNote::noteWidth( CANote *note ) {
+	double width = noteHeadWidth( note->playableLength().musicLength() );
+	if (note->playableLength().dotted()) {
+		width += 3 + 2*note->playableLength().dotted();
+	}
+
+	return width;
+}
+
 void CADrawableNote::draw(QPainter *p, CADrawSettings s) {
 	QFont font("Emmentaler");
 	font.setPixelSize(qRound(35*s.z));
@@ -177,7 +203,7 @@ void CADrawableNote::draw(QPainter *p, CADrawSettings s) {
 
 	// Draw notehead
 	s.y += height()*s.z/2;
-	p->drawText(s.x, s.y, QString(CACanorus::fetaCodepoint(_noteHeadGlyphName)));
+	p->drawText(s.x, s.y, QString(CADrawable::fetaCodepoint(_noteHeadGlyphName)));
 
 	if (note()->noteLength().musicLength() >= CAPlayableLength::Half) {
 		// Draw stem and flag
@@ -189,14 +215,14 @@ void CADrawableNote::draw(QPainter *p, CADrawSettings s) {
 			s.x+=qRound(_noteHeadWidth*s.z); // increase X-offset before drawing the stem
 			p->drawLine(s.x, qRound(s.y-1*s.z), s.x, s.y-qRound(_stemLength*s.z));
 			if(note()->noteLength().musicLength() >= CAPlayableLength::Eighth) {
-				p->drawText(qRound(s.x+0.6*s.z),qRound(s.y - _stemLength*s.z),QString(CACanorus::fetaCodepoint(_flagUpGlyphName)));
+				p->drawText(qRound(s.x+0.6*s.z),qRound(s.y - _stemLength*s.z),QString(CADrawable::fetaCodepoint(_flagUpGlyphName)));
 				s.x+=qRound(6*s.z); // additional X-offset for dots because of the flag on the right
 			}
 		} else {
 			s.x+=qRound(0.6*s.z);
 			p->drawLine(s.x, qRound(s.y+1*s.z), s.x, s.y+qRound(_stemLength*s.z));
 			if(note()->noteLength().musicLength() >= CAPlayableLength::Eighth) {
-				p->drawText(qRound(s.x+0.4*s.z),qRound(s.y + (_stemLength+5)*s.z),QString(CACanorus::fetaCodepoint(_flagDownGlyphName)));
+				p->drawText(qRound(s.x+0.4*s.z),qRound(s.y + (_stemLength+5)*s.z),QString(CADrawable::fetaCodepoint(_flagDownGlyphName)));
 			}
 			s.x+=qRound(_noteHeadWidth*s.z); // increase X-offset after drawing the stem
 		}
@@ -32,6 +32,11 @@ class CADrawableNote : public CADrawableMusElement {
 		void setDrawableAccidental(CADrawableAccidental *acc) { _drawableAcc = acc; }
 		CADrawableAccidental *drawableAccidental() { return _drawableAcc; }
 
+		bool canReuse() { return _stemDirection==note()->actualStemDirection(); }
+
+		static double noteHeadWidth( CAPlayableLength::CAMusicLength length );
+		static double noteWidth( CANote *note );
+
 	private:
 		bool _drawLedgerLines;	///Are the ledger lines drawn or not. True when ledger lines needed, False when the note is inside the staff
 		bool _shadowNote;	///Is the current note shadow note?
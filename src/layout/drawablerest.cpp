@@ -9,7 +9,6 @@
 #include "layout/drawablecontext.h"
 #include "layout/drawablestaff.h"
 #include "score/rest.h"
-#include "canorus.h"
 
 #include <QPainter>
 
@@ -22,54 +21,54 @@ CADrawableRest::CADrawableRest(CARest *rest, CADrawableContext *drawableContext,
 
 	switch ( rest->playableLength().musicLength() ) {
 	case CAPlayableLength::HundredTwentyEighth:
-		setWidth( 16 );
+		setWidth( restGlyphWidth( CAPlayableLength::HundredTwentyEighth ) );
 		setHeight( 49 );
 		break;
 
 	case CAPlayableLength::SixtyFourth:
-		setWidth( 14 );
+		setWidth( restGlyphWidth( CAPlayableLength::SixtyFourth ) );
 		setHeight( 41 );
 		break;
 
 	case CAPlayableLength::ThirtySecond:
-		setWidth( 12 );
+		setWidth( restGlyphWidth( CAPlayableLength::ThirtySecond ) );
 		setHeight( 33 );
 		setYPos(y + 2);
 		break;
 
 	case CAPlayableLength::Sixteenth:
-		setWidth( 10 );
+		setWidth( restGlyphWidth( CAPlayableLength::Sixteenth ) );
 		setHeight( 24 );
 		setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
 		break;
 
 	case CAPlayableLength::Eighth:
-		setWidth( 8 );
+		setWidth( restGlyphWidth( CAPlayableLength::Eighth ) );
 		setHeight( 17 );
 		setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
 		break;
 
 	case CAPlayableLength::Quarter:
-		setWidth( 8 );
+		setWidth( restGlyphWidth( CAPlayableLength::Quarter ) );
 		setHeight( 20 );
 		setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
 		break;
 
 	case CAPlayableLength::Half:
-		setWidth( 12 );
+		setWidth( restGlyphWidth( CAPlayableLength::Half ) );
 		setHeight( 5 );
 		setYPos(y + 1.5*static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
 		break;
 
 	case CAPlayableLength::Whole:
-		setWidth( 12 );
+		setWidth( restGlyphWidth( CAPlayableLength::Whole ) );
 		setHeight( 5 );
 		//values in constructor are the notehead center coords. yPos represents the top of the stem.
 		setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
 		break;
 
 	case CAPlayableLength::Breve:
-		setWidth( 4 );
+		setWidth( restGlyphWidth( CAPlayableLength::Breve ) );
 		setHeight( 9 );
 		setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
 		break;
@@ -82,16 +81,50 @@ CADrawableRest::CADrawableRest(CARest *rest, CADrawableContext *drawableContext,
 
 	_restWidth = _width;
 
-	if (rest->playableLength().dotted()) {
-		setWidth( width() + 3 );
-		for (int i=0; i<rest->playableLength().dotted(); i++)
-			setWidth( width() + 2 );
-	}
+	setWidth( restWidth( rest ) );
 }
 
 CADrawableRest::~CADrawableRest() {
 }
 
+/*!
+	Returns the width of the rest symbol of the given \a length without dots.
+*/
+double CADrawableRest::restGlyphWidth( CAPlayableLength::CAMusicLength length ) {
+	switch (length) {
+	case CAPlayableLength::HundredTwentyEighth:
+		return 16;
+	case CAPlayableLength::SixtyFourth:
+		return 14;
+	case CAPlayableLength::ThirtySecond:
+		return 12;
+	case CAPlayableLength::Sixteenth:
+		return 10;
+	case CAPlayableLength::Half:
+	case CAPlayableLength::Whole:
+		return 12;
+	case CAPlayableLength::Breve:
+		return 4;
+	case CAPlayableLength::Undefined:
+		return 0;
+	default:
+		return 8;
+	}
+}
+
+/*!
+	Returns the width of the drawable instance of the \a rest in a staff including the dots.
+	The layout engine spaces the rests by it before their drawable instances are created.
+*/
+double CADrawableRest::restWidth( CARest *rest ) {
+	double width = restGlyphWidth( rest->playableLength().musicLength() );
+	if (rest->playableLength().dotted()) {
+		width += 3 + 2*rest->playableLength().dotted();
+	}
+
+	return width;
+}
+
 CADrawableRest *CADrawableRest::clone(CADrawableContext* newContext) {
 	return new CADrawableRest(rest(), (newContext)?newContext:_drawableContext, xPos(), yPos());
 }
@@ -106,39 +139,39 @@ void CADrawableRest::draw(QPainter *p, CADrawSettings s) {
 	QPen pen;
 	switch ( rest()->playableLength().musicLength() ) {
 	case CAPlayableLength::HundredTwentyEighth: {
-		p->drawText(qRound(s.x + 4*s.z), qRound(s.y + (2.6*((CADrawableStaff*)_drawableContext)->lineSpace())*s.z), QString(CACanorus::fetaCodepoint("rests.7")));
+		p->drawText(qRound(s.x + 4*s.z), qRound(s.y + (2.6*((CADrawableStaff*)_drawableContext)->lineSpace())*s.z), QString(CADrawable::fetaCodepoint("rests.7")));
 		break;
 	}
 	case CAPlayableLength::SixtyFourth: {
-		p->drawText(qRound(s.x + 3*s.z), qRound(s.y + (1.75*((CADrawableStaff*)_drawableContext)->lineSpace())*s.z), QString(CACanorus::fetaCodepoint("rests.6")));
+		p->drawText(qRound(s.x + 3*s.z), qRound(s.y + (1.75*((CADrawableStaff*)_drawableContext)->lineSpace())*s.z), QString(CADrawable::fetaCodepoint("rests.6")));
 		break;
 	}
 	case CAPlayableLength::ThirtySecond: {
-		p->drawText(qRound(s.x + 2.5*s.z), qRound(s.y + (1.8*((CADrawableStaff*)_drawableContext)->lineSpace())*s.z), QString(CACanorus::fetaCodepoint("rests.5")));
+		p->drawText(qRound(s.x + 2.5*s.z), qRound(s.y + (1.8*((CADrawableStaff*)_drawableContext)->lineSpace())*s.z), QString(CADrawable::fetaCodepoint("rests.5")));
 		break;
 	}
 	case CAPlayableLength::Sixteenth: {
-		p->drawText(qRound(s.x + 1*s.z), qRound(s.y + (((CADrawableStaff*)_drawableContext)->lineSpace()-0.9)*s.z), QString(CACanorus::fetaCodepoint("rests.4")));
+		p->drawText(qRound(s.x + 1*s.z), qRound(s.y + (((CADrawableStaff*)_drawableContext)->lineSpace()-0.9)*s.z), QString(CADrawable::fetaCodepoint("rests.4")));
 		break;
 	}
 	case CAPlayableLength::Eighth: {
-		p->drawText(s.x, qRound(s.y + (((CADrawableStaff*)_drawableContext)->lineSpace()-0.9)*s.z), QString(CACanorus::fetaCodepoint("rests.3")));
+		p->drawText(s.x, qRound(s.y + (((CADrawableStaff*)_drawableContext)->lineSpace()-0.9)*s.z), QString(CADrawable::fetaCodepoint("rests.3")));
 		break;
 	}
 	case CAPlayableLength::Quarter: {
-		p->drawText(s.x,qRound(s.y + 0.5*height()*s.z),QString(CACanorus::fetaCodepoint("rests.2")));
+		p->drawText(s.x,qRound(s.y + 0.5*height()*s.z),QString(CADrawable::fetaCodepoint("rests.2")));
 		break;
 	}
 	case CAPlayableLength::Half: {
-		p->drawText(s.x,qRound(s.y + height()*s.z + 0.5), QString(CACanorus::fetaCodepoint("rests.1")));
+		p->drawText(s.x,qRound(s.y + height()*s.z + 0.5), QString(CADrawable::fetaCodepoint("rests.1")));
 		break;
 	}
 	case CAPlayableLength::Whole: {
-		p->drawText(s.x, s.y, QString(CACanorus::fetaCodepoint("rests.0")));
+		p->drawText(s.x, s.y, QString(CADrawable::fetaCodepoint("rests.0")));
 		break;
 	}
 	case CAPlayableLength::Breve: {
-		p->drawText(s.x, qRound(s.y + height()*s.z), QString(CACanorus::fetaCodepoint("rests.M1")));
+		p->drawText(s.x, qRound(s.y + height()*s.z), QString(CADrawable::fetaCodepoint("rests.M1")));
 		break;
 	}
 	case CAPlayableLength::Undefined:
@@ -21,6 +21,9 @@ class CADrawableRest : public CADrawableMusElement {
 
 		inline CARest* rest() { return static_cast<CARest*>(_musElement); }
 
+		static double restGlyphWidth( CAPlayableLength::CAMusicLength length );
+		static double restWidth( CARest *rest );
+
 	private:
 		double _restWidth;	///Width of the rest itself without dots, ledger lines etc.
 };
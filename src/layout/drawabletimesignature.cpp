@@ -58,10 +58,10 @@ void CADrawableTimeSignature::draw(QPainter *p, CADrawSettings s) {
 	switch (timeSignature()->timeSignatureType()) {
 		case CATimeSignature::Classical: {	//draw C or C| only, otherwise don't break, go to Number then!
 			if ((timeSignature()->beat() == 4) && (timeSignature()->beats() == 4)) {
-				p->drawText(s.x, qRound(s.y + 0.5*height()*s.z), QString(CACanorus::fetaCodepoint("timesig.C44")));
+				p->drawText(s.x, qRound(s.y + 0.5*height()*s.z), QString(CADrawable::fetaCodepoint("timesig.C44")));
 				break;
 			} else if ((timeSignature()->beat() == 2) && (timeSignature()->beats() == 2)) {
-				p->drawText(s.x, qRound(s.y + 0.5*height()*s.z), QString(CACanorus::fetaCodepoint("timesig.C22")));
+				p->drawText(s.x, qRound(s.y + 0.5*height()*s.z), QString(CADrawable::fetaCodepoint("timesig.C22")));
 				break;
 			}
 		}
@@ -10,7 +10,6 @@
 
 #include "layout/drawablemuselement.h"
 #include "score/timesignature.h"
-#include "canorus.h"
 
 class CADrawableStaff;
 
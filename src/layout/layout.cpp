@@ -0,0 +1,285 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <algorithm> // std::lower_bound, std::upper_bound
+#include <iostream>
+
+#include "layout/layout.h"
+#include "layout/drawablecontext.h"
+#include "layout/drawablemuselement.h"
+#include "layout/drawablenotecheckererror.h"
+
+#include "score/sheet.h"
+#include "score/voice.h"
+
+/*!
+	\class CALayout
+	\brief Drawable elements of a sheet created by the layout engine
+
+	CALayout is the result of CALayoutEngine. It owns the drawable contexts, music elements and
+	note checker errors of the sheet, stored in k-d trees for fast lookups by coordinates, and
+	maps the abstract music elements and contexts to their drawable instances.
+
+	The layout doesn't depend on any widgets, so a sheet can be laid out without the GUI (eg. in
+	benchmarks) and different sheets can be laid out concurrently, each into its own layout:
+
+	\code
+	CALayout layout( sheet );
+	CALayoutEngine::reposit( &layout );
+	\endcode
+
+	The score views use CASheetLayout which shares the layout of a sheet among all its views and
+	lays out long sheets lazily. It calls recycle() instead of clear() before laying out the
+	sheet again, so the engine reuses the drawable elements of the music elements which weren't
+	changed meanwhile, see takeRecycled().
+
+	\sa CALayoutEngine, CASheetLayout
+*/
+
+/*!
+	Creates an empty layout of the given \a sheet.
+*/
+CALayout::CALayout( CASheet *sheet ) {
+	_sheet = sheet;
+	_recycling = false;
+}
+
+CALayout::~CALayout() {
+	clear();
+}
+
+/*!
+	Destroys all the drawable elements.
+	The capacity of the drawable map is kept, because the next layout of the sheet usually
+	creates about the same number of drawables.
+*/
+void CALayout::clear() {
+	clearRecycled();
+	_contentHashes.clear();
+
+	_drawableMList.clear(true);
+	_drawableCList.clear(true);
+	_drawableNCEList.clear(true);
+
+	int n = _mapDrawable.size();
+	_mapDrawable.clear();
+	_mapDrawable.reserve( n );
+}
+
+/*!
+	Removes all the drawable elements like clear(), but keeps the drawable music elements which
+	can be reused by the next layout of the sheet. They are given to the layout engine by
+	takeRecycled(). Elements left over from the previous call are destroyed.
+
+	Only the drawable notes, rests, accidentals, clefs, time signatures, barlines and marks are
+	kept, other elements depend on their neighbours and are always created again. The content
+	hashes needed to find out which music elements changed are only stored while isRecycling().
+
+	\sa clearRecycled()
+*/
+void CALayout::recycle() {
+	clearRecycled();
+
+	QList<CADrawableMusElement*> elts = _drawableMList.list();
+	_drawableMList.clear(false);
+	for (int i=0; i<elts.size(); i++) {
+		QHash<CADrawableMusElement*, unsigned int>::const_iterator hash = _contentHashes.constFind( elts[i] );
+		if ( hash==_contentHashes.constEnd() ) {
+			delete elts[i];
+			continue;
+		}
+
+		CARecycledDrawable r;
+		r.drawable = elts[i];
+		r.contentHash = hash.value();
+		r.contextHeight = elts[i]->drawableContext()->height();
+		_recycled.insert( elts[i]->musElement(), r );
+	}
+	_contentHashes.clear();
+
+	_drawableCList.clear(true);
+	_drawableNCEList.clear(true);
+
+	int n = _mapDrawable.size();
+	_mapDrawable.clear();
+	_mapDrawable.reserve( n );
+}
+
+/*!
+	Destroys the drawable elements kept by recycle() which were not reused.
+*/
+void CALayout::clearRecycled() {
+	for (QMultiHash<CAMusElement*, CARecycledDrawable>::const_iterator it=_recycled.constBegin(); it!=_recycled.constEnd(); ++it) {
+		delete it.value().drawable;
+	}
+	_recycled.clear();
+}
+
+/*!
+	Returns the drawable element of the given \a type kept by recycle() for the music element
+	\a elt or 0, if there is none. The element is only returned, if the content of the music
+	element wasn't changed, the new drawable \a context has the same height and the drawable
+	element can be reused. Otherwise it is destroyed.
+
+	The caller takes the ownership and must move the element to its new position and \a context
+	by CADrawableMusElement::moveTo() before adding it to the layout again.
+*/
+CADrawableMusElement *CALayout::takeRecycled( CAMusElement *elt, CADrawableMusElement::CADrawableMusElementType type, CADrawableContext *context ) {
+	if ( _recycled.isEmpty() ) {
+		return 0;
+	}
+
+	QMultiHash<CAMusElement*, CARecycledDrawable>::iterator it = _recycled.find( elt );
+	for (; it!=_recycled.end() && it.key()==elt; ++it) {
+		if ( it.value().drawable->drawableMusElementType()!=type ) {
+			continue;
+		}
+
+		CARecycledDrawable r = it.value();
+		_recycled.erase( it );
+
+		unsigned int hash = elt->contentHash();
+		if ( r.contentHash!=hash || r.contextHeight!=context->height() || !r.drawable->canReuse() ) {
+			delete r.drawable;
+			return 0;
+		}
+
+		_contentHashes[ r.drawable ] = hash; // already computed, addMElement() doesn't need to
+		return r.drawable;
+	}
+
+	return 0;
+}
+
+/*!
+	Returns True, if the drawable elements of the given \a type are kept by recycle().
+*/
+bool CALayout::isReusable( CADrawableMusElement::CADrawableMusElementType type ) {
+	switch ( type ) {
+		case CADrawableMusElement::DrawableNote:
+		case CADrawableMusElement::DrawableRest:
+		case CADrawableMusElement::DrawableAccidental:
+		case CADrawableMusElement::DrawableClef:
+		case CADrawableMusElement::DrawableTimeSignature:
+		case CADrawableMusElement::DrawableBarline:
+		case CADrawableMusElement::DrawableMark:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*!
+	Adds a drawable music element \a elt to the layout.
+*/
+void CALayout::addMElement( CADrawableMusElement *elt ) {
+	_drawableMList.addElement(elt);
+	_mapDrawable.insert(elt->musElement(), elt);
+	if ( _recycling && isReusable(elt->drawableMusElementType()) && !_contentHashes.contains(elt) ) {
+		_contentHashes.insert( elt, elt->musElement()->contentHash() );
+	}
+
+	elt->drawableContext()->addMElement(elt);
+}
+
+/*!
+	Adds a drawable context \a elt to the layout.
+*/
+void CALayout::addCElement( CADrawableContext *elt ) {
+	_drawableCList.addElement(elt);
+	_mapDrawable.insert(elt->context(), elt);
+}
+
+/*!
+	Adds a drawable note checker error \a dnce to the layout.
+*/
+void CALayout::addDrawableNoteCheckerError( CADrawableNoteCheckerError *dnce ) {
+	_drawableNCEList.addElement(dnce);
+	_mapDrawable.insert(0, dnce);
+}
+
+/*!
+	Finds the first drawable instance of the given abstract music element.
+
+	\sa findCElement()
+*/
+CADrawableMusElement *CALayout::findMElement( CAMusElement *elt ) {
+	QList<CADrawable*> hits = _mapDrawable.values(elt);
+	if (hits.size()) {
+		return static_cast<CADrawableMusElement*>(hits[0]);
+	}
+	return 0;
+}
+
+/*!
+	Finds the drawable instance of the given abstract context.
+
+	\sa findMElement()
+*/
+CADrawableContext *CALayout::findCElement( CAContext *context ) {
+	QList<CADrawable*> hits = _mapDrawable.values(context);
+	if (hits.size()) {
+		return static_cast<CADrawableContext*>(hits[0]);
+	}
+	return 0;
+}
+
+static bool musElementTimeLessThan( const CAMusElement* a, const int b ) {
+	return (a->timeStart() < b);
+}
+
+static bool timeMusElementLessThan( const int a, const CAMusElement* b ) {
+	return (a < b->timeStart());
+}
+
+/*!
+	Returns the X coordinate for the given Canorus \a time.
+	Returns -1, if such a time doesn't exist in the score or wasn't laid out yet.
+*/
+double CALayout::timeToCoords( int time ) {
+	CADrawableMusElement *leftElt = 0;
+	CADrawableMusElement *rightElt = 0;
+
+	QList<CAVoice*> voiceList = _sheet->voiceList();
+	for (int i=0; i<voiceList.size(); i++) {
+		// get the element still smaller or equal, but nearest to time
+		QList<CAMusElement*>::const_iterator it = std::lower_bound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, musElementTimeLessThan);
+		if (it!=voiceList[i]->musElementList().constEnd()) {
+			if (_mapDrawable.contains(*it)) {
+				CADrawableMusElement *dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).last());
+				if (!leftElt || leftElt->xPos()<dElt->xPos()) {
+					leftElt = dElt;
+				}
+			} else if ( isComplete() ) {
+				std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in the layout!" << std::endl;
+			}
+		}
+
+		// and for the right element
+		it = std::upper_bound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, timeMusElementLessThan);
+		if (it!=voiceList[i]->musElementList().constEnd()) {
+			if (_mapDrawable.contains(*it)) {
+				CADrawableMusElement *dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).first());
+				if (!rightElt || rightElt->xPos()>dElt->xPos()) {
+					rightElt = dElt;
+				}
+			} else if ( isComplete() ) {
+				std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in the layout!" << std::endl;
+			}
+		}
+	}
+
+	// get the relative position between the nearest left and the nearest right elements
+	if ( leftElt && rightElt && leftElt->musElement() && rightElt->musElement() ) {
+		int delta = (rightElt->musElement()->timeStart() - leftElt->musElement()->timeStart());
+		if (!delta) delta=1;
+		return leftElt->xPos() + ( rightElt->xPos() - leftElt->xPos() ) *
+		              ( ((double)time - leftElt->musElement()->timeStart()) / delta );
+	} else {
+		return -1;
+	}
+}
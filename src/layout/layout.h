@@ -0,0 +1,77 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <QList>
+#include <QMultiHash>
+
+#include "layout/kdtree.h"
+#include "layout/drawablemuselement.h"
+
+class CASheet;
+class CAContext;
+class CAMusElement;
+class CADrawable;
+class CADrawableContext;
+class CADrawableNoteCheckerError;
+
+class CALayout {
+public:
+	CALayout( CASheet *sheet );
+	virtual ~CALayout();
+
+	inline CASheet *sheet() { return _sheet; }
+
+	void clear();
+	void recycle();
+	void clearRecycled();
+	inline bool isRecycling() { return _recycling; }
+	inline void setRecycling( bool recycling ) { _recycling = recycling; }
+	CADrawableMusElement *takeRecycled( CAMusElement *elt, CADrawableMusElement::CADrawableMusElementType type, CADrawableContext *context );
+	virtual bool isComplete() { return true; }
+
+	void addMElement( CADrawableMusElement *elt );
+	void addCElement( CADrawableContext *elt );
+	void addDrawableNoteCheckerError( CADrawableNoteCheckerError *dnce );
+
+	inline CAKDTree<CADrawableMusElement*>& drawableMList() { return _drawableMList; }
+	inline CAKDTree<CADrawableContext*>& drawableCList() { return _drawableCList; }
+	inline CAKDTree<CADrawableNoteCheckerError*>& drawableNCEList() { return _drawableNCEList; }
+	inline QList<CADrawable*> drawables( void *elt ) { return _mapDrawable.values(elt); }
+
+	CADrawableMusElement *findMElement( CAMusElement *elt );
+	CADrawableContext    *findCElement( CAContext *context );
+	double timeToCoords( int time );
+
+protected:
+	CASheet *_sheet;
+
+	CAKDTree<CADrawableMusElement*>       _drawableMList;   // Drawable music elements
+	CAKDTree<CADrawableContext*>          _drawableCList;   // Drawable contexts
+	CAKDTree<CADrawableNoteCheckerError*> _drawableNCEList; // Drawable note checker errors
+	QMultiHash<void*, CADrawable*>        _mapDrawable;     // Mapping of music elements/contexts -> drawable elements
+
+private:
+	struct CARecycledDrawable {
+		CADrawableMusElement *drawable;
+		unsigned int contentHash;   // content hash of the music element when the drawable was created
+		double contextHeight;       // height of the drawable context it was placed in
+	};
+
+	static bool isReusable( CADrawableMusElement::CADrawableMusElementType type );
+
+	bool                                          _recycling;     // Are the content hashes stored for recycle()
+	QHash<CADrawableMusElement*, unsigned int>    _contentHashes; // Content hashes of the music elements of the reusable drawables
+	QMultiHash<CAMusElement*, CARecycledDrawable> _recycled;      // Drawable elements of the previous layout waiting for reuse
+
+	CALayout( const CALayout& );            // not copyable, owns the drawable elements
+	CALayout& operator=( const CALayout& );
+};
+
+#endif /* LAYOUT_H_ */
@@ -7,10 +7,16 @@
 
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QFontDatabase>
 #include <iostream>	//debug
+#include <stdio.h>
 #include "layout/layoutengine.h"
 
-#include "widgets/scoreview.h"
+#include "layout/layout.h"
 
 #include "layout/drawablestaff.h"
 #include "layout/drawableclef.h"
@@ -38,6 +44,9 @@
 #include "score/sheet.h"
 
 #include "score/staff.h"
+#include "score/measuretable.h"
+#include "score/clef.h"
+#include "score/barline.h"
 #include "score/voice.h"
 #include "score/keysignature.h"
 #include "score/timesignature.h"
@@ -50,14 +59,14 @@
 
 #include "score/functionmarkcontext.h"
 #include "score/functionmark.h"
+#include "score/notecheckererror.h"
 
 #include "interface/mididevice.h" // needed for midiPitch->diatonicPitch
 
 #define INITIAL_X_OFFSET 20 // space between the left border and the first music element
 #define MINIMUM_SPACE 10    // minimum space between the music elements
+#define PARALLEL_JOBS_MIN 64 // minimum number of drawable elements created in parallel
 
-QList<CADrawableMusElement*> CALayoutEngine::scalableElts;
-int *CALayoutEngine::streamsRehersalMarks;
 
 /*!
 	\class CAEngraver
@@ -65,23 +74,35 @@ int *CALayoutEngine::streamsRehersalMarks;
 
 	This class is a bridge between the data part of Canorus and the UI.
 	Out of data CAMusElement* and CAContext* objects, it creates their CADrawable* instances.
+
+	The elements are placed column by column from the beginning of the sheet. The engine keeps
+	its state between the calls, so the sheet can be laid out in chunks: repositUntil() and
+	repositBars() stop at the given time or bar and continue from there on the next call.
+	Use reposit() to lay out the whole sheet at once. Each chunk is spaced column by column first
+	and the drawable elements are created per context afterwards, see materialize().
+
+	The engine only writes into the given CALayout and has no global state, so it doesn't need
+	any widgets and different sheets can be laid out at the same time in separate threads. The
+	sheet itself must not be modified meanwhile. The engine and the drawable elements are built
+	as the canoruslayout library.
+
+	\sa CALayout, CASheetLayout
 */
 
 /*!
-	Repositions the notes in the abstract sheet of the given score view \a v so they fit nicely.
-	This function doesn't clear the view, but only adds the elements.
+	Creates the layout engine for the given layout \a v and places the drawable contexts.
+	No music elements are placed until repositUntil() or repositBars() is called.
 */
-void CALayoutEngine::reposit( CAScoreView *v ) {
-	//int i;
+CALayoutEngine::CALayoutEngine( CALayout *v )
+ : _layout(v), _time(0), _finished(false) {
 	CASheet *sheet = v->sheet();
 
-	//list of all the music element lists (ie. streams) taken from all the contexts
-	QList< QList<CAMusElement*> > musStreamList; // streams music elements
-	QList<CAContext*> contexts; // which context does the stream belong to
+	QList< QList<CAMusElement*> >& musStreamList = _musStreamList;
+	QList<CAContext*>& contexts = _contexts;
+	QList<int>& nonFirstVoiceIdxs = _nonFirstVoiceIdxs;
+	QMap<CAContext*, CADrawableContext*>& drawableContextMap = _drawableContextMap;
 
 	int dy = 50;
-	QList<int> nonFirstVoiceIdxs;	//list of indexes of musStreamLists which the voices aren't the first voice. This is used later for determining should a sign be created or not (if it has been created in 1st voice already, don't recreate it in the other voices in the same staff).
-	QMap<CAContext*, CADrawableContext*> drawableContextMap;
 
 	for (int i=0; i < sheet->contextList().size(); i++) {
 		if (sheet->contextList()[i]->contextType() == CAContext::Staff) {
@@ -149,30 +170,55 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 	}
 
 	int streams = musStreamList.size();
-	int *streamsIdx = new int[streams];
-	for (int i=0; i<streams; i++) streamsIdx[i] = 0;
-	int *streamsX = new int[streams];
-	for (int i=0; i<streams; i++) streamsX[i] = INITIAL_X_OFFSET;
-	int *streamsRehersalMarks = new int[streams];
-	for (int i=0; i<streams; i++) streamsRehersalMarks[i] = 0;
-	CALayoutEngine::streamsRehersalMarks = streamsRehersalMarks;
-	CAClef **lastClef = new CAClef *[streams];
-	for (int i=0; i<streams; i++) lastClef[i] = 0;
-	CAKeySignature **lastKeySig = new CAKeySignature *[streams];
-	for (int i=0; i<streams; i++) lastKeySig[i] = 0;
-	CATimeSignature **lastTimeSig = new CATimeSignature *[streams];
-	for (int i=0; i<streams; i++) lastTimeSig[i] = 0;
-	scalableElts.clear();
-
-	int timeStart = 0;
-	bool done = false;
-	CADrawableFunctionMarkSupport **lastDFMTonicizations = new CADrawableFunctionMarkSupport *[streams];
-	for (int i=0; i<streams; i++) lastDFMTonicizations[i]=0;
-	while (!done) {
+	_streamsIdx.fill( 0, streams );
+	_streamsX.fill( INITIAL_X_OFFSET, streams );
+	_streamsRehersalMarks.fill( 0, streams );
+	_lastClef.fill( 0, streams );
+	_lastKeySig.fill( 0, streams );
+	_lastTimeSig.fill( 0, streams );
+	_lastDFMTonicizations.fill( 0, streams );
+}
+
+CALayoutEngine::~CALayoutEngine() {
+	qDeleteAll( _scalableElts ); // scalable elements which were not placed yet
+}
+
+/*!
+	Repositions the notes in the abstract sheet of the given layout \a v so they fit nicely.
+	This function doesn't clear the layout, but only adds the elements.
+*/
+void CALayoutEngine::reposit( CALayout *v ) {
+	CALayoutEngine engine( v );
+	engine.repositUntil( -1 );
+}
+
+/*!
+	Places the music elements starting before the given \a time. Negative time places all the
+	remaining elements.
+
+	Returns True, if the whole sheet is laid out.
+*/
+bool CALayoutEngine::repositUntil( int time ) {
+	CALayout *v = _layout;
+	QList< QList<CAMusElement*> >& musStreamList = _musStreamList;
+	QList<CAContext*>& contexts = _contexts;
+	QList<int>& nonFirstVoiceIdxs = _nonFirstVoiceIdxs;
+	QMap<CAContext*, CADrawableContext*>& drawableContextMap = _drawableContextMap;
+
+	int streams = musStreamList.size();
+	int *streamsIdx = _streamsIdx.data();
+	int *streamsX = _streamsX.data();
+	CAClef **lastClef = _lastClef.data();
+	CAKeySignature **lastKeySig = _lastKeySig.data();
+	CATimeSignature **lastTimeSig = _lastTimeSig.data();
+	CADrawableFunctionMarkSupport **lastDFMTonicizations = _lastDFMTonicizations.data();
+
+	int timeStart = _time;
+	while (!_finished) {
 		//if all the indices are at the end of the streams, finish.
 		int idx;
 		for (idx=0; (idx < streams) && (streamsIdx[idx] == musStreamList[idx].size()); idx++);
-		if (idx==streams) { done=true; continue; }
+		if (idx==streams) { _finished=true; continue; }
 
 		//Synchronize minimum X-es between the contexts
 		int maxX = 0;
@@ -190,6 +236,10 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 		}
 		//timeStart now holds the nearest next time we're going to draw
 
+		// stop at the checkpoint, the following elements are placed on the next call
+		if ( time>=0 && timeStart>=time )
+			break;
+
 		//go through all the streams and check if the following element has this time
 		CAMusElement *elt;
 		CADrawableContext *drawableContext;
@@ -212,12 +262,15 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 				     (!nonFirstVoiceIdxs.contains(i)) ) {
 					switch ( elt->musElementType() ) {
 						case CAMusElement::Clef: {
-							CADrawableClef *clef = new CADrawableClef(
-								(CAClef*)elt,
-								(CADrawableStaff*)drawableContext,
-								streamsX[i],
-								drawableContext->yPos()
-							);
+							CADrawableClef *clef = static_cast<CADrawableClef*>( reuse( elt, CADrawableMusElement::DrawableClef, drawableContext, streamsX[i], drawableContext->yPos() ) );
+							if ( !clef ) {
+								clef = new CADrawableClef(
+									(CAClef*)elt,
+									(CADrawableStaff*)drawableContext,
+									streamsX[i],
+									drawableContext->yPos()
+								);
+							}
 
 							v->addMElement(clef);
 
@@ -229,7 +282,7 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 							streamsX[i] += (clef->neededWidth() + MINIMUM_SPACE);
 							//placedSymbol = true;
 
-							placeMarks( clef, v, i );
+							addJob( CADrawableJob::Marks, elt, drawableContext, clef->xPos(), clef->yPos(), i, clef );
 
 							break;
 						}
@@ -248,20 +301,25 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 								if (contexts[j]==contexts[i])
 									lastKeySig[j] = keySig->keySignature();
 
+							_staffAccs.remove( contexts[i] ); // accidentals are valid until the key signature
+
 							streamsX[i] += (keySig->neededWidth() + MINIMUM_SPACE);
 							//placedSymbol = true;
 
-							placeMarks( keySig, v, i );
+							addJob( CADrawableJob::Marks, elt, drawableContext, keySig->xPos(), keySig->yPos(), i, keySig );
 
 							break;
 						}
 						case CAMusElement::TimeSignature: {
-							CADrawableTimeSignature *timeSig = new CADrawableTimeSignature(
-								(CATimeSignature*)elt,
-								(CADrawableStaff*)drawableContext,
-								streamsX[i],
-								drawableContext->yPos()
-							);
+							CADrawableTimeSignature *timeSig = static_cast<CADrawableTimeSignature*>( reuse( elt, CADrawableMusElement::DrawableTimeSignature, drawableContext, streamsX[i], drawableContext->yPos() ) );
+							if ( !timeSig ) {
+								timeSig = new CADrawableTimeSignature(
+									(CATimeSignature*)elt,
+									(CADrawableStaff*)drawableContext,
+									streamsX[i],
+									drawableContext->yPos()
+								);
+							}
 
 							v->addMElement(timeSig);
 
@@ -273,7 +331,7 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 							streamsX[i] += (timeSig->neededWidth() + MINIMUM_SPACE);
 							//placedSymbol = true;
 
-							placeMarks( timeSig, v, i );
+							addJob( CADrawableJob::Marks, elt, drawableContext, timeSig->xPos(), timeSig->yPos(), i, timeSig );
 
 							break;
 						}
@@ -346,19 +404,23 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 				}
 
 				drawableContext = drawableContextMap[elt->context()];
-				CADrawableBarline *bar = new CADrawableBarline(
-					(CABarline*)elt,
-					(CADrawableStaff*)drawableContext,
-					streamsX[i],
-					drawableContext->yPos()
-				);
+				CADrawableBarline *bar = static_cast<CADrawableBarline*>( reuse( elt, CADrawableMusElement::DrawableBarline, drawableContext, streamsX[i], drawableContext->yPos() ) );
+				if ( !bar ) {
+					bar = new CADrawableBarline(
+						(CABarline*)elt,
+						(CADrawableStaff*)drawableContext,
+						streamsX[i],
+						drawableContext->yPos()
+					);
+				}
 
 				v->addMElement(bar);
 				//placedSymbol = true;
 				streamsX[i] += (bar->neededWidth() + MINIMUM_SPACE);
 				streamsIdx[i] = streamsIdx[i] + 1;
+				_staffAccs.remove( contexts[i] ); // accidentals are valid until the barline
 
-				placeMarks( bar, v, i );
+				addJob( CADrawableJob::Marks, elt, drawableContext, bar->xPos(), bar->yPos(), i, bar );
 				placeNoteCheckerErrors( bar, v );
 			}
 		}
@@ -372,12 +434,13 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 
 		// Place accidentals and key names of the function marks, if needed.
 		// These elements are so called Support elements. They can't be selected and they're not really connected usually to any logical element, but they're needed when drawing.
+		// The drawable notes don't exist yet, so the accidentals of the notes placed before in the
+		// same bar are looked up in _staffAccs instead of the drawable staff.
 		int maxWidth = 0;
 		int maxAccidentalXEnd = 0;
-		QList<CADrawableAccidental*> lastAccidentals;
+		QList<int> lastAccidentals; // indices of the accidental jobs
 		for (int i=0; i < streams; i++) {
 			// loop until the element has come, which has bigger timeStart
-			CADrawableMusElement *newElt=0;
 			int oldStreamIdx = streamsIdx[i];
 			while ( (streamsIdx[i] < musStreamList[i].size()) &&
 			        ((elt = musStreamList[i].at(streamsIdx[i]))->timeStart() == timeStart) &&
@@ -386,22 +449,25 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 				drawableContext = drawableContextMap[elt->context()];
 
 				if (elt->musElementType()==CAMusElement::Note &&
-					((CADrawableStaff*)drawableContext)->getAccs(streamsX[i], static_cast<CANote*>(elt)->diatonicPitch().noteName()) != static_cast<CANote*>(elt)->diatonicPitch().accs()
+					staffAccs(i, static_cast<CANote*>(elt)->diatonicPitch().noteName()) != static_cast<CANote*>(elt)->diatonicPitch().accs()
 				   ) {
-						newElt = new CADrawableAccidental(
-							((CANote*)elt)->diatonicPitch().accs(),
-							((CANote*)elt),
-							((CADrawableStaff*)drawableContext),
+						signed char accs = static_cast<CANote*>(elt)->diatonicPitch().accs();
+						addJob(
+							CADrawableJob::Accidental,
+							elt,
+							drawableContext,
 							streamsX[i],
-							((CADrawableStaff*)drawableContext)->calculateCenterYCoord((CANote*)elt, lastClef[i])
+							((CADrawableStaff*)drawableContext)->calculateCenterYCoord((CANote*)elt, lastClef[i]),
+							i
 						);
-
-						v->addMElement(newElt);
-						lastAccidentals << (CADrawableAccidental*)newElt;
-						if (newElt->neededWidth() > maxWidth)
-							maxWidth = newElt->neededWidth();
-						if (maxAccidentalXEnd < newElt->neededWidth()+newElt->xPos())
-							maxAccidentalXEnd = newElt->neededWidth()+newElt->xPos();
+						_jobs.last().accs = accs;
+
+						lastAccidentals << _jobs.size()-1;
+						int width = CADrawableAccidental::accidentalWidth(accs);
+						if (width > maxWidth)
+							maxWidth = width;
+						if (maxAccidentalXEnd < width+streamsX[i])
+							maxAccidentalXEnd = width+streamsX[i];
 				}
 
 				streamsIdx[i]++;
@@ -421,7 +487,7 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 
 		int deltaXPos = maxX - maxAccidentalXEnd;
 		for (int i=0; i<lastAccidentals.size(); i++) {
-			lastAccidentals[i]->setXPos(lastAccidentals[i]->xPos()+deltaXPos-1);
+			_jobs[ lastAccidentals[i] ].x += deltaXPos-1;
 		}
 
 		// Place noteheads and other elements aligned to noteheads (syllables, function marks)
@@ -440,214 +506,25 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 
 				switch ( elt->musElementType() ) {
 					case CAMusElement::Note: {
-						newElt = new CADrawableNote(
-							(CANote*)elt,
+						CANote *note = static_cast<CANote*>(elt);
+						addJob(
+							CADrawableJob::Note,
+							elt,
 							drawableContext,
 							streamsX[i],
-							((CADrawableStaff*)drawableContext)->calculateCenterYCoord((CANote*)elt, lastClef[i])
+							((CADrawableStaff*)drawableContext)->calculateCenterYCoord(note, lastClef[i]),
+							i
 						);
+						_staffAccs[ contexts[i] ][ note->diatonicPitch().noteName() ] = note->diatonicPitch().accs();
 
-						// Create Ties
-						if ( static_cast<CADrawableNote*>(newElt)->note()->tieStart() ) {
-							CASlur::CASlurDirection dir = static_cast<CADrawableNote*>(newElt)->note()->tieStart()->slurDirection();
-							if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
-								dir = static_cast<CADrawableNote*>(newElt)->note()->actualSlurDirection();
-							CADrawableSlur *tie=0;
-							if (dir==CASlur::SlurUp) {
-								tie = new CADrawableSlur(
-									static_cast<CADrawableNote*>(newElt)->note()->tieStart(), drawableContext,
-									newElt->xPos()+newElt->width(), newElt->yPos(),
-									newElt->xPos() + 20, newElt->yPos() - 5,
-									newElt->xPos() + 40, newElt->yPos()
-								);
-							} else
-							if (dir==CASlur::SlurDown) {
-								tie = new CADrawableSlur(
-									static_cast<CADrawableNote*>(newElt)->note()->tieStart(), drawableContext,
-									newElt->xPos()+newElt->width(), newElt->yPos() + newElt->height(),
-									newElt->xPos() + 20, newElt->yPos() + newElt->height() + 5,
-									newElt->xPos() + 40, newElt->yPos()	+ newElt->height()
-								);
-							}
-							v->addMElement(tie);
-						}
-						if ( static_cast<CADrawableNote*>(newElt)->note()->tieEnd() ) {
-							// Set the slur coordinates for the second note
-							CASlur::CASlurDirection dir = static_cast<CADrawableNote*>(newElt)->note()->tieEnd()->slurDirection();
-							if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
-								dir = static_cast<CADrawableNote*>(newElt)->note()->tieEnd()->noteStart()->actualSlurDirection();
-							CADrawableSlur *dSlur = static_cast<CADrawableSlur*>(v->findMElement(static_cast<CADrawableNote*>(newElt)->note()->tieEnd()));
-							dSlur->setX2( newElt->xPos() );
-							dSlur->setXMid( qRound(0.5*dSlur->xPos() + 0.5*newElt->xPos()) );
-							if ( dir==CASlur::SlurUp ) {
-								dSlur->setY2( newElt->yPos() );
-								dSlur->setYMid( qMin( dSlur->y2(), dSlur->y1() ) - 5 );
-							} else
-							if ( dir==CASlur::SlurDown ) {
-								dSlur->setY2( newElt->yPos() + newElt->height() );
-								dSlur->setYMid( qMax( dSlur->y2(), dSlur->y1() ) + 5 );
-							}
-
-						}
-
-						// Create Slurs
-						if ( static_cast<CADrawableNote*>(newElt)->note()->slurStart() ) {
-							CASlur::CASlurDirection dir = static_cast<CADrawableNote*>(newElt)->note()->slurStart()->slurDirection();
-							if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
-								dir = static_cast<CADrawableNote*>(newElt)->note()->actualSlurDirection();
-							CADrawableSlur *slur=0;
-							if (dir==CASlur::SlurUp) {
-								slur = new CADrawableSlur(
-									static_cast<CADrawableNote*>(newElt)->note()->slurStart(), drawableContext,
-									newElt->xPos()+newElt->width(), newElt->yPos(),
-									newElt->xPos() + 20, newElt->yPos() - 15,
-									newElt->xPos() + 40, newElt->yPos()
-								);
-							} else
-							if (dir==CASlur::SlurDown) {
-								slur = new CADrawableSlur(
-									static_cast<CADrawableNote*>(newElt)->note()->slurStart(), drawableContext,
-									newElt->xPos()+newElt->width(), newElt->yPos() + newElt->height(),
-									newElt->xPos() + 20, newElt->yPos() + newElt->height() + 15,
-									newElt->xPos() + 40, newElt->yPos()	+ newElt->height()
-								);
-							}
-							v->addMElement(slur);
-						}
-						if ( static_cast<CADrawableNote*>(newElt)->note()->slurEnd() ) {
-							// Set the slur coordinates for the second note
-							CASlur::CASlurDirection dir = static_cast<CADrawableNote*>(newElt)->note()->slurEnd()->slurDirection();
-							if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
-								dir = static_cast<CADrawableNote*>(newElt)->note()->slurEnd()->noteStart()->actualSlurDirection();
-							CADrawableSlur *dSlur = static_cast<CADrawableSlur*>(v->findMElement(static_cast<CADrawableNote*>(newElt)->note()->slurEnd()));
-							if( dSlur )
-							{
-								dSlur->setX2( newElt->xPos() );
-								dSlur->setXMid( qRound(0.5*dSlur->xPos() + 0.5*newElt->xPos()) );
-								if ( dir==CASlur::SlurUp ) {
-									dSlur->setY2( newElt->yPos() );
-									dSlur->setYMid( qMin( dSlur->y2(), dSlur->y1() ) - 15 );
-								} else
-								if ( dir==CASlur::SlurDown ) {
-									dSlur->setY2( newElt->yPos() + newElt->height() );
-									dSlur->setYMid( qMax( dSlur->y2(), dSlur->y1() ) + 15 );
-								}
-							}
-						}
-
-						// Create Phrasing Slurs
-						if ( static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurStart() ) {
-							CASlur::CASlurDirection dir = static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurStart()->slurDirection();
-							if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral)
-								dir = static_cast<CADrawableNote*>(newElt)->note()->actualSlurDirection();
-							CADrawableSlur *phrasingSlur=0;
-							if (dir==CASlur::SlurUp) {
-								phrasingSlur = new CADrawableSlur(
-									static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurStart(), drawableContext,
-									newElt->xPos()+newElt->width(), newElt->yPos(),
-									newElt->xPos() + 20, newElt->yPos() - 19,
-									newElt->xPos() + 40, newElt->yPos()
-								);
-							} else
-							if (dir==CASlur::SlurDown) {
-								phrasingSlur = new CADrawableSlur(
-									static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurStart(), drawableContext,
-									newElt->xPos()+newElt->width(), newElt->yPos() + newElt->height(),
-									newElt->xPos() + 20, newElt->yPos() + newElt->height() + 19,
-									newElt->xPos() + 40, newElt->yPos()	+ newElt->height()
-								);
-							}
-							v->addMElement(phrasingSlur);
-						}
-						if ( static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurEnd() ) {
-							// Set the slur coordinates for the second note
-							CASlur::CASlurDirection dir = static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurEnd()->slurDirection();
-							if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
-								dir = static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurEnd()->noteStart()->actualSlurDirection();
-							CADrawableSlur *dSlur = static_cast<CADrawableSlur*>(v->findMElement(static_cast<CADrawableNote*>(newElt)->note()->phrasingSlurEnd()));
-							dSlur->setX2( newElt->xPos() );
-							dSlur->setXMid( qRound(0.5*dSlur->xPos() + 0.5*newElt->xPos()) );
-							if ( dir==CASlur::SlurUp ) {
-								dSlur->setY2( newElt->yPos() );
-								dSlur->setYMid( qMin( dSlur->y2(), dSlur->y1() ) - 19 );
-							} else
-							if ( dir==CASlur::SlurDown ) {
-								dSlur->setY2( newElt->yPos() + newElt->height() );
-								dSlur->setYMid( qMax( dSlur->y2(), dSlur->y1() ) + 19 );
-							}
-						}
-
-						v->addMElement(newElt);
-
-						// add tuplet - same as for the rests
-						if ( static_cast<CADrawableNote*>(newElt)->note()->isLastInTuplet() ) {
-							int x1 = v->findMElement(static_cast<CADrawableNote*>(newElt)->note()->tuplet()->firstNote())->xPos();
-							int x2 = newElt->xPos() + newElt->width();
-							int y1 = v->findMElement(static_cast<CADrawableNote*>(newElt)->note()->tuplet()->firstNote())->yPos();
-							if ( y1 > drawableContext->yPos() && y1 < drawableContext->yPos()+drawableContext->height() ) {
-								y1 = drawableContext->yPos()+drawableContext->height() + 10; // inside the staff
-							} else if ( y1 < drawableContext->yPos() ){
-								y1 -= 10; // above the staff
-							} else {
-								y1 += 10; // under the staff
-							}
-							int y2 = v->findMElement(static_cast<CADrawableNote*>(newElt)->note()->tuplet()->lastNote())->yPos();
-							if ( y2 > drawableContext->yPos() && y2 < drawableContext->yPos()+drawableContext->height() ) {
-								y2 = drawableContext->yPos()+drawableContext->height() + 10; // inside the staff
-							} else if ( y2 < drawableContext->yPos() ){
-								y2 -= 10; // above the staff
-							} else {
-								y2 += 10; // under the staff
-							}
-
-							CADrawableTuplet *dTuplet = new CADrawableTuplet( static_cast<CADrawableNote*>(newElt)->note()->tuplet(), drawableContext, x1, y1, x2, y2 );
-							v->addMElement(dTuplet);
-						}
-
-						if ( static_cast<CANote*>(elt)->isLastInChord() )
-							streamsX[i] += (newElt->neededWidth() + MINIMUM_SPACE);
-
-						placeMarks( newElt, v, i );
+						if ( note->isLastInChord() )
+							streamsX[i] += (CADrawableNote::noteWidth(note) + MINIMUM_SPACE);
 
 						break;
 					}
 					case CAMusElement::Rest: {
-						newElt = new CADrawableRest(
-							(CARest*)elt,
-							drawableContext,
-							streamsX[i],
-							drawableContext->yPos()
-						);
-
-						v->addMElement(newElt);
-						streamsX[i] += (newElt->neededWidth() + MINIMUM_SPACE);
-
-						// add tuplet - same as for the notes
-						if ( static_cast<CADrawableRest*>(newElt)->rest()->isLastInTuplet() ) {
-							int x1 = v->findMElement(static_cast<CADrawableRest*>(newElt)->rest()->tuplet()->firstNote())->xPos();
-							int x2 = newElt->xPos() + newElt->width();
-							int y1 = v->findMElement(static_cast<CADrawableRest*>(newElt)->rest()->tuplet()->firstNote())->yPos();
-							if ( y1 > drawableContext->yPos() && y1 < drawableContext->yPos()+drawableContext->height() ) {
-								y1 = drawableContext->yPos()+drawableContext->height() + 10; // inside the staff
-							} else if ( y1 < drawableContext->yPos() ){
-								y1 -= 10; // above the staff
-							} else {
-								y1 += 10; // under the staff
-							}
-							int y2 = v->findMElement(static_cast<CADrawableRest*>(newElt)->rest()->tuplet()->lastNote())->yPos();
-							if ( y2 > drawableContext->yPos() && y2 < drawableContext->yPos()+drawableContext->height() ) {
-								y2 = drawableContext->yPos()+drawableContext->height() + 10; // inside the staff
-							} else if ( y2 < drawableContext->yPos() ){
-								y2 -= 10; // above the staff
-							} else {
-								y2 += 10; // under the staff
-							}
-
-							CADrawableTuplet *dTuplet = new CADrawableTuplet( static_cast<CADrawableRest*>(newElt)->rest()->tuplet(), drawableContext, x1, y1, x2, y2 );
-							v->addMElement(dTuplet);
-						}
-
-						placeMarks( newElt, v, i );
+						addJob( CADrawableJob::Rest, elt, drawableContext, streamsX[i], drawableContext->yPos(), i );
+						streamsX[i] += (CADrawableRest::restWidth(static_cast<CARest*>(elt)) + MINIMUM_SPACE);
 
 						break;
 					}
@@ -987,37 +864,394 @@ void CALayoutEngine::reposit( CAScoreView *v ) {
 
 		}
 	}
+	_time = timeStart;
+
+	materialize();
+	placeScalableElts();
 
-	// reposit the scalable elements (eg. crescendo)
-	for (int i=0; i<scalableElts.size(); i++) {
-		scalableElts[i]->setXPos( v->timeToCoords(scalableElts[i]->musElement()->timeStart()) );
-		scalableElts[i]->setWidth( v->timeToCoords(scalableElts[i]->musElement()->timeEnd()) - scalableElts[i]->xPos() );
-		v->addMElement(scalableElts[i]);
+	return _finished;
+}
+
+/*!
+	Places the music elements of the next \a bars bars following the already placed ones.
+	Bars are taken from the measure table of the first staff in the sheet. If the sheet doesn't
+	have any bars, all the remaining elements are placed.
+
+	Returns True, if the whole sheet is laid out.
+
+	\sa repositUntil(), CAMeasureTable
+*/
+bool CALayoutEngine::repositBars( int bars ) {
+	return repositUntil( checkpointTime( bars ) );
+}
+
+/*!
+	Returns the start time of the bar \a bars bars after the current time or -1, if there is
+	no such bar.
+*/
+int CALayoutEngine::checkpointTime( int bars ) {
+	QList<CAContext*> contextList = _layout->sheet()->contextList();
+	for (int i=0; i<contextList.size(); i++) {
+		if ( contextList[i]->contextType()!=CAContext::Staff ) {
+			continue;
+		}
+
+		CAMeasureTable *measures = static_cast<CAStaff*>(contextList[i])->measureTable();
+		if ( !measures->measureCount() ) {
+			continue;
+		}
+
+		int idx = measures->measureIndexAt( _time );
+		if ( idx==-1 || idx+bars>=measures->measureCount() ) {
+			return -1;
+		}
+
+		int time = measures->measure( idx+bars ).timeStart;
+		return ( time>_time ? time : -1 ); // avoid getting stuck on empty bars
 	}
-	delete [] streamsIdx;
-	delete [] streamsX;
-	delete [] streamsRehersalMarks;
-	delete [] lastClef;
-	delete [] lastKeySig;
-	delete [] lastTimeSig;
-	delete [] lastDFMTonicizations;
+
+	return -1;
 }
 
 /*!
-	Place marks for the given music element.
+	Returns the X coordinate where the next placed elements will start.
 */
-void CALayoutEngine::placeMarks( CADrawableMusElement *e, CAScoreView *v, int streamIdx ) {
-	CAMusElement *elt = e->musElement();
-	int xCoord = e->xPos();
+int CALayoutEngine::xEnd() {
+	int maxX = 0;
+	for (int i=0; i<_streamsX.size(); i++) maxX = (_streamsX[i] > maxX) ? _streamsX[i] : maxX;
+	return maxX;
+}
 
-	for ( int i=0,j=0,k=0; i < elt->markList().size(); i++ ) {
-		if ( elt->markList()[i]->isCommon() &&
-		     elt->musElementType()==CAMusElement::Note &&
-		     !static_cast<CANote*>(elt)->isFirstInChord() ) {
+/*!
+	Places the scalable elements (eg. crescendo) when both their ends are already laid out.
+	Once the whole sheet is laid out, all the remaining scalable elements are placed.
+*/
+void CALayoutEngine::placeScalableElts() {
+	for (int i=0; i<_scalableElts.size(); i++) {
+		double x1 = _layout->timeToCoords(_scalableElts[i]->musElement()->timeStart());
+		double x2 = _layout->timeToCoords(_scalableElts[i]->musElement()->timeEnd());
+		if ( !_finished && (x1<0 || x2<0) ) {
 			continue;
 		}
 
+		_scalableElts[i]->setXPos( x1 );
+		_scalableElts[i]->setWidth( x2 - _scalableElts[i]->xPos() );
+		_layout->addMElement(_scalableElts[i]);
+		_scalableElts.removeAt(i--);
+	}
+}
+
+/*!
+	Returns the accidental of the note \a noteName in the staff of the stream \a streamIdx valid
+	at the current column. It is the accidental of the last note with the same pitch placed
+	since the last barline or the key signature, or the one given by the key signature.
+*/
+int CALayoutEngine::staffAccs( int streamIdx, int noteName ) {
+	QHash<CAContext*, QHash<int, int> >::const_iterator it = _staffAccs.constFind( _contexts[streamIdx] );
+	if ( it!=_staffAccs.constEnd() && it.value().contains(noteName) ) {
+		return it.value().value( noteName );
+	}
+
+	CAKeySignature *key = _lastKeySig[ streamIdx ];
+	return (key?key->accidentals()[ noteName<0 ? 6-(-noteName-1)%7 : noteName%7 ]:0);	// watch: % operator with negative numbers is implementation dependent
+}
+
+/*!
+	Returns True, if the \a mark of the music element \a elt gets its own drawable mark.
+	Common marks are placed for the first note of the chord only.
+*/
+static bool isMarkPlaced( CAMusElement *elt, CAMark *mark ) {
+	return !( mark->isCommon() &&
+	          elt->musElementType()==CAMusElement::Note &&
+	          !static_cast<CANote*>(elt)->isFirstInChord() );
+}
+
+/*!
+	Queues the drawable element of the given \a type for the music element \a elt positioned
+	at \a x, \a y in the drawable context \a context of the stream \a streamIdx.
+	Marks jobs take the already created \a drawable whose marks are placed.
+
+	The drawable elements are created by materialize() at the end of repositUntil().
+*/
+void CALayoutEngine::addJob( CADrawableJob::CADrawableJobType type, CAMusElement *elt, CADrawableContext *context, double x, double y, int streamIdx, CADrawableMusElement *drawable ) {
+	CADrawableJob job;
+	job.type = type;
+	job.elt = elt;
+	job.context = context;
+	job.x = x;
+	job.y = y;
+	job.accs = 0;
+	job.rehersalMarkNumber = _streamsRehersalMarks[ streamIdx ];
+	job.pendingLinks = 0;
+	job.drawable = drawable;
+
+	// the reused elements are moved to their positions by buildDrawables()
+	switch ( type ) {
+		case CADrawableJob::Accidental:
+			job.drawable = _layout->takeRecycled( elt, CADrawableMusElement::DrawableAccidental, context );
+			break;
+		case CADrawableJob::Note:
+			job.drawable = _layout->takeRecycled( elt, CADrawableMusElement::DrawableNote, context );
+			break;
+		case CADrawableJob::Rest:
+			job.drawable = _layout->takeRecycled( elt, CADrawableMusElement::DrawableRest, context );
+			break;
+		case CADrawableJob::Marks:
+			break;
+	}
+
+	// number the rehersal marks in the order of the stream
+	if ( type!=CADrawableJob::Accidental ) {
+		for (int i=0; i<elt->markList().size(); i++) {
+			CAMark *mark = elt->markList()[i];
+			if ( !isMarkPlaced(elt, mark) ) {
+				continue;
+			}
+
+			if ( mark->markType()==CAMark::RehersalMark ) {
+				_streamsRehersalMarks[ streamIdx ]++;
+			}
+			job.marks << static_cast<CADrawableMark*>( _layout->takeRecycled( mark, CADrawableMusElement::DrawableMark, context ) );
+		}
+	}
+
+	_jobs << job;
+}
+
+/*!
+	Returns the drawable element of the given \a type of the previous layout of \a elt moved to
+	the drawable \a context and the position \a x, \a y or 0, if it can't be reused.
+
+	\sa CALayout::takeRecycled()
+*/
+CADrawableMusElement *CALayoutEngine::reuse( CAMusElement *elt, CADrawableMusElement::CADrawableMusElementType type, CADrawableContext *context, double x, double y ) {
+	CADrawableMusElement *d = _layout->takeRecycled( elt, type, context );
+	if ( d ) {
+		d->moveTo( context, x, y );
+	}
+
+	return d;
+}
+
+/*!
+	\class CADrawableBuilder
+	\brief Creates the drawable elements of a single context in a worker thread
+
+	\sa CALayoutEngine::materialize()
+*/
+class CADrawableBuilder : public QRunnable {
+public:
+	CADrawableBuilder( CALayoutEngine::CADrawableJob *jobs, const QVector<int>& idxs, QSemaphore *done )
+	 : _jobs(jobs), _idxs(idxs), _done(done) { }
+
+	void run() {
+		CALayoutEngine::buildDrawables( _jobs, _idxs );
+		_done->release();
+	}
+
+private:
+	CALayoutEngine::CADrawableJob *_jobs;
+	QVector<int> _idxs;
+	QSemaphore *_done;
+};
+
+/*!
+	Creates the drawable elements of the jobs with the given indices \a idxs. The jobs belong to
+	a single context, so ties, slurs and tuplets are connected to the notes created here. Links
+	to the elements placed by the previous calls of repositUntil() are left in pendingLinks.
+
+	Doesn't access the layout, so different contexts can be built at the same time.
+*/
+void CALayoutEngine::buildDrawables( CADrawableJob *jobs, const QVector<int>& idxs ) {
+	QHash<CAMusElement*, CADrawableMusElement*> placed;
+
+	for (int i=0; i<idxs.size(); i++) {
+		CADrawableJob& job = jobs[ idxs[i] ];
+
+		switch ( job.type ) {
+			case CADrawableJob::Accidental: {
+				if ( job.drawable )
+					job.drawable->moveTo( job.context, job.x, job.y );
+				else
+					job.drawable = new CADrawableAccidental( job.accs, job.elt, job.context, job.x, job.y );
+				job.drawables << job.drawable;
+				break;
+			}
+			case CADrawableJob::Note: {
+				if ( job.drawable )
+					job.drawable->moveTo( job.context, job.x, job.y );
+				else
+					job.drawable = new CADrawableNote( static_cast<CANote*>(job.elt), job.context, job.x, job.y );
+				startSlurs( static_cast<CADrawableNote*>(job.drawable), job.drawables );
+				job.drawables << job.drawable;
+				break;
+			}
+			case CADrawableJob::Rest: {
+				if ( job.drawable )
+					job.drawable->moveTo( job.context, job.x, job.y );
+				else
+					job.drawable = new CADrawableRest( static_cast<CARest*>(job.elt), job.context, job.x, job.y );
+				job.drawables << job.drawable;
+				break;
+			}
+			case CADrawableJob::Marks:
+				break;
+		}
+
+		if ( job.type==CADrawableJob::Note || job.type==CADrawableJob::Rest ) {
+			for (int j=0; j<job.drawables.size(); j++) {
+				placed.insert( job.drawables[j]->musElement(), job.drawables[j] );
+			}
+			job.pendingLinks = linkEnds( job.drawable, TieEnd|SlurEnd|PhrasingSlurEnd|TupletEnd, job.drawables, &placed, 0 );
+		}
+
+		if ( job.type!=CADrawableJob::Accidental ) {
+			buildMarks( job );
+		}
+	}
+}
+
+/*!
+	Creates the ties, slurs and phrasing slurs starting at the drawable note \a dNote and appends
+	them to \a drawables. Their ends are set by linkEnds() when the last note is placed.
+*/
+void CALayoutEngine::startSlurs( CADrawableNote *dNote, QList<CADrawableMusElement*>& drawables ) {
+	CASlur *starts[3] = { dNote->note()->tieStart(), dNote->note()->slurStart(), dNote->note()->phrasingSlurStart() };
+	const int heights[3] = { 5, 15, 19 };
+
+	for (int i=0; i<3; i++) {
+		if ( !starts[i] ) {
+			continue;
+		}
+
+		CASlur::CASlurDirection dir = starts[i]->slurDirection();
+		if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
+			dir = dNote->note()->actualSlurDirection();
+		CADrawableSlur *slur=0;
+		if (dir==CASlur::SlurUp) {
+			slur = new CADrawableSlur(
+				starts[i], dNote->drawableContext(),
+				dNote->xPos()+dNote->width(), dNote->yPos(),
+				dNote->xPos() + 20, dNote->yPos() - heights[i],
+				dNote->xPos() + 40, dNote->yPos()
+			);
+		} else
+		if (dir==CASlur::SlurDown) {
+			slur = new CADrawableSlur(
+				starts[i], dNote->drawableContext(),
+				dNote->xPos()+dNote->width(), dNote->yPos() + dNote->height(),
+				dNote->xPos() + 20, dNote->yPos() + dNote->height() + heights[i],
+				dNote->xPos() + 40, dNote->yPos() + dNote->height()
+			);
+		}
+
+		if (slur)
+			drawables << slur;
+	}
+}
+
+/*!
+	Returns the drawable instance of \a elt among the \a placed elements or in the \a layout,
+	if \a placed is 0.
+*/
+static CADrawableMusElement *findPlaced( CAMusElement *elt, const QHash<CAMusElement*, CADrawableMusElement*> *placed, CALayout *layout ) {
+	return ( placed ? placed->value( elt ) : layout->findMElement( elt ) );
+}
+
+/*!
+	Connects the drawable note or rest \a dElt to the ties, slurs and tuplets ending at it. Only
+	the given CALinkType \a links are connected. The starts of the slurs and the first note of the
+	tuplet are looked up among the \a placed elements of the current task or in the \a layout,
+	if \a placed is 0. The created tuplets are appended to \a drawables.
+
+	Returns the links whose starts were not found.
+*/
+int CALayoutEngine::linkEnds( CADrawableMusElement *dElt, int links, QList<CADrawableMusElement*>& drawables, const QHash<CAMusElement*, CADrawableMusElement*> *placed, CALayout *layout ) {
+	int pending = 0;
+
+	if ( dElt->drawableMusElementType()==CADrawableMusElement::DrawableNote ) {
+		CANote *note = static_cast<CANote*>(dElt->musElement());
+		CASlur *ends[3] = { note->tieEnd(), note->slurEnd(), note->phrasingSlurEnd() };
+		const int types[3] = { TieEnd, SlurEnd, PhrasingSlurEnd };
+		const int heights[3] = { 5, 15, 19 };
+
+		for (int i=0; i<3; i++) {
+			if ( !(links & types[i]) || !ends[i] ) {
+				continue;
+			}
+
+			// Set the slur coordinates for the second note
+			CADrawableSlur *dSlur = static_cast<CADrawableSlur*>( findPlaced(ends[i], placed, layout) );
+			if ( !dSlur ) {
+				pending |= types[i];
+				continue;
+			}
+
+			CASlur::CASlurDirection dir = ends[i]->slurDirection();
+			if ( dir==CASlur::SlurPreferred || dir==CASlur::SlurNeutral )
+				dir = ends[i]->noteStart()->actualSlurDirection();
+			dSlur->setX2( dElt->xPos() );
+			dSlur->setXMid( qRound(0.5*dSlur->xPos() + 0.5*dElt->xPos()) );
+			if ( dir==CASlur::SlurUp ) {
+				dSlur->setY2( dElt->yPos() );
+				dSlur->setYMid( qMin( dSlur->y2(), dSlur->y1() ) - heights[i] );
+			} else
+			if ( dir==CASlur::SlurDown ) {
+				dSlur->setY2( dElt->yPos() + dElt->height() );
+				dSlur->setYMid( qMax( dSlur->y2(), dSlur->y1() ) + heights[i] );
+			}
+		}
+	}
+
+	CAPlayable *playable = static_cast<CAPlayable*>(dElt->musElement());
+	if ( (links & TupletEnd) && playable->isLastInTuplet() ) {
+		CADrawableMusElement *first = findPlaced( playable->tuplet()->firstNote(), placed, layout );
+		CADrawableMusElement *last = findPlaced( playable->tuplet()->lastNote(), placed, layout );
+		if ( !first || !last ) {
+			return pending | TupletEnd;
+		}
+
+		CADrawableContext *drawableContext = dElt->drawableContext();
+		int x1 = first->xPos();
+		int x2 = dElt->xPos() + dElt->width();
+		int y1 = first->yPos();
+		if ( y1 > drawableContext->yPos() && y1 < drawableContext->yPos()+drawableContext->height() ) {
+			y1 = drawableContext->yPos()+drawableContext->height() + 10; // inside the staff
+		} else if ( y1 < drawableContext->yPos() ){
+			y1 -= 10; // above the staff
+		} else {
+			y1 += 10; // under the staff
+		}
+		int y2 = last->yPos();
+		if ( y2 > drawableContext->yPos() && y2 < drawableContext->yPos()+drawableContext->height() ) {
+			y2 = drawableContext->yPos()+drawableContext->height() + 10; // inside the staff
+		} else if ( y2 < drawableContext->yPos() ){
+			y2 -= 10; // above the staff
+		} else {
+			y2 += 10; // under the staff
+		}
+
+		drawables << new CADrawableTuplet( playable->tuplet(), drawableContext, x1, y1, x2, y2 );
+	}
+
+	return pending;
+}
+
+/*!
+	Places the drawable marks of the music element of the \a job. The marks list of the job
+	contains the reused drawable mark or 0 for each placed mark, the missing ones are created.
+*/
+void CALayoutEngine::buildMarks( CADrawableJob& job ) {
+	CADrawableMusElement *e = job.drawable;
+	CAMusElement *elt = job.elt;
+	int xCoord = e->xPos();
+	int rehersalMarkNumber = job.rehersalMarkNumber;
+
+	for ( int i=0,j=0,k=0,m=0; i < elt->markList().size(); i++ ) {
 		CAMark *mark = elt->markList()[i];
+		if ( !isMarkPlaced(elt, mark) ) {
+			continue;
+		}
 
 		int yCoord;
 		CAFingering *fingering = dynamic_cast<CAFingering*>(mark);
@@ -1046,20 +1280,94 @@ void CALayoutEngine::placeMarks( CADrawableMusElement *e, CAScoreView *v, int st
 			xCoord = e->xPos() + qRound(e->width()/2.0) - 3;
 		}
 
-		CADrawableMark *m = new CADrawableMark( mark, e->drawableContext(), xCoord, yCoord );
+		CADrawableMark *drawableMark = job.marks[m];
+		if ( drawableMark ) {
+			drawableMark->moveTo( e->drawableContext(), xCoord, yCoord );
+		} else {
+			drawableMark = new CADrawableMark( mark, e->drawableContext(), xCoord, yCoord );
+			job.marks[m] = drawableMark;
+		}
+		m++;
 
 		if ( mark->markType()==CAMark::RehersalMark )
-			m->setRehersalMarkNumber( streamsRehersalMarks[ streamIdx ]++ );
+			drawableMark->setRehersalMarkNumber( rehersalMarkNumber++ );
+	}
+}
 
-		if (m->isHScalable() || m->isVScalable()) {
-			scalableElts << m;
-		} else {
-			v->addMElement( m );
+/*!
+	Creates the drawable elements positioned by the spacing pass of repositUntil() and adds
+	them to the layout.
+
+	The spacing pass only computes the positions of the notes, rests, accidentals and marks, so
+	it stays sequential. The drawable elements of different contexts don't depend on each other
+	and are created in parallel on the global thread pool, one task per context, including the
+	ties, slurs and tuplets connecting the notes of the context. The elements are added to the
+	layout in the original order after all the tasks finished, so the result doesn't depend on
+	the number of threads. Slurs and tuplets starting in the previously placed chunks of the
+	sheet are connected then.
+
+	Small chunks and platforms without threaded font rendering are built serially.
+*/
+void CALayoutEngine::materialize() {
+	if ( _jobs.isEmpty() ) {
+		return;
+	}
+
+	// group the jobs by their contexts
+	QList< QVector<int> > groups;
+	QHash<CADrawableContext*, int> groupIdx;
+	for (int i=0; i<_jobs.size(); i++) {
+		if ( !groupIdx.contains(_jobs[i].context) ) {
+			groupIdx[ _jobs[i].context ] = groups.size();
+			groups << QVector<int>();
 		}
+		groups[ groupIdx[_jobs[i].context] ] << i;
 	}
+
+	CADrawableJob *jobs = _jobs.data();
+	QThreadPool *pool = QThreadPool::globalInstance();
+	if ( groups.size()>1 && _jobs.size()>=PARALLEL_JOBS_MIN &&
+	     pool->maxThreadCount()>1 && QFontDatabase::supportsThreadedFontRendering() ) {
+		QSemaphore done;
+		for (int i=1; i<groups.size(); i++) {
+			pool->start( new CADrawableBuilder( jobs, groups[i], &done ) );
+		}
+		buildDrawables( jobs, groups[0] ); // the calling thread helps as well
+		done.acquire( groups.size()-1 );
+	} else {
+		for (int i=0; i<groups.size(); i++) {
+			buildDrawables( jobs, groups[i] );
+		}
+	}
+
+	for (int i=0; i<_jobs.size(); i++) {
+		CADrawableJob& job = _jobs[i];
+		for (int j=0; j<job.drawables.size(); j++) {
+			_layout->addMElement( job.drawables[j] );
+		}
+
+		if ( job.pendingLinks ) {
+			QList<CADrawableMusElement*> tuplets;
+			linkEnds( job.drawable, job.pendingLinks, tuplets, 0, _layout );
+			for (int j=0; j<tuplets.size(); j++) {
+				_layout->addMElement( tuplets[j] );
+			}
+		}
+
+		for (int j=0; j<job.marks.size(); j++) {
+			CADrawableMark *m = job.marks[j];
+			if (m->isHScalable() || m->isVScalable()) {
+				_scalableElts << m;
+			} else {
+				_layout->addMElement( m );
+			}
+		}
+	}
+
+	_jobs.clear();
 }
 
-void CALayoutEngine::placeNoteCheckerErrors( CADrawableMusElement* dMusElt, CAScoreView* v ) {
+void CALayoutEngine::placeNoteCheckerErrors( CADrawableMusElement* dMusElt, CALayout* v ) {
 	QList<CANoteCheckerError*> ncErrors = dMusElt->musElement()->noteCheckerErrorList();
 	for (int i=0; i<ncErrors.size(); i++) {
 		v->addDrawableNoteCheckerError(
@@ -9,18 +9,103 @@
 #define LAYOUTENGINE_
 
 #include <QList>
+#include <QMap>
+#include <QHash>
+#include <QVector>
 
-class CAScoreView;
-class CADrawableMusElement;
+#include "layout/drawablemuselement.h"
+
+class CALayout;
+class CAContext;
+class CAMusElement;
+class CAClef;
+class CAKeySignature;
+class CAMark;
+class CATimeSignature;
+class CADrawableContext;
+class CADrawableMark;
+class CADrawableNote;
+class CADrawableFunctionMarkSupport;
 
 class CALayoutEngine {
 	public:
-		static void reposit(CAScoreView *v);
+		CALayoutEngine( CALayout *v );
+		~CALayoutEngine();
+
+		static void reposit(CALayout *v);
+
+		bool repositUntil( int time );
+		bool repositBars( int bars );
+
+		inline bool isFinished() { return _finished; }
+		inline int time() { return _time; }
+		int xEnd();
+
 	private:
-		static void placeMarks( CADrawableMusElement*, CAScoreView*, int );
-		static void placeNoteCheckerErrors( CADrawableMusElement*, CAScoreView* );
-		static int *streamsRehersalMarks;
-		static QList<CADrawableMusElement*> scalableElts;
+		CALayoutEngine( const CALayoutEngine& );            // not copyable
+		CALayoutEngine& operator=( const CALayoutEngine& );
+
+		// drawable element positioned by the spacing pass and created later by materialize()
+		struct CADrawableJob {
+			enum CADrawableJobType {
+				Accidental,  // drawable accidental of the note
+				Note,        // drawable note with its ties, slurs and tuplet
+				Rest,        // drawable rest with its tuplet
+				Marks        // marks of the already created drawable element
+			};
+
+			CADrawableJobType type;
+			CAMusElement *elt;
+			CADrawableContext *context;
+			double x;
+			double y;
+			signed char accs;                       // accidental of the Accidental job
+			int rehersalMarkNumber;                 // number of the first rehersal mark of the element
+			int pendingLinks;                       // CALinkType flags of the elements placed by other tasks
+			CADrawableMusElement *drawable;         // created or already placed drawable element
+			QList<CADrawableMusElement*> drawables; // created elements in the order they are added to the layout
+			QList<CADrawableMark*> marks;           // drawable marks, reused ones are taken when queued
+		};
+
+		enum CALinkType {
+			TieEnd = 1,
+			SlurEnd = 2,
+			PhrasingSlurEnd = 4,
+			TupletEnd = 8
+		};
+		friend class CADrawableBuilder;
+
+		int checkpointTime( int bars );
+		void placeScalableElts();
+		void addJob( CADrawableJob::CADrawableJobType type, CAMusElement *elt, CADrawableContext *context, double x, double y, int streamIdx, CADrawableMusElement *drawable=0 );
+		CADrawableMusElement *reuse( CAMusElement *elt, CADrawableMusElement::CADrawableMusElementType type, CADrawableContext *context, double x, double y );
+		void materialize();
+		static void buildDrawables( CADrawableJob *jobs, const QVector<int>& idxs );
+		static void buildMarks( CADrawableJob& job );
+		static void startSlurs( CADrawableNote *dNote, QList<CADrawableMusElement*>& drawables );
+		static int linkEnds( CADrawableMusElement *dElt, int links, QList<CADrawableMusElement*>& drawables, const QHash<CAMusElement*, CADrawableMusElement*> *placed, CALayout *layout );
+		void placeNoteCheckerErrors( CADrawableMusElement*, CALayout* );
+		int staffAccs( int streamIdx, int noteName );
+
+		CALayout *_layout;
+		int _time;      // start time of the music elements which will be placed next
+		bool _finished; // are all the music elements placed
+
+		QList< QList<CAMusElement*> > _musStreamList;       // streams music elements
+		QList<CAContext*> _contexts;                         // which context does the stream belong to
+		QList<int> _nonFirstVoiceIdxs;                       // indexes of streams which aren't the first voice of their staff
+		QMap<CAContext*, CADrawableContext*> _drawableContextMap;
+
+		QVector<int> _streamsIdx;             // index of the next element in each stream
+		QVector<int> _streamsX;               // X coordinate of the next element in each stream
+		QVector<int> _streamsRehersalMarks;   // number of rehersal marks placed in each stream
+		QVector<CAClef*> _lastClef;
+		QVector<CAKeySignature*> _lastKeySig;
+		QVector<CATimeSignature*> _lastTimeSig;
+		QVector<CADrawableFunctionMarkSupport*> _lastDFMTonicizations;
+		QHash<CAContext*, QHash<int, int> > _staffAccs; // accidentals of the notes placed since the last barline or key signature in each staff
+		QList<CADrawableMusElement*> _scalableElts; // scalable elements (eg. crescendo) waiting for their end to be laid out
+		QVector<CADrawableJob> _jobs;               // elements positioned in this call, but not created yet
 };
 
 #endif /* LAYOUTENGINE_ */
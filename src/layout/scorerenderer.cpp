@@ -0,0 +1,236 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QPainter>
+#include <QColor>
+
+#include <algorithm> // std::sort, std::unique, std::upper_bound
+
+#include "layout/scorerenderer.h"
+#include "layout/layout.h"
+#include "layout/layoutengine.h"
+#include "layout/drawablecontext.h"
+#include "layout/drawablemuselement.h"
+
+#include "score/sheet.h"
+#include "score/rest.h"
+
+/*!
+	\class CAScoreRenderer
+	\brief Native renderer of a sheet to printable pages
+
+	CAScoreRenderer paints the sheet without the external typesetter. The sheet is laid out by
+	CALayoutEngine into its own CALayout and the drawable elements are painted directly to any
+	paint device (QPdfWriter, QSvgGenerator, QPrinter). This is much faster than exporting to
+	LilyPond and running it, but the result is the same as in the score view and not engraved.
+
+	The sheet is laid out as a single long system. The renderer cuts it into systems of
+	systemWidth() world units, preferably after a barline, and puts as many systems on a page
+	as fit below each other. Elements crossing the system border (eg. slurs) are clipped.
+
+	Usage:
+	\code
+	CAScoreRenderer renderer( sheet );
+	renderer.paginate( QSizeF(writer.width(), writer.height()) );
+	QPainter p( &writer );
+	for (int i=0; i<renderer.pageCount(); i++) {
+		if (i) writer.newPage();
+		renderer.renderPage( &p, i, QRectF(0, 0, writer.width(), writer.height()) );
+	}
+	\endcode
+
+	Hidden rests and invisible elements are not painted. Elements are painted in their own
+	color, if set, or black otherwise. The renderer doesn't depend on the GUI, so it can be used
+	in the export threads.
+
+	\sa CALayoutEngine, CATypesetter
+*/
+
+const double CAScoreRenderer::DEFAULT_SYSTEM_WIDTH = 1000;
+const double CAScoreRenderer::SYSTEM_SPACING = 40;
+const double CAScoreRenderer::PAGE_MARGIN = 0.08;
+
+/*!
+	Lays out the given \a sheet and cuts it into systems of the default width.
+*/
+CAScoreRenderer::CAScoreRenderer( CASheet *sheet ) {
+	_layout = new CALayout( sheet );
+	CALayoutEngine::reposit( _layout );
+
+	_systemWidth = DEFAULT_SYSTEM_WIDTH;
+	_systemsPerPage = 1;
+	_pageCount = 0;
+	_top = 0;
+	_bottom = 0;
+
+	QList<CADrawableContext*> cList = _layout->drawableCList().list();
+	QList<CADrawableMusElement*> mList = _layout->drawableMList().list();
+	if ( !cList.isEmpty() ) {
+		_top = cList[0]->yPos();
+		_bottom = cList[0]->yPos() + cList[0]->height();
+	} else if ( !mList.isEmpty() ) {
+		_top = mList[0]->yPos();
+		_bottom = mList[0]->yPos() + mList[0]->height();
+	}
+
+	for (int i=0; i<cList.size(); i++) {
+		_top = qMin( _top, cList[i]->yPos() );
+		_bottom = qMax( _bottom, cList[i]->yPos() + cList[i]->height() );
+	}
+
+	for (int i=0; i<mList.size(); i++) {
+		_top = qMin( _top, mList[i]->yPos() );
+		_bottom = qMax( _bottom, mList[i]->yPos() + mList[i]->height() );
+		if ( mList[i]->drawableMusElementType()==CADrawableMusElement::DrawableBarline ) {
+			_breaks << mList[i]->xPos() + mList[i]->width();
+		}
+	}
+
+	// barlines of all the staffs end at the same coordinates
+	std::sort( _breaks.begin(), _breaks.end() );
+	_breaks.erase( std::unique(_breaks.begin(), _breaks.end()), _breaks.end() );
+
+	createSystems();
+}
+
+CAScoreRenderer::~CAScoreRenderer() {
+	delete _layout;
+}
+
+CASheet *CAScoreRenderer::sheet() {
+	return _layout->sheet();
+}
+
+/*!
+	Sets the width of a system to \a width world units and cuts the sheet into systems again.
+	Call paginate() afterwards.
+*/
+void CAScoreRenderer::setSystemWidth( double width ) {
+	_systemWidth = qMax( width, 1.0 );
+	createSystems();
+}
+
+/*!
+	Cuts the laid out sheet into systems of at most systemWidth() world units. Each system ends
+	after the last barline fitting into it. The system is cut in the middle of the bar, if it
+	would be shorter than half of the width otherwise.
+*/
+void CAScoreRenderer::createSystems() {
+	_systemList.clear();
+
+	double xEnd = 0;
+	QList<CADrawableMusElement*> mList = _layout->drawableMList().list();
+	for (int i=0; i<mList.size(); i++) {
+		xEnd = qMax( xEnd, mList[i]->xPos() + mList[i]->width() );
+	}
+
+	double x = 0;
+	while ( x < xEnd ) {
+		CASystem system;
+		system.x1 = x;
+		system.x2 = qMin( x + _systemWidth, xEnd );
+
+		if ( system.x2 < xEnd ) {
+			QVector<double>::const_iterator it = std::upper_bound( _breaks.constBegin(), _breaks.constEnd(), x + _systemWidth );
+			if ( it!=_breaks.constBegin() && *(it-1) > x + _systemWidth/2 ) {
+				system.x2 = *(it-1);
+			}
+		}
+
+		_systemList << system;
+		x = system.x2;
+	}
+}
+
+/*!
+	Distributes the systems to pages of the given \a pageSize in device units.
+
+	\sa pageCount(), renderPage()
+*/
+void CAScoreRenderer::paginate( const QSizeF& pageSize ) {
+	double margin = pageSize.width() * PAGE_MARGIN;
+	double width = pageSize.width() - 2*margin;
+	double height = pageSize.height() - 2*margin;
+	if ( width <= 0 || height <= 0 || _systemList.isEmpty() ) {
+		_systemsPerPage = 1;
+		_pageCount = _systemList.size();
+		return;
+	}
+
+	// page height in world units, the system width fills the page width
+	double pageHeight = height * _systemWidth / width;
+	double systemHeight = _bottom - _top;
+
+	_systemsPerPage = qMax( 1, static_cast<int>( (pageHeight + SYSTEM_SPACING) / (systemHeight + SYSTEM_SPACING) ) );
+	_pageCount = ( _systemList.size() + _systemsPerPage - 1 ) / _systemsPerPage;
+}
+
+/*!
+	Paints the given \a page into the rectangle \a pageRect of the painter \a p.
+	The rectangle should have the same size as passed to paginate().
+*/
+void CAScoreRenderer::renderPage( QPainter *p, int page, const QRectF& pageRect ) {
+	double margin = pageRect.width() * PAGE_MARGIN;
+	QRectF r = pageRect.adjusted( margin, margin, -margin, -margin );
+	double z = r.width() / _systemWidth;
+
+	int first = page * _systemsPerPage;
+	for (int i=first; i<first+_systemsPerPage && i<_systemList.size(); i++) {
+		double y = r.top() + (i-first) * (_bottom - _top + SYSTEM_SPACING) * z;
+		renderSystem( p, _systemList[i], r.left(), y, z );
+	}
+}
+
+/*!
+	Paints the given \a system with its top left corner at \a x, \a y in device units using
+	the zoom level \a z.
+*/
+void CAScoreRenderer::renderSystem( QPainter *p, const CASystem& system, double x, double y, double z ) {
+	int w = qRound( (system.x2 - system.x1) * z );
+	int h = qRound( (_bottom - _top) * z );
+
+	p->save();
+	p->translate( x, y );
+	p->setClipRect( QRect(0, 0, w, h) );
+	p->setRenderHint( QPainter::Antialiasing, true );
+
+	QList<CADrawableContext*> cList = _layout->drawableCList().findInRange( system.x1, _top, system.x2-system.x1, _bottom-_top );
+	for (int i=0; i<cList.size(); i++) {
+		CADrawSettings s = {
+			static_cast<float>(z),
+			qRound( (cList[i]->xPos() - system.x1) * z ),
+			qRound( (cList[i]->yPos() - _top) * z ),
+			w, h,
+			Qt::black,
+			system.x1,
+			_top
+		};
+		cList[i]->draw( p, s );
+	}
+
+	QList<CADrawableMusElement*> mList = _layout->drawableMList().findInRange( system.x1, _top, system.x2-system.x1, _bottom-_top );
+	for (int i=0; i<mList.size(); i++) {
+		CAMusElement *elt = mList[i]->musElement();
+		if ( elt && ( !elt->isVisible() ||
+		     (elt->musElementType()==CAMusElement::Rest && static_cast<CARest*>(elt)->restType()==CARest::Hidden) ) ) {
+			continue;
+		}
+
+		CADrawSettings s = {
+			static_cast<float>(z),
+			qRound( (mList[i]->xPos() - system.x1) * z ),
+			qRound( (mList[i]->yPos() - _top) * z ),
+			w, h,
+			( (elt && elt->color()!=QColor(0,0,0,0)) ? elt->color() : QColor(Qt::black) ),
+			system.x1,
+			_top
+		};
+		mList[i]->draw( p, s );
+	}
+
+	p->restore();
+}
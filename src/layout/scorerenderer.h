@@ -0,0 +1,59 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef SCORERENDERER_H_
+#define SCORERENDERER_H_
+
+#include <QVector>
+#include <QSizeF>
+#include <QRectF>
+
+class QPainter;
+class CASheet;
+class CALayout;
+
+class CAScoreRenderer {
+public:
+	CAScoreRenderer( CASheet *sheet );
+	~CAScoreRenderer();
+
+	CASheet *sheet();
+
+	inline double systemWidth() { return _systemWidth; }
+	void setSystemWidth( double width );
+
+	void paginate( const QSizeF& pageSize );
+	inline int pageCount() { return _pageCount; }
+	void renderPage( QPainter *p, int page, const QRectF& pageRect );
+
+	static const double DEFAULT_SYSTEM_WIDTH;
+	static const double SYSTEM_SPACING;
+	static const double PAGE_MARGIN;
+
+private:
+	CAScoreRenderer( const CAScoreRenderer& );            // not copyable, owns the layout
+	CAScoreRenderer& operator=( const CAScoreRenderer& );
+
+	struct CASystem {
+		double x1;
+		double x2;
+	};
+
+	void createSystems();
+	void renderSystem( QPainter *p, const CASystem& system, double x, double y, double z );
+
+	CALayout *_layout;
+	double _systemWidth;        // Width of a system in world units
+	double _top;                // Smallest Y coordinate of any drawable element
+	double _bottom;             // Largest Y coordinate of any drawable element
+	QVector<double> _breaks;    // Right borders of the barlines where a system can end
+	QVector<CASystem> _systemList;
+	int _systemsPerPage;
+	int _pageCount;
+};
+
+#endif /* SCORERENDERER_H_ */
@@ -0,0 +1,307 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QTimer>
+
+#include "layout/sheetlayout.h"
+#include "layout/layoutengine.h"
+#include "layout/drawablemuselement.h"
+
+#include "score/document.h"
+#include "score/sheet.h"
+
+/*!
+	\class CASheetLayout
+	\brief Drawable elements of a sheet shared by all its score views
+
+	Split views and multiple main windows may show the same sheet at once. Instead of each view
+	owning and laying out its own drawable elements, the views of a sheet share a single layout.
+	The layout is created by CALayoutEngine and is never changed by the views. Per-view state like
+	zoom, world coordinates, selection, current context and colors is kept in CAScoreView.
+
+	Use acquire() to get the layout of the sheet and release() when the view doesn't need it
+	anymore. The layout is destroyed when the last view releases it.
+
+	update() lays out the sheet again only when the document version, the sheet content or the
+	note checker errors changed since the last layout. The first view rebuilt after an edit
+	repositions the elements, other views reuse the result. aboutToChange() is emitted before the
+	drawable elements are removed and changed() when the new ones are ready, so the views can
+	store and restore their state.
+
+	The drawable elements of the music elements which weren't changed by the edit are kept and
+	only moved to their new positions, see CALayout::recycle(). Only the drawables of the
+	changed elements are destroyed and created again.
+
+	Long sheets are laid out lazily. update() only places the music elements up to the given X
+	coordinate (usually the right border of the view) and the rest is placed in chunks of
+	chunkBars() bars while the GUI is idle. grown() is emitted each time new elements were added.
+	Use layoutTo() when the view needs elements further right and finish() when the complete
+	layout is needed (eg. for zooming to the whole sheet or selecting all the elements). Looking
+	up the drawable instances of music elements lays out the sheet up to the element on demand.
+	The whole sheet is laid out at once, if chunkBars() is 0.
+
+	\sa CAScoreView, CALayoutEngine
+*/
+
+QHash<CASheet*, CASheetLayout*> CASheetLayout::_layouts;
+int CASheetLayout::_chunkBars = 16;
+
+CASheetLayout::CASheetLayout( CASheet *sheet )
+ : QObject(), CALayout( sheet ) {
+	_refCount = 0;
+	_valid = false;
+	_key = 0;
+	_version = 0;
+	_engine = 0;
+	_repositing = false;
+	setRecycling( true );
+
+	_chunkTimer = new QTimer( this );
+	_chunkTimer->setSingleShot( true );
+	_chunkTimer->setInterval( 0 );
+	connect( _chunkTimer, SIGNAL(timeout()), this, SLOT(on_chunkTimer_timeout()) );
+}
+
+CASheetLayout::~CASheetLayout() {
+	clear();
+}
+
+/*!
+	Returns the shared layout of the given \a sheet and increases its reference count.
+	The layout is created, if the sheet doesn't have one yet.
+
+	Each call must be paired with release().
+*/
+CASheetLayout *CASheetLayout::acquire( CASheet *sheet ) {
+	CASheetLayout *layout = _layouts.value( sheet );
+	if ( !layout ) {
+		layout = new CASheetLayout( sheet );
+		_layouts[ sheet ] = layout;
+	}
+
+	layout->_refCount++;
+	return layout;
+}
+
+/*!
+	Decreases the reference count of the given \a layout and destroys it, if it is not used anymore.
+*/
+void CASheetLayout::release( CASheetLayout *layout ) {
+	if ( !layout ) {
+		return;
+	}
+
+	if ( !(--layout->_refCount) ) {
+		_layouts.remove( layout->sheet() );
+		delete layout;
+	}
+}
+
+/*!
+	Lays out the sheet, if it was changed since the last time or the layout was invalidated.
+	At least the music elements up to the X coordinate \a x are placed, the rest is placed
+	later in chunks. Returns True, if the drawable elements were recreated.
+
+	\sa invalidate(), layoutTo()
+*/
+bool CASheetLayout::update( double x ) {
+	if ( !_sheet ) {
+		return false;
+	}
+
+	unsigned int key = layoutKey();
+	if ( _valid && key==_key ) {
+		layoutTo( x );
+		return false;
+	}
+
+	emit aboutToChange();
+
+	stop();
+	recycle();
+	_key = key;
+	_version = documentVersion();
+	_valid = true;
+
+	_engine = new CALayoutEngine( this );
+	_repositing = true;
+	if ( _chunkBars>0 ) {
+		do {
+			_engine->repositBars( _chunkBars );
+		} while ( !_engine->isFinished() && _engine->xEnd() <= x );
+	} else {
+		_engine->repositUntil( -1 );
+	}
+	_repositing = false;
+
+	if ( _engine->isFinished() ) {
+		delete _engine;
+		_engine = 0;
+		clearRecycled();
+	} else {
+		_chunkTimer->start();
+	}
+
+	emit changed();
+
+	return true;
+}
+
+/*!
+	Places the music elements until the layout reaches the X coordinate \a x.
+
+	\sa layoutToTime(), finish()
+*/
+void CASheetLayout::layoutTo( double x ) {
+	if ( !isExtendable() || _engine->xEnd() > x ) {
+		return;
+	}
+
+	_repositing = true;
+	do {
+		_engine->repositBars( _chunkBars );
+	} while ( !_engine->isFinished() && _engine->xEnd() <= x );
+	_repositing = false;
+
+	chunkPlaced();
+}
+
+/*!
+	Places the music elements starting before or at the given \a time.
+
+	\sa layoutTo(), finish()
+*/
+void CASheetLayout::layoutToTime( int time ) {
+	if ( !isExtendable() || _engine->time() > time ) {
+		return;
+	}
+
+	repositChunk( time+1 );
+}
+
+/*!
+	Places all the remaining music elements.
+
+	\sa isComplete()
+*/
+void CASheetLayout::finish() {
+	if ( !isExtendable() ) {
+		return;
+	}
+
+	repositChunk( -1 );
+}
+
+/*!
+	Places the music elements starting before the given \a time or all the remaining ones, if
+	\a time is -1.
+*/
+void CASheetLayout::repositChunk( int time ) {
+	_repositing = true;
+	_engine->repositUntil( time );
+	_repositing = false;
+
+	chunkPlaced();
+}
+
+/*!
+	Destroys the engine when the sheet is completely laid out or schedules the next chunk
+	otherwise. Emits grown().
+*/
+void CASheetLayout::chunkPlaced() {
+	if ( _engine->isFinished() ) {
+		delete _engine;
+		_engine = 0;
+		_chunkTimer->stop();
+		clearRecycled(); // the rest of the previous layout wasn't reused
+	} else {
+		_chunkTimer->start();
+	}
+
+	emit grown();
+}
+
+/*!
+	Lays out the next chunk of bars while the GUI is idle.
+*/
+void CASheetLayout::on_chunkTimer_timeout() {
+	if ( !isExtendable() ) {
+		return; // the sheet was changed meanwhile, wait for update()
+	}
+
+	_repositing = true;
+	_engine->repositBars( _chunkBars );
+	_repositing = false;
+
+	chunkPlaced();
+}
+
+/*!
+	Returns the value identifying the state of the sheet the layout depends on.
+*/
+unsigned int CASheetLayout::layoutKey() {
+	unsigned int key = ( _sheet->document() ? _sheet->document()->version() : 0 );
+	key = CAMusElement::combineHash( key, _sheet->contentHash() );
+
+	QList<CANoteCheckerError*>& nceList = _sheet->noteCheckerErrorList();
+	key = CAMusElement::combineHash( key, nceList.size() );
+	for (int i=0; i<nceList.size(); i++) {
+		key = CAMusElement::combineHash( key, qHash(nceList[i]) );
+	}
+
+	return key;
+}
+
+/*!
+	Returns the modification counter of the document. The engine reads the music elements
+	directly, so the layout is not extended once the document was modified until update() is
+	called again.
+*/
+unsigned int CASheetLayout::documentVersion() {
+	return ( _sheet->document() ? _sheet->document()->version() : 0 );
+}
+
+/*!
+	Stops laying out the rest of the sheet.
+*/
+void CASheetLayout::stop() {
+	_chunkTimer->stop();
+	delete _engine; // also destroys the pending scalable elements
+	_engine = 0;
+}
+
+/*!
+	Stops laying out the rest of the sheet and destroys all the drawable elements.
+*/
+void CASheetLayout::clear() {
+	stop();
+	CALayout::clear();
+}
+
+/*!
+	Returns the drawable instances of the given music element \a elt.
+	The sheet is laid out up to the element, if it wasn't placed yet.
+*/
+QList<CADrawable*> CASheetLayout::drawables( CAMusElement *elt ) {
+	if ( elt && !_mapDrawable.contains(elt) ) {
+		layoutToTime( elt->timeStart() );
+	}
+	return _mapDrawable.values(elt);
+}
+
+/*!
+	Finds the first drawable instance of the given abstract music element.
+	The sheet is laid out up to the element, if it wasn't placed yet.
+
+	\sa CALayout::findMElement()
+*/
+CADrawableMusElement *CASheetLayout::findMElement( CAMusElement *elt ) {
+	if ( elt && !_mapDrawable.contains(elt) ) {
+		layoutToTime( elt->timeStart() );
+	}
+	return CALayout::findMElement( elt );
+}
@@ -0,0 +1,75 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef SHEETLAYOUT_H_
+#define SHEETLAYOUT_H_
+
+#include <QObject>
+#include <QHash>
+
+#include "layout/layout.h"
+
+class QTimer;
+class CALayoutEngine;
+
+class CASheetLayout : public QObject, public CALayout {
+Q_OBJECT
+
+public:
+	static CASheetLayout *acquire( CASheet *sheet );
+	static void release( CASheetLayout *layout );
+
+	bool update( double x=0 );
+	inline void invalidate() { _valid = false; }
+	inline bool isValid() { return _valid; }
+
+	void layoutTo( double x );
+	void layoutToTime( int time );
+	void finish();
+	bool isComplete() { return !_engine; }
+
+	static inline int chunkBars() { return _chunkBars; }
+	static inline void setChunkBars( int bars ) { _chunkBars = bars; }
+
+	using CALayout::drawables;
+	QList<CADrawable*> drawables( CAMusElement *elt );
+	CADrawableMusElement *findMElement( CAMusElement *elt );
+
+signals:
+	void aboutToChange();
+	void changed();
+	void grown();
+
+private slots:
+	void on_chunkTimer_timeout();
+
+private:
+	CASheetLayout( CASheet *sheet );
+	~CASheetLayout();
+
+	void stop();
+	void clear();
+	unsigned int layoutKey();
+	unsigned int documentVersion();
+	inline bool isExtendable() { return _engine && !_repositing && documentVersion()==_version; }
+	void repositChunk( int time );
+	void chunkPlaced();
+
+	int _refCount;          // Number of views sharing this layout
+	bool _valid;            // Was the layout computed and not invalidated since
+	unsigned int _key;      // Document version, content hash and note checker errors the layout was computed for
+	unsigned int _version;  // Document version the layout was computed for
+
+	CALayoutEngine *_engine; // Engine placing the rest of the sheet or 0, if the sheet is completely laid out
+	QTimer *_chunkTimer;     // Lays out the next chunk when the GUI is idle
+	bool _repositing;        // Is the engine currently placing elements
+
+	static QHash<CASheet*, CASheetLayout*> _layouts;
+	static int _chunkBars;  // Number of bars laid out at once, 0 for the whole sheet
+};
+
+#endif /* SHEETLAYOUT_H_ */
@@ -34,6 +34,13 @@ int CAArticulation::compare(CAMusElement *elt) {
 	return 0;
 }
 
+unsigned int CAArticulation::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, articulationType() );
+
+	return h;
+}
+
 const QString CAArticulation::articulationTypeToString( CAArticulationType t ) {
 	switch (t) {
 	case Accent:
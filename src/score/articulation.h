@@ -48,12 +48,13 @@ public:
 
 	CAArticulation *clone(CAMusElement* elt);
 	int compare(CAMusElement *elt);
+	unsigned int contentHash();
 
 	inline CANote *associatedNote() { return static_cast<CANote*>(associatedElement()); }
 	inline void *setAssociatedNote( CANote* n ) { setAssociatedElement(n); return n; }
 
 	inline CAArticulationType articulationType() { return _articulationType; }
-	inline void setArticulationType( CAArticulationType t ) { _articulationType = t; }
+	inline void setArticulationType( CAArticulationType t ) { _articulationType = t; contentChanged(); }
 
 	static const QString articulationTypeToString( CAArticulationType t );
 	static CAArticulationType articulationTypeFromString( const QString s );
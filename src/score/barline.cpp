@@ -57,6 +57,13 @@ int CABarline::compare( CAMusElement *elt ) {
 	return diffs;
 }
 
+unsigned int CABarline::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, barlineType() );
+
+	return h;
+}
+
 /*!
 	Converts the given barline's \a type to QString.
 
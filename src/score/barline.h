@@ -32,9 +32,10 @@ public:
 
 	CABarline *clone(CAContext* context=0);
 	int compare(CAMusElement* elt);
+	unsigned int contentHash();
 
 	CABarlineType barlineType() { return _barlineType; }
-	void setBarlineType( CABarlineType t ) { _barlineType = t; }
+	void setBarlineType( CABarlineType t ) { _barlineType = t; contentChanged(); }
 
 	static const QString barlineTypeToString( CABarlineType );
 	static CABarlineType barlineTypeFromString( const QString );
@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <QHash>
+
 #include "score/bookmark.h"
 
 /*!
@@ -38,3 +40,10 @@ int CABookMark::compare(CAMusElement *elt) {
 
 	return 0;
 }
+
+unsigned int CABookMark::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, qHash(text()) );
+
+	return h;
+}
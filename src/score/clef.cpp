@@ -26,7 +26,7 @@
 	\sa CAPredefinedClefType, CAMusElement
 */
 CAClef::CAClef( CAPredefinedClefType type, CAStaff *staff, int time, int offsetInterval ) : CAMusElement( staff, time ) {
-	_musElementType = CAMusElement::Clef;
+	setMusElementType( CAMusElement::Clef );
 
 	_offset = CAClef::offsetFromReadable( offsetInterval );
 	setPredefinedType(type);
@@ -39,7 +39,7 @@ CAClef::CAClef( CAPredefinedClefType type, CAStaff *staff, int time, int offsetI
 	\sa CAPredefinedClefType, CAMusElement
 */
 CAClef::CAClef( CAClefType type, int c1, CAStaff *staff, int time, int offset ) : CAMusElement( staff, time ) {
-	_musElementType = CAMusElement::Clef;
+	setMusElementType( CAMusElement::Clef );
 
 	_c1 = c1;
 	_offset = offset;
@@ -93,6 +93,8 @@ void CAClef::setPredefinedType( CAPredefinedClefType type ) {
 		case Tablature:
 			break;
 	}
+
+	contentChanged();
 }
 
 /*!
@@ -114,6 +116,7 @@ void CAClef::setClefType(CAClefType type) {
 	}
 
 	_centerPitch += offset();
+	contentChanged();
 }
 
 CAClef* CAClef::clone(CAContext* context) {
@@ -139,6 +142,15 @@ int CAClef::compare(CAMusElement *elt) {
 	return diffs;
 }
 
+unsigned int CAClef::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, clefType() );
+	h = combineHash( h, offset() );
+	h = combineHash( h, c1() );
+
+	return h;
+}
+
 /*!
 	Converts clef \a type to QString.
 
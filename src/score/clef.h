@@ -52,10 +52,11 @@ public:
 	const int c1() { return _c1; }
 	const int centerPitch() { return _centerPitch; }
 	int compare(CAMusElement *elt);
+	unsigned int contentHash();
 
 	void setClefType(CAClefType type);
 
-	inline void setOffset( int offset ) { _c1+=_offset; _c1-=(_offset=offset); }
+	inline void setOffset( int offset ) { _c1+=_offset; _c1-=(_offset=offset); contentChanged(); }
 	inline int offset() { return _offset; }
 
 	static const QString clefTypeToString(CAClefType);
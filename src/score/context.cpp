@@ -6,6 +6,7 @@
 */
 
 #include "score/context.h"
+#include "score/sheet.h"
 
 /*!
 	\class CAContext
@@ -32,6 +33,27 @@ CAContext::CAContext( const QString name, CASheet *s ) {
 CAContext::~CAContext() {
 }
 
+/*!
+	\fn unsigned int CAContext::contentHash()
+	Returns the hash of the context content. Contexts with the same content have the same hash,
+	so caches (layout, export, note checker) can skip the unchanged contexts.
+
+	\sa invalidateHash(), CASheet::contentHash()
+*/
+
+/*!
+	Called when the music element \a elt or the context itself (\a elt is 0) was changed.
+	Contexts caching their hash invalidate the affected parts of the cache and call this
+	function, which invalidates the cached hash of the sheet.
+
+	\sa contentHash(), CAMusElement::contentChanged(), CASheet::invalidateHash()
+*/
+void CAContext::invalidateHash( CAMusElement* ) {
+	if ( _sheet ) {
+		_sheet->invalidateHash();
+	}
+}
+
 /*!
 	\enum CAContext::CAContextType
 	This enum holds different CAContext types:
@@ -27,7 +27,7 @@ public:
 	};
 
 	const QString name() { return _name; }
-	void setName(const QString name) { _name = name; }
+	void setName(const QString name) { _name = name; invalidateHash(); }
 
 	CAContextType contextType() { return _contextType; }
 
@@ -39,6 +39,9 @@ public:
 	virtual CAMusElement *previous(CAMusElement *elt) = 0;
 	virtual bool remove( CAMusElement *elt ) = 0;
 
+	virtual unsigned int contentHash() = 0;
+	virtual void invalidateHash( CAMusElement *elt=0 );
+
 protected:
 	void setContextType( CAContextType t ) { _contextType = t; }
 
@@ -47,6 +47,14 @@ int CACrescendo::compare( CAMusElement *elt ) {
 	return 0;
 }
 
+unsigned int CACrescendo::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, finalVolume() );
+	h = combineHash( h, crescendoType() );
+
+	return h;
+}
+
 const QString CACrescendo::crescendoTypeToString( CACrescendoType t ) {
 	switch (t) {
 	case Crescendo:
@@ -24,11 +24,12 @@ public:
 
 	CACrescendo *clone(CAMusElement* elt=0);
 	int compare( CAMusElement* );
+	unsigned int contentHash();
 
 	inline const int finalVolume() { return _finalVolume; }
-	inline void setFinalVolume( const int v ) { _finalVolume = v; }
+	inline void setFinalVolume( const int v ) { _finalVolume = v; contentChanged(); }
 	inline const CACrescendoType crescendoType() { return _crescendoType; }
-	inline void setCrescendoType( CACrescendoType t ) { _crescendoType = t; }
+	inline void setCrescendoType( CACrescendoType t ) { _crescendoType = t; contentChanged(); }
 
 	static const QString crescendoTypeToString( CACrescendoType t );
 	static CACrescendoType crescendoTypeFromString( const QString r );
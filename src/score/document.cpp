@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <QStringList>
+
 #include "control/resourcectl.h"
 #include "score/context.h"
 #include "score/staff.h"
@@ -34,11 +36,17 @@ CADocument::CADocument() {
 	setDateLastModified( QDateTime::currentDateTime() );
 	setTimeEdited(0);
 	setArchive( new CAArchive() );
+	_version = 0;
+	_propertiesHash = 0;
+	_propertiesHashValid = false;
 	setModified( false );
 }
 
 /*!
 	Clones this document and all its sheets and returns a pointer to its clone.
+
+	This is done for every undo command and takes linear time in the number of elements.
+	\todo Share unchanged time blocks with the clone instead, see TODO.
 */
 CADocument *CADocument::clone() {
 	CADocument *newDocument = new CADocument();
@@ -93,6 +101,7 @@ void CADocument::clear() {
 	_dateLastModified = QDateTime::currentDateTime();
 	_timeEdited = 0;
 	_comments.clear();
+	_propertiesHashValid = false;
 
 	for (int i=0; i<_sheetList.size(); i++) {
 		_sheetList[i]->clear();
@@ -140,3 +149,29 @@ CASheet *CADocument::findSheet(const QString name) {
 	return 0;
 }
 
+/*!
+	Returns the hash of the document properties and all its sheets.
+	Documents with the same content have the same hash, eg. the document and its clone.
+
+	The hash of the properties is cached. Sheets cache their own hashes, so combining them is cheap.
+
+	\sa CASheet::contentHash()
+*/
+unsigned int CADocument::contentHash() {
+	if ( !_propertiesHashValid ) {
+		QStringList properties;
+		properties << title() << subtitle() << composer() << arranger() << poet()
+		           << textTranslator() << dedication() << copyright() << comments();
+
+		_propertiesHash = qHash( properties.join( QString(QChar(0)) ) );
+		_propertiesHashValid = true;
+	}
+
+	unsigned int h = _propertiesHash;
+	for (int i=0; i<_sheetList.size(); i++) {
+		h = CAMusElement::combineHash( h, _sheetList[i]->contentHash() );
+	}
+
+	return h;
+}
+
@@ -30,6 +30,8 @@ public:
 	inline void removeSheet(CASheet *sheet) { _sheetList.removeAll(sheet); }
 	CASheet *findSheet(const QString name);
 
+	unsigned int contentHash();
+
 	const QList<CAResource*>& resourceList() { return _resourceList; }
 	inline void addResource(CAResource *r) { _resourceList << r; }
 	inline void removeResource(CAResource *r) { _resourceList.removeAll(r); }
@@ -47,28 +49,29 @@ public:
 	const unsigned int timeEdited() { return _timeEdited; }
 	const QString comments() { return _comments; }
 
-	void setTitle(const QString title) { _title = title; }
-	void setSubtitle(const QString subtitle) { _subtitle = subtitle; }
-	void setComposer(const QString composer) { _composer = composer; }
-	void setArranger(const QString arranger) { _arranger = arranger; }
-	void setPoet(const QString poet) { _poet = poet; }
-	void setTextTranslator(const QString textTranslator) { _textTranslator = textTranslator; }
-	void setDedication(const QString dedication) { _dedication = dedication; }
-	void setCopyright(const QString copyright) { _copyright = copyright; }
+	void setTitle(const QString title) { _title = title; _propertiesHashValid = false; }
+	void setSubtitle(const QString subtitle) { _subtitle = subtitle; _propertiesHashValid = false; }
+	void setComposer(const QString composer) { _composer = composer; _propertiesHashValid = false; }
+	void setArranger(const QString arranger) { _arranger = arranger; _propertiesHashValid = false; }
+	void setPoet(const QString poet) { _poet = poet; _propertiesHashValid = false; }
+	void setTextTranslator(const QString textTranslator) { _textTranslator = textTranslator; _propertiesHashValid = false; }
+	void setDedication(const QString dedication) { _dedication = dedication; _propertiesHashValid = false; }
+	void setCopyright(const QString copyright) { _copyright = copyright; _propertiesHashValid = false; }
 	void setDateCreated(const QDateTime dateCreated) { _dateCreated = dateCreated; }
 	void setDateLastModified(const QDateTime dateLastModified) { _dateLastModified = dateLastModified; }
 	void setTimeEdited(const unsigned int timeEdited) { _timeEdited = timeEdited; }
-	void setComments(const QString comments) { _comments = comments; }
+	void setComments(const QString comments) { _comments = comments; _propertiesHashValid = false; }
 
 	///////////////////////////////////////////////////////
 	// Temporary properties (not stored inside the file) //
 	///////////////////////////////////////////////////////
 	const QString fileName() { return _fileName; }
 	bool isModified() { return _modified; }
+	unsigned int version() { return _version; }
 	CAArchive *archive() { return _archive; }
 
 	void setFileName(const QString fileName) { _fileName = fileName; } // not saved!
-	void setModified( bool m ) { _modified = m; }
+	void setModified( bool m ) { _modified = m; if (m) _version++; }
 	void setArchive( CAArchive *a ) { _archive = a; }
 
 private:
@@ -93,6 +96,9 @@ private:
 	////////////////////////////////////////////////////
 	QString _fileName;   // absolute filename of the document
 	bool    _modified;   // unsaved changes
+	unsigned int _version; // modification counter, see CASheetSnapshot
+	unsigned int _propertiesHash; // cached hash of the text properties
+	bool    _propertiesHashValid;
 	CAArchive *_archive; // pointer to existing archive, if it exists
 };
 #endif /* DOCUMENT_H_ */
@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <QHash>
+
 #include "score/dynamic.h"
 #include "score/note.h"
 
@@ -41,6 +43,14 @@ int CADynamic::compare( CAMusElement *elt ) {
 	return 0;
 }
 
+unsigned int CADynamic::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, qHash(text()) );
+	h = combineHash( h, volume() );
+
+	return h;
+}
+
 const QString CADynamic::dynamicTextToString( CADynamicText t ) {
 	switch (t) {
 		case ppppp: return "ppppp";
@@ -27,11 +27,12 @@ public:
 
 	CADynamic *clone(CAMusElement* elt=0);
 	int compare( CAMusElement* );
+	unsigned int contentHash();
 
 	inline const QString text() { return _text; }
-	inline void setText( const QString t ) { _text = t; }
+	inline void setText( const QString t ) { _text = t; contentChanged(); }
 	inline const int volume() { return _volume; }
-	inline void setVolume( const int v ) { _volume = v; }
+	inline void setVolume( const int v ) { _volume = v; contentChanged(); }
 
 	static const QString dynamicTextToString( CADynamicText t );
 	static CADynamicText dynamicTextFromString( const QString t );
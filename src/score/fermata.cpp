@@ -49,6 +49,13 @@ int CAFermata::compare( CAMusElement *elt ) {
 	return 0;
 }
 
+unsigned int CAFermata::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, fermataType() );
+
+	return h;
+}
+
 const QString CAFermata::fermataTypeToString( CAFermataType t ) {
 	switch (t) {
 	case NormalFermata:
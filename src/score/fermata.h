@@ -28,9 +28,10 @@ public:
 
 	CAFermata *clone(CAMusElement* elt=0);
 	int compare( CAMusElement* );
+	unsigned int contentHash();
 
 	inline CAFermataType fermataType() { return _fermataType; }
-	inline void setFermataType( CAFermataType t ) { _fermataType = t; }
+	inline void setFermataType( CAFermataType t ) { _fermataType = t; contentChanged(); }
 
 	static const QString fermataTypeToString( CAFermataType t );
 	static CAFermataType fermataTypeFromString( const QString r );
@@ -24,6 +24,8 @@
 CAFiguredBassContext::CAFiguredBassContext( QString name, CASheet *sheet )
  : CAContext(name, sheet) {
 	setContextType( FiguredBassContext );
+	_dirtyTime = 0;
+	_chordsRevision = ( sheet ? sheet->chordsRevision() : 0 );
 	repositFiguredBassMarks();
 }
 
@@ -43,6 +45,7 @@ void CAFiguredBassContext::addFiguredBassMark( CAFiguredBassMark *m, bool replac
 		delete _figuredBassMarkList.takeAt(i);
 	}
 	_figuredBassMarkList.insert(i, m);
+	invalidateFiguredBassMarks( m->timeStart() );
 	for (i++; i<_figuredBassMarkList.size(); i++)
 		_figuredBassMarkList[i]->setTimeStart( _figuredBassMarkList[i]->timeStart() + m->timeLength() );
 }
@@ -55,6 +58,7 @@ void CAFiguredBassContext::addEmptyFiguredBassMark( int timeStart, int timeLengt
 	int i;
 	for (i=0; i<_figuredBassMarkList.size() && _figuredBassMarkList[i]->timeStart()<timeStart; i++);
 	_figuredBassMarkList.insert(i, (new CAFiguredBassMark( this, timeStart, timeLength )));
+	invalidateFiguredBassMarks( timeStart );
 	for (i++; i<_figuredBassMarkList.size(); i++)
 		_figuredBassMarkList[i]->setTimeStart( _figuredBassMarkList[i]->timeStart() + timeLength );
 }
@@ -62,14 +66,34 @@ void CAFiguredBassContext::addEmptyFiguredBassMark( int timeStart, int timeLengt
 /*!
 	Updates timeStarts and timeLength of all figured bass marks according to the chords they belong.
 	Adds new empty figured bass marks at the end, if needed.
+
+	The earliest changed time is read from CASheet::chordsDirtyTime() and by
+	invalidateFiguredBassMarks(). Marks before the chord preceding that time are still aligned, so
+	the reposition starts there. Nothing is done, if the chords weren't changed since the last call.
+
+	\sa invalidateFiguredBassMarks(), CASheet::invalidateChords()
  */
 void CAFiguredBassContext::repositFiguredBassMarks() {
-	if ( !sheet() ) {
+	if ( sheet() && _chordsRevision!=sheet()->chordsRevision() ) {
+		if ( sheet()->chordsDirtyTime()!=-1 )
+			invalidateFiguredBassMarks( sheet()->chordsDirtyTime() );
+		_chordsRevision = sheet()->chordsRevision();
+		sheet()->updateChordsDirtyTime();
+	}
+
+	if ( !sheet() || _dirtyTime==-1 ) {
 		return;
 	}
 
-	QList<CAPlayable*> chord = sheet()->getChord(0);
-	int fbmIdx = 0;
+	// resume at the first mark of the last chord before the changed time
+	int fbmIdx;
+	for (fbmIdx=0; fbmIdx<_figuredBassMarkList.size() && _figuredBassMarkList[fbmIdx]->timeStart()<_dirtyTime; fbmIdx++);
+	if ( fbmIdx>0 ) {
+		int prevTimeStart = _figuredBassMarkList[fbmIdx-1]->timeStart();
+		for (fbmIdx--; fbmIdx>0 && _figuredBassMarkList[fbmIdx-1]->timeStart()==prevTimeStart; fbmIdx--);
+	}
+
+	QList<CAPlayable*> chord = sheet()->getChord( fbmIdx<_figuredBassMarkList.size() ? _figuredBassMarkList[fbmIdx]->timeStart() : 0 );
 	while (chord.size()) {
 		int maxTimeStart = chord[0]->timeStart();
 		int minTimeEnd = chord[0]->timeEnd();
@@ -108,6 +132,8 @@ void CAFiguredBassContext::repositFiguredBassMarks() {
 		_figuredBassMarkList[fbmIdx]->setTimeStart(((fbmIdx>0)?_figuredBassMarkList[fbmIdx-1]:_figuredBassMarkList[0])->timeEnd());
 		_figuredBassMarkList[fbmIdx]->setTimeLength(CAPlayableLength::Quarter);
 	}
+
+	_dirtyTime = -1;
 }
 
 /*!
@@ -138,6 +164,20 @@ void CAFiguredBassContext::clear() {
 		delete _figuredBassMarkList.takeFirst();
 }
 
+/*!
+	Returns the hash of the figured bass marks in the context.
+	The hash is not cached.
+*/
+unsigned int CAFiguredBassContext::contentHash() {
+	unsigned int h = CAMusElement::combineHash( qHash(name()), contextType() );
+	for (int i=0; i<_figuredBassMarkList.size(); i++) {
+		h = CAMusElement::combineHash( h, _figuredBassMarkList[i]->contentHash() );
+		h = CAMusElement::combineHash( h, _figuredBassMarkList[i]->timeStart() );
+	}
+
+	return h;
+}
+
 CAMusElement* CAFiguredBassContext::next( CAMusElement* elt ) {
 	if (elt->musElementType()!=CAMusElement::FiguredBassMark)
 		return 0;
@@ -165,6 +205,7 @@ bool CAFiguredBassContext::remove( CAMusElement *elt ) {
 		return false;
 
 	bool success=false;
+	invalidateFiguredBassMarks( elt->timeStart() );
 	success = _figuredBassMarkList.removeAll(static_cast<CAFiguredBassMark*>(elt));
 
 	if(success)
@@ -20,6 +20,7 @@ public:
 
 	CAContext* clone( CASheet* );
 	void clear();
+	unsigned int contentHash();
 	CAMusElement *next(CAMusElement *elt);
 	CAMusElement *previous(CAMusElement *elt);
 	bool remove( CAMusElement *elt );
@@ -28,11 +29,15 @@ public:
 	CAFiguredBassMark *figuredBassMarkAtTimeStart( int timeStart );
 
 	void repositFiguredBassMarks();
+	inline void invalidateFiguredBassMarks( int timeStart ) { if ( _dirtyTime==-1 || timeStart<_dirtyTime ) _dirtyTime = timeStart; }
+	inline int chordsRevision() { return _chordsRevision; }
 	void addFiguredBassMark( CAFiguredBassMark*, bool replace=true );
 	void addEmptyFiguredBassMark( int timeStart, int timeLength );
 
 private:
 	QList<CAFiguredBassMark*> _figuredBassMarkList;
+	int _dirtyTime; // marks need to be repositioned from this time on, -1 if aligned
+	int _chordsRevision; // CASheet::chordsRevision() when the changed chords were last read
 };
 
 #endif /* FIGUREDBASSCONTEXT_H_ */
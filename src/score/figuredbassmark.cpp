@@ -111,3 +111,13 @@ int CAFiguredBassMark::compare(CAMusElement *elt) {
 
 	return diff;
 }
+
+unsigned int CAFiguredBassMark::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	for (int i=0; i<numbers().size(); i++) {
+		h = combineHash( h, numbers()[i] );
+		h = combineHash( h, accs().value( numbers()[i], 0 ) );
+	}
+
+	return h;
+}
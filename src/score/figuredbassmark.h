@@ -21,6 +21,7 @@ public:
 
 	CAMusElement* clone(CAContext* context=0);
 	int compare(CAMusElement *elt);
+	unsigned int contentHash();
 
 	void addNumber( int number );
 	void addNumber( int number, int accs );
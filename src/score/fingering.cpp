@@ -59,6 +59,16 @@ int CAFingering::compare( CAMusElement *elt ) {
 	return differ;
 }
 
+unsigned int CAFingering::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	for (int i=0; i<fingerList().size(); i++) {
+		h = combineHash( h, fingerList()[i] );
+	}
+	h = combineHash( h, isOriginal() );
+
+	return h;
+}
+
 const QString CAFingering::fingerNumberToString( CAFingerNumber n ) {
 	switch (n) {
 	case First:
@@ -35,15 +35,16 @@ public:
 
 	CAFingering *clone(CAMusElement* elt=0);
 	int compare(CAMusElement *elt);
+	unsigned int contentHash();
 
 	inline CAFingerNumber finger()                   { return (_fingerList.size()?_fingerList[0]:Undefined); }
-	inline void setFinger(CAFingerNumber f)          { _fingerList.clear(); _fingerList << f; }
+	inline void setFinger(CAFingerNumber f)          { _fingerList.clear(); _fingerList << f; contentChanged(); }
 	inline const QList<CAFingerNumber>& fingerList() { return _fingerList; }
-	inline void addFinger( CAFingerNumber f )        { _fingerList << f; }
-	inline void removeFinger( CAFingerNumber n )     { _fingerList.removeAll(n); }
+	inline void addFinger( CAFingerNumber f )        { _fingerList << f; contentChanged(); }
+	inline void removeFinger( CAFingerNumber n )     { _fingerList.removeAll(n); contentChanged(); }
 
 	inline bool isOriginal() { return _original; }
-	inline void setOriginal( bool original ) { _original = original; }
+	inline void setOriginal( bool original ) { _original = original; contentChanged(); }
 
 	static const QString fingerNumberToString( CAFingerNumber n );
 	static CAFingerNumber fingerNumberFromString( const QString s );
@@ -24,7 +24,7 @@
 
 CAFunctionMark::CAFunctionMark(CAFunctionType function, bool minor, const CADiatonicKey key, CAFunctionMarkContext* context, int timeStart, int timeLength, CAFunctionType chordArea, bool chordAreaMinor, CAFunctionType tonicDegree, bool tonicDegreeMinor, const QString alterations, bool ellipseSequence)
  : CAMusElement(context, timeStart, timeLength) {
- 	_musElementType = CAMusElement::FunctionMark;
+ 	setMusElementType( CAMusElement::FunctionMark );
  	_function = function;
  	_tonicDegree = tonicDegree;
  	_tonicDegreeMinor = tonicDegreeMinor;
@@ -91,6 +91,28 @@ int CAFunctionMark::compare( CAMusElement *func ) {
 	return diffs;
 }
 
+unsigned int CAFunctionMark::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, function() );
+	h = combineHash( h, isMinor() );
+	h = combineHash( h, key().diatonicPitch().noteName() );
+	h = combineHash( h, key().diatonicPitch().accs() );
+	h = combineHash( h, key().gender() );
+	h = combineHash( h, chordArea() );
+	h = combineHash( h, isChordAreaMinor() );
+	h = combineHash( h, tonicDegree() );
+	h = combineHash( h, isTonicDegreeMinor() );
+	h = combineHash( h, isPartOfEllipse() );
+	for (int i=0; i<alteredDegrees().size(); i++) {
+		h = combineHash( h, alteredDegrees()[i] );
+	}
+	for (int i=0; i<addedDegrees().size(); i++) {
+		h = combineHash( h, addedDegrees()[i] + 100 );
+	}
+
+	return h;
+}
+
 /*!
 	Reads \a alterations and sets alteredDegrees and addedDegrees.
 	Sixte ajoutee and other added degrees have +/- sign after the number.
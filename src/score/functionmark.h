@@ -69,6 +69,7 @@ public:
 	bool isPartOfEllipse() { return _ellipseSequence; }
 
 	int compare(CAMusElement *function);
+	unsigned int contentHash();
 
 	static const QString functionTypeToString(CAFunctionType);
 	static CAFunctionType functionTypeFromString(const QString);
@@ -24,6 +24,8 @@
 CAFunctionMarkContext::CAFunctionMarkContext( const QString name, CASheet *sheet )
  : CAContext( name, sheet ) {
  	_contextType = CAContext::FunctionMarkContext;
+ 	_dirtyTime = 0;
+ 	_chordsRevision = ( sheet ? sheet->chordsRevision() : 0 );
 
  	repositFunctions();
 }
@@ -50,6 +52,20 @@ void CAFunctionMarkContext::clear() {
 	_functionMarkList.clear();
 }
 
+/*!
+	Returns the hash of the function marks in the context.
+	The hash is not cached.
+*/
+unsigned int CAFunctionMarkContext::contentHash() {
+	unsigned int h = CAMusElement::combineHash( qHash(name()), contextType() );
+	for (int i=0; i<_functionMarkList.size(); i++) {
+		h = CAMusElement::combineHash( h, _functionMarkList[i]->contentHash() );
+		h = CAMusElement::combineHash( h, _functionMarkList[i]->timeStart() );
+	}
+
+	return h;
+}
+
 /*!
 	Adds an already created function mark to this context.
 */
@@ -57,6 +73,7 @@ void CAFunctionMarkContext::addFunctionMark( CAFunctionMark *function, bool repl
 	int i;
 	for (i=_functionMarkList.size()-1; i>0 && _functionMarkList[i]->timeStart()>function->timeStart(); i--);
 	_functionMarkList.insert( i+1, function );
+	invalidateFunctions( function->timeStart() );
 	if ( replace && i<_functionMarkList.size() && i>=0 && _functionMarkList[i]->isEmpty() ) {
 		_functionMarkList.removeAt( i );
 	} else if (!replace) {
@@ -89,22 +106,47 @@ CAMusElement *CAFunctionMarkContext::previous(CAMusElement *elt) {
 }
 
 bool CAFunctionMarkContext::remove( CAMusElement *elt ) {
+	invalidateFunctions( elt->timeStart() );
 	return _functionMarkList.removeAll(static_cast<CAFunctionMark*>(elt));
 }
 
 /*!
-	This method is similar to CALyircsContext::repositFunctions().
+	This method is similar to CALyricsContext::repositSyllables().
 	It repositions the functions (sets timeStart and timeLength) one by one according to the chords
 	above the context.
 
 	If two functions contain the same timeStart, they are treated as modulation and will contain
 	the same timeStart after reposition is done as well!
+
+	The earliest changed time is read from CASheet::chordsDirtyTime() and by invalidateFunctions().
+	Functions before the chord preceding that time are still aligned, so the reposition starts
+	there. Nothing is done, if the chords weren't changed since the last call.
+
+	\sa invalidateFunctions(), CASheet::invalidateChords()
 */
 void CAFunctionMarkContext::repositFunctions() {
-	int TS, TL;
+	if ( sheet() && _chordsRevision!=sheet()->chordsRevision() ) {
+		if ( sheet()->chordsDirtyTime()!=-1 )
+			invalidateFunctions( sheet()->chordsDirtyTime() );
+		_chordsRevision = sheet()->chordsRevision();
+		sheet()->updateChordsDirtyTime();
+	}
+
+	if ( _dirtyTime==-1 ) {
+		return;
+	}
+
+	// resume at the first function of the last chord before the changed time
 	int curIdx;
+	for (curIdx=0; curIdx<_functionMarkList.size() && _functionMarkList[curIdx]->timeStart()<_dirtyTime; curIdx++);
+	if ( curIdx>0 ) {
+		int prevTimeStart = _functionMarkList[curIdx-1]->timeStart();
+		for (curIdx--; curIdx>0 && _functionMarkList[curIdx-1]->timeStart()==prevTimeStart; curIdx--);
+	}
+
+	int TS, TL;
 	QList<CAPlayable*> chord;
-	for ( TS=0, curIdx=0; ( sheet() && (chord=sheet()->getChord(TS)).size() ) || curIdx<_functionMarkList.size(); TS+=TL ) {
+	for ( TS=(curIdx<_functionMarkList.size()?_functionMarkList[curIdx]->timeStart():0); ( sheet() && (chord=sheet()->getChord(TS)).size() ) || curIdx<_functionMarkList.size(); TS+=TL ) {
 		TL = (chord.size()?chord[0]->timeLength():256);
 		for ( int i=0; i<chord.size(); i++ )
 			if (chord[i]->timeLength()<TL)
@@ -112,15 +154,17 @@ void CAFunctionMarkContext::repositFunctions() {
 
 		if ( curIdx == _functionMarkList.size() ) { // add new empty functions, if chords still exist
 			addEmptyFunction( TS, TL);
-			curIdx++;
 		}
 
-		// apply timestart and length to existing function marks
-		for ( int startIdx = curIdx; curIdx==0 || ( curIdx < _functionMarkList.size() && _functionMarkList[curIdx]->timeStart()==_functionMarkList[startIdx]->timeStart() ); curIdx++ ) {
+		// apply timestart and length to existing function marks, modulations share the same timestart
+		int oldTS = _functionMarkList[curIdx]->timeStart();
+		for ( ; curIdx < _functionMarkList.size() && _functionMarkList[curIdx]->timeStart()==oldTS; curIdx++ ) {
 			_functionMarkList[curIdx]->setTimeLength( TL );
 			_functionMarkList[curIdx]->setTimeStart( TS );
 		}
 	}
+
+	_dirtyTime = -1;
 }
 
 /*!
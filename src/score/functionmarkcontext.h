@@ -28,13 +28,18 @@ public:
 	void addEmptyFunction( int timeStart, int timeLength );
 
 	void repositFunctions();
+	inline void invalidateFunctions( int timeStart ) { if ( _dirtyTime==-1 || timeStart<_dirtyTime ) _dirtyTime = timeStart; }
+	inline int chordsRevision() { return _chordsRevision; }
 
 	void clear();
+	unsigned int contentHash();
 	CAMusElement *next(CAMusElement *elt);
 	CAMusElement *previous(CAMusElement *elt);
 	bool remove( CAMusElement *elt );
 
 private:
 	QList<CAFunctionMark*> _functionMarkList;
+	int _dirtyTime; // functions need to be repositioned from this time on, -1 if aligned
+	int _chordsRevision; // CASheet::chordsRevision() when the changed chords were last read
 };
 #endif /* FUNCTIONMARKCONTEXT_H_*/
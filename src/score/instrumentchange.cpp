@@ -42,3 +42,10 @@ int CAInstrumentChange::compare( CAMusElement *elt ) {
 
 	return 0;
 }
+
+unsigned int CAInstrumentChange::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, instrument() );
+
+	return h;
+}
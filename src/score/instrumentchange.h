@@ -20,9 +20,10 @@ public:
 
 	CAInstrumentChange *clone(CAMusElement *elt=0);
 	int compare( CAMusElement* );
+	unsigned int contentHash();
 
 	inline const int instrument() { return _instrument; }
-	inline void setInstrument( const int instrument ) { _instrument = instrument; }
+	inline void setInstrument( const int instrument ) { _instrument = instrument; contentChanged(); }
 
 private:
 	int _instrument;
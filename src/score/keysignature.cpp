@@ -141,6 +141,17 @@ int CAKeySignature::compare(CAMusElement *elt) {
 	return diffs;
 }
 
+unsigned int CAKeySignature::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, keySignatureType() );
+	h = combineHash( h, diatonicKey().diatonicPitch().noteName() );
+	h = combineHash( h, diatonicKey().diatonicPitch().accs() );
+	h = combineHash( h, diatonicKey().gender() );
+	h = combineHash( h, modus() );
+
+	return h;
+}
+
 CAKeySignature::CAKeySignatureType CAKeySignature::keySignatureTypeFromString(const QString type) {
 	if (type=="major-minor") {
 		return MajorMinor;
@@ -45,17 +45,18 @@ public:
 	CAStaff *staff() { return static_cast<CAStaff*>(context()); }
 
 	inline CAKeySignatureType keySignatureType() { return _keySignatureType; }
-	inline void setKeySignatureType(CAKeySignatureType type) { _keySignatureType = type; }
+	inline void setKeySignatureType(CAKeySignatureType type) { _keySignatureType = type; contentChanged(); }
 
 	CADiatonicKey diatonicKey() { return _diatonicKey; }
 	CAModus modus() { return _modus; }
 
-	void setDiatonicKey(CADiatonicKey k) { _diatonicKey = k; updateAccidentals(); }
-	void setModus(CAModus modus) { _modus = modus; }
+	void setDiatonicKey(CADiatonicKey k) { _diatonicKey = k; updateAccidentals(); contentChanged(); }
+	void setModus(CAModus modus) { _modus = modus; contentChanged(); }
 
 	QList<int>& accidentals() { return _accidentals; }
 
 	int compare(CAMusElement* elt);
+	unsigned int contentHash();
 
 	static const QString keySignatureTypeToString(CAKeySignatureType);
 	static CAKeySignatureType keySignatureTypeFromString(const QString);
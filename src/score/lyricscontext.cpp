@@ -9,6 +9,8 @@
 #include "score/syllable.h"
 #include "score/voice.h"
 
+#include <algorithm> // std::lower_bound
+
 /*!
 	\class CALyricsContext
 	\brief One stanza line of lyrics
@@ -29,6 +31,9 @@ CALyricsContext::CALyricsContext( const QString name, int stanzaNumber, CAVoice
 	setContextType( LyricsContext );
 
 	_associatedVoice = 0;
+	_dirtyTime = 0;
+	_hash = 0;
+	_hashValid = false;
 	setAssociatedVoice( v ); // also reposits syllables
 	setStanzaNumber(stanzaNumber);
 }
@@ -38,6 +43,9 @@ CALyricsContext::CALyricsContext( const QString name, int stanzaNumber, CASheet
 	setContextType( LyricsContext );
 
 	_associatedVoice = 0;
+	_dirtyTime = 0;
+	_hash = 0;
+	_hashValid = false;
 	setAssociatedVoice( 0 ); // also reposits syllables
 	setStanzaNumber(stanzaNumber);
 }
@@ -52,15 +60,52 @@ CALyricsContext::~CALyricsContext() {
 void CALyricsContext::clear() {
 	while(!_syllableList.isEmpty())
 		delete _syllableList.takeFirst();
+	invalidateHash();
+}
+
+/*!
+	Returns the hash of the stanza and its syllables.
+
+	The hash is cached until a syllable or a property of the stanza is changed. The name of the
+	associated voice is combined on each call, because renaming the voice doesn't notify the
+	lyrics.
+
+	\sa invalidateHash()
+*/
+unsigned int CALyricsContext::contentHash() {
+	if ( !_hashValid ) {
+		_hash = CAMusElement::combineHash( qHash(name()), contextType() );
+		_hash = CAMusElement::combineHash( _hash, stanzaNumber() );
+		_hash = CAMusElement::combineHash( _hash, qHash(customStanzaName()) );
+		for (int i=0; i<_syllableList.size(); i++) {
+			_hash = CAMusElement::combineHash( _hash, _syllableList[i]->contentHash() );
+			_hash = CAMusElement::combineHash( _hash, _syllableList[i]->timeStart() );
+		}
+		_hashValid = true;
+	}
+
+	return CAMusElement::combineHash( _hash, associatedVoice() ? qHash(associatedVoice()->name()) : 0 );
+}
+
+/*!
+	Marks the cached hash as changed. Called when the syllable \a elt, the list of syllables or
+	a property of the stanza was changed.
+
+	\sa contentHash()
+*/
+void CALyricsContext::invalidateHash( CAMusElement *elt ) {
+	_hashValid = false;
+	CAContext::invalidateHash( elt );
 }
 
 CALyricsContext *CALyricsContext::clone( CASheet *s ) {
 	CALyricsContext *newLc = new CALyricsContext( name(), stanzaNumber(), s );
 	newLc->cloneLyricsContextProperties( this );
 
+	// syllables are already sorted, append them directly
+	newLc->_syllableList.reserve( _syllableList.size() );
 	for (int i=0; i<_syllableList.size(); i++) {
-		CASyllable *newSyllable = static_cast<CASyllable*>(_syllableList[i]->clone(newLc));
-		newLc->addSyllable( newSyllable );
+		newLc->_syllableList << static_cast<CASyllable*>(_syllableList[i]->clone(newLc));
 	}
 	return newLc;
 }
@@ -75,42 +120,63 @@ void CALyricsContext::cloneLyricsContextProperties( CALyricsContext *lc ) {
 	setAssociatedVoice( lc->associatedVoice() );
 }
 
+static bool syllableTimeLessThan( CASyllable *s, int time ) {
+	return s->timeStart() < time;
+}
+
 /*!
 	Keeps the content and order of the syllables, but changes startTimes and lengths according to the notes in associatedVoice.
 	This function is usually called when associatedVoice is changed or the whole lyricsContext is initialized for the first time.
 	If the notes and syllables aren't synchronized (too little syllables for notes) it adds empty syllables.
+
+	The n-th syllable always belongs to the n-th chord of the voice. The voice reports the earliest
+	changed time by invalidateSyllables(), so the syllables before it are still aligned and only the
+	syllables from the first changed chord on are repositioned. Nothing is done, if the voice wasn't
+	changed since the last call.
+
+	\sa invalidateSyllables()
 */
 void CALyricsContext::repositSyllables() {
-	if (associatedVoice()) {
-		QList<CANote*> noteList = associatedVoice()->getNoteList();
-		int i,j;
-		for (i=0, j=0; i<noteList.size() && j<_syllableList.size(); i++, j++) {
-			if (i>0 && noteList[i-1]->timeStart()==noteList[i]->timeStart()) { // chord
-				i++;
-				continue;
-			}
-			_syllableList[j]->setTimeStart( noteList[i]->timeStart() );
-			_syllableList[j]->setTimeLength( noteList[i]->timeLength() );
-		}
-		int firstEmpty = j;
-		for (; j<_syllableList.size() && j>0; j++) { // add syllables at the end, if too much of them exist
-			if ( !_syllableList[j]->text().isEmpty() )
-				firstEmpty = j+1;
+	if ( !associatedVoice() || _dirtyTime==-1 ) {
+		return;
+	}
 
-			_syllableList[j]->setTimeStart(_syllableList[j-1]->timeStart()+_syllableList[j-1]->timeLength());
-			_syllableList[j]->setTimeLength( 256 );
-		}
-		// remove empty "leftover" syllables from the end
-		for (j=firstEmpty; j<_syllableList.size() && j>0; j++) {
-			delete _syllableList.takeAt(j);
+	// syllables before the changed time keep their notes
+	int j = std::lower_bound( _syllableList.begin(), _syllableList.end(), _dirtyTime, syllableTimeLessThan ) - _syllableList.begin();
+
+	const QList<CAMusElement*>& eltList = associatedVoice()->musElementList();
+	int lastTimeStart = -1;
+	for (int i=associatedVoice()->lowerBoundIndex( _dirtyTime ); i<eltList.size(); i++) {
+		if ( eltList[i]->musElementType()!=CAMusElement::Note || eltList[i]->timeStart()==lastTimeStart ) // only one syllable per chord
+			continue;
+
+		lastTimeStart = eltList[i]->timeStart();
+		if ( j<_syllableList.size() ) {
+			_syllableList[j]->setTimeStart( eltList[i]->timeStart() );
+			_syllableList[j]->setTimeLength( eltList[i]->timeLength() );
+		} else { // add empty syllables at the end, if missing
+			_syllableList << new CASyllable( "", (j>0 && _syllableList[j-1]->hyphenStart()), (j>0 && _syllableList[j-1]->melismaStart()), this, eltList[i]->timeStart(), eltList[i]->timeLength() );
+			invalidateHash();
 		}
+		j++;
+	}
 
-		for (; i<noteList.size(); i++) { // add empty syllables at the end, if missing
-			if (i>0 && noteList[i]->timeStart()==noteList[i-1]->timeStart()) // chord
-				continue;
-			addEmptySyllable( noteList[i]->timeStart(), noteList[i]->timeLength() );
-		}
+	int firstEmpty = j;
+	for (; j<_syllableList.size() && j>0; j++) { // add syllables at the end, if too much of them exist
+		if ( !_syllableList[j]->text().isEmpty() )
+			firstEmpty = j+1;
+
+		_syllableList[j]->setTimeStart(_syllableList[j-1]->timeStart()+_syllableList[j-1]->timeLength());
+		_syllableList[j]->setTimeLength( 256 );
 	}
+
+	// remove empty "leftover" syllables from the end
+	while ( firstEmpty>0 && _syllableList.size()>firstEmpty ) {
+		delete _syllableList.takeLast();
+		invalidateHash();
+	}
+
+	_dirtyTime = -1;
 }
 
 CAMusElement* CALyricsContext::next( CAMusElement* elt ) {
@@ -143,10 +209,13 @@ bool CALyricsContext::remove( CAMusElement* elt ) {
 		return false;
 
 	bool success=false;
+	invalidateSyllables( elt->timeStart() );
 	success = _syllableList.removeAll(static_cast<CASyllable*>(elt));
 
-	if(success)
+	if(success) {
 		delete elt;
+		invalidateHash();
+	}
 
 	return success;
 }
@@ -162,12 +231,14 @@ CASyllable* CALyricsContext::removeSyllableAtTimeStart( int timeStart ) {
 	for (i=0; i<_syllableList.size() && _syllableList[i]->timeStart()!=timeStart; i++);
 	if (i<_syllableList.size()) {
 		CASyllable *syllable = _syllableList[i];
+		invalidateSyllables( timeStart );
 
 		// update times
 		for (int j=i+1; j<_syllableList.size(); j++)
 			_syllableList[j]->setTimeStart( _syllableList[j]->timeStart() - syllable->timeLength() );
 
 		delete _syllableList.takeAt(i);
+		invalidateHash();
 		return syllable;
 	} else {
 		return 0;
@@ -190,6 +261,8 @@ bool CALyricsContext::addSyllable( CASyllable *syllable, bool replace ) {
 		delete _syllableList.takeAt(i);
 	}
 	_syllableList.insert(i, syllable);
+	invalidateSyllables( syllable->timeStart() );
+	invalidateHash();
 	for (i++; i<_syllableList.size(); i++)
 		_syllableList[i]->setTimeStart( _syllableList[i]->timeStart() + syllable->timeLength() );
 
@@ -205,6 +278,8 @@ bool CALyricsContext::addEmptySyllable( int timeStart, int timeLength ) {
 	int i;
 	for (i=0; i<_syllableList.size() && _syllableList[i]->timeStart()<timeStart; i++);
 	_syllableList.insert(i, (new CASyllable( "", ((i>0)?(_syllableList[i-1]->hyphenStart()):(false)), ((i>0)?(_syllableList[i-1]->melismaStart()):(false)), this, timeStart, timeLength )));
+	invalidateSyllables( timeStart );
+	invalidateHash();
 	for (i++; i<_syllableList.size(); i++)
 		_syllableList[i]->setTimeStart( _syllableList[i]->timeStart() + timeLength );
 
@@ -235,5 +310,7 @@ void CALyricsContext::setAssociatedVoice( CAVoice *v ) {
 		v->addLyricsContext(this);
 
 	_associatedVoice = v;
+	invalidateHash();
+	invalidateSyllables( 0 );
 	repositSyllables();
 }
@@ -25,11 +25,14 @@ public:
 	void cloneLyricsContextProperties( CALyricsContext* );
 
 	void repositSyllables();
+	inline void invalidateSyllables( int timeStart ) { if ( _dirtyTime==-1 || timeStart<_dirtyTime ) _dirtyTime = timeStart; }
 
 	CAMusElement* next(CAMusElement*);
 	CAMusElement* previous(CAMusElement*);
 	bool remove( CAMusElement* );
 	void clear();
+	unsigned int contentHash();
+	void invalidateHash( CAMusElement *elt=0 );
 
 	inline const QList<CASyllable*>& syllableList() { return _syllableList; }
 	bool addSyllable( CASyllable*, bool replace=true );
@@ -41,15 +44,18 @@ public:
 	inline CAVoice *associatedVoice() { return _associatedVoice; }
 	void setAssociatedVoice( CAVoice *v );
 	inline int stanzaNumber() { return _stanzaNumber; }
-	inline void setStanzaNumber( int sn ) { _stanzaNumber = sn; }
+	inline void setStanzaNumber( int sn ) { _stanzaNumber = sn; invalidateHash(); }
 	inline QString customStanzaName() { return _customStanzaName; }
-	inline void setCustomStanzaName( QString name ) { _customStanzaName = name; }
+	inline void setCustomStanzaName( QString name ) { _customStanzaName = name; invalidateHash(); }
 
 private:
 	QList< CASyllable* > _syllableList;
 	CAVoice             *_associatedVoice;
 	int                  _stanzaNumber;
 	QString              _customStanzaName;
+	int                  _dirtyTime; // syllables need to be repositioned from this time on, -1 if aligned
+	unsigned int         _hash;      // cached hash of the stanza and its syllables
+	bool                 _hashValid;
 };
 
 #endif /* LYRICSCONTEXT_H_ */
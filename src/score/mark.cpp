@@ -144,6 +144,14 @@ int CAMark::compare( CAMusElement *elt ) {
 	}
 }
 
+unsigned int CAMark::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, markType() );
+	h = combineHash( h, isCommon() );
+
+	return h;
+}
+
 /*!
 	\var bool CAMark::_common
 	Is mark present in all music elements in the chord. Default: True.
@@ -38,12 +38,13 @@ public:
 	virtual CAMark *clone(CAContext* context) { CAMark* c = clone(); c->setContext(context); return c; }
 	virtual CAMark *clone(CAMusElement* elt=0);
 	virtual int compare( CAMusElement* elt );
+	virtual unsigned int contentHash();
 
 	inline CAMusElement *associatedElement() { return _associatedElt; }
 	inline void setAssociatedElement( CAMusElement* elt ) { _associatedElt = elt; if(elt) _context = elt->context(); }
 
 	inline CAMarkType markType() { return _markType; }
-	inline void setMarkType( CAMarkType type ) { _markType = type; }
+	inline void setMarkType( CAMarkType type ) { _markType = type; contentChanged(); }
 
 	inline bool isCommon() { return _common; }
 
@@ -51,7 +52,7 @@ public:
 	static CAMarkType markTypeFromString( const QString s );
 
 protected:
-	inline void setCommon( bool c ) { _common=c; }
+	inline void setCommon( bool c ) { _common=c; contentChanged(); }
 
 private:
 	CAMusElement *_associatedElt;
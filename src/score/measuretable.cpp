@@ -0,0 +1,253 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <algorithm> // std::lower_bound, std::upper_bound
+
+#include "score/measuretable.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/barline.h"
+#include "score/timesignature.h"
+
+/*!
+	\class CAMeasureTable
+	\brief Table of bars of the staff
+
+	Exporters, the note checker and the GUI often need to walk the staff bar by bar or find the
+	bar at the given time. Instead of scanning the voices for barlines each time, every staff
+	keeps a table of its bars. Each entry contains the bar number (the pickup bar is bar 0 as on
+	the ruler, others are counted from 1), the start and end time, the
+	time signature in effect, the closing barline and for each voice the range of indices of the
+	music elements inside the bar. The range starts after the opening barline and includes the
+	closing one. Dotted barlines only divide the bar and don't start a new one.
+
+	If there are any elements after the last barline, an unfinished bar without the closing
+	barline ends the table.
+
+	The staff reports changes by calling invalidate() (see CAStaff::invalidateVoices()). The table
+	is rebuilt lazily on the next access from the first bar affected by the change on. Bar with
+	the given number is then returned in O(1) and the bar at the given time is found in O(log n).
+
+	\sa CAStaff::measureTable()
+*/
+
+static bool measureEndLessThan( const CAMeasureTable::CAMeasure& m, int time ) {
+	return m.timeEnd < time;
+}
+
+static bool timeLessThanMeasureStart( int time, const CAMeasureTable::CAMeasure& m ) {
+	return time < m.timeStart;
+}
+
+static bool eltTimeLessThan( CAMusElement *elt, int time ) {
+	return elt->timeStart() < time;
+}
+
+static bool timeLessThanElt( int time, CAMusElement *elt ) {
+	return time < elt->timeStart();
+}
+
+/*!
+	Creates an empty table of bars of the given \a staff.
+*/
+CAMeasureTable::CAMeasureTable( CAStaff *staff ) {
+	_staff = staff;
+	_dirtyTime = 0;
+}
+
+/*!
+	Marks the bars starting at or after the given \a timeStart as changed.
+*/
+void CAMeasureTable::invalidate( int timeStart ) {
+	if ( _dirtyTime==-1 || timeStart<_dirtyTime ) {
+		_dirtyTime = timeStart;
+	}
+}
+
+/*!
+	Returns the number of bars in the staff including the unfinished last bar.
+*/
+int CAMeasureTable::measureCount() {
+	update();
+	return _measureList.size();
+}
+
+/*!
+	Returns the bar at the given index \a idx.
+
+	The returned reference is valid until the staff is changed.
+
+	\sa bar()
+*/
+const CAMeasureTable::CAMeasure& CAMeasureTable::measure( int idx ) {
+	update();
+	return _measureList[idx];
+}
+
+/*!
+	Returns the bar with the given bar \a number.
+
+	\sa measure(), firstBarNumber()
+*/
+const CAMeasureTable::CAMeasure& CAMeasureTable::bar( int number ) {
+	return measure( number-firstBarNumber() );
+}
+
+/*!
+	Returns 0, if the first bar is a pickup bar (anacrusis) shorter than the time signature.
+	Otherwise returns 1.
+*/
+int CAMeasureTable::firstBarNumber() {
+	update();
+	return ( _measureList.size() ? _measureList[0].number : 1 );
+}
+
+/*!
+	Returns the index of the bar containing the given \a time or -1, if the time is after the
+	end of the staff. Elements at the time of the barline belong to the following bar.
+*/
+int CAMeasureTable::measureIndexAt( int time ) {
+	update();
+
+	int idx = std::upper_bound( _measureList.begin(), _measureList.end(), time, timeLessThanMeasureStart ) - _measureList.begin() - 1;
+	if ( idx<0 ) {
+		return ( _measureList.size() ? 0 : -1 );
+	}
+
+	if ( idx==_measureList.size()-1 && _measureList[idx].barline && time>=_measureList[idx].timeEnd ) {
+		return -1;
+	}
+
+	return idx;
+}
+
+/*!
+	Returns the music elements of the given \a voice inside the bar with index \a idx.
+	The list doesn't contain the opening barline and contains the closing one.
+*/
+QList<CAMusElement*> CAMeasureTable::measureElements( int idx, CAVoice *voice ) {
+	int v = _staff->voiceList().indexOf( voice );
+	if ( v==-1 || idx<0 || idx>=measureCount() ) {
+		return QList<CAMusElement*>();
+	}
+
+	const CAMeasure& m = _measureList[idx];
+	return voice->musElementList().mid( m.startIndex[v], m.endIndex[v]-m.startIndex[v] );
+}
+
+/*!
+	Returns the last time signature starting at or before the given \a time or 0, if none.
+*/
+CATimeSignature *CAMeasureTable::timeSignatureAt( int time ) {
+	const QList<CAMusElement*>& list = _staff->timeSignatureRefs();
+	int idx = std::upper_bound( list.begin(), list.end(), time, timeLessThanElt ) - list.begin() - 1;
+
+	return ( idx>=0 ? static_cast<CATimeSignature*>(list[idx]) : 0 );
+}
+
+/*!
+	Rebuilds the bars from the first bar ending at or after the dirty time on. Bars before it
+	are kept, because neither their times nor the indices of their elements have changed.
+*/
+void CAMeasureTable::update() {
+	if ( _dirtyTime==-1 ) {
+		return;
+	}
+
+	int first = std::lower_bound( _measureList.begin(), _measureList.end(), _dirtyTime, measureEndLessThan ) - _measureList.begin();
+	if ( first>0 && first==_measureList.size() && !_measureList.last().barline ) {
+		first--; // the unfinished bar is always rebuilt
+	}
+	_measureList.resize( first );
+
+	const QList<CAVoice*>& voices = _staff->voiceList();
+	const QList<CAMusElement*>& barlines = _staff->barlineRefs();
+
+	QVector<int> startIndex( voices.size(), 0 );
+	int timeStart = 0;
+	int b = 0;
+
+	if ( !_measureList.isEmpty() ) {
+		const CAMeasure& last = _measureList.last();
+		startIndex = last.endIndex;
+		timeStart = last.timeEnd;
+
+		// continue after the closing barline of the last kept bar
+		b = std::lower_bound( barlines.begin(), barlines.end(), timeStart, eltTimeLessThan ) - barlines.begin();
+		while ( b<barlines.size() && barlines[b]->timeStart()==timeStart ) {
+			if ( barlines[b++]==last.barline ) {
+				break;
+			}
+		}
+	}
+
+	// the pickup bar is numbered 0
+	int firstNumber = ( _measureList.isEmpty() ? 1 : _measureList[0].number );
+	if ( _measureList.isEmpty() ) {
+		for (int i=0; i<barlines.size(); i++) {
+			if ( static_cast<CABarline*>(barlines[i])->barlineType()!=CABarline::Dotted ) {
+				CATimeSignature *timeSig = timeSignatureAt( 0 );
+				if ( timeSig && barlines[i]->timeStart() < timeSig->barDuration() ) {
+					firstNumber = 0;
+				}
+				break;
+			}
+		}
+	}
+
+	for (; b<barlines.size(); b++) {
+		CABarline *barline = static_cast<CABarline*>(barlines[b]);
+		if ( barline->barlineType()==CABarline::Dotted ) {
+			continue;
+		}
+
+		CAMeasure m;
+		m.number = _measureList.size()+firstNumber;
+		m.timeStart = timeStart;
+		m.timeEnd = barline->timeStart();
+		m.timeSignature = timeSignatureAt( timeStart );
+		m.barline = barline;
+		m.startIndex = startIndex;
+		m.endIndex.resize( voices.size() );
+		for (int i=0; i<voices.size(); i++) {
+			int idx = voices[i]->indexOf( barline );
+			m.endIndex[i] = qMax( startIndex[i], ( idx!=-1 ? idx+1 : voices[i]->lowerBoundIndex( m.timeEnd ) ) );
+		}
+
+		_measureList << m;
+		startIndex = m.endIndex;
+		timeStart = m.timeEnd;
+	}
+
+	// unfinished last bar
+	bool unfinished = false;
+	int timeEnd = timeStart;
+	for (int i=0; i<voices.size(); i++) {
+		if ( startIndex[i] < voices[i]->musElementList().size() ) {
+			unfinished = true;
+			timeEnd = qMax( timeEnd, voices[i]->lastTimeEnd() );
+		}
+	}
+
+	if ( unfinished ) {
+		CAMeasure m;
+		m.number = _measureList.size()+firstNumber;
+		m.timeStart = timeStart;
+		m.timeEnd = timeEnd;
+		m.timeSignature = timeSignatureAt( timeStart );
+		m.barline = 0;
+		m.startIndex = startIndex;
+		m.endIndex.resize( voices.size() );
+		for (int i=0; i<voices.size(); i++) {
+			m.endIndex[i] = voices[i]->musElementList().size();
+		}
+
+		_measureList << m;
+	}
+
+	_dirtyTime = -1;
+}
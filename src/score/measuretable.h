@@ -0,0 +1,56 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef MEASURETABLE_H_
+#define MEASURETABLE_H_
+
+#include <QList>
+#include <QVector>
+
+class CAStaff;
+class CAVoice;
+class CAMusElement;
+class CABarline;
+class CATimeSignature;
+
+class CAMeasureTable {
+public:
+	struct CAMeasure {
+		int number;                     // bar number, 0 for the pickup bar
+		int timeStart;
+		int timeEnd;
+		CATimeSignature *timeSignature; // time signature in effect at timeStart or 0
+		CABarline *barline;             // closing barline or 0 for the unfinished last bar
+		QVector<int> startIndex;        // per voice index of the first element in the bar
+		QVector<int> endIndex;          // per voice index after the closing barline
+	};
+
+	CAMeasureTable( CAStaff *staff );
+
+	inline CAStaff *staff() { return _staff; }
+
+	void invalidate( int timeStart );
+	inline int dirtyTime() { return _dirtyTime; }
+
+	int measureCount();
+	const CAMeasure& measure( int idx );
+	const CAMeasure& bar( int number );
+	int firstBarNumber();
+	int measureIndexAt( int time );
+
+	QList<CAMusElement*> measureElements( int idx, CAVoice *voice );
+
+private:
+	void update();
+	CATimeSignature *timeSignatureAt( int time );
+
+	CAStaff *_staff;
+	QVector<CAMeasure> _measureList;
+	int _dirtyTime; // measures need to be rebuilt from this time on, -1 if up to date
+};
+
+#endif /* MEASURETABLE_H_ */
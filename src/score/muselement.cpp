@@ -8,6 +8,8 @@
 #include "score/muselement.h"
 #include "score/context.h"
 #include "score/staff.h"
+#include "score/sheet.h"
+#include "score/tempomap.h"
 #include "score/playable.h"
 #include "score/mark.h"
 #include "score/articulation.h"
@@ -36,13 +38,15 @@
 	Constructs a music element with parent context (staff, lyrics, functionmarks) \a context,
 	start time \a time and length \a length.
 */
-CAMusElement::CAMusElement(CAContext *context, int time, int length) {
+CAMusElement::CAMusElement(CAContext *context, int time, int length)
+ : _hasExtra( 0 ) {
 	_context = context;
 	_timeStart = time;
 	_timeLength = length;
+	_timeBlock = 0;
 	_musElementType = CAMusElement::Undefined;
 	_visible = true;
-	_color = QColor( 0, 0, 0, 0 );
+	_typeCount[Undefined].ref();
 }
 
 /*!
@@ -55,7 +59,7 @@ CAMusElement::~CAMusElement() {
 		     musElementType()!=CAMusElement::Note ) {
 			delete _markList.takeFirst();
 		} else {
-			_markList.takeFirst();
+			removeMark( _markList.first() );
 		}
 	}
 
@@ -63,9 +67,177 @@ CAMusElement::~CAMusElement() {
 	if( context() && !isPlayable() )
 		context()->remove( this );
 	
-	while (_noteCheckerErrorList.size()) {
-		delete _noteCheckerErrorList.front(); // also removes instances from _noteCheckerErrorList and CASheet->noteCheckerErrorList
+	while (noteCheckerErrorList().size()) {
+		delete noteCheckerErrorList().front(); // also removes instances from noteCheckerErrorList() and CASheet->noteCheckerErrorList
 	}
+
+	if ( hasExtra() ) {
+		QWriteLocker locker( &_extraLock );
+		delete _extraTable.take( this );
+	}
+
+	_typeCount[_musElementType].deref();
+}
+
+QHash< const CAMusElement*, CAMusElement::CAMusElementExtra* > CAMusElement::_extraTable;
+QReadWriteLock CAMusElement::_extraLock;
+QAtomicInt CAMusElement::_typeCount[CAMusElement::Mark+1];
+
+/*!
+	Returns the rarely used attributes of the element stored in the side table.
+	If \a create is True, the attributes are created, if they don't exist yet; otherwise 0 is
+	returned in that case.
+
+	Names, colors and note checker errors are set on a small fraction of elements only. Keeping
+	them outside of the element saves memory for large scores.
+
+	The _extraLock must be held while calling this and while using the returned attributes, for
+	writing if \a create is True or the attributes are changed. Getters copy the values out
+	before unlocking, because another thread may change them afterwards. The table is only
+	locked for the elements having the attributes (see hasExtra()), so lookups from different
+	threads share the lock and only the setters lock it exclusively.
+*/
+CAMusElement::CAMusElementExtra *CAMusElement::extra( bool create ) {
+	CAMusElementExtra *e = _extraTable.value( this );
+	if ( e || !create ) {
+		return e; // also when created by another thread while waiting for the lock
+	}
+
+	e = new CAMusElementExtra;
+	e->color = QColor( 0, 0, 0, 0 );
+	_extraTable[this] = e;
+	_hasExtra.fetchAndStoreRelease( 1 );
+
+	return e;
+}
+
+/*!
+	Returns the name of the music element.
+	Names are optional and are not necessary unique.
+
+	\sa setName()
+*/
+const QString CAMusElement::name() {
+	if ( !hasExtra() ) {
+		return QString();
+	}
+
+	QReadLocker locker( &_extraLock );
+	return extra(false)->name;
+}
+
+/*!
+	Sets the name of the music element to \a name.
+
+	\sa name()
+*/
+void CAMusElement::setName( const QString name ) {
+	if ( !hasExtra() && name.isEmpty() ) {
+		return;
+	}
+
+	QWriteLocker locker( &_extraLock );
+	extra(true)->name = name;
+}
+
+/*!
+	Returns the color of the music element.
+	Fully transparent color is returned, if the default color should be used.
+
+	\sa setColor()
+*/
+const QColor CAMusElement::color() {
+	if ( !hasExtra() ) {
+		return QColor( 0, 0, 0, 0 );
+	}
+
+	QReadLocker locker( &_extraLock );
+	return extra(false)->color;
+}
+
+/*!
+	Sets the color of the music element to \a c.
+
+	\sa color()
+*/
+void CAMusElement::setColor( const QColor c ) {
+	if ( !hasExtra() && c==QColor( 0, 0, 0, 0 ) ) {
+		return;
+	}
+
+	{
+		QWriteLocker locker( &_extraLock );
+		extra(true)->color = c;
+	}
+	contentChanged();
+}
+
+/*!
+	Returns a copy of the list of note checker errors of this element.
+*/
+QList<CANoteCheckerError*> CAMusElement::noteCheckerErrorList() {
+	if ( !hasExtra() ) {
+		return QList<CANoteCheckerError*>();
+	}
+
+	QReadLocker locker( &_extraLock );
+	return extra(false)->noteCheckerErrorList;
+}
+
+void CAMusElement::addNoteCheckerError( CANoteCheckerError* nce ) {
+	QWriteLocker locker( &_extraLock );
+	extra(true)->noteCheckerErrorList << nce;
+}
+
+void CAMusElement::removeNoteCheckerError( CANoteCheckerError* nce ) {
+	if ( hasExtra() ) {
+		QWriteLocker locker( &_extraLock );
+		extra(false)->noteCheckerErrorList.removeAll( nce );
+	}
+}
+
+/*!
+	Sets the type of the music element to \a type.
+	This should be called once in the constructor of the inherited class.
+*/
+void CAMusElement::setMusElementType( CAMusElementType type ) {
+	_typeCount[_musElementType].deref();
+	_musElementType = type;
+	_typeCount[_musElementType].ref();
+}
+
+/*!
+	Returns a human-readable report of the number of music elements per type and the memory
+	saved by keeping the rarely used attributes in the side table.
+*/
+QString CAMusElement::memoryReport() {
+	int extraCount;
+	{
+		QReadLocker locker( &_extraLock );
+		extraCount = _extraTable.size();
+	}
+
+	const int savedPerElement = sizeof(CAMusElementExtra);
+	qint64 total = 0;
+	QString report;
+	for (int i=Undefined; i<=Mark; i++) {
+		int count = _typeCount[i].fetchAndAddRelaxed( 0 ); // load() is Qt5 only
+		if ( !count )
+			continue;
+
+		report += QString("%1: %2 elements, %3 bytes saved\n")
+		          .arg( musElementTypeToString(static_cast<CAMusElementType>(i)) )
+		          .arg( count )
+		          .arg( static_cast<qint64>(count)*savedPerElement );
+		total += count;
+	}
+
+	report += QString("Total: %1 elements, %2 with rare attributes, %3 bytes saved\n")
+	          .arg( total )
+	          .arg( extraCount )
+	          .arg( (total - extraCount)*savedPerElement - extraCount*static_cast<qint64>(sizeof(void*)*2) );
+
+	return report;
 }
 
 /*!
@@ -145,6 +317,114 @@ void CAMusElement::addMark( CAMark *mark ) {
 	}
 
 	_markList.insert( l, mark );
+	mark->setTimeBlock( _timeBlock );
+	contentChanged();
+
+	if ( mark->context() && mark->context()->sheet() ) {
+		mark->context()->sheet()->tempoMap()->addMark( mark );
+	}
+}
+
+/*!
+	Returns the hash of the element content.
+
+	Start time is not included, because elements in the time blocks are hashed relative
+	to the block offset by their voice. Times of marks are hashed relative to the element.
+	Subclasses add their own properties.
+
+	\sa contentChanged(), CAVoice::contentHash()
+*/
+unsigned int CAMusElement::contentHash() {
+	unsigned int h = combineHash( _musElementType, _timeLength );
+	h = combineHash( h, _visible );
+	if ( hasExtra() ) {
+		h = combineHash( h, color().rgba() );
+	}
+
+	for (int i=0; i<_markList.size(); i++) {
+		h = combineHash( h, _markList[i]->contentHash() );
+		h = combineHash( h, _markList[i]->timeStart() - timeStart() );
+	}
+
+	return h;
+}
+
+/*!
+	Invalidates the cached content hashes of the element context.
+	Call this whenever a property included in contentHash() is changed.
+
+	\sa CAContext::invalidateHash()
+*/
+void CAMusElement::contentChanged() {
+	if ( _context ) {
+		_context->invalidateHash( this );
+	}
+}
+
+/*!
+	Moves the element and its marks to the time \a block. Absolute times of the elements
+	are preserved.
+
+	Playable elements are put in time blocks by their voice.
+
+	\sa CATimeBlock, CAVoice::updateTimes()
+*/
+void CAMusElement::setTimeBlock( CATimeBlock *block ) {
+	int time = timeStart();
+	_timeBlock = block;
+	setTimeStart( time );
+
+	for (int i=0; i<_markList.size(); i++) {
+		_markList[i]->setTimeBlock( block );
+	}
+}
+
+/*!
+	Returns the time in miliseconds when the music element appears in the score.
+	Tempo marks of the sheet are taken into account.
+
+	If the element is not part of any sheet, timeStart() is returned.
+
+	\sa CATempoMap::timeToMs()
+*/
+int CAMusElement::realTimeStart() {
+	if ( !context() || !context()->sheet() )
+		return timeStart();
+
+	return qRound( context()->sheet()->tempoMap()->timeToMs( timeStart() ) );
+}
+
+/*!
+	Returns the time in miliseconds how long the music element lasts.
+
+	If the element is not part of any sheet, timeLength() is returned.
+
+	\sa realTimeStart()
+*/
+int CAMusElement::realTimeLength() {
+	if ( !context() || !context()->sheet() )
+		return timeLength();
+
+	return context()->sheet()->tempoMap()->timeLengthToMs( timeStart(), timeLength() );
+}
+
+/*!
+	Removes the \a mark from the mark list.
+	The mark is not destroyed.
+*/
+void CAMusElement::removeMark( CAMark* mark ) {
+	if ( _markList.removeAll(mark) ) {
+		contentChanged();
+	}
+
+	// the mark doesn't follow the element anymore
+	if ( mark && mark->associatedElement()==this ) {
+		mark->setTimeBlock( 0 );
+	}
+
+	if ( mark && mark->context() && mark->context()->sheet() ) {
+		mark->context()->sheet()->tempoMap()->removeMark( mark );
+	}
 }
 
 /*!
@@ -196,7 +476,9 @@ void CAMusElement::addMarks( QList<CAMark*> marks ) {
 	Returns the time in the score when the music element appears in time.
 	The returned time is in absolute time units.
 
-	\sa _timeStart, setTimeStart()
+	If the element is part of a time block, the block offset is added to the stored time.
+
+	\sa _timeStart, setTimeStart(), timeBlock()
 */
 
 /*!
@@ -204,6 +486,8 @@ void CAMusElement::addMarks( QList<CAMark*> marks ) {
 	Sets the time in the score when the music element appears for this music element to \a time.
 	The given time is in absolute time units.
 
+	The context is only notified about the change, if the time relative to the time block changed.
+
 	\sa _timeStart, timeStart()
 */
 
@@ -218,7 +502,7 @@ void CAMusElement::addMarks( QList<CAMark*> marks ) {
 /*!
 	\fn CAMusElement::setTimeLength(int length)
 	Sets the length in the score for this music element to \a time.
-	The given time is in absolute time units.
+	The given time is in absolute time units. Setting the same length doesn't notify the context.
 
 	\sa _timeLength, timeLength()
 */
@@ -232,18 +516,6 @@ void CAMusElement::addMarks( QList<CAMark*> marks ) {
 	\sa _timeStart, _timeLength
 */
 
-/*!
-	\fn CAMusElement::name()
-	Returns the name of the music element.
-*/
-
-/*!
-	\fn CAMusElement::setName(QString name)
-	Sets the name of the music element to \a name.
-
-	\sa _name, name()
-*/
-
 /*!
 	\fn CAMusElement::clone()
 	Clones a music element with exact properties including the context.
@@ -284,6 +556,14 @@ void CAMusElement::addMarks( QList<CAMark*> marks ) {
 	\sa timeStart(), setTimeStart()
 */
 
+/*!
+	\var CAMusElement::_timeBlock
+	Time block of consecutive elements in the voice sharing the time offset or 0, if the
+	_timeStart is absolute.
+
+	\sa timeBlock(), setTimeBlock()
+*/
+
 /*!
 	\var CAMusElement::_timeLength
 	How long does this music element lasts.
@@ -296,9 +576,10 @@ void CAMusElement::addMarks( QList<CAMark*> marks ) {
 */
 
 /*!
-	\var CAMusElement::_name
-	Specific name of the music element in QString.
-	Names are optional and are not necessary unique.
+	\var CAMusElement::_hasExtra
+	Non-zero, if the element has any of the rarely used attributes (name, color, note checker
+	errors) stored in the _extraTable. It is set once while holding the _extraLock for writing and
+	read without the lock, so only the elements having the attributes lock the table.
 
-	\sa name(), setName()
+	\sa extra()
 */
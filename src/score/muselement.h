@@ -11,6 +11,14 @@
 #include <QString>
 #include <QList>
 #include <QColor>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+
+#include <cstddef>
+
+#include "score/timeblock.h"
+#include "score/muselementpool.h"
 
 class CAContext;
 class CAMusElement;
@@ -40,6 +48,11 @@ public:
 	CAMusElement(CAContext *context, int timeStart, int timeLength=0);
 	virtual ~CAMusElement();
 
+#ifndef SWIG
+	static inline void *operator new( std::size_t size ) { return CAMusElementPool::musElementPool()->allocate( size ); }
+	static inline void operator delete( void *p, std::size_t size ) { CAMusElementPool::musElementPool()->release( p, size ); }
+#endif
+
 	virtual CAMusElement* clone(CAContext* context=0) = 0;
 	virtual int compare(CAMusElement *elt) = 0;
 
@@ -48,50 +61,76 @@ public:
 	inline CAContext *context() { return _context; }
 	inline void setContext(CAContext *context) { _context = context; }
 
-	inline virtual int timeStart() const { return _timeStart; }
-	inline void setTimeStart(int time) { _timeStart = time; }
+	inline virtual int timeStart() const { return _timeBlock ? _timeStart + _timeBlock->offset() : _timeStart; }
+	inline void setTimeStart(int time) {
+		int t = _timeBlock ? time - _timeBlock->offset() : time;
+		if ( t!=_timeStart ) { _timeStart = t; contentChanged(); }
+	}
 	inline virtual int timeLength() const { return _timeLength; }
-	inline void setTimeLength(int length) { _timeLength = length; }
+	inline void setTimeLength(int length) { if ( length!=_timeLength ) { _timeLength = length; contentChanged(); } }
 	inline int timeEnd() { return timeStart() + timeLength(); }
 
-	inline virtual int realTimeStart() { return _timeStart; } // TODO: calculates and returns time in miliseconds
-	inline virtual int realTimeLength() { return _timeLength; } // TODO: calculates and returns time in miliseconds
-	inline int realTimeEnd() { return realTimeStart() + realTimeLength(); } // TODO: calculates and returns time in miliseconds
+	inline CATimeBlock *timeBlock() { return _timeBlock; }
+	void setTimeBlock( CATimeBlock *block );
 
-	inline const QString name() { return _name; }
-	inline void setName(const QString name) { _name = name; }
+	virtual int realTimeStart();
+	virtual int realTimeLength();
+	inline int realTimeEnd() { return realTimeStart() + realTimeLength(); }
+
+	const QString name();
+	void setName(const QString name);
 
 	inline const bool isVisible() { return _visible; }
-	inline void setVisible( const bool v ) { _visible = v; }
+	inline void setVisible( const bool v ) { _visible = v; contentChanged(); }
 
-	inline const QColor color() { return _color; }
-	inline void setColor( const QColor c ) { _color = c; }
+	const QColor color();
+	void setColor( const QColor c );
 
-	inline const QList<CAMark*> markList() { return _markList; }
+	inline const QList<CAMark*>& markList() { return _markList; }
 	void addMark( CAMark *mark );
 	void addMarks( QList<CAMark*> marks );
-	inline void removeMark( CAMark* mark ) { _markList.removeAll(mark); }
+	void removeMark( CAMark* mark );
 	
-	inline const QList<CANoteCheckerError*>& noteCheckerErrorList() { return _noteCheckerErrorList; };
-	inline void addNoteCheckerError( CANoteCheckerError* nce ) { _noteCheckerErrorList << nce; }
-	inline void removeNoteCheckerError( CANoteCheckerError* nce ) { _noteCheckerErrorList.removeAll(nce); }
+	QList<CANoteCheckerError*> noteCheckerErrorList();
+	void addNoteCheckerError( CANoteCheckerError* nce );
+	void removeNoteCheckerError( CANoteCheckerError* nce );
 
 	bool isPlayable();
 
+	virtual unsigned int contentHash();
+	void contentChanged();
+	static inline unsigned int combineHash( unsigned int seed, unsigned int value ) { return seed ^ (value + 0x9e3779b9u + (seed<<6) + (seed>>2)); }
+
 	static const QString musElementTypeToString(CAMusElementType);
 	static CAMusElementType musElementTypeFromString(const QString);
 
+	static QString memoryReport();
+
 protected:
-	inline void setMusElementType( CAMusElementType type ) { _musElementType = type; }
+	void setMusElementType( CAMusElementType type );
 
 	CAMusElementType _musElementType;
 	QList< CAMark* > _markList;
-	QList< CANoteCheckerError* > _noteCheckerErrorList;
 	CAContext *_context;
 	int _timeStart;
 	int _timeLength;
+	CATimeBlock *_timeBlock;
 	bool _visible;
-	QColor _color;
-	QString _name;
+
+private:
+	struct CAMusElementExtra {
+		QString name;
+		QColor color;
+		QList< CANoteCheckerError* > noteCheckerErrorList;
+	};
+
+	inline bool hasExtra() { return _hasExtra.fetchAndAddAcquire( 0 ); } // load() is Qt5 only
+	CAMusElementExtra *extra( bool create );
+
+	QAtomicInt _hasExtra; // rarely used attributes are stored in _extraTable, set once under the write lock
+
+	static QHash< const CAMusElement*, CAMusElementExtra* > _extraTable;
+	static QReadWriteLock _extraLock; // many readers (eg. layout threads reading colors), rare writers
+	static QAtomicInt _typeCount[Mark+1];
 };
 #endif /* MUSELEMENT_H_ */
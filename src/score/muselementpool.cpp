@@ -0,0 +1,224 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QMutexLocker>
+
+#include <new>
+
+#include "score/muselementpool.h"
+
+/*!
+	\class CAMusElementPool
+	\brief Size-class memory pools for music elements, marks and their drawable instances
+
+	Music elements are small objects which are created and destroyed in large numbers
+	when opening, cloning (eg. for undo) and closing the documents. Instead of allocating
+	each of them separately on the heap, CAMusElement::operator new() takes the memory from
+	the pool of the corresponding size class. Every pool allocates ChunkSize bytes at once
+	and keeps the released slots in a free list.
+
+	The same holds for the drawable elements, which are all destroyed and created again on
+	every relayout of the sheet. CADrawable::operator new() takes the memory from its own
+	drawablePool(), which never frees its chunks. The new drawables reuse the slots of the
+	ones destroyed just before, even when the layout was cleared completely.
+
+	Each size class has its own mutex, so the threads allocating objects of different sizes
+	(eg. the layout worker threads) don't wait for each other.
+
+	The musElementPool() is shared by all the documents, because operator new() doesn't know
+	the document an element belongs to. Each chunk counts its used slots, so a chunk is freed
+	as soon as all of its slots are released, eg. when a document or its undo copies are
+	destroyed while other documents are still open. Up to KeptChunks empty chunks of each size
+	class are kept, so releasing and allocating a few elements in a loop doesn't allocate and
+	free a chunk each time. New slots are taken from the chunk which got a slot back last.
+
+	Allocation counters allocationCount(), liveCount(), chunkCount() and reservedBytes()
+	of each pool can be used for profiling.
+
+	\sa CAMusElement, CADrawable
+*/
+
+/*!
+	Creates an empty pool. Up to \a keptChunks empty chunks of each size class are kept for the
+	next allocations, the others are freed. Pass -1 to never free the chunks.
+*/
+CAMusElementPool::CAMusElementPool( int keptChunks ) {
+	_keptChunks = keptChunks;
+	for (int i=0; i<MaxSize/Granularity; i++) {
+		_sizeClasses[i].emptyChunkCount = 0;
+		_sizeClasses[i].slotSize = 0;
+		_sizeClasses[i].liveCount = 0;
+		_sizeClasses[i].allocationCount = 0;
+	}
+}
+
+/*!
+	Returns the pool used by CAMusElement::operator new().
+	The pool is never destroyed, so the elements deleted at the program exit can still release
+	their memory.
+*/
+CAMusElementPool *CAMusElementPool::musElementPool() {
+	static CAMusElementPool *pool = new CAMusElementPool( KeptChunks );
+	return pool;
+}
+
+/*!
+	Returns the pool used by CADrawable::operator new().
+	Its chunks are never freed, because the next relayout needs them again.
+*/
+CAMusElementPool *CAMusElementPool::drawablePool() {
+	static CAMusElementPool *pool = new CAMusElementPool( -1 );
+	return pool;
+}
+
+/*!
+	Returns the pool for objects of the given \a size or 0, if the object is too big.
+*/
+CAMusElementPool::CASizeClass *CAMusElementPool::sizeClass( std::size_t size ) {
+	if ( !size || size>MaxSize ) {
+		return 0;
+	}
+
+	return &_sizeClasses[ (size-1)/Granularity ];
+}
+
+/*!
+	Returns a memory block of at least \a size bytes.
+*/
+void *CAMusElementPool::allocate( std::size_t size ) {
+	CASizeClass *c = sizeClass( size );
+	if ( !c ) {
+		return ::operator new( size );
+	}
+
+	QMutexLocker locker( &c->mutex );
+
+	if ( c->freeChunkList.isEmpty() ) {
+		// allocate a new chunk and split it into slots
+		c->slotSize = ((size-1)/Granularity + 1)*Granularity;
+		CAPoolChunk *chunk = new CAPoolChunk;
+		chunk->memory = static_cast<char*>( ::operator new( ChunkSize ) );
+		chunk->freeList = 0;
+		chunk->liveCount = 0;
+		for (int i=(ChunkSize/c->slotSize-1)*c->slotSize; i>=0; i-=c->slotSize) {
+			CAPoolSlot *slot = reinterpret_cast<CAPoolSlot*>( chunk->memory+i );
+			slot->next = chunk->freeList;
+			chunk->freeList = slot;
+		}
+		c->chunkMap.insert( chunk->memory, chunk );
+		c->freeChunkList << chunk;
+		c->emptyChunkCount++;
+	}
+
+	CAPoolChunk *chunk = c->freeChunkList.last();
+	if ( !chunk->liveCount ) {
+		c->emptyChunkCount--;
+	}
+
+	CAPoolSlot *slot = chunk->freeList;
+	chunk->freeList = slot->next;
+	chunk->liveCount++;
+	if ( !chunk->freeList ) {
+		c->freeChunkList.removeLast();
+	}
+
+	c->liveCount++;
+	c->allocationCount++;
+
+	return slot;
+}
+
+/*!
+	Returns the memory block \a p of the given \a size back to the pool.
+	If there are no used slots left in its chunk and more than keptChunks() chunks of the size
+	class are empty, the chunk is freed.
+*/
+void CAMusElementPool::release( void *p, std::size_t size ) {
+	if ( !p ) {
+		return;
+	}
+
+	CASizeClass *c = sizeClass( size );
+	if ( !c ) {
+		::operator delete( p );
+		return;
+	}
+
+	QMutexLocker locker( &c->mutex );
+
+	// the chunk is the one with the highest address not above p
+	QMap<char*, CAPoolChunk*>::iterator it = c->chunkMap.upperBound( static_cast<char*>(p) );
+	CAPoolChunk *chunk = (--it).value();
+
+	if ( !chunk->freeList ) {
+		c->freeChunkList << chunk;
+	}
+
+	CAPoolSlot *slot = static_cast<CAPoolSlot*>( p );
+	slot->next = chunk->freeList;
+	chunk->freeList = slot;
+	chunk->liveCount--;
+	c->liveCount--;
+
+	if ( !chunk->liveCount ) {
+		c->emptyChunkCount++;
+		if ( _keptChunks!=-1 && c->emptyChunkCount>_keptChunks ) {
+			freeChunk( c, chunk );
+		}
+	}
+}
+
+/*!
+	Frees the empty \a chunk of the size class \a c. The size class must be locked.
+*/
+void CAMusElementPool::freeChunk( CASizeClass *c, CAPoolChunk *chunk ) {
+	c->chunkMap.remove( chunk->memory );
+	c->freeChunkList.removeOne( chunk );
+	c->emptyChunkCount--;
+
+	::operator delete( chunk->memory );
+	delete chunk;
+}
+
+/*!
+	Returns the number of allocations from the pool so far.
+*/
+qint64 CAMusElementPool::allocationCount() {
+	qint64 count = 0;
+	for (int i=0; i<MaxSize/Granularity; i++) {
+		QMutexLocker locker( &_sizeClasses[i].mutex );
+		count += _sizeClasses[i].allocationCount;
+	}
+
+	return count;
+}
+
+/*!
+	Returns the number of currently used slots of all the size classes.
+*/
+qint64 CAMusElementPool::liveCount() {
+	qint64 count = 0;
+	for (int i=0; i<MaxSize/Granularity; i++) {
+		QMutexLocker locker( &_sizeClasses[i].mutex );
+		count += _sizeClasses[i].liveCount;
+	}
+
+	return count;
+}
+
+/*!
+	Returns the number of chunks allocated by all the size classes.
+*/
+qint64 CAMusElementPool::chunkCount() {
+	qint64 count = 0;
+	for (int i=0; i<MaxSize/Granularity; i++) {
+		QMutexLocker locker( &_sizeClasses[i].mutex );
+		count += _sizeClasses[i].chunkMap.size();
+	}
+
+	return count;
+}
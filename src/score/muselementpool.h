@@ -0,0 +1,71 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef MUSELEMENTPOOL_H_
+#define MUSELEMENTPOOL_H_
+
+#include <QList>
+#include <QMap>
+#include <QMutex>
+
+#include <cstddef>
+
+class CAMusElementPool {
+public:
+	CAMusElementPool( int keptChunks );
+
+	static CAMusElementPool *musElementPool();
+	static CAMusElementPool *drawablePool();
+
+	void *allocate( std::size_t size );
+	void release( void *p, std::size_t size );
+
+	qint64 allocationCount();
+	qint64 liveCount();
+	qint64 chunkCount();
+	inline qint64 reservedBytes() { return chunkCount()*ChunkSize; }
+	inline int keptChunks() { return _keptChunks; }
+
+	enum {
+		Granularity = 16,   // sizes are rounded up to the multiple of this
+		MaxSize = 256,      // bigger objects are allocated on the heap
+		ChunkSize = 16384,  // bytes allocated at once for a size class
+		KeptChunks = 4      // empty chunks of a music element size class kept for the next allocations
+	};
+
+private:
+	CAMusElementPool( const CAMusElementPool& );            // not copyable, owns the chunks
+	CAMusElementPool& operator=( const CAMusElementPool& );
+
+	struct CAPoolSlot {
+		CAPoolSlot *next;
+	};
+
+	struct CAPoolChunk {
+		char *memory;            // ChunkSize bytes split into slots
+		CAPoolSlot *freeList;    // unused slots in this chunk
+		int liveCount;           // number of used slots in this chunk
+	};
+
+	struct CASizeClass {
+		QMutex mutex;                         // guards this size class only
+		QMap<char*, CAPoolChunk*> chunkMap;   // allocated chunks by their memory address
+		QList<CAPoolChunk*> freeChunkList;    // chunks with unused slots, the last one is used first
+		int emptyChunkCount;                  // number of chunks without used slots
+		int slotSize;                         // size of a slot in bytes
+		int liveCount;                        // number of used slots
+		qint64 allocationCount;               // number of allocations so far
+	};
+
+	CASizeClass *sizeClass( std::size_t size );
+	void freeChunk( CASizeClass *c, CAPoolChunk *chunk );
+
+	CASizeClass _sizeClasses[MaxSize/Granularity];
+	int _keptChunks;         // empty chunks kept per size class or -1 for all
+};
+
+#endif /* MUSELEMENTPOOL_H_ */
@@ -30,7 +30,7 @@
 */
 CANote::CANote( CADiatonicPitch pitch, CAPlayableLength length, CAVoice *voice, int timeStart, int timeLength )
  : CAPlayable( length, voice, timeStart, timeLength ) {
-	_musElementType = CAMusElement::Note;
+	setMusElementType( CAMusElement::Note );
 	_forceAccidentals = false;
 	_stemDirection = StemPreferred;
 
@@ -147,14 +147,14 @@ const QString CANote::generateNoteName(int pitch, int accs) {
 	Returns true, if the note is part of a chord; otherwise false.
 */
 bool CANote::isPartOfChord() {
-	int idx = voice()->musElementList().indexOf(this);
+	int idx = voice()->indexOf(this);
 
 	// is there a note with the same start time after ours?
-	if (idx+1<voice()->musElementList().size() && voice()->musElementList()[idx+1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx+1]->timeStart()==_timeStart)
+	if (idx+1<voice()->musElementList().size() && voice()->musElementList()[idx+1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx+1]->timeStart()==timeStart())
 		return true;
 
 	// is there a note with the same start time before ours?
-	if (idx>0 && voice()->musElementList()[idx-1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx-1]->timeStart()==_timeStart)
+	if (idx>0 && voice()->musElementList()[idx-1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx-1]->timeStart()==timeStart())
 		return true;
 
 	return false;
@@ -164,10 +164,10 @@ bool CANote::isPartOfChord() {
 	Returns true, if the note is the first in the list of the chord; otherwise false.
 */
 bool CANote::isFirstInChord() {
-	int idx = voice()->musElementList().indexOf(this);
+	int idx = voice()->indexOf(this);
 
 	//is there a note with the same start time before ours?
-	if (idx>0 && voice()->musElementList()[idx-1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx-1]->timeStart()==_timeStart)
+	if (idx>0 && voice()->musElementList()[idx-1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx-1]->timeStart()==timeStart())
 		return false;
 
 	return true;
@@ -177,10 +177,10 @@ bool CANote::isFirstInChord() {
 	Returns true, if the note is the last in the list of the chord; otherwise false.
 */
 bool CANote::isLastInChord() {
-	int idx = voice()->musElementList().indexOf(this);
+	int idx = voice()->indexOf(this);
 
 	//is there a note with the same start time after ours?
-	if (idx+1<voice()->musElementList().size() && voice()->musElementList()[idx+1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx+1]->timeStart()==_timeStart)
+	if (idx+1<voice()->musElementList().size() && voice()->musElementList()[idx+1]->musElementType()==CAMusElement::Note && voice()->musElementList()[idx+1]->timeStart()==timeStart())
 		return false;
 
 	return true;
@@ -196,7 +196,7 @@ bool CANote::isLastInChord() {
 */
 QList<CANote*> CANote::getChord() {
 	QList<CANote*> list;
-	int idx = voice()->musElementList().indexOf(this) - 1;
+	int idx = voice()->indexOf(this) - 1;
 
 	while (idx>=0 &&
 	       voice()->musElementList()[idx]->musElementType()==CAMusElement::Note &&
@@ -222,11 +222,26 @@ int CANote::compare(CAMusElement *elt) {
 	return diffs;
 }
 
+unsigned int CANote::contentHash() {
+	unsigned int h = CAPlayable::contentHash();
+	h = combineHash( h, diatonicPitch().noteName() );
+	h = combineHash( h, diatonicPitch().accs() );
+	h = combineHash( h, stemDirection() );
+	h = combineHash( h, forceAccidentals() );
+	h = combineHash( h, tieStart() ? tieStart()->slurStyle()+1 : 0 );
+	h = combineHash( h, slurStart() ? slurStart()->slurDirection()*4 + slurStart()->slurStyle() + 1 : 0 );
+	h = combineHash( h, phrasingSlurStart() ? phrasingSlurStart()->slurDirection()*4 + phrasingSlurStart()->slurStyle() + 1 : 0 );
+	h = combineHash( h, (tieEnd()?1:0) | (slurEnd()?2:0) | (phrasingSlurEnd()?4:0) );
+
+	return h;
+}
+
 /*!
 	Sets the stem direction and update tie, slur and phrasing slur direction.
 */
 void CANote::setStemDirection( CAStemDirection dir ) {
 	_stemDirection = dir;
+	contentChanged();
 }
 
 /*!
@@ -36,6 +36,7 @@ public:
 	inline void setDiatonicPitch( CADiatonicPitch pitch ) {
 		_diatonicPitch = pitch;
 		updateTies();
+		contentChanged();
 	}
 	inline int midiPitch() { return _diatonicPitch.midiPitch(); }
 
@@ -54,12 +55,12 @@ public:
 	CAStemDirection         actualStemDirection();
 	CASlur::CASlurDirection actualSlurDirection();
 
-	inline void setTieStart( CASlur *tieStart ) { _tieStart = tieStart; }
-	inline void setTieEnd( CASlur *tieEnd ) { _tieEnd = tieEnd; }
-	inline void setSlurStart( CASlur *slurStart ) { _slurStart = slurStart; }
-	inline void setSlurEnd( CASlur *slurEnd ) { _slurEnd = slurEnd; }
-	inline void setPhrasingSlurStart( CASlur *pSlurStart ) { _phrasingSlurStart = pSlurStart; }
-	inline void setPhrasingSlurEnd( CASlur *pSlurEnd ) { _phrasingSlurEnd = pSlurEnd; }
+	inline void setTieStart( CASlur *tieStart ) { _tieStart = tieStart; contentChanged(); }
+	inline void setTieEnd( CASlur *tieEnd ) { _tieEnd = tieEnd; contentChanged(); }
+	inline void setSlurStart( CASlur *slurStart ) { _slurStart = slurStart; contentChanged(); }
+	inline void setSlurEnd( CASlur *slurEnd ) { _slurEnd = slurEnd; contentChanged(); }
+	inline void setPhrasingSlurStart( CASlur *pSlurStart ) { _phrasingSlurStart = pSlurStart; contentChanged(); }
+	inline void setPhrasingSlurEnd( CASlur *pSlurEnd ) { _phrasingSlurEnd = pSlurEnd; contentChanged(); }
 
 	void updateTies();
 
@@ -69,7 +70,7 @@ public:
 	QList<CANote*> getChord();
 
 	bool forceAccidentals() { return _forceAccidentals; }
-	void setForceAccidentals(bool force) { _forceAccidentals = force; }
+	void setForceAccidentals(bool force) { _forceAccidentals = force; contentChanged(); }
 
 	static const QString generateNoteName(int pitch, int accs);
 
@@ -77,6 +78,7 @@ public:
 	static CAStemDirection stemDirectionFromString(const QString);
 
 	int compare(CAMusElement* elt);
+	unsigned int contentHash();
 
 private:
 	CADiatonicPitch _diatonicPitch;
@@ -90,3 +90,11 @@ void CAPlayable::resetTime() {
 
 	calculateTimeLength();
 }
+
+unsigned int CAPlayable::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, _playableLength.musicLength() );
+	h = combineHash( h, _playableLength.dotted() );
+
+	return h;
+}
@@ -21,7 +21,7 @@ public:
 	virtual ~CAPlayable();
 
 	inline CAPlayableLength& playableLength() { return _playableLength; }
-	inline void setPlayableLength( CAPlayableLength& l ) { _playableLength = l; }
+	inline void setPlayableLength( CAPlayableLength& l ) { _playableLength = l; contentChanged(); }
 	virtual CAPlayable* clone(CAContext* context) { CAPlayable* pl = clone(); pl->setContext(context); return pl; }
 	virtual CAPlayable* clone(CAVoice* voice=0)=0;
 
@@ -38,6 +38,8 @@ public:
 	void resetTime();
 	void calculateTimeLength();
 
+	unsigned int contentHash();
+
 protected:
 	CAPlayableLength _playableLength;
 	CAVoice *_voice;
@@ -99,122 +99,217 @@ const QString CAPlayableLength::musicLengthToString(CAPlayableLength::CAMusicLen
 	}
 }
 
+/*!
+	Time lengths of music lengths from breve to hundred-twenty-eighth (rows) with 0 to MaxDots dots (columns).
+	Dotted lengths are rounded the same way as the length factors in the previous floating point
+	computation (eg. hundred-twenty-eighth with four dots is 15.5 and rounded to 16).
+*/
+static const int TimeLengthTable[9][CAPlayableLength::MaxDots+1] = {
+	{ 2048, 3072, 3584, 3840, 3968 }, // breve
+	{ 1024, 1536, 1792, 1920, 1984 }, // whole
+	{  512,  768,  896,  960,  992 }, // half
+	{  256,  384,  448,  480,  496 }, // quarter
+	{  128,  192,  224,  240,  248 }, // eighth
+	{   64,   96,  112,  120,  124 }, // sixteenth
+	{   32,   48,   56,   60,   62 }, // thirty-second
+	{   16,   24,   28,   30,   31 }, // sixty-fourth
+	{    8,   12,   14,   15,   16 }  // hundred-twenty-eighth
+};
+
+/*!
+	Returns the row of the given music length \a l in the TimeLengthTable or -1, if the length is undefined.
+*/
+static inline int musicLengthIndex( CAPlayableLength::CAMusicLength l ) {
+	switch ( l ) {
+		case CAPlayableLength::Breve:               return 0;
+		case CAPlayableLength::Whole:               return 1;
+		case CAPlayableLength::Half:                return 2;
+		case CAPlayableLength::Quarter:             return 3;
+		case CAPlayableLength::Eighth:              return 4;
+		case CAPlayableLength::Sixteenth:           return 5;
+		case CAPlayableLength::ThirtySecond:        return 6;
+		case CAPlayableLength::SixtyFourth:         return 7;
+		case CAPlayableLength::HundredTwentyEighth: return 8;
+		default:                                    return -1;
+	}
+}
+
 /*!
 	Converts internal enum playableLength to actual timeLength.
 
+	Lengths with up to MaxDots dots are read from a precomputed table.
+
 	\sa CARest::composeRests()
 */
 const int CAPlayableLength::playableLengthToTimeLength( CAPlayableLength length ) {
-	int timeLength;
+	int idx = musicLengthIndex( length.musicLength() );
+	if ( idx==-1 ) {
+		return 0; // This should never occur!
+	}
 
-	switch ( length.musicLength() ) {
-		case HundredTwentyEighth:
-			timeLength = 8;
-			break;
-		case SixtyFourth:
-			timeLength = 16;
-			break;
-		case ThirtySecond:
-			timeLength = 32;
-			break;
-		case Sixteenth:
-			timeLength = 64;
-			break;
-		case Eighth:
-			timeLength = 128;
-			break;
-		case Quarter:
-			timeLength = 256;
-			break;
-		case Half:
-			timeLength = 512;
-			break;
-		case Whole:
-			timeLength = 1024;
-			break;
-		case Breve:
-			timeLength = 2048;
-			break;
-		default:            // This should never occur!
-			timeLength = 0;
-			break;
+	if ( length.dotted()>=0 && length.dotted()<=MaxDots ) {
+		return TimeLengthTable[idx][length.dotted()];
 	}
 
 	float factor = 1.0, delta=0.5;
 	for (int i=0; i<length.dotted(); i++, factor+=delta, delta/=2); // calculate the length factor out of number of dots
-	timeLength = qRound(timeLength*factor);                         // increase the time length for the factor
+	return qRound(TimeLengthTable[idx][0]*factor);                  // increase the time length for the factor
+}
 
-	return timeLength;
+/*!
+	Returns the actual timeLength of the playable \a length inside the tuplet with the given
+	\a number and \a actualNumber (eg. 3 and 2 for triplets).
+
+	\sa CATuplet
+*/
+const int CAPlayableLength::playableLengthToTimeLength( CAPlayableLength length, int number, int actualNumber ) {
+	if ( number<=0 ) {
+		return playableLengthToTimeLength( length );
+	}
+
+	return ( 2*playableLengthToTimeLength( length )*actualNumber + number ) / ( 2*number ); // rounded
 }
 
 /*!
-	Compute for a given time length the CAPlayableLengths. In the general case
-	this could result in several notes. In the canorus GUI we can have max. 4 dots.
-	By default longer notes appear first in the list, but with negating longNotesFirst
-	the short ones appear first. This is useful for end of bar notes.
+	\class CADurationTable
+	\brief Decomposition of time lengths shorter than two breves into playable lengths
+
+	Every time length shorter than two breves (in steps of hundred-twenty-eighths) is decomposed
+	once for every dots limit. timeLengthToPlayableLengths() then only copies the entry.
+*/
+class CADurationTable {
+public:
+	enum {
+		Step = 8,          // hundred-twenty-eighth
+		Range = 2*2048,    // two breves
+		MaxEntryLength = 9 // one length per bit at most
+	};
+
+	struct CAEntry {
+		unsigned char count;
+		unsigned char musicLength[MaxEntryLength];
+		unsigned char dotted[MaxEntryLength];
+	};
+
+	CADurationTable();
+	inline const CAEntry& entry( int dotsLimit, int timeLength ) const { return _entries[dotsLimit][timeLength/Step]; }
+
+private:
+	CAEntry _entries[CAPlayableLength::MaxDots+1][Range/Step];
+};
+
+/*!
+	Fills the table.
 
 	To make this computation fast we take in account that note durations are
 	a binary presentation of the time duration. The breve value is not exactly
 	a log2 value, so we do this singular nonlinear operation through the method of
 	computation (see **).
+*/
+CADurationTable::CADurationTable() {
+	const int breveTime = TimeLengthTable[0][0];
+
+	for (int dotsLimit=0; dotsLimit<=CAPlayableLength::MaxDots; dotsLimit++) {
+		for (int t=0; t<Range; t+=Step) {
+			CAEntry &e = _entries[dotsLimit][t/Step];
+			e.count = 0;
+
+			int workTime = t;
+			int currentTime = breveTime;
+			int logCurrentMusLenPlusOne = 0;
+			int dots = 0;
+			bool findNote = true;
+			while (workTime && (currentTime >= Step)) {
+				if (findNote) {
+					if (workTime & currentTime) {
+						// Now we reverse log2 and exponentiate and do the nonlinear mapping of breve (**)
+						// when the value 1 is erased by division with 2::
+						e.musicLength[e.count] = (1<<logCurrentMusLenPlusOne)/2;
+						e.dotted[e.count] = 0;
+						e.count++;
+						dots = dotsLimit;
+						findNote = dotsLimit > 0 ? false : true;
+					} else {
+						findNote = true;
+					}
+				} else {
+					// try to find a dot for the current note
+					if (workTime & currentTime) {
+						e.dotted[e.count-1]++;
+						dots--;
+						findNote = dots > 0 ? false : true;
+					} else
+						findNote = true;
+				}
+				workTime &= ~currentTime;
+				currentTime /= 2;
+				logCurrentMusLenPlusOne++;
+			}
+		}
+	}
+}
+
+static const CADurationTable& durationTable() {
+	static const CADurationTable table;
+	return table;
+}
+
+/*!
+	Compute for a given time length the CAPlayableLengths. In the general case
+	this could result in several notes. In the canorus GUI we can have max. 4 dots.
+	By default longer notes appear first in the list, but with negating longNotesFirst
+	the short ones appear first. This is useful for end of bar notes.
 
 	Limitations: Maximum four dots per note, and the smallest resulting time duration
-	is SixtyFourth;
+	is HundredTwentyEighth;
 
-	Todo: Allow change of limitations as function parameters, which are longest note
-	and number of dots.
+	\sa timeLengthToPlayableLengths()
 */
 QList<CAPlayableLength> CAPlayableLength::timeLengthToPlayableLengthList( int t, bool longNotesFirst, int dotsLimit ) {
+	CALengthArray list;
+	timeLengthToPlayableLengths( t, list, longNotesFirst, dotsLimit );
 
 	QList<CAPlayableLength> pl;
-	int workTime = t;	// this is the register that decreases for every item processed
-	const int breveTime = playableLengthToTimeLength( Breve );
+	for (int i=0; i<list.size(); i++) {
+		pl << list[i];
+	}
+	return pl;
+}
+
+/*!
+	Appends the playable lengths of the given time length \a t to the \a list.
+	This is the same as timeLengthToPlayableLengthList(), but it doesn't allocate any memory
+	for short lists and the decomposition is read from a precomputed table.
+*/
+void CAPlayableLength::timeLengthToPlayableLengths( int t, CALengthArray& list, bool longNotesFirst, int dotsLimit ) {
+	if ( t<=0 ) {
+		return;
+	}
+
+	if (dotsLimit > MaxDots) dotsLimit = MaxDots;
+	if (dotsLimit < 0) dotsLimit = 0;
 
-	int leadingBreves = workTime & ~(2*breveTime-1);
-	while (leadingBreves>=breveTime) {
-		pl << CAPlayableLength( Breve );
-		leadingBreves -= breveTime;
+	int first = list.size();
+
+	// leading breves which don't fit into the table
+	for (int i=t/CADurationTable::Range*2; i>0; i--) {
+		list.append( CAPlayableLength( Breve ) );
 	}
 
-	// Now only maximum one breve with possibly many dots is left
-	workTime &= 2*breveTime-1;
 	// and as a safety measure we suppress time elements smaller than 128ths.
-	workTime &= ~(playableLengthToTimeLength( HundredTwentyEighth )-1);
-	if (dotsLimit > 4) dotsLimit = 4;
-
-	int currentTime = breveTime;
-	int logCurrentMusLenPlusOne = 0;
-	int dots;
-	bool findNote = true;
-	while (workTime && (currentTime >= musicLengthToTimeLength( HundredTwentyEighth ))) {
-
-		if (findNote) {
-			if (workTime & currentTime) {
-				// Now we reverse log2 and exponentiate and do the nonlinear mapping of breve (**)
-				// when the value 1 is erased by division with 2::
-				pl << CAPlayableLength( CAMusicLength( (1<<logCurrentMusLenPlusOne)/2 ));
-				dots = dotsLimit;
-				findNote = dotsLimit > 0 ? false : true;
-			} else {
-				findNote = true;
-			}
-		} else {
-			// try to find a dot for the current note
-			if (workTime & currentTime) {
-				pl.back().setDotted( pl.back().dotted() + 1 );
-				dots--;
-				findNote = dots > 0 ? false : true;
-			} else
-				findNote = true;
-		}
-		workTime &= ~currentTime;
-		currentTime /= 2;
-		logCurrentMusLenPlusOne++;
+	const CADurationTable::CAEntry &e = durationTable().entry( dotsLimit, t % CADurationTable::Range );
+	for (int i=0; i<e.count; i++) {
+		list.append( CAPlayableLength( static_cast<CAMusicLength>(e.musicLength[i]), e.dotted[i] ) );
 	}
+
 	// If not short notes first, for example at the end of bar, we reverse the list.
-	int i,j;
-	if (!longNotesFirst) for( i=0, j=pl.size()-1; i<j ; i++,j-- ) pl.swap(i,j);
-	return pl;
+	if (!longNotesFirst) {
+		for (int i=first, j=list.size()-1; i<j; i++, j--) {
+			CAPlayableLength l = list[i];
+			list[i] = list[j];
+			list[j] = l;
+		}
+	}
 }
 
 /*!
@@ -264,17 +359,21 @@ QList<CAPlayableLength> CAPlayableLength::matchToBars( CAPlayableLength len, int
 	int noteLen = len.playableLengthToTimeLength( len );
 
 	// now we really do a split
-	QList<CAPlayableLength> list;
+	CALengthArray split;
 	int tSplit = barRest ? barRest : barLength;
 	bool longNotesFirst = barRest ? false : true;
 	while (noteLen) {
 		tSplit = tSplit > noteLen ? noteLen : tSplit;
-		list << timeLengthToPlayableLengthList( tSplit, longNotesFirst, dotsLimit );
+		timeLengthToPlayableLengths( tSplit, split, longNotesFirst, dotsLimit );
 		noteLen -= tSplit;
 		tSplit = noteLen > barLength ? barLength : noteLen;
 		longNotesFirst = true;
 	}
 
+	QList<CAPlayableLength> list;
+	for (int i=0; i<split.size(); i++) {
+		list << split[i];
+	}
 	return list;
 }
 
@@ -290,8 +389,22 @@ QList<CAPlayableLength> CAPlayableLength::matchToBars( CAPlayableLength len, int
 	merged.
 */
 QList<CAPlayableLength> CAPlayableLength::matchToBars( int timeLength, int timeStart, CABarline *lastBarline, CATimeSignature *ts, int dotsLimit, int separationTime ) {
+	CALengthArray split;
+	matchToBars( timeLength, timeStart, lastBarline, ts, split, dotsLimit, separationTime );
 
 	QList<CAPlayableLength> list;
+	for (int i=0; i<split.size(); i++) {
+		list << split[i];
+	}
+	return list;
+}
+
+/*!
+	Appends the split playable lengths to the given \a list instead of returning a new list.
+	The split is done without allocating any memory, if the \a list is short enough.
+	This is used in the inner loops of the midi import.
+*/
+void CAPlayableLength::matchToBars( int timeLength, int timeStart, CABarline *lastBarline, CATimeSignature *ts, CALengthArray& list, int dotsLimit, int separationTime ) {
 	// default time signature is 4/4
 	int barLength = CAPlayableLength::playableLengthToTimeLength( CAPlayableLength::Quarter ) * 4;
 	if (ts) {
@@ -303,7 +416,7 @@ QList<CAPlayableLength> CAPlayableLength::matchToBars( int timeLength, int timeS
 		case 16:
 		case 1:
 		case 32:	break;
-		default:	return list; // If something is strange or undoable we prepare for returning an empty list!
+		default:	return; // If something is strange or undoable we prepare for returning an empty list!
 		}
 		barLength = CAPlayableLength::playableLengthToTimeLength(
 				CAPlayableLength( static_cast<CAPlayableLength::CAMusicLength>(ts->beat()) ) ) * ts->beats();
@@ -331,13 +444,11 @@ QList<CAPlayableLength> CAPlayableLength::matchToBars( int timeLength, int timeS
 	while (noteLen) {
 		tSplit = tSplit > noteLen ? noteLen : tSplit;
 		int decr = (tSplit < sepRest) || (sepRest <= 0) ? tSplit : sepRest;
-		list << timeLengthToPlayableLengthList( decr, longNotesFirst, dotsLimit );
+		timeLengthToPlayableLengths( decr, list, longNotesFirst, dotsLimit );
 		noteLen -= decr;
 		sepRest -= decr;
 		tSplit = noteLen > barLength ? barLength : noteLen;
 		longNotesFirst = true;
 	}
-
-	return list;
 }
 
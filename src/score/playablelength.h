@@ -9,6 +9,8 @@
 #define PLAYABLELENGTH_H_
 
 #include <QString>
+#include <QList>
+#include <QVarLengthArray>
 
 class CABarline;
 class CATimeSignature;
@@ -28,6 +30,14 @@ public:
 		HundredTwentyEighth = 128
 	};
 
+	enum {
+		MaxDots = 4 // maximum number of dots in the time length tables
+	};
+
+#ifndef SWIG
+	typedef QVarLengthArray<CAPlayableLength, 16> CALengthArray; // stack allocated list of lengths
+#endif
+
 	CAPlayableLength();
 	CAPlayableLength( CAMusicLength l, int dotted=0 );
 
@@ -44,12 +54,17 @@ public:
 	static CAMusicLength musicLengthFromString( const QString length );
 
 	static const int playableLengthToTimeLength( CAPlayableLength length );
+	static const int playableLengthToTimeLength( CAPlayableLength length, int number, int actualNumber );
 	inline static const int musicLengthToTimeLength( CAMusicLength l ) {
 		return playableLengthToTimeLength( CAPlayableLength(l) );
 	}
 	static QList<CAPlayableLength> timeLengthToPlayableLengthList( int timeLength, bool longNotesFirst = true, int dotsLimit = 4 );
 	static QList<CAPlayableLength> matchToBars( CAPlayableLength len, int timeStart, CABarline *lastBarline, CATimeSignature *ts, int dotsLimit = 4 );
 	static QList<CAPlayableLength> matchToBars( int timeLength, int timeStart, CABarline *lastBarline, CATimeSignature *ts, int dotsLimit = 4, int separiationTime = 0 );
+#ifndef SWIG
+	static void timeLengthToPlayableLengths( int timeLength, CALengthArray& list, bool longNotesFirst = true, int dotsLimit = 4 );
+	static void matchToBars( int timeLength, int timeStart, CABarline *lastBarline, CATimeSignature *ts, CALengthArray& list, int dotsLimit = 4, int separationTime = 0 );
+#endif
 
 private:
 	CAMusicLength _musicLength; // note, rest length (half, whole, quarter)
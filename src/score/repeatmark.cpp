@@ -43,6 +43,14 @@ int CARepeatMark::compare( CAMusElement *elt ) {
 		return 0;
 }
 
+unsigned int CARepeatMark::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, repeatMarkType() );
+	h = combineHash( h, voltaNumber() );
+
+	return h;
+}
+
 const QString CARepeatMark::repeatMarkTypeToString( CARepeatMarkType t ) {
 	switch (t) {
 	case (Undefined):
@@ -24,7 +24,7 @@
 */
 CARest::CARest( CARestType type, CAPlayableLength length, CAVoice *voice, int timeStart, int timeLength )
  : CAPlayable( length, voice, timeStart, timeLength ) {
- 	_musElementType = CAMusElement::Rest;
+ 	setMusElementType( CAMusElement::Rest );
  	_restType = type;
 }
 
@@ -55,6 +55,13 @@ int CARest::compare(CAMusElement *elt) {
 	return diffs;
 }
 
+unsigned int CARest::contentHash() {
+	unsigned int h = CAPlayable::contentHash();
+	h = combineHash( h, restType() );
+
+	return h;
+}
+
 /*!
 	Converts rest type CARestType to QString.
 	This is usually used when saving the score.
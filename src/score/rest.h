@@ -26,9 +26,10 @@ public:
 	CARest *clone(CAVoice* voice = 0);
 
 	CARestType restType() { return _restType; }
-	void setRestType( CARestType type ) { _restType = type; }
+	void setRestType( CARestType type ) { _restType = type; contentChanged(); }
 
 	int compare(CAMusElement *elt);
+	unsigned int contentHash();
 
 	static const QString restTypeToString(CARestType);
 	static CARestType restTypeFromString(const QString);
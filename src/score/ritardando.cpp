@@ -7,6 +7,8 @@
 
 #include "score/ritardando.h"
 #include "score/playable.h"
+#include "score/sheet.h"
+#include "score/tempomap.h"
 
 /*!
 	\class CARitardando
@@ -29,6 +31,17 @@ CARitardando::CARitardando( int finalTempo, CAPlayable *p, int timeLength, CARit
 CARitardando::~CARitardando() {
 }
 
+/*!
+	Sets the tempo at the end of the ritardando to \a t and updates the tempo map of the sheet.
+*/
+void CARitardando::setFinalTempo( const int t ) {
+	_finalTempo = t;
+	contentChanged();
+
+	if ( context() && context()->sheet() )
+		context()->sheet()->tempoMap()->invalidate();
+}
+
 CARitardando* CARitardando::clone(CAMusElement* elt) {
 	return new CARitardando( finalTempo(), (elt->isPlayable())?static_cast<CAPlayable*>(elt):0, timeLength(), ritardandoType() );
 }
@@ -49,6 +62,14 @@ int CARitardando::compare( CAMusElement *elt ) {
 	return 0;
 }
 
+unsigned int CARitardando::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, finalTempo() );
+	h = combineHash( h, ritardandoType() );
+
+	return h;
+}
+
 const QString CARitardando::ritardandoTypeToString( CARitardandoType t ) {
 	switch (t) {
 	case Ritardando:
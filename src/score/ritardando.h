@@ -24,11 +24,12 @@ public:
 
 	CARitardando *clone(CAMusElement* elt=0);
 	int compare( CAMusElement* );
+	unsigned int contentHash();
 
 	inline const int finalTempo() { return _finalTempo; }
-	inline void setFinalTempo( const int t ) { _finalTempo = t; }
+	void setFinalTempo( const int t );
 	inline const CARitardandoType ritardandoType() { return _ritardandoType; }
-	inline void setRitardandoType( CARitardandoType t ) { _ritardandoType = t; }
+	inline void setRitardandoType( CARitardandoType t ) { _ritardandoType = t; contentChanged(); }
 
 	static const QString ritardandoTypeToString( CARitardandoType t );
 	static CARitardandoType ritardandoTypeFromString( const QString r );
@@ -14,7 +14,12 @@
 #include "score/sheet.h"
 #include "score/voice.h"
 #include "score/lyricscontext.h"
+#include "score/functionmarkcontext.h"
+#include "score/figuredbasscontext.h"
 #include "score/tempo.h"
+#include "score/tempomap.h"
+#include "score/sheetsnapshot.h"
+#include "score/sheetcolumns.h"
 #include "score/notecheckererror.h"
 
 /*!
@@ -36,10 +41,15 @@
 CASheet::CASheet(const QString name, CADocument *doc) {
 	_name = name;
 	_document = doc;
+	_tempoMap = new CATempoMap( this );
+	_chordsDirtyTime = -1;
+	_chordsRevision = 0;
+	_hash = 0;
+	_hashValid = false;
 }
 
 CASheet::~CASheet() {
-
+	delete _tempoMap;
 }
 
 /*!
@@ -85,17 +95,19 @@ CAStaff *CASheet::addStaff() {
 	s->addVoice();
 
 	_contextList.append(s);
+	invalidateHash();
 
 	return s;
 }
 
 void CASheet::clear() {
-	for (int i=0; i<_contextList.size(); i++) {
-		_contextList[i]->clear();
-		delete _contextList[i];
+	// take the context out of the list first, so staffs don't notify the deleted contexts
+	while ( !_contextList.isEmpty() ) {
+		CAContext *c = _contextList.takeFirst();
+		c->clear();
+		delete c;
 	}
-
-	_contextList.clear();
+	invalidateHash();
 }
 
 /*!
@@ -127,19 +139,116 @@ QList<CAPlayable*> CASheet::getChord(int time) {
 	return chordList;
 }
 
+/*!
+	Tells the contexts assigned to the chords of the sheet (function marks and figured bass)
+	that the chords from \a timeStart on have changed.
+
+	Staffs call this on every change, so the contexts are not notified directly. The earliest
+	changed time is kept in the sheet and the contexts read it when repositioning their elements,
+	if chordsRevision() has changed since.
+
+	\sa chordsDirtyTime(), updateChordsDirtyTime(), CAStaff::invalidateVoices()
+*/
+void CASheet::invalidateChords( int timeStart ) {
+	if ( _chordsDirtyTime==-1 || timeStart<_chordsDirtyTime ) {
+		_chordsDirtyTime = timeStart;
+	}
+	_chordsRevision++;
+}
+
+/*!
+	Clears the chords dirty time, when all the function mark and figured bass contexts have read
+	it. The contexts call this after repositioning their elements.
+
+	\sa invalidateChords()
+*/
+void CASheet::updateChordsDirtyTime() {
+	for (int i=0; i<_contextList.size(); i++) {
+		switch ( _contextList[i]->contextType() ) {
+		case CAContext::FunctionMarkContext:
+			if ( static_cast<CAFunctionMarkContext*>(_contextList[i])->chordsRevision()!=_chordsRevision )
+				return;
+			break;
+		case CAContext::FiguredBassContext:
+			if ( static_cast<CAFiguredBassContext*>(_contextList[i])->chordsRevision()!=_chordsRevision )
+				return;
+			break;
+		default:
+			break;
+		}
+	}
+
+	_chordsDirtyTime = -1;
+}
+
 /*!
 	Returns the Tempo element active at the given time.
+
+	\sa tempoMap()
  */
 CATempo *CASheet::getTempo( int time ) {
-	CATempo *tempo = 0;
-	for (int i=0; i<staffList().size(); i++) {
-		CATempo *t = staffList()[i]->getTempo(time);
-		if ( t && (!tempo || t->timeStart() > tempo->timeStart()) ) {
-			tempo = t;
+	return tempoMap()->tempoAt( time );
+}
+
+/*!
+	Returns the hash of the sheet content.
+
+	The hash is combined from the hashes of the contexts in the sheet. Staffs and lyrics report
+	their changes by CAContext::invalidateHash(), so their part of the hash is cached until one of
+	them or the list of contexts changes. Function marks and figured bass don't report changes of
+	their marks, so their hashes are combined on each call together with their index.
+
+	\sa invalidateHash(), CAContext::contentHash(), CADocument::contentHash()
+*/
+unsigned int CASheet::contentHash() {
+	if ( !_hashValid ) {
+		_hash = qHash( name() );
+		for (int i=0; i<_contextList.size(); i++) {
+			if ( _contextList[i]->contextType()==CAContext::Staff || _contextList[i]->contextType()==CAContext::LyricsContext ) {
+				_hash = CAMusElement::combineHash( _hash, _contextList[i]->contentHash() );
+			}
 		}
+		_hash = CAMusElement::combineHash( _hash, _contextList.size() );
+		_hashValid = true;
+	}
+
+	unsigned int h = _hash;
+	for (int i=0; i<_contextList.size(); i++) {
+		if ( _contextList[i]->contextType()!=CAContext::Staff && _contextList[i]->contextType()!=CAContext::LyricsContext ) {
+			h = CAMusElement::combineHash( h, i );
+			h = CAMusElement::combineHash( h, _contextList[i]->contentHash() );
+		}
+	}
+
+	return h;
+}
+
+/*!
+	Returns an immutable snapshot of the sheet for playback, exporters and other threads.
+	Call this from the thread owning the sheet.
+
+	\sa CASheetSnapshot
+*/
+QSharedPointer<const CASheetSnapshot> CASheet::snapshot() {
+	return QSharedPointer<const CASheetSnapshot>( new CASheetSnapshot(this) );
+}
+
+/*!
+	Returns the columnar view of the sheet.
+
+	The columns are cached until the document is modified (see CADocument::version()).
+	Changes not registered by the document yet (eg. right after an edit, before the undo
+	command is pushed, or from scripts not using the undo) require calling invalidateColumns()
+	first. Call this from the thread owning the sheet.
+
+	\sa CASheetColumns, snapshot()
+*/
+QSharedPointer<const CASheetColumns> CASheet::columns() {
+	if ( !_columns || !document() || _columns->version()!=document()->version() ) {
+		_columns = QSharedPointer<const CASheetColumns>( new CASheetColumns( snapshot().data() ) );
 	}
 
-	return tempo;
+	return _columns;
 }
 
 /*!
@@ -176,6 +285,9 @@ void CASheet::insertContextAfter( CAContext *after, CAContext *c ) {
 	} else {
 		_contextList.insert(idx+1, c);
 	}
+
+	invalidateChords(0);
+	invalidateHash();
 }
 
 /*!
@@ -10,6 +10,7 @@
 
 #include <QString>
 #include <QList>
+#include <QSharedPointer>
 
 #include "score/context.h"
 #include "score/staff.h"
@@ -18,6 +19,9 @@ class CADocument;
 class CAPlayable;
 class CATempo;
 class CANoteCheckerError;
+class CATempoMap;
+class CASheetSnapshot;
+class CASheetColumns;
 
 class CASheet {
 public:
@@ -28,23 +32,34 @@ public:
 
 	inline const QList<CAContext*>& contextList() { return _contextList; }
 	CAContext *findContext(const QString name);
-	inline void insertContext( int pos, CAContext *c) { _contextList.insert( pos, c ); }
+	inline void insertContext( int pos, CAContext *c) { _contextList.insert( pos, c ); invalidateChords(0); invalidateHash(); }
 	void insertContextAfter( CAContext *after, CAContext *c );
-	inline void addContext( CAContext* c ) { _contextList << c; }
-	inline void removeContext( CAContext* c ) { _contextList.removeAll(c); }
+	inline void addContext( CAContext* c ) { _contextList << c; invalidateChords(0); invalidateHash(); }
+	inline void removeContext( CAContext* c ) { _contextList.removeAll(c); invalidateChords(0); invalidateHash(); }
 
 	CAStaff *addStaff();
 	QList<CAStaff*> staffList(); // generated list
 	QList<CAVoice*> voiceList(); // generated list
 
 	QList<CAPlayable*> getChord(int time);
+	void invalidateChords(int timeStart);
+	inline int chordsDirtyTime() { return _chordsDirtyTime; }
+	inline int chordsRevision() { return _chordsRevision; }
+	void updateChordsDirtyTime();
 	CATempo           *getTempo(int time);
+	inline CATempoMap *tempoMap() { return _tempoMap; }
+
+#ifndef SWIG
+	QSharedPointer<const CASheetSnapshot> snapshot();
+	QSharedPointer<const CASheetColumns> columns();
+	inline void invalidateColumns() { _columns.clear(); }
+#endif
 	
 	inline CADocument *document() { return _document; }
 	inline void setDocument(CADocument *doc) { _document = doc; }
 
 	inline const QString name() { return _name; }
-	inline void setName(const QString name) { _name = name; }
+	inline void setName(const QString name) { _name = name; invalidateHash(); }
 
 	inline void addNoteCheckerError(CANoteCheckerError *nce) { _noteCheckerErrorList << nce; }
 	void clearNoteCheckerErrors();
@@ -52,10 +67,21 @@ public:
 	
 	void clear();
 
+	unsigned int contentHash();
+	inline void invalidateHash() { _hashValid = false; }
+
 private:
 	QList<CAContext *> _contextList;
 	CADocument *_document;
 	QList<CANoteCheckerError*> _noteCheckerErrorList;
+	CATempoMap *_tempoMap;
+	int _chordsDirtyTime; // chords have changed from this time on since the contexts read it, -1 if unchanged
+	int _chordsRevision;  // increased on every change of the chords
+	unsigned int _hash;   // cached hash of the name, staffs and lyrics
+	bool _hashValid;
+#ifndef SWIG
+	QSharedPointer<const CASheetColumns> _columns; // cached columns, see columns()
+#endif
 
 	QString _name;
 };
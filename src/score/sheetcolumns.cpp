@@ -0,0 +1,93 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <algorithm> // std::stable_sort
+
+#include "score/sheetcolumns.h"
+#include "score/sheetsnapshot.h"
+
+/*!
+	\class CASheetColumns
+	\brief Columnar view of all the music elements in the sheet
+
+	Analytic consumers (MIDI export, note checker, harmony analysis) usually only need the
+	times, pitch, voice and type of the elements. CASheetColumns stores these attributes of all
+	the elements in the sheet in separate contiguous arrays, sorted by their start time. Row i
+	in all the columns describes the same element. Scanning a single column is cache friendly
+	and can be vectorized by the compiler.
+
+	Elements starting at the same time keep the order of voices and the order inside the voice.
+
+	The columns are built from the sheet snapshot and are immutable, so they can be read from
+	any thread. Use CASheet::columns() to get the cached columns of the sheet.
+
+	\sa CASheetSnapshot, CASheet::columns()
+*/
+
+struct CAColumnRow {
+	int timeStart;
+	int stream;
+	int event;
+};
+
+static bool rowTimeLessThan( const CAColumnRow& a, const CAColumnRow& b ) {
+	return a.timeStart < b.timeStart;
+}
+
+/*!
+	Builds the columns out of the given \a snapshot.
+*/
+CASheetColumns::CASheetColumns( const CASheetSnapshot *snapshot ) {
+	_version = snapshot->version();
+
+	const QVector<CASheetSnapshot::CAStream>& streams = snapshot->streamList();
+
+	QVector<CAColumnRow> rows;
+	int n = 0;
+	for (int i=0; i<streams.size(); i++) {
+		n += streams[i].eventList.size();
+	}
+	rows.reserve( n );
+
+	for (int i=0; i<streams.size(); i++) {
+		for (int j=0; j<streams[i].eventList.size(); j++) {
+			CAColumnRow r;
+			r.timeStart = streams[i].eventList[j].timeStart;
+			r.stream = i;
+			r.event = j;
+			rows << r;
+		}
+	}
+
+	// voices are already sorted, so this only merges them
+	std::stable_sort( rows.begin(), rows.end(), rowTimeLessThan );
+
+	_timeStart.resize( n );
+	_timeLength.resize( n );
+	_midiPitch.resize( n );
+	_voice.resize( n );
+	_type.resize( n );
+	_element.resize( n );
+
+	for (int i=0; i<n; i++) {
+		const CASheetSnapshot::CAEvent& e = streams[rows[i].stream].eventList[rows[i].event];
+		_timeStart[i] = e.timeStart;
+		_timeLength[i] = e.timeEnd - e.timeStart;
+		_midiPitch[i] = ( e.type==CAMusElement::Note ? e.midiPitch : -1 );
+		_voice[i] = rows[i].stream;
+		_type[i] = e.type;
+		_element[i] = e.element;
+	}
+}
+
+/*!
+	Returns the index of the first row starting at or after the given \a time or size(), if
+	there is no such row.
+*/
+int CASheetColumns::lowerBound( int time ) const {
+	return std::lower_bound( _timeStart.begin(), _timeStart.end(), time ) - _timeStart.begin();
+}
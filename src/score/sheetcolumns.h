@@ -0,0 +1,43 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef SHEETCOLUMNS_H_
+#define SHEETCOLUMNS_H_
+
+#include <QVector>
+
+class CAMusElement;
+class CASheetSnapshot;
+
+class CASheetColumns {
+public:
+	CASheetColumns( const CASheetSnapshot *snapshot );
+
+	inline unsigned int version() const { return _version; }
+	inline int size() const { return _timeStart.size(); }
+
+	inline const QVector<int>& timeStartColumn() const { return _timeStart; }
+	inline const QVector<int>& timeLengthColumn() const { return _timeLength; }
+	inline const QVector<short>& midiPitchColumn() const { return _midiPitch; }
+	inline const QVector<unsigned short>& voiceColumn() const { return _voice; }
+	inline const QVector<unsigned char>& typeColumn() const { return _type; }
+	inline const QVector<CAMusElement*>& elementColumn() const { return _element; }
+
+	int lowerBound( int time ) const;
+
+private:
+	unsigned int _version;
+
+	QVector<int> _timeStart;
+	QVector<int> _timeLength;
+	QVector<short> _midiPitch;         // -1 for non-notes
+	QVector<unsigned short> _voice;    // index of the stream in the snapshot
+	QVector<unsigned char> _type;      // CAMusElement::CAMusElementType
+	QVector<CAMusElement*> _element;   // original elements, only used as identifiers
+};
+
+#endif /* SHEETCOLUMNS_H_ */
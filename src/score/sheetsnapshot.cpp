@@ -0,0 +1,191 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include "score/sheetsnapshot.h"
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/playable.h"
+#include "score/note.h"
+#include "score/slur.h"
+#include "score/mark.h"
+#include "score/dynamic.h"
+#include "score/instrumentchange.h"
+#include "score/tempo.h"
+#include "score/tempomap.h"
+#include "score/barline.h"
+#include "score/timesignature.h"
+#include "score/keysignature.h"
+
+/*!
+	\class CASheetSnapshot
+	\brief Immutable copy of the sheet content used by other threads
+
+	Playback, exporters and analysis run in their own threads while the user keeps editing
+	the sheet in the GUI thread. Instead of reading the live music elements, these workers
+	read a snapshot of the sheet created by CASheet::snapshot().
+
+	The snapshot stores a stream of flat events for every voice in the sheet. Events contain
+	everything needed for the playback (times, MIDI pitches, ties, dynamics, tempo changes,
+	repeats) and a pointer to the original music element. The pointer is only used to identify
+	the element and must never be dereferenced, as the element might have been changed or
+	destroyed meanwhile and its memory reused by another element. Refer to the events by their
+	CAEventIndex instead and find the elements by liveElement() (eg. for highlighting the currently
+	played notes in the GUI).
+
+	The snapshot is never changed after its creation, so it can be shared between any number
+	of threads without locking. It has to be created in the thread owning the sheet.
+
+	version() contains the modification counter of the document at the time of creation.
+	Compare it to CADocument::version() to find out whether the snapshot is outdated.
+
+	\sa CASheet::snapshot(), CAPlayback
+*/
+
+/*!
+	Creates a snapshot of the given \a sheet.
+*/
+CASheetSnapshot::CASheetSnapshot( CASheet *sheet ) {
+	_version = ( sheet->document() ? sheet->document()->version() : 0 );
+	_sheetName = sheet->name();
+	_tempoMap = sheet->tempoMap()->clone();
+
+	for (int i=0; i<sheet->contextList().size(); i++) {
+		if ( sheet->contextList()[i]->contextType()==CAContext::Staff ) {
+			CAStaff *staff = static_cast<CAStaff*>(sheet->contextList()[i]);
+			for (int j=0; j<staff->voiceList().size(); j++) {
+				_streamList << createStream( staff->voiceList()[j] );
+			}
+		}
+	}
+}
+
+CASheetSnapshot::~CASheetSnapshot() {
+	delete _tempoMap;
+}
+
+/*!
+	Returns the length in miliseconds of \a timeLength time units starting at \a timeStart.
+
+	\sa CATempoMap::timeLengthToMs()
+*/
+int CASheetSnapshot::timeLengthToMs( int timeStart, int timeLength ) const {
+	return _tempoMap->timeLengthToMs( timeStart, timeLength );
+}
+
+/*!
+	Returns the music element of the live \a sheet for the event at the given \a index or 0, if
+	the sheet was changed since the snapshot was taken. Call this from the thread owning the sheet.
+
+	The streams and events are in the same order as the voices and their music elements, so the
+	element is found by its index and checked against the event.
+*/
+CAMusElement *CASheetSnapshot::liveElement( CASheet *sheet, const CAEventIndex& index ) const {
+	if ( !sheet || (sheet->document() && sheet->document()->version()!=_version) ||
+	     index.stream<0 || index.stream>=_streamList.size() ||
+	     index.event<0 || index.event>=_streamList[index.stream].eventList.size() ) {
+		return 0;
+	}
+
+	QList<CAVoice*> voices = sheet->voiceList();
+	if ( voices.size()!=_streamList.size() || index.event>=voices[index.stream]->musElementList().size() ) {
+		return 0;
+	}
+
+	CAMusElement *elt = voices[index.stream]->musElementList()[index.event];
+	const CAEvent& e = _streamList[index.stream].eventList[index.event];
+	if ( elt!=e.element || elt->musElementType()!=e.type || elt->timeStart()!=e.timeStart ) {
+		return 0;
+	}
+
+	return elt;
+}
+
+/*!
+	Returns a stream of events for all the music elements in the given \a voice.
+*/
+CASheetSnapshot::CAStream CASheetSnapshot::createStream( CAVoice *voice ) {
+	CAStream s;
+	s.midiChannel = voice->midiChannel();
+	s.midiProgram = voice->midiProgram();
+
+	const QList<CAMusElement*>& list = voice->musElementList();
+	s.eventList.reserve( list.size() );
+	for (int i=0; i<list.size(); i++) {
+		s.eventList << createEvent( list[i] );
+	}
+
+	return s;
+}
+
+/*!
+	Returns the event describing the music element \a elt.
+*/
+CASheetSnapshot::CAEvent CASheetSnapshot::createEvent( CAMusElement *elt ) {
+	CAEvent e;
+	e.element = elt;
+	e.type = elt->musElementType();
+	e.timeStart = elt->timeStart();
+	e.timeEnd = elt->timeEnd();
+	e.firstInChord = true;
+	e.midiChannel = ( elt->isPlayable() ? static_cast<CAPlayable*>(elt)->voice()->midiChannel() : 0 );
+	e.midiPitch = 0;
+	e.noteOn = false;
+	e.noteOff = false;
+	e.volume = -1;
+	e.instrument = -1;
+	e.tempoBpm = -1;
+	e.beats = 0;
+	e.beat = 0;
+	e.keyAccs = 0;
+	e.minor = false;
+	e.repeatOpen = false;
+	e.repeatClose = false;
+
+	switch ( e.type ) {
+	case CAMusElement::Note: {
+		CANote *note = static_cast<CANote*>(elt);
+		e.firstInChord = note->isFirstInChord();
+		e.midiPitch = CADiatonicPitch::diatonicPitchToMidiPitch( note->diatonicPitch() ) + note->voice()->midiPitchOffset();
+		e.noteOn = !note->tieEnd();
+		e.noteOff = !( note->tieStart() && note->tieStart()->noteEnd() );
+		break;
+	}
+	case CAMusElement::TimeSignature:
+		e.beats = static_cast<CATimeSignature*>(elt)->beats();
+		e.beat = static_cast<CATimeSignature*>(elt)->beat();
+		break;
+	case CAMusElement::KeySignature: {
+		CADiatonicKey dk = static_cast<CAKeySignature*>(elt)->diatonicKey();
+		e.keyAccs = dk.numberOfAccs();
+		e.minor = ( dk.gender()==CADiatonicKey::Minor );
+		break;
+	}
+	case CAMusElement::Barline:
+		e.repeatOpen = ( static_cast<CABarline*>(elt)->barlineType()==CABarline::RepeatOpen );
+		e.repeatClose = ( static_cast<CABarline*>(elt)->barlineType()==CABarline::RepeatClose );
+		break;
+	default:
+		break;
+	}
+
+	if ( e.type==CAMusElement::Note || e.type==CAMusElement::Rest ) {
+		for (int i=0; i<elt->markList().size(); i++) {
+			CAMark *m = elt->markList()[i];
+			if ( m->markType()==CAMark::Tempo ) {
+				e.tempoBpm = static_cast<CATempo*>(m)->bpm();
+			} else if ( e.type==CAMusElement::Note && m->markType()==CAMark::Dynamic ) {
+				e.volume = static_cast<CADynamic*>(m)->volume();
+			} else if ( e.type==CAMusElement::Note && m->markType()==CAMark::InstrumentChange ) {
+				e.instrument = static_cast<CAInstrumentChange*>(m)->instrument();
+			}
+		}
+	}
+
+	return e;
+}
@@ -0,0 +1,77 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef SHEETSNAPSHOT_H_
+#define SHEETSNAPSHOT_H_
+
+#include <QString>
+#include <QVector>
+
+#include "score/muselement.h"
+
+class CASheet;
+class CAVoice;
+class CATempoMap;
+
+class CASheetSnapshot {
+public:
+	struct CAEvent {
+		CAMusElement *element;   // original element, only used as an identifier
+		CAMusElement::CAMusElementType type;
+		int timeStart;
+		int timeEnd;
+		bool firstInChord;       // note is the first one in the chord or not a chord note
+		unsigned char midiChannel; // playables only
+		int midiPitch;           // notes only, including the voice pitch offset
+		bool noteOn;             // note is not tied from the previous note
+		bool noteOff;            // note is not tied to the next note
+		int volume;              // dynamic mark volume in percents or -1
+		int instrument;          // instrument change program or -1
+		int tempoBpm;            // tempo mark or -1
+		int beats;               // time signature only
+		int beat;                // time signature only
+		int keyAccs;             // key signature only
+		bool minor;              // key signature only
+		bool repeatOpen;         // barlines only
+		bool repeatClose;        // barlines only
+	};
+
+	struct CAStream {
+		unsigned char midiChannel;
+		unsigned char midiProgram;
+		QVector<CAEvent> eventList;
+	};
+
+	struct CAEventIndex {
+		int stream;              // index in streamList()
+		int event;               // index in the stream eventList
+	};
+
+	CASheetSnapshot( CASheet *sheet );
+	~CASheetSnapshot();
+
+	inline unsigned int version() const { return _version; }
+	inline const QString& sheetName() const { return _sheetName; }
+	inline const QVector<CAStream>& streamList() const { return _streamList; }
+
+	int timeLengthToMs( int timeStart, int timeLength ) const;
+	CAMusElement *liveElement( CASheet *sheet, const CAEventIndex& index ) const;
+
+	static CAStream createStream( CAVoice *voice );
+	static CAEvent createEvent( CAMusElement *elt );
+
+private:
+	CASheetSnapshot( const CASheetSnapshot& );            // not copyable
+	CASheetSnapshot& operator=( const CASheetSnapshot& );
+
+	unsigned int _version;
+	QString _sheetName;
+	QVector<CAStream> _streamList; // voices of all the staffs in order of appearance
+	CATempoMap *_tempoMap;         // detached copy of the sheet tempo map
+};
+
+#endif /* SHEETSNAPSHOT_H_ */
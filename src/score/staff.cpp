@@ -8,7 +8,9 @@
 #include <QtDebug>
 
 #include <QPainter>
+#include <QHash>
 #include <iostream>
+#include <algorithm> // std::lower_bound
 
 #include "score/voice.h"
 #include "score/staff.h"
@@ -16,9 +18,13 @@
 #include "score/rest.h" // used for voice synchronization
 #include "score/tuplet.h"
 #include "score/tempo.h"
+#include "score/mark.h"
+#include "score/slur.h"
+#include "score/sheet.h"
 
 #include "score/barline.h"
 #include "score/timesignature.h"
+#include "score/measuretable.h"
 
 /*!
 	\class CAStaff
@@ -42,10 +48,21 @@ CAStaff::CAStaff( const QString name, CASheet *s, int numberOfLines) : CAContext
 	_contextType = CAContext::Staff;
 	_numberOfLines = numberOfLines;
 	_name = name;
+	_dirtyTime = 0;
+	_measureTable = new CAMeasureTable( this );
+	_hash = 0;
+	_hashValid = false;
+	_signHash = 0;
+	_signHashValid = false;
 }
 
 CAStaff::~CAStaff() {
 	clear();
+	delete _measureTable;
+
+	for (int r=0; r<4; r++) {
+		qDeleteAll( _signTimeBlockList[r] );
+	}
 }
 
 CAStaff *CAStaff::clone( CASheet *s ) {
@@ -58,18 +75,16 @@ CAStaff *CAStaff::clone( CASheet *s ) {
 
 	int *peltIdx = new int[voiceList().size()];
 	for (int i=0; i<voiceList().size(); i++) peltIdx[i]=0;
-	QList<CANote*> tiedOrigNotes; // original notes having opened tie
-	QList<CANote*> sluredOrigNotes; // original notes having opened slur
-	QList<CANote*> phrasingSluredOrigNotes; // original notes having opened phrasing slur
-	QList<CANote*> tiedClonedNotes; // cloned notes having opened tie
-	QList<CANote*> sluredClonedNotes; // cloned notes having opened slur
-	QList<CANote*> phrasingSluredClonedNotes; // cloned notes having opened phrasing slur
+	QHash<CANote*, CANote*> tiedClonedNotes; // cloned notes having opened tie, by the original end note
+	QHash<CANote*, CANote*> sluredClonedNotes; // cloned notes having opened slur, by the original end note
+	QHash<CANote*, CANote*> phrasingSluredClonedNotes; // cloned notes having opened phrasing slur, by the original end note
 
 	bool done=false;
 	while (!done) {
 		// append playable elements
 		for (int i=0; i<voiceList().size(); i++) {
 			QList<CAPlayable*> elementsUnderTuplet;
+			int segmentStart = newStaff->voiceList()[i]->lastTimeStart();
 
 			// clone elements in the current voice until the non-playable element is reached
 			while ( peltIdx[i]<voiceList()[i]->musElementList().size() && voiceList()[i]->musElementList()[peltIdx[i]]->isPlayable() ) {
@@ -84,56 +99,41 @@ CAStaff *CAStaff::clone( CASheet *s ) {
 					CANote *origNote = static_cast<CANote*>(origElt);
 					CANote *clonedNote = static_cast<CANote*>(clonedElt);
 
-					// check starting ties, slurs, prasing slurs
-					for ( int i=0; i<tiedOrigNotes.size(); i++ ) {
-						if ( tiedOrigNotes[i]->tieStart()->noteEnd()==origNote ) {
-							CASlur *newTie = tiedOrigNotes[i]->tieStart()->clone(newStaff);
-							tiedClonedNotes[i]->setTieStart( newTie );
-							newTie->setNoteStart(tiedClonedNotes[i]);
-							newTie->setNoteEnd(clonedNote);
-							clonedNote->setTieEnd(newTie);
-
-							tiedOrigNotes.removeAt(i);
-							tiedClonedNotes.removeAt(i);
-						}
+					// check ending ties, slurs, prasing slurs
+					if ( origNote->tieEnd() && tiedClonedNotes.contains(origNote) ) {
+						CANote *clonedStart = tiedClonedNotes.take(origNote);
+						CASlur *newTie = origNote->tieEnd()->clone(newStaff);
+						clonedStart->setTieStart( newTie );
+						newTie->setNoteStart(clonedStart);
+						newTie->setNoteEnd(clonedNote);
+						clonedNote->setTieEnd(newTie);
 					}
-					for ( int i=0; i<sluredOrigNotes.size(); i++ ) {
-						if ( sluredOrigNotes[i]->slurStart()->noteEnd()==origNote ) {
-							CASlur *newSlur = sluredOrigNotes[i]->slurStart()->clone(newStaff);
-							sluredClonedNotes[i]->setSlurStart( newSlur );
-							newSlur->setNoteStart(sluredClonedNotes[i]);
-							newSlur->setNoteEnd(clonedNote);
-							clonedNote->setSlurEnd(newSlur);
-
-							sluredOrigNotes.removeAt(i);
-							sluredClonedNotes.removeAt(i);
-						}
+					if ( origNote->slurEnd() && sluredClonedNotes.contains(origNote) ) {
+						CANote *clonedStart = sluredClonedNotes.take(origNote);
+						CASlur *newSlur = origNote->slurEnd()->clone(newStaff);
+						clonedStart->setSlurStart( newSlur );
+						newSlur->setNoteStart(clonedStart);
+						newSlur->setNoteEnd(clonedNote);
+						clonedNote->setSlurEnd(newSlur);
 					}
-					for ( int i=0; i<phrasingSluredOrigNotes.size(); i++ ) {
-						if ( phrasingSluredOrigNotes[i]->phrasingSlurStart()->noteEnd()==origNote ) {
-							CASlur *newPhrasingSlur = phrasingSluredOrigNotes[i]->phrasingSlurStart()->clone(newStaff);
-							phrasingSluredClonedNotes[i]->setPhrasingSlurStart( newPhrasingSlur );
-							newPhrasingSlur->setNoteStart(phrasingSluredClonedNotes[i]);
-							newPhrasingSlur->setNoteEnd(clonedNote);
-							clonedNote->setPhrasingSlurEnd(newPhrasingSlur);
-
-							phrasingSluredOrigNotes.removeAt(i);
-							phrasingSluredClonedNotes.removeAt(i);
-						}
+					if ( origNote->phrasingSlurEnd() && phrasingSluredClonedNotes.contains(origNote) ) {
+						CANote *clonedStart = phrasingSluredClonedNotes.take(origNote);
+						CASlur *newPhrasingSlur = origNote->phrasingSlurEnd()->clone(newStaff);
+						clonedStart->setPhrasingSlurStart( newPhrasingSlur );
+						newPhrasingSlur->setNoteStart(clonedStart);
+						newPhrasingSlur->setNoteEnd(clonedNote);
+						clonedNote->setPhrasingSlurEnd(newPhrasingSlur);
 					}
 
-					// check ending ties, slurs, phrasing slurs
-					if ( origNote->tieStart() ) {
-						tiedOrigNotes << origNote;
-						tiedClonedNotes << static_cast<CANote*>(clonedElt);
+					// check starting ties, slurs, phrasing slurs
+					if ( origNote->tieStart() && origNote->tieStart()->noteEnd() ) {
+						tiedClonedNotes[ origNote->tieStart()->noteEnd() ] = clonedNote;
 					}
-					if ( origNote->slurStart() ) {
-						sluredOrigNotes << origNote;
-						sluredClonedNotes << static_cast<CANote*>(clonedElt);
+					if ( origNote->slurStart() && origNote->slurStart()->noteEnd() ) {
+						sluredClonedNotes[ origNote->slurStart()->noteEnd() ] = clonedNote;
 					}
-					if ( origNote->phrasingSlurStart() ) {
-						phrasingSluredOrigNotes << origNote;
-						phrasingSluredClonedNotes << static_cast<CANote*>(clonedElt);
+					if ( origNote->phrasingSlurStart() && origNote->phrasingSlurStart()->noteEnd() ) {
+						phrasingSluredClonedNotes[ origNote->phrasingSlurStart()->noteEnd() ] = clonedNote;
 					}
 				}
 
@@ -149,7 +149,7 @@ CAStaff *CAStaff::clone( CASheet *s ) {
 
 				peltIdx[i]++;
 			}
-			newStaff->voiceList()[i]->synchronizeMusElements();
+			newStaff->voiceList()[i]->synchronizeMusElements( segmentStart );
 		}
 
 		// append non-playable elements (shared by all voices - only create clone of the first voice element and append it to all)
@@ -196,6 +196,80 @@ void CAStaff::clear() {
 	}
 }
 
+/*!
+	Returns the hash of the staff content including all its voices and the shared signs.
+
+	The hash is cached. Voices only rehash the time blocks which were changed since the last
+	call, so the hash of a slightly changed staff is cheap to get. Shared signs are hashed the
+	same way by their time blocks relative to the block offsets.
+
+	\sa invalidateHash(), CAVoice::contentHash()
+*/
+unsigned int CAStaff::contentHash() {
+	if ( _hashValid ) {
+		return _hash;
+	}
+
+	if ( !_signHashValid ) {
+		_signHash = 0;
+		for (int r=0; r<4; r++) {
+			for (int i=0; i<_signTimeBlockList[r].size(); i++) {
+				CATimeBlock *block = _signTimeBlockList[r][i];
+				if ( !block->isHashValid() ) {
+					rehashSignBlock( r, block );
+				}
+				_signHash = CAMusElement::combineHash( _signHash, block->hash() );
+				_signHash = CAMusElement::combineHash( _signHash, block->offset() );
+			}
+			_signHash = CAMusElement::combineHash( _signHash, _signTimeBlockList[r].size() );
+		}
+		_signHashValid = true;
+	}
+
+	_hash = CAMusElement::combineHash( qHash(name()), contextType() );
+	_hash = CAMusElement::combineHash( _hash, numberOfLines() );
+	_hash = CAMusElement::combineHash( _hash, _signHash );
+	for (int i=0; i<_voiceList.size(); i++) {
+		_hash = CAMusElement::combineHash( _hash, _voiceList[i]->contentHash() );
+	}
+	_hashValid = true;
+
+	return _hash;
+}
+
+/*!
+	Invalidates the cached hash of the staff and the part of its content the music element
+	\a elt belongs to: the time block and the voice of a playable element or the time block of
+	a shared sign. Marks and slurs invalidate the element they belong to.
+
+	\sa contentHash(), CAContext::invalidateHash()
+*/
+void CAStaff::invalidateHash( CAMusElement *elt ) {
+	if ( elt && elt->musElementType()==CAMusElement::Mark ) {
+		elt = static_cast<CAMark*>(elt)->associatedElement();
+	} else if ( elt && elt->musElementType()==CAMusElement::Slur ) {
+		elt = static_cast<CASlur*>(elt)->noteStart();
+	}
+
+	if ( elt && elt->isPlayable() ) {
+		if ( elt->timeBlock() ) { // element is part of the voice
+			elt->timeBlock()->invalidateHash( elt );
+			static_cast<CAPlayable*>(elt)->voice()->invalidateHash();
+		}
+	} else if ( elt ) {
+		if ( elt->timeBlock() ) {
+			elt->timeBlock()->invalidateHash( elt );
+		}
+		_signHashValid = false;
+
+		// eg. barline changed to or from dotted or the time signature of the bar was replaced
+		_measureTable->invalidate( elt->timeStart() );
+	}
+
+	_hashValid = false;
+	CAContext::invalidateHash( elt );
+}
+
 /*!
 	Adds an empty voice to the staff.
 	Call synchronizeVoices() manually to synchronize a new voice with other voices.
@@ -214,7 +288,7 @@ CAVoice *CAStaff::addVoice() {
 */
 CAMusElement *CAStaff::next( CAMusElement *elt ) {
 	for ( int i=0; i<voiceList().size(); i++ ) {	// go through all the voices and check, if any of them includes the given element
-		if ( voiceList()[i]->musElementList().contains(elt) ) {
+		if ( voiceList()[i]->indexOf(elt)!=-1 ) {
 			return voiceList()[i]->next(elt);
 		}
 	}
@@ -229,7 +303,7 @@ CAMusElement *CAStaff::next( CAMusElement *elt ) {
 */
 CAMusElement *CAStaff::previous( CAMusElement *elt ) {
 	for ( int i=0; i<voiceList().size(); i++ ) {	// go through all the voices and check, if any of them includes the given element
-		if ( voiceList()[i]->musElementList().contains(elt) ) {
+		if ( voiceList()[i]->indexOf(elt)!=-1 ) {
 			return voiceList()[i]->previous(elt);
 		}
 	}
@@ -327,6 +401,283 @@ CATempo *CAStaff::getTempo( int time ) {
 	return tempo;
 }
 
+static bool signTimeLessThan( CAMusElement *sign, int time ) {
+	return sign->timeStart() < time;
+}
+
+/*!
+	Returns the index of the references list and time blocks of the shared signs of the given
+	\a type or -1, if the elements of the type are not shared.
+*/
+int CAStaff::signRefsIndex( CAMusElement::CAMusElementType type ) {
+	switch (type) {
+	case CAMusElement::Clef:          return 0;
+	case CAMusElement::KeySignature:  return 1;
+	case CAMusElement::TimeSignature: return 2;
+	case CAMusElement::Barline:       return 3;
+	default:                          return -1;
+	}
+}
+
+/*!
+	Returns the references list with the index \a r.
+
+	\sa signRefsIndex()
+*/
+QList<CAMusElement*>& CAStaff::signRefs( int r ) {
+	switch (r) {
+	case 0:  return _clefList;
+	case 1:  return _keySignatureList;
+	case 2:  return _timeSignatureList;
+	default: return _barlineList;
+	}
+}
+
+/*!
+	Inserts the shared \a sign to its references list at the given position \a pos or appends it,
+	if \a pos is -1.
+
+	As playable elements in the voice, the signs in each references list are grouped into time
+	blocks, so shifting all the signs after the changed time only changes the block offsets. The
+	sign is added to the time block of its neighbour.
+
+	\sa removeSignRef(), shiftSigns(), CATimeBlock
+*/
+void CAStaff::addSignRef( CAMusElement *sign, int pos ) {
+	int r = signRefsIndex( sign->musElementType() );
+	if ( r==-1 ) {
+		return;
+	}
+
+	QList<CAMusElement*> &refs = signRefs( r );
+	if ( pos<0 || pos>refs.size() ) {
+		pos = refs.size();
+	}
+	refs.insert( pos, sign );
+
+	// signs only present in the references list (eg. during the import) don't have a block
+	CATimeBlock *block = 0;
+	int i;
+	for (i=pos-1; i>=0 && !refs[i]->timeBlock(); i--);
+	if ( i>=0 ) {
+		block = refs[i]->timeBlock();
+	} else {
+		for (i=pos+1; i<refs.size() && !refs[i]->timeBlock(); i++);
+		if ( i<refs.size() )
+			block = refs[i]->timeBlock();
+	}
+
+	if ( !block ) {
+		block = new CATimeBlock();
+		_signTimeBlockList[r].prepend( block );
+	}
+
+	sign->setTimeBlock( block );
+	block->setCount( block->count()+1 );
+	block->invalidateHash( sign );
+	_signHashValid = false;
+	invalidateHash();
+
+	if ( block->count() > 2*CAVoice::TimeBlockSize ) {
+		splitSignTimeBlock( r, pos );
+	}
+}
+
+/*!
+	Removes the shared \a sign from its references list and time block. The sign gets its
+	absolute time back.
+
+	\sa addSignRef()
+*/
+void CAStaff::removeSignRef( CAMusElement *sign ) {
+	int r = signRefsIndex( sign->musElementType() );
+	if ( r==-1 ) {
+		return;
+	}
+
+	int pos = signRefs( r ).indexOf( sign );
+	if ( pos!=-1 ) {
+		removeSignRefAt( r, pos );
+	}
+}
+
+void CAStaff::removeSignRefAt( int r, int pos ) {
+	CAMusElement *sign = signRefs( r ).takeAt( pos );
+	CATimeBlock *block = sign->timeBlock();
+	if ( !block ) {
+		return;
+	}
+
+	sign->setTimeBlock( 0 );
+	block->setCount( block->count()-1 );
+	if ( !block->count() ) {
+		_signTimeBlockList[r].removeAll( block );
+		delete block;
+	} else {
+		QList<CAMusElement*> &refs = signRefs( r );
+		if ( pos>0 && refs[pos-1]->timeBlock()==block ) {
+			block->invalidateHash( refs[pos-1] );
+		} else {
+			block->invalidateHash( pos<refs.size() && refs[pos]->timeBlock()==block ? refs[pos] : 0 );
+		}
+	}
+	_signHashValid = false;
+	invalidateHash();
+}
+
+/*!
+	Splits the time block of the sign at index \a pos in the references list \a r in halves.
+
+	\sa CAVoice::splitTimeBlock()
+*/
+void CAStaff::splitSignTimeBlock( int r, int pos ) {
+	QList<CAMusElement*> &refs = signRefs( r );
+	CATimeBlock *block = refs[pos]->timeBlock();
+
+	int first = pos;
+	for (int i=pos-1; i>=0; i--) {
+		if ( !refs[i]->timeBlock() )
+			continue;
+		if ( refs[i]->timeBlock()!=block )
+			break;
+		first = i;
+	}
+
+	CATimeBlock *newBlock = new CATimeBlock( block->offset() );
+	_signTimeBlockList[r].insert( _signTimeBlockList[r].indexOf(block)+1, newBlock );
+
+	int half = block->count()/2;
+	int n = 0;
+	for (int i=first; i<refs.size(); i++) {
+		if ( !refs[i]->timeBlock() )
+			continue;
+		if ( refs[i]->timeBlock()!=block )
+			break;
+		if ( n == half )
+			newBlock->invalidateHash( refs[i] );
+		if ( n++ >= half )
+			refs[i]->setTimeBlock( newBlock );
+	}
+
+	newBlock->setCount( block->count()-half );
+	block->setCount( half );
+	block->invalidateHash( refs[first] );
+}
+
+/*!
+	Recalculates the hash of the shared signs in the given time \a block of the references
+	list \a r relative to the block offset. The block is found by its remembered member sign.
+
+	\sa contentHash(), CAVoice::rehashTimeBlock()
+*/
+void CAStaff::rehashSignBlock( int r, CATimeBlock *block ) {
+	QList<CAMusElement*> &refs = signRefs( r );
+	CAMusElement *member = block->member();
+
+	int idx = -1;
+	if ( member && member->timeBlock()==block ) {
+		idx = std::lower_bound( refs.begin(), refs.end(), member->timeStart(), signTimeLessThan ) - refs.begin();
+		while ( idx<refs.size() && refs[idx]!=member && refs[idx]->timeStart()==member->timeStart() ) {
+			idx++;
+		}
+		if ( idx>=refs.size() || refs[idx]!=member ) {
+			idx = -1;
+		}
+	}
+	if ( idx==-1 ) {
+		for (idx=0; idx<refs.size() && refs[idx]->timeBlock()!=block; idx++);
+	}
+
+	// find the first sign in the block
+	int first = idx;
+	for (int i=idx-1; i>=0; i--) {
+		if ( !refs[i]->timeBlock() )
+			continue;
+		if ( refs[i]->timeBlock()!=block )
+			break;
+		first = i;
+	}
+
+	unsigned int h = 0;
+	for (int i=first; i<refs.size(); i++) {
+		if ( !refs[i]->timeBlock() )
+			continue;
+		if ( refs[i]->timeBlock()!=block )
+			break;
+		h = CAMusElement::combineHash( h, refs[i]->contentHash() );
+		h = CAMusElement::combineHash( h, refs[i]->timeStart() - block->offset() );
+	}
+
+	block->setHash( h );
+}
+
+/*!
+	Shifts the shared signs placed at index \a idx or later in the given \a voice for \a length.
+	Marks of the signs are shifted as well.
+
+	Only the signs in the time block of the first shifted sign are updated one by one. The
+	following blocks are shifted by changing their offsets which takes O(n/TimeBlockSize).
+	Call this before the times in the voice are changed.
+
+	\sa CAVoice::updateTimes(), addSignRef()
+*/
+void CAStaff::shiftSigns( CAVoice *voice, int idx, int length ) {
+	if ( idx>=voice->musElementList().size() ) {
+		return;
+	}
+
+	int timeStart = voice->musElementList()[idx]->timeStart();
+	for (int r=0; r<4; r++) {
+		QList<CAMusElement*> &refs = signRefs( r );
+
+		// signs at the same time may be placed before idx
+		int first = std::lower_bound( refs.begin(), refs.end(), timeStart, signTimeLessThan ) - refs.begin();
+		while ( first<refs.size() && refs[first]->timeStart()==timeStart && voice->indexOf(refs[first])<idx ) {
+			first++;
+		}
+
+		CATimeBlock *block = 0;
+		int i;
+		for (i=first; i<refs.size(); i++) {
+			if ( !refs[i]->timeBlock() )
+				continue; // not in a time block yet
+			if ( block && refs[i]->timeBlock()!=block )
+				break;
+			block = refs[i]->timeBlock();
+			voice->shiftTime( refs[i], length ); // rehashes this block only
+		}
+
+		if ( i<refs.size() ) {
+			// only the offsets are combined into the hash of the following blocks
+			QList<CATimeBlock*> &blocks = _signTimeBlockList[r];
+			for (int j=blocks.indexOf(refs[i]->timeBlock()); j<blocks.size(); j++) {
+				blocks[j]->setOffset( blocks[j]->offset() + length );
+			}
+			_signHashValid = false;
+			invalidateHash();
+		}
+	}
+}
+
+/*!
+	Marks the voices as changed from the given \a timeStart on. Chords of the sheet have changed
+	as well, so the function mark and figured bass contexts are notified.
+	The table of bars is rebuilt from that time on as well.
+
+	\sa synchronizeVoices(), CASheet::invalidateChords(), CAMeasureTable
+*/
+void CAStaff::invalidateVoices( int timeStart ) {
+	if ( _dirtyTime==-1 || timeStart<_dirtyTime ) {
+		_dirtyTime = timeStart;
+	}
+
+	_measureTable->invalidate( timeStart );
+
+	if ( sheet() ) {
+		sheet()->invalidateChords( timeStart );
+	}
+}
+
 /*!
 	Fixes voices inconsistency:
 	1) If any of the voices include signs (key sigs, clefs etc.) which aren't present in all voices,
@@ -341,26 +692,55 @@ CATempo *CAStaff::getTempo( int time ) {
 	insertions and synchronization of the voices every time a new element is inserted would considerably
 	slow down the import filter.
 
+	Voices report the earliest changed time by invalidateVoices(). Voices are only re-merged from the last
+	shared sign before that time and the references lists are patched from there on. Appending elements
+	at the end of the staff only re-merges the last bar.
+
 	Returns True, if everything was ok. False, if fixes were needed.
+
+	\sa invalidateVoices()
 */
 bool CAStaff::synchronizeVoices() {
+	if ( _dirtyTime==-1 ) {
+		return false;
+	}
+
+	// resume at the last shared sign before the first change
+	int timeStart = 0;
+	QList<CAMusElement*> *refs[] = { &_clefList, &_keySignatureList, &_timeSignatureList, &_barlineList };
+	for (int i=0; i<4; i++) {
+		for (int j=refs[i]->size()-1; j>=0; j--) {
+			if ( refs[i]->at(j)->timeStart() < _dirtyTime ) {
+				timeStart = qMax( timeStart, refs[i]->at(j)->timeStart() );
+				break;
+			}
+		}
+	}
+
+	// the references lists are repopulated from timeStart on
+	for (int i=0; i<4; i++) {
+		while ( refs[i]->size() && refs[i]->last()->timeStart() >= timeStart ) {
+			removeSignRefAt( i, refs[i]->size()-1 );
+		}
+	}
+
 	int *pidx = new int[voiceList().size()];
-        for (int i=0; i<voiceList().size(); i++) pidx[i]=-1;          // array of current indices of voices at current timeStart
 	CAMusElement **plastPlayable = new CAMusElement*[voiceList().size()];
- 	for (int i=0; i<voiceList().size(); i++) plastPlayable[i]=0;
-
-	_clefList.clear();
-	_keySignatureList.clear();
-	_timeSignatureList.clear();
-	_barlineList.clear();
+	for (int i=0; i<voiceList().size(); i++) {
+		pidx[i] = voiceList()[i]->lowerBoundIndex( timeStart ) - 1; // array of current indices of voices at current timeStart
+		plastPlayable[i] = 0;
+		for (int j=pidx[i]; j>=0 && !plastPlayable[i]; j--) {
+			if ( voiceList()[i]->musElementList()[j]->isPlayable() )
+				plastPlayable[i] = voiceList()[i]->musElementList()[j];
+		}
+	}
 
-	int timeStart = 0;
 	bool done = false;
 	bool changesMade = false;
 
 	// first fix any inconsistencies inside a voice
 	for (int i=0; i<voiceList().size(); i++)
-		voiceList()[i]->synchronizeMusElements();
+		voiceList()[i]->synchronizeMusElements( timeStart );
 
 	while (!done) {
 		QList<CAMusElement*> sharedList; // list of shared music elements having the same time-start sorted by voice number
@@ -372,7 +752,7 @@ bool CAStaff::synchronizeVoices() {
 				if ( !sharedList.contains(voiceList()[i]->musElementList()[ pidx[i]+1 ]) ) {
 					sharedList << voiceList()[i]->musElementList()[ pidx[i]+1 ];
 				}
-				voiceList()[i]->_musElementList.removeAt( pidx[i]+1 );
+				voiceList()[i]->removeAt( pidx[i]+1 );
 			}
 		}
 
@@ -381,7 +761,7 @@ bool CAStaff::synchronizeVoices() {
 		if ( sharedList.size() ) {
 			for ( int i=0; i<voiceList().size(); i++ ) {
 				for ( int j=0; j<sharedList.size(); j++) {
-					voiceList()[i]->_musElementList.insert( pidx[i]+1+j, sharedList[j] );
+					voiceList()[i]->insertAt( pidx[i]+1+j, sharedList[j] );
 				}
 				pidx[i]++; // jump to the first one inserted from the sharedList, if inserting shared elts for the first time
 				          // or the first one after the sharedList in second pass
@@ -389,13 +769,7 @@ bool CAStaff::synchronizeVoices() {
 			
 			// populate the references lists
 			for ( int j=0; j<sharedList.size(); j++) {
-				switch (sharedList[j]->musElementType()) {
-					case CAMusElement::KeySignature: _keySignatureList << sharedList[j]; break;
-					case CAMusElement::TimeSignature: _timeSignatureList << sharedList[j]; break;
-					case CAMusElement::Clef: _clefList << sharedList[j]; break;
-					case CAMusElement::Barline: _barlineList << sharedList[j]; break;
-					default: break;
-				}
+				addSignRef( sharedList[j] );
 			}
 
 		} else {
@@ -425,7 +799,7 @@ bool CAStaff::synchronizeVoices() {
 
 					voiceList()[i]->musElementList()[pidx[i]]->setTimeStart( plastPlayable[j]->timeEnd() );
 					for ( int k=0; k < restList.size(); k++ )
-						voiceList()[i]->_musElementList.insert( pidx[i]++, restList[k] ); // insert the missing rests, rests are added in back, pidx++
+						voiceList()[i]->insertAt( pidx[i]++, restList[k] ); // insert the missing rests, rests are added in back, pidx++
 					voiceList()[i]->updateTimes( pidx[i], gapLength, false );              // increase playable timeStarts
 					if (restList.size()) {
 						plastPlayable[ i ] = restList.last();
@@ -446,7 +820,7 @@ bool CAStaff::synchronizeVoices() {
 				int gapLength = timeStart - ( (pidx[j]==-1||!plastPlayable[j])?0:plastPlayable[ j ]->timeEnd() );
 				QList<CARest*> restList = CARest::composeRests( gapLength, (pidx[j]==-1||!plastPlayable[j])?0:plastPlayable[ j ]->timeEnd(), voiceList()[j] );
 				for ( int k=0; k < restList.size(); k++ )
-					voiceList()[j]->_musElementList.insert( pidx[j]++, restList[k] ); // insert the missing rests, rests are added in back, pidx++
+					voiceList()[j]->insertAt( pidx[j]++, restList[k] ); // insert the missing rests, rests are added in back, pidx++
 				voiceList()[j]->updateTimes( pidx[j], gapLength, false );              // increase playable timeStarts
 				if (restList.size()) {
 					plastPlayable[ j ] = restList.last();
@@ -485,6 +859,10 @@ bool CAStaff::synchronizeVoices() {
 	}
 
 	delete [] pidx;
+	delete [] plastPlayable;
+
+	_dirtyTime = -1;
+
 	return changesMade;
 }
 
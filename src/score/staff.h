@@ -18,9 +18,11 @@ class QPainter;
 
 class CASheet;
 class CAContext;
+class CAMeasureTable;
 class CAVoice;
 class CANote;
 class CATempo;
+class CATimeBlock;
 
 class CAStaff : public CAContext {
 public:
@@ -28,15 +30,15 @@ public:
 	~CAStaff();
 
 	inline int numberOfLines() { return _numberOfLines; }
-	inline void setNumberOfLines(int val) { _numberOfLines = val; }
+	inline void setNumberOfLines(int val) { _numberOfLines = val; invalidateHash(); }
 	void clear();
 	CAStaff *clone( CASheet *s );
 
 	inline const QList<CAVoice*>& voiceList() { return _voiceList; }
-	inline void addVoice(CAVoice *voice) { _voiceList << voice; }
-	inline void insertVoice(int idx, CAVoice *voice) { _voiceList.insert(idx, voice); }
+	inline void addVoice(CAVoice *voice) { _voiceList << voice; invalidateVoices(0); invalidateHash(); }
+	inline void insertVoice(int idx, CAVoice *voice) { _voiceList.insert(idx, voice); invalidateVoices(0); invalidateHash(); }
 	CAVoice* addVoice();
-	inline void removeVoice(CAVoice *voice) { _voiceList.removeAll(voice); }
+	inline void removeVoice(CAVoice *voice) { _voiceList.removeAll(voice); invalidateVoices(0); invalidateHash(); }
 	CAVoice *findVoice(const QString name);
 
 	CAMusElement *next( CAMusElement *elt );
@@ -44,6 +46,9 @@ public:
 	bool remove( CAMusElement *elt, bool updateSignTimes );
 	bool remove( CAMusElement *elt ) { return remove(elt, true); }
 
+	unsigned int contentHash();
+	void invalidateHash( CAMusElement *elt=0 );
+
 	int lastTimeEnd();
 	QList<CAMusElement*> getEltByType( CAMusElement::CAMusElementType type, int startTime );
 	CAMusElement *getOneEltByType( CAMusElement::CAMusElementType type, int startTime );
@@ -52,6 +57,9 @@ public:
 	CATempo           *getTempo( int time );
 
 	bool synchronizeVoices();
+	void invalidateVoices( int timeStart );
+	inline int dirtyTime() { return _dirtyTime; }
+	inline CAMeasureTable *measureTable() { return _measureTable; }
 
 	static bool placeAutoBar( CAPlayable* elt );
 
@@ -60,15 +68,32 @@ public:
 	inline QList<CAMusElement *>& keySignatureRefs() { return _keySignatureList; }
 	inline QList<CAMusElement *>& timeSignatureRefs() { return _timeSignatureList; }
 	inline QList<CAMusElement *>& barlineRefs() { return _barlineList; }
+	void addSignRef( CAMusElement *sign, int pos=-1 );
+	void removeSignRef( CAMusElement *sign );
+	void shiftSigns( CAVoice *voice, int idx, int length );
 	
 private:
+	static int signRefsIndex( CAMusElement::CAMusElementType type );
+	QList<CAMusElement*>& signRefs( int r );
+	void removeSignRefAt( int r, int pos );
+	void splitSignTimeBlock( int r, int pos );
+	void rehashSignBlock( int r, CATimeBlock *block );
+
 	QList<CAVoice *> _voiceList;
 
 	int _numberOfLines;
+	int _dirtyTime; // voices need to be synchronized from this time on, -1 if synchronized
+	CAMeasureTable *_measureTable;
+
+	unsigned int _hash;     // cached contentHash()
+	bool _hashValid;
+	unsigned int _signHash; // hash of the shared signs combined from their time blocks
+	bool _signHashValid;
 
 	QList<CAMusElement *> _clefList;
 	QList<CAMusElement *> _keySignatureList;
 	QList<CAMusElement *> _timeSignatureList;
 	QList<CAMusElement *> _barlineList;
+	QList<CATimeBlock *> _signTimeBlockList[4]; // time blocks of the clefs, key and time signatures and barlines
 };
 #endif /* STAFF_H_ */
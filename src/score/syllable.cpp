@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <QHash>
+
 #include "score/syllable.h"
 #include "score/mark.h"
 
@@ -74,3 +76,12 @@ int CASyllable::compare(CAMusElement* c) {
 	else
 		return 1;
 }
+
+unsigned int CASyllable::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, qHash(text()) );
+	h = combineHash( h, hyphenStart() );
+	h = combineHash( h, melismaStart() );
+
+	return h;
+}
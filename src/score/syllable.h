@@ -23,11 +23,11 @@ public:
 	void clear();
 
 	inline bool hyphenStart() { return _hyphenStart; }
-	inline void setHyphenStart(bool h) { _hyphenStart = h; }
+	inline void setHyphenStart(bool h) { _hyphenStart = h; contentChanged(); }
 	inline bool melismaStart() { return _melismaStart; }
-	inline void setMelismaStart(bool m) { _melismaStart = m; }
+	inline void setMelismaStart(bool m) { _melismaStart = m; contentChanged(); }
 	inline QString text() { return _text; }
-	inline void setText(QString text) { _text = text; }
+	inline void setText(QString text) { _text = text; contentChanged(); }
 	inline CAVoice *associatedVoice() { return _associatedVoice; }
 	inline void setAssociatedVoice(CAVoice* v) { _associatedVoice = v; }
 
@@ -35,6 +35,7 @@ public:
 
 	CASyllable* clone(CAContext* context);
 	int compare(CAMusElement*);
+	unsigned int contentHash();
 
 private:
 	bool _hyphenStart, _melismaStart;
@@ -6,6 +6,8 @@
 */
 
 #include "score/tempo.h"
+#include "score/sheet.h"
+#include "score/tempomap.h"
 
 /*!
 	\class CATempo
@@ -24,6 +26,28 @@ CATempo::CATempo( CAPlayableLength p, int bpm, CAMusElement *t )
 CATempo::~CATempo() {
 }
 
+/*!
+	Sets the beats per minute to \a bpm and updates the tempo map of the sheet.
+*/
+void CATempo::setBpm( int bpm ) {
+	_bpm = bpm;
+	contentChanged();
+
+	if ( context() && context()->sheet() )
+		context()->sheet()->tempoMap()->invalidate();
+}
+
+/*!
+	Sets the beat length to \a l and updates the tempo map of the sheet.
+*/
+void CATempo::setBeat( CAPlayableLength l ) {
+	_beat = l;
+	contentChanged();
+
+	if ( context() && context()->sheet() )
+		context()->sheet()->tempoMap()->invalidate();
+}
+
 CATempo *CATempo::clone(CAMusElement* elt) {
 	return new CATempo( beat(), bpm(), elt );
 }
@@ -40,3 +64,12 @@ int CATempo::compare( CAMusElement *elt ) {
 	else
 		return 0;
 }
+
+unsigned int CATempo::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, bpm() );
+	h = combineHash( h, beat().musicLength() );
+	h = combineHash( h, beat().dotted() );
+
+	return h;
+}
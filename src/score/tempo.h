@@ -18,11 +18,12 @@ public:
 
 	CATempo *clone(CAMusElement* elt=0);
 	int compare( CAMusElement *elt );
+	unsigned int contentHash();
 
 	inline int bpm() { return _bpm; }
-	inline void setBpm( int bpm ) { _bpm = bpm; }
+	void setBpm( int bpm );
 	inline CAPlayableLength beat() { return _beat; }
-	inline void setBeat( CAPlayableLength l ) { _beat = l; }
+	void setBeat( CAPlayableLength l );
 
 private:
 	CAPlayableLength _beat;
@@ -0,0 +1,278 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <algorithm> // std::stable_sort
+#include <cmath>     // log, exp
+
+#include "score/tempomap.h"
+#include "score/mark.h"
+#include "score/tempo.h"
+#include "score/ritardando.h"
+#include "score/playablelength.h"
+
+/*!
+	\class CATempoMap
+	\brief Tempo changes of the sheet for converting time units to miliseconds
+
+	Music elements store their times in absolute time units which are not affected by
+	tempo. CATempoMap keeps the list of tempo and ritardando marks in the sheet and
+	builds a sorted list of tempo segments out of them. Every segment has a constant
+	tempo or a linear tempo change (ritardando, accellerando) and a prefix sum of the
+	miliseconds at its start.
+
+	Converting the time units to miliseconds and back is then done in O(log n) where n
+	is the number of tempo marks.
+
+	Marks are registered by CAMusElement::addMark() and removeMark(). Segments are
+	rebuilt lazily on the next query after the map was invalidated, eg. when times of
+	the elements in the sheet were changed.
+
+	\sa CASheet::tempoMap(), CAMusElement::realTimeStart()
+*/
+
+/*!
+	Tempo in beats per minute with the quarter beat used when there are no tempo marks
+	present. This is the default tempo of MIDI files as well.
+*/
+const int CATempoMap::DefaultBpm = 120;
+
+CATempoMap::CATempoMap( CASheet *sheet ) {
+	_sheet = sheet;
+	_dirty = true;
+}
+
+CATempoMap::~CATempoMap() {
+}
+
+/*!
+	Returns a new map with the same tempo segments.
+
+	The clone doesn't reference the sheet and the marks, and its segments are already built.
+	It is only read afterwards, so it can be safely used from other threads.
+
+	\sa CASheetSnapshot
+*/
+CATempoMap *CATempoMap::clone() {
+	if ( _dirty ) {
+		rebuild();
+	}
+
+	CATempoMap *m = new CATempoMap( 0 );
+	m->_segments = _segments;
+	for (int i=0; i<m->_segments.size(); i++) {
+		m->_segments[i].tempo = 0;
+	}
+	m->_dirty = false;
+
+	return m;
+}
+
+/*!
+	Adds the tempo or ritardando \a mark to the map.
+	Other marks are ignored.
+
+	\sa removeMark()
+*/
+void CATempoMap::addMark( CAMark *mark ) {
+	if ( !mark || (mark->markType()!=CAMark::Tempo && mark->markType()!=CAMark::Ritardando) || _markList.contains(mark) )
+		return;
+
+	_markList << mark;
+	invalidate();
+}
+
+/*!
+	Removes the \a mark from the map.
+
+	\sa addMark()
+*/
+void CATempoMap::removeMark( CAMark *mark ) {
+	if ( _markList.removeAll(mark) ) {
+		invalidate();
+	}
+}
+
+static bool markTimeLessThan( CAMark *a, CAMark *b ) {
+	if ( a->timeStart()!=b->timeStart() )
+		return a->timeStart() < b->timeStart();
+
+	// tempo marks are applied before ritardandos starting at the same time
+	return ( a->markType()==CAMark::Tempo && b->markType()!=CAMark::Tempo );
+}
+
+/*!
+	Appends a new segment and computes its prefix sum.
+	If the last segment starts at the same time, it is replaced.
+*/
+void CATempoMap::appendSegment( int timeStart, double bpm, double slope, int beatLength, CATempo *tempo ) {
+	if ( bpm<1 ) {
+		bpm = 1;
+	}
+
+	if ( _segments.size() && _segments.last().timeStart==timeStart ) {
+		_segments.removeLast();
+	}
+
+	CATempoSegment s;
+	s.timeStart = timeStart;
+	s.bpm = bpm;
+	s.slope = slope;
+	s.beatLength = beatLength;
+	s.tempo = tempo;
+	s.msStart = 0;
+	if ( _segments.size() ) {
+		s.msStart = _segments.last().msStart + segmentMs( _segments.last(), timeStart - _segments.last().timeStart );
+	}
+
+	_segments << s;
+}
+
+/*!
+	Sorts the marks and regenerates the tempo segments with their prefix sums.
+	This takes O(n log n) for n tempo and ritardando marks.
+*/
+void CATempoMap::rebuild() {
+	_segments.clear();
+	std::stable_sort( _markList.begin(), _markList.end(), markTimeLessThan );
+
+	int beatLength = CAPlayableLength::musicLengthToTimeLength( CAPlayableLength::Quarter );
+	double bpm = DefaultBpm;
+	CATempo *tempo = 0;
+	int restoreTime = -1; // end of the current ritardando, when the original tempo is restored
+
+	appendSegment( 0, bpm, 0, beatLength, tempo );
+
+	for (int i=0; i<_markList.size(); i++) {
+		CAMark *m = _markList[i];
+
+		if ( restoreTime!=-1 && restoreTime<=m->timeStart() ) {
+			appendSegment( restoreTime, bpm, 0, beatLength, tempo );
+			restoreTime = -1;
+		}
+
+		if ( m->markType()==CAMark::Tempo ) {
+			tempo = static_cast<CATempo*>(m);
+			int l = CAPlayableLength::playableLengthToTimeLength( tempo->beat() );
+			if ( l>0 ) {
+				beatLength = l;
+			}
+			bpm = tempo->bpm();
+			restoreTime = -1; // new tempo cancels the running ritardando
+			appendSegment( m->timeStart(), bpm, 0, beatLength, tempo );
+		} else if ( m->timeLength()>0 ) {
+			CARitardando *r = static_cast<CARitardando*>(m);
+			appendSegment( m->timeStart(), bpm, (r->finalTempo() - bpm)/m->timeLength(), beatLength, tempo );
+			restoreTime = m->timeEnd();
+		}
+	}
+
+	if ( restoreTime!=-1 ) {
+		appendSegment( restoreTime, bpm, 0, beatLength, tempo );
+	}
+
+	_dirty = false;
+}
+
+/*!
+	Returns the index of the segment in effect at the given \a time.
+*/
+int CATempoMap::segmentAt( int time ) {
+	if ( _dirty ) {
+		rebuild();
+	}
+
+	int low = 0, high = _segments.size()-1;
+	while ( low < high ) {
+		int mid = (low + high + 1) / 2;
+		if ( _segments[mid].timeStart <= time )
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	return low;
+}
+
+/*!
+	Returns the miliseconds elapsed in the first \a length time units of the segment \a s.
+	Ritardandos change the tempo linearly, so the integral is logarithmic.
+*/
+double CATempoMap::segmentMs( const CATempoSegment& s, int length ) {
+	double msPerBeat = 60000.0 / s.beatLength;
+
+	if ( s.slope==0 ) {
+		return msPerBeat * length / s.bpm;
+	}
+
+	double bpmEnd = s.bpm + s.slope*length;
+	if ( bpmEnd<1 ) {
+		bpmEnd = 1;
+	}
+
+	return msPerBeat / s.slope * log( bpmEnd / s.bpm );
+}
+
+/*!
+	Returns the tempo mark in effect at the given \a time or 0, if the default tempo is used.
+*/
+CATempo *CATempoMap::tempoAt( int time ) {
+	return _segments[segmentAt(time)].tempo;
+}
+
+/*!
+	Returns the tempo in beats per minute at the given \a time.
+	The beat length is given by the tempo mark in effect.
+*/
+double CATempoMap::bpmAt( int time ) {
+	const CATempoSegment& s = _segments[segmentAt(time)];
+	return s.bpm + s.slope*(time - s.timeStart);
+}
+
+/*!
+	Converts the absolute \a time to miliseconds from the beginning of the sheet.
+
+	\sa msToTime()
+*/
+double CATempoMap::timeToMs( int time ) {
+	const CATempoSegment& s = _segments[segmentAt(time)];
+	return s.msStart + segmentMs( s, time - s.timeStart );
+}
+
+/*!
+	Converts the miliseconds \a ms from the beginning of the sheet to absolute time units.
+
+	\sa timeToMs()
+*/
+int CATempoMap::msToTime( double ms ) {
+	if ( _dirty ) {
+		rebuild();
+	}
+
+	int low = 0, high = _segments.size()-1;
+	while ( low < high ) {
+		int mid = (low + high + 1) / 2;
+		if ( _segments[mid].msStart <= ms )
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	const CATempoSegment& s = _segments[low];
+	double beats = (ms - s.msStart) * s.beatLength / 60000.0;
+	if ( s.slope==0 ) {
+		return s.timeStart + qRound( beats * s.bpm );
+	} else {
+		return s.timeStart + qRound( s.bpm * (exp( beats * s.slope ) - 1) / s.slope );
+	}
+}
+
+/*!
+	Returns the length in miliseconds of \a timeLength time units starting at \a timeStart.
+*/
+int CATempoMap::timeLengthToMs( int timeStart, int timeLength ) {
+	return qRound( timeToMs(timeStart + timeLength) - timeToMs(timeStart) );
+}
@@ -0,0 +1,60 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef TEMPOMAP_H_
+#define TEMPOMAP_H_
+
+#include <QList>
+#include <QVector>
+
+class CASheet;
+class CAMark;
+class CATempo;
+
+class CATempoMap {
+public:
+	CATempoMap( CASheet *sheet );
+	~CATempoMap();
+	CATempoMap *clone();
+
+	inline CASheet *sheet() { return _sheet; }
+
+	void addMark( CAMark *mark );
+	void removeMark( CAMark *mark );
+	inline const QList<CAMark*>& markList() { return _markList; }
+	inline void invalidate() { _dirty = true; }
+
+	CATempo *tempoAt( int time );
+	double bpmAt( int time );
+	double timeToMs( int time );
+	int msToTime( double ms );
+	int timeLengthToMs( int timeStart, int timeLength );
+
+	static const int DefaultBpm;
+
+private:
+	struct CATempoSegment {
+		int timeStart;     // start of the segment in absolute time units
+		double bpm;        // tempo at the segment start
+		double slope;      // tempo change per time unit, non-zero for ritardando and accellerando
+		int beatLength;    // length of the beat in absolute time units
+		double msStart;    // prefix sum of miliseconds at the segment start
+		CATempo *tempo;    // tempo mark in effect or 0, if the default tempo
+	};
+
+	void rebuild();
+	int segmentAt( int time );
+	double segmentMs( const CATempoSegment& s, int length );
+	void appendSegment( int timeStart, double bpm, double slope, int beatLength, CATempo *tempo );
+
+	CASheet *_sheet;
+	QList<CAMark*> _markList;           // tempo and ritardando marks in the sheet
+	QVector<CATempoSegment> _segments;  // tempo segments sorted by timeStart
+	bool _dirty;
+};
+
+#endif /* TEMPOMAP_H_ */
@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <QHash>
+
 #include "score/text.h"
 #include "score/playable.h"
 
@@ -41,3 +43,10 @@ int CAText::compare(CAMusElement *elt) {
 
 	return 0;
 }
+
+unsigned int CAText::contentHash() {
+	unsigned int h = CAMark::contentHash();
+	h = combineHash( h, qHash(text()) );
+
+	return h;
+}
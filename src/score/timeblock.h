@@ -0,0 +1,52 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#ifndef TIMEBLOCK_H_
+#define TIMEBLOCK_H_
+
+class CAMusElement;
+
+/*!
+	\class CATimeBlock
+	\brief Shared time offset of a block of consecutive playable elements in the voice
+
+	Music elements in a block store their timeStart relative to the block offset. Shifting
+	all the elements after the given one is then done by changing the offsets of the following
+	blocks only.
+
+	Blocks also cache the content hash of their elements. When the hash is invalidated, one of the
+	elements in the block is remembered, so the block can be found and rehashed without walking the
+	whole voice.
+
+	\sa CAVoice::updateTimes(), CAVoice::contentHash(), CAMusElement::timeBlock()
+*/
+class CATimeBlock {
+public:
+	CATimeBlock( int offset=0 ) { _offset = offset; _count = 0; _hash = 0; _hashValid = false; _member = 0; }
+
+	inline int offset() const { return _offset; }
+	inline void setOffset( int offset ) { _offset = offset; }
+
+	inline int count() { return _count; }
+	inline void setCount( int count ) { _count = count; }
+
+	inline bool isHashValid() const { return _hashValid; }
+	inline unsigned int hash() const { return _hash; }
+	inline void setHash( unsigned int hash ) { _hash = hash; _hashValid = true; }
+	inline void invalidateHash( CAMusElement *member ) { _hashValid = false; _member = member; }
+	inline CAMusElement *member() { return _member; }
+
+private:
+	int _offset; // time added to timeStart of all the elements in the block
+	int _count;  // number of playable elements in the block
+
+	unsigned int _hash;    // hash of the elements relative to the offset
+	bool _hashValid;
+	CAMusElement *_member; // any element in the block, when the hash is invalid
+};
+
+#endif /* TIMEBLOCK_H_ */
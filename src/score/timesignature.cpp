@@ -52,7 +52,7 @@
 */
 CATimeSignature::CATimeSignature(int beats, int beat, CAStaff *staff, int startTime, CATimeSignatureType type)
  : CAMusElement(staff, startTime) {
- 	_musElementType = CAMusElement::TimeSignature;
+ 	setMusElementType( CAMusElement::TimeSignature );
 
  	_beats = beats;
  	_beat = beat;
@@ -111,6 +111,15 @@ int CATimeSignature::compare(CAMusElement *elt) {
 	return diffs;
 }
 
+unsigned int CATimeSignature::contentHash() {
+	unsigned int h = CAMusElement::contentHash();
+	h = combineHash( h, beats() );
+	h = combineHash( h, beat() );
+	h = combineHash( h, timeSignatureType() );
+
+	return h;
+}
+
 const QString CATimeSignature::timeSignatureTypeToString(CATimeSignatureType type) {
 	switch (type) {
 		case Classical:
@@ -32,10 +32,10 @@ class CATimeSignature : public CAMusElement {
 		CAStaff *staff() { return static_cast<CAStaff*>(context()); }
 
 		int beats() { return _beats; }
-		void setBeats(int beats) { _beats = beats; }
+		void setBeats(int beats) { _beats = beats; contentChanged(); }
 
 		int beat() { return _beat; }
-		void setBeat(int beat) { _beat = beat; }
+		void setBeat(int beat) { _beat = beat; contentChanged(); }
 		
 		int barDuration();
 		
@@ -48,6 +48,7 @@ class CATimeSignature : public CAMusElement {
 		static CATimeSignatureType timeSignatureTypeFromString(const QString);
 
 		int compare(CAMusElement *elt);
+		unsigned int contentHash();
 
 	private:
 		int _beats;
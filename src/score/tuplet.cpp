@@ -188,7 +188,7 @@ void CATuplet::assignTimes() {
 		if ( j < noteList().size() ) {
 			noteList()[i]->setTimeLength( noteList()[j]->timeStart() - noteList()[i]->timeStart() );
 		} else {
-			noteList()[i]->setTimeLength( qRound( CAPlayableLength::playableLengthToTimeLength( noteList()[i]->playableLength() ) * ((float)actualNumber() / number()) ) );
+			noteList()[i]->setTimeLength( CAPlayableLength::playableLengthToTimeLength( noteList()[i]->playableLength(), number(), actualNumber() ) );
 		}
 	}
 
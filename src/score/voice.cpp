@@ -18,6 +18,8 @@
 #include "score/slur.h"
 #include "score/mark.h"
 #include "score/tempo.h"
+#include "score/sheet.h"
+#include "score/tempomap.h"
 #include "interface/mididevice.h"
 
 /*!
@@ -42,6 +44,9 @@ CAVoice::CAVoice( const QString name, CAStaff *staff, CANote::CAStemDirection st
 	_midiChannel = ((staff && staff->sheet()) ? CAMidiDevice::freeMidiChannel( staff->sheet() ) : 0);
 	_midiProgram = 0;
 	_midiPitchOffset = 0;
+
+	_hash = 0;
+	_hashValid = false;
 }
 
 /*!
@@ -61,6 +66,8 @@ CAVoice::~CAVoice() {
 	if (staff()) {
 		staff()->removeVoice(this);
 	}
+
+	qDeleteAll( _timeBlockList );
 }
 
 /*!
@@ -100,7 +107,7 @@ void CAVoice::clear() {
 		if ( _musElementList.front()->isPlayable() || ( staff() && staff()->voiceList().size()<2 ) )
 			delete _musElementList.front(); // CAMusElement's destructor removes it from the list
 		else
-			_musElementList.removeFirst();
+			removeAt( 0 );
 	}
 }
 
@@ -169,7 +176,7 @@ bool CAVoice::insert( CAMusElement *eltAfter, CAMusElement *elt, bool addToChord
 
 		// calculate note positions in staff when inserting a new clef
 		if ( elt->musElementType()==CAMusElement::Clef ) {
-			for ( int i=musElementList().indexOf(elt)+1; i < musElementList().size(); i++ ) {
+			for ( int i=indexOf(elt)+1; i < musElementList().size(); i++ ) {
 				if ( musElementList()[i]->musElementType()==CAMusElement::Note )
 					static_cast<CANote*>(musElementList()[i])->setDiatonicPitch( static_cast<CANote*>(musElementList()[i])->diatonicPitch() );
 			}
@@ -187,7 +194,7 @@ bool CAVoice::insert( CAMusElement *eltAfter, CAMusElement *elt, bool addToChord
 
 		elt->setTimeStart( eltAfter?(eltAfter->timeStart()):lastTimeEnd() );
 		res = insertMusElement( eltAfter, elt );
-		updateTimes( musElementList().indexOf(elt)+1, elt->timeLength(), true );
+		updateTimes( indexOf(elt)+1, elt->timeLength(), true );
 
 	}
 
@@ -242,51 +249,39 @@ CAPlayable* CAVoice::insertInTupletAndVoiceAt( CAPlayable *reference, CAPlayable
 	Returns a pointer to the clef which the given \a elt belongs to.
 	Returns 0, if no clefs placed yet.
 
-	Warning! This operation is slow (linear time), but always returns the
-	correct clef depending on the order of the musElementList. If a timeBased
-	result suffices, use CAStaff::getClef(time).
+	The element is found in O(log n) and the list is walked back to the nearest clef, so this
+	always returns the correct clef depending on the order of the musElementList. If a time based
+	result suffices, use getPreviousClef(time).
 */
 CAClef* CAVoice::getClef(CAMusElement *elt) {
-	if (!elt || !musElementList().contains(elt))
-		elt = lastMusElement();
-
-	while ( elt && (elt->musElementType() != CAMusElement::Clef) && (elt = previous(elt)) );
-
-	return static_cast<CAClef*>(elt);
+	int i = lastIndexOfType( CAMusElement::Clef, elt );
+	return ( i!=-1 ) ? static_cast<CAClef*>(_musElementList[i]) : 0;
 }
 
 /*!
 	Returns a pointer to the time signature which the given \a elt belongs to.
 	Returns 0, if no time signatures placed yet.
 
-	Warning! This operation is slow (linear time), but always returns the
-	correct timeSig depending on the order of the musElementList. If a timeBased
-	result suffices, use CAStaff::getClef(time).
+	The element is found in O(log n) and the list is walked back to the nearest time signature, so
+	this always returns the correct timeSig depending on the order of the musElementList. If a time based
+	result suffices, use getPreviousTimeSignature(time).
 */
 CATimeSignature* CAVoice::getTimeSig(CAMusElement *elt) {
-	if (!elt || !musElementList().contains(elt))
-		elt = lastMusElement();
-
-	while ( elt && (elt->musElementType() != CAMusElement::TimeSignature) && (elt = previous(elt)) );
-
-	return static_cast<CATimeSignature*>(elt);
+	int i = lastIndexOfType( CAMusElement::TimeSignature, elt );
+	return ( i!=-1 ) ? static_cast<CATimeSignature*>(_musElementList[i]) : 0;
 }
 
 /*!
 	Returns a pointer to the key signature which the given \a elt belongs to.
 	Returns 0, if no key signatures placed yet.
 
-	Warning! This operation is slow (linear time), but always returns the
-	correct keySig depending on the order of the musElementList. If a timeBased
-	result suffices, use CAStaff::getClef(time).
+	The element is found in O(log n) and the list is walked back to the nearest key signature, so
+	this always returns the correct keySig depending on the order of the musElementList. If a time based
+	result suffices, use getPreviousKeySignature(time).
 */
 CAKeySignature* CAVoice::getKeySig(CAMusElement *elt) {
-	if (!elt || !musElementList().contains(elt))
-		elt = lastMusElement();
-
-	while ( elt && (elt->musElementType() != CAMusElement::KeySignature) && (elt = previous(elt)) );
-
-	return static_cast<CAKeySignature*>(elt);
+	int i = lastIndexOfType( CAMusElement::KeySignature, elt );
+	return ( i!=-1 ) ? static_cast<CAKeySignature*>(_musElementList[i]) : 0;
 }
 
 /*!
@@ -305,56 +300,79 @@ CAKeySignature* CAVoice::getKeySig(CAMusElement *elt) {
 	Returns true, if the element was found and removed; otherwise false.
 */
 bool CAVoice::remove( CAMusElement *elt, bool updateSigns ) {
-	if ( _musElementList.contains(elt) ) {	// if the search element is found
-		if ( !elt->isPlayable() && staff() ) {          // element is shared - remove it from all the voices
-			for (int i=0; i<staff()->voiceList().size(); i++) {
-				staff()->voiceList()[i]->_musElementList.removeAll(elt);
-			}
-			// remove it from the references list
-			if (elt->musElementType() == CAMusElement::KeySignature )  staff()->keySignatureRefs().removeAll( elt ); else
-			if (elt->musElementType() == CAMusElement::TimeSignature ) staff()->timeSignatureRefs().removeAll( elt ); else
-			if (elt->musElementType() == CAMusElement::Clef )          staff()->clefRefs().removeAll( elt ); else
-			if (elt->musElementType() == CAMusElement::Barline )       staff()->barlineRefs().removeAll( elt );
-		} else {
-			// element is playable
-			if ( elt->musElementType()==CAMusElement::Note ) {
-				CANote *n = static_cast<CANote*>(elt);
-				if ( n->isPartOfChord() && n->isFirstInChord() ) {
-					// if the note is the first in the chord, the slurs and marks should be relinked to the 2nd in the chord
-					CANote *prevNote = n->getChord().at(1);
-					prevNote->setSlurStart( n->slurStart() );
-					prevNote->setSlurEnd( n->slurEnd() );
-					prevNote->setPhrasingSlurStart( n->phrasingSlurStart() );
-					prevNote->setPhrasingSlurEnd( n->phrasingSlurEnd() );
-
-					for (int i=0; i<n->markList().size(); i++) {
-						if ( n->markList()[i]->isCommon() ) {
-							prevNote->addMark( n->markList()[i] );
-							n->markList()[i]->setAssociatedElement( prevNote );
-							n->removeMark( n->markList()[i--] );
-						}
+	if ( indexOf(elt)!=-1 ) {	// if the search element is found
+		int idx;
+		if ( removeMusElement( elt, idx ) )
+			updateTimes( idx, elt->timeLength()*(-1), updateSigns ); // shift back timeStarts of playable elements after it
+
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/*!
+	Removes the given music element  elt from this voice or from all the voices in the staff,
+	if non-playable. The times of the following elements are not changed.
+
+	 idx is set to the index of the element following the removed one.
+
+	Returns True, if the elements after the removed one should be shifted back for its timeLength;
+	otherwise False.
+
+	\sa remove()
+*/
+bool CAVoice::removeMusElement( CAMusElement *elt, int &idx ) {
+	idx = indexOf(elt);
+	bool shift = false;
+
+	if ( !elt->isPlayable() && staff() ) {          // element is shared - remove it from all the voices
+		// indices of the following elements change in all voices, bars and chords need to be updated
+		for (int i=0; i<staff()->voiceList().size(); i++) {
+			staff()->voiceList()[i]->invalidateTimes( elt->timeStart() );
+			staff()->voiceList()[i]->_musElementList.removeAll(elt);
+		}
+		// remove it from the references list
+		staff()->removeSignRef( elt );
+		staff()->invalidateHash( elt );
+	} else {
+		// element is playable
+		if ( elt->musElementType()==CAMusElement::Note ) {
+			CANote *n = static_cast<CANote*>(elt);
+			if ( n->isPartOfChord() && n->isFirstInChord() ) {
+				// if the note is the first in the chord, the slurs and marks should be relinked to the 2nd in the chord
+				CANote *prevNote = n->getChord().at(1);
+				prevNote->setSlurStart( n->slurStart() );
+				prevNote->setSlurEnd( n->slurEnd() );
+				prevNote->setPhrasingSlurStart( n->phrasingSlurStart() );
+				prevNote->setPhrasingSlurEnd( n->phrasingSlurEnd() );
+
+				for (int i=0; i<n->markList().size(); i++) {
+					if ( n->markList()[i]->isCommon() ) {
+						prevNote->addMark( n->markList()[i] );
+						n->markList()[i]->setAssociatedElement( prevNote );
+						n->removeMark( n->markList()[i--] );
 					}
-				} else if ( !(n->isPartOfChord()) ) {
-					if ( n->slurStart() ) delete n->slurStart();
-					if ( n->slurEnd() ) delete n->slurEnd();
-					if ( n->phrasingSlurStart() ) delete n->phrasingSlurStart();
-					if ( n->phrasingSlurEnd() ) delete n->phrasingSlurEnd();
-					if ( n->tuplet() ) delete n->tuplet();
-
-					updateTimes( musElementList().indexOf(elt)+1, elt->timeLength()*(-1), updateSigns ); // shift back timeStarts of playable elements after it
 				}
-			} else {
-				if ( elt->isPlayable() && static_cast<CAPlayable*>(elt)->tuplet() ) delete static_cast<CAPlayable*>(elt)->tuplet();
-				updateTimes( musElementList().indexOf(elt)+1, elt->timeLength()*(-1), updateSigns ); // shift back timeStarts of playable elements after it
+			} else if ( !(n->isPartOfChord()) ) {
+				if ( n->slurStart() ) delete n->slurStart();
+				if ( n->slurEnd() ) delete n->slurEnd();
+				if ( n->phrasingSlurStart() ) delete n->phrasingSlurStart();
+				if ( n->phrasingSlurEnd() ) delete n->phrasingSlurEnd();
+				if ( n->tuplet() ) delete n->tuplet();
+
+				shift = true;
 			}
-
-			_musElementList.removeAll(elt);          // removes the element from the voice music element list
+		} else {
+			if ( elt->isPlayable() && static_cast<CAPlayable*>(elt)->tuplet() ) delete static_cast<CAPlayable*>(elt)->tuplet();
+			shift = true;
 		}
 
-		return true;
-	} else {
-		return false;
+		idx = indexOf(elt);                      // deleting the tuplet reinserts its elements
+		removeAt( idx );                         // removes the element from the voice music element list
 	}
+
+	return shift;
 }
 
 /*!
@@ -365,13 +383,13 @@ bool CAVoice::remove( CAMusElement *elt, bool updateSigns ) {
 */
 bool CAVoice::insertMusElement( CAMusElement *eltAfter, CAMusElement *elt ) {
 	if (!eltAfter || !_musElementList.size()) {
-		_musElementList.push_back(elt);
+		insertAt( _musElementList.size(), elt );
 	} else {
-		int i = musElementList().indexOf( eltAfter );
+		int i = indexOf( eltAfter );
 
 		// if element wasn't found and the element before is slur
 		if ( eltAfter->musElementType()==CAMusElement::Slur && i==-1 )
-			i = musElementList().indexOf( static_cast<CASlur*>(eltAfter)->noteEnd() );
+			i = indexOf( static_cast<CASlur*>(eltAfter)->noteEnd() );
 
 		if (i==-1) {
 			// eltBefore still wasn't found, return False
@@ -379,7 +397,7 @@ bool CAVoice::insertMusElement( CAMusElement *eltAfter, CAMusElement *elt ) {
 		}
 		
 		// eltBefore found, insert it
-		_musElementList.insert(i, elt);
+		insertAt( i, elt );
 	}
 	
 	CAMusElement *next = nextByType(elt->musElementType(), elt);
@@ -399,8 +417,9 @@ bool CAVoice::insertMusElement( CAMusElement *eltAfter, CAMusElement *elt ) {
 		}
 
 		if (!refs->contains(elt)) {
-			refs->insert(idxInRefs, elt);
+			staff()->addSignRef( elt, idxInRefs );
 		}
+		staff()->invalidateHash( elt );
 	}
 	
 	return true;
@@ -421,18 +440,18 @@ bool CAVoice::insertMusElement( CAMusElement *eltAfter, CAMusElement *elt ) {
 	\sa CANote::chord()
 */
 bool CAVoice::addNoteToChord(CANote *note, CANote *referenceNote) {
-	int idx = _musElementList.indexOf(referenceNote);
+	int idx = indexOf(referenceNote);
 
 	if (idx==-1)
 		return false;
 
 	QList<CANote*> chord = referenceNote->getChord();
-	idx = _musElementList.indexOf(chord.first());
+	idx = indexOf(chord.first());
 
 	int i;
 	for ( i=0; i<chord.size() && chord[i]->diatonicPitch().noteName() < note->diatonicPitch().noteName(); i++ );
 
-	_musElementList.insert( idx+i, note );
+	insertAt( idx+i, note );
 	note->setPlayableLength( referenceNote->playableLength() );
 	note->setTimeLength( referenceNote->timeLength() );
 	note->setTimeStart( referenceNote->timeStart() );
@@ -502,8 +521,15 @@ CANote* CAVoice::lastNote() {
 }
 
 
-//! \A common binary search Algorithm with its pseudocode
+/*!
+	A common binary search of the music element with the given \a time in the voice.
+
+	Returns True and sets \a position to the index of any of the elements starting at \a time, if
+	found. Otherwise returns False and sets \a position to the index where an element starting at
+	\a time would be inserted.
 
+	\sa lowerBoundIndex(), upperBoundIndex()
+*/
 bool CAVoice::binarySearch_startTime(int time, int& position) {
 
 	int low = 0, high = _musElementList.size()-1, midpoint = 0;
@@ -518,9 +544,96 @@ bool CAVoice::binarySearch_startTime(int time, int& position) {
 		else
 			low = midpoint + 1;
 	}
+	position = low;
 	return false;
 }
 
+/*!
+	Returns the index of the first music element in the voice with timeStart equal
+	or greater than the given \a time or the size of the list, if there is no such element.
+
+	Music elements in the voice are always sorted by their timeStart so the music
+	element list itself serves as a time index. The lookup is done in O(log n) plus the
+	number of elements starting at \a time.
+
+	\sa upperBoundIndex(), indexOf()
+*/
+int CAVoice::lowerBoundIndex( int time ) {
+	int i;
+	if ( binarySearch_startTime( time, i ) ) {
+		while ( i>0 && _musElementList[i-1]->timeStart()==time )
+			i--;
+	}
+	return i;
+}
+
+/*!
+	Returns the index of the first music element in the voice with timeStart strictly
+	greater than the given \a time or the size of the list, if there is no such element.
+
+	\sa lowerBoundIndex()
+*/
+int CAVoice::upperBoundIndex( int time ) {
+	int i;
+	if ( binarySearch_startTime( time, i ) ) {
+		while ( i<_musElementList.size() && _musElementList[i]->timeStart()==time )
+			i++;
+	}
+	return i;
+}
+
+/*!
+	Returns the index of the given music element \a elt in the voice or -1, if the
+	element isn't part of the voice.
+
+	Only the elements with the same timeStart are searched which takes O(log n). Until the
+	staff is synchronized, the shared signs after the changed time may be out of order (eg. when
+	the times were updated without the signs), so that part of the voice is searched as well.
+
+	If the element is still not found, the whole voice is searched. This only happens for
+	elements not in the voice or when the times are out of order without the staff knowing
+	it, which asserts in debug builds.
+
+	\sa CAStaff::dirtyTime()
+*/
+int CAVoice::indexOf( CAMusElement *elt ) {
+	if (!elt)
+		return -1;
+
+	int i = lowerBoundIndex( elt->timeStart() );
+	for (; i<_musElementList.size() && _musElementList[i]->timeStart()==elt->timeStart(); i++) {
+		if (_musElementList[i]==elt)
+			return i;
+	}
+
+	if ( staff() && staff()->dirtyTime()!=-1 ) {
+		for (i=_musElementList.size()-1; i>=0 && _musElementList[i]->timeStart()>=staff()->dirtyTime(); i--) {
+			if (_musElementList[i]==elt)
+				return i;
+		}
+	}
+
+	i = _musElementList.indexOf( elt );
+	Q_ASSERT_X( i==-1, "CAVoice::indexOf()", "element time is out of order" );
+	return i;
+}
+
+/*!
+	Returns the index of the last element of type \a type at or before the given \a elt or -1, if
+	there is no such element. If \a elt is Null or not in the voice, the search starts at the end.
+
+	The element is found in O(log n) and the list is walked back from there.
+*/
+int CAVoice::lastIndexOfType( CAMusElement::CAMusElementType type, CAMusElement *elt ) {
+	int i = elt ? indexOf(elt) : -1;
+	if ( i==-1 )
+		i = _musElementList.size()-1;
+
+	while ( i>=0 && _musElementList[i]->musElementType()!=type )
+		i--;
+
+	return i;
+}
 
 /*!
 	Returns a music element which has the given \a startTime and \a type.
@@ -529,8 +642,7 @@ bool CAVoice::binarySearch_startTime(int time, int& position) {
 */
 CAMusElement *CAVoice::getOneEltByType(CAMusElement::CAMusElementType type, int startTime) {
 
-	int i;
-	for (i=0; i < _musElementList.size() && _musElementList[i]->timeStart() < startTime; i++);	// seek to the start of the music elements with the given time
+	int i = lowerBoundIndex( startTime );	// seek to the start of the music elements with the given time
 
 	while (i<_musElementList.size() && _musElementList[i]->timeStart()==startTime) {	// create a list of music elements with the given time
 		if (_musElementList[i]->musElementType() == type)
@@ -550,8 +662,7 @@ CAMusElement *CAVoice::getOneEltByType(CAMusElement::CAMusElementType type, int
 QList<CAMusElement*> CAVoice::getEltByType(CAMusElement::CAMusElementType type, int startTime) {
 	QList<CAMusElement*> eltList;
 
-	int i;
-	for (i=0; i < _musElementList.size() && _musElementList[i]->timeStart() < startTime; i++);	// seek to the start of the music elements with the given time
+	int i = lowerBoundIndex( startTime );	// seek to the start of the music elements with the given time
 
 	while (i<_musElementList.size() && _musElementList[i]->timeStart()==startTime) {	// create a list of music elements with the given time
 		if (_musElementList[i]->musElementType() == type)
@@ -571,9 +682,7 @@ QList<CAMusElement*> CAVoice::getEltByType(CAMusElement::CAMusElementType type,
 */
 CAMusElement *CAVoice::getOnePreviousByType(CAMusElement::CAMusElementType type, int startTime) {
 
-	int i;
-	for (i= _musElementList.size()-1;
-			i >= 0 && _musElementList[i]->timeStart() > startTime; i--);	// seek to the most right of the music elements with the given time
+	int i = upperBoundIndex( startTime )-1;	// seek to the most right of the music elements with the given time
 	while (i >=0 && _musElementList[i]->timeStart() <= startTime) {	// create a list of music elements not past the given time
 		if (_musElementList[i]->musElementType() == type)
 			return _musElementList[i];
@@ -594,9 +703,7 @@ CAMusElement *CAVoice::getOnePreviousByType(CAMusElement::CAMusElementType type,
 QList<CAMusElement*> CAVoice::getPreviousByType(CAMusElement::CAMusElementType type, int startTime) {
 	QList<CAMusElement*> eltList;
 
-	int i;
-	for (i= _musElementList.size()-1;
-			i >= 0 && _musElementList[i]->timeStart() > startTime; i--);	// seek to the most right of the music elements with the given time
+	int i = upperBoundIndex( startTime )-1;	// seek to the most right of the music elements with the given time
 	while (i >=0 && _musElementList[i]->timeStart() <= startTime) {	// create a list of music elements not past the given time
 		if (_musElementList[i]->musElementType() == type)
 			eltList.prepend(_musElementList[i]);
@@ -607,18 +714,45 @@ QList<CAMusElement*> CAVoice::getPreviousByType(CAMusElement::CAMusElementType t
 	return eltList;
 }
 
+/*!
+	Returns the index of the last playable element of the chord sounding at the given
+	\a time or the first playable element after the \a time, if nothing is sounding.
+	Returns -1, if there are no such playable elements.
+
+	\sa getChord(), getBar()
+*/
+int CAVoice::chordIndex( int time ) {
+	int i = upperBoundIndex( time );
+
+	// playable elements are linear, so only the last playable element starting at or before the time can be sounding
+	int j = i-1;
+	while ( j>=0 && !_musElementList[j]->isPlayable() ) {
+		j--;
+	}
+	if ( j>=0 && _musElementList[j]->timeEnd()>time ) {
+		return j;
+	}
+
+	// otherwise take the first playable element after the time
+	while ( i<_musElementList.size() && !_musElementList[i]->isPlayable() ) {
+		i++;
+	}
+
+	return (i<_musElementList.size())?i:-1;
+}
+
 /*!
 	Returns a list of notes and rests (chord) in the given voice in the given
 	time slice \a time.
 
 	This is useful for determination of the harmony at certain point in time.
+	The chord is looked up in O(log n).
 
 	\sa CAStaff:getChord(), CASheet::getChord()
 */
 QList<CAPlayable*> CAVoice::getChord(int time) {
-	int i;
-	for (i=0; i<_musElementList.size() && (_musElementList[i]->timeEnd()<=time || !_musElementList[i]->isPlayable()); i++);
-	if (i!=_musElementList.size()) {
+	int i = chordIndex( time );
+	if (i!=-1) {
 		if (_musElementList[i]->musElementType()==CAMusElement::Note) {	// music element is a note
 			//! \todo Casting QList<CANote*> to QList<CAPlayable*> doesn't work?! :( Do the conversation manually. This is slow. -Matevz
 			QList<CANote*> list = static_cast<CANote*>(_musElementList[i])->getChord();
@@ -644,32 +778,37 @@ QList<CAPlayable*> CAVoice::getChord(int time) {
 	The parameter \a time is any time of music elements inside the bar.
 
 	This function is usually called when double clicking on the score.
+	The bar is found in O(log n) and then walked by indices.
  */
 QList<CAMusElement*> CAVoice::getBar( int time ) {
-	QList<CAPlayable*> chord = getChord(time);
 	QList<CAMusElement*> ret;
+	int idx = chordIndex( time );
 
-	if ( !chord.size() ) {
+	if ( idx==-1 ) {
 		return ret;
 	}
 
+	// rewind to the first note in the chord
+	while ( idx>0 && _musElementList[idx]->musElementType()==CAMusElement::Note &&
+	        _musElementList[idx-1]->musElementType()==CAMusElement::Note &&
+	        _musElementList[idx-1]->timeStart()==_musElementList[idx]->timeStart() ) {
+		idx--;
+	}
+
 	// search left
-	CAMusElement *curElt = previous( chord[0] );
-	while ( curElt && curElt->musElementType()!=CAMusElement::Barline ) {
-		ret.append( curElt );
-		curElt = previous(curElt);
+	int i;
+	for ( i=idx-1; i>=0 && _musElementList[i]->musElementType()!=CAMusElement::Barline; i-- ) {
+		ret.append( _musElementList[i] );
 	}
 
-	ret.append( chord[0] );
+	ret.append( _musElementList[idx] );
 
-	curElt = next( chord[0] );
-	while ( curElt && curElt->musElementType()!=CAMusElement::Barline ) {
-		ret.append( curElt );
-		curElt = next(curElt);
+	for ( i=idx+1; i<_musElementList.size() && _musElementList[i]->musElementType()!=CAMusElement::Barline; i++ ) {
+		ret.append( _musElementList[i] );
 	}
 
-	if (curElt) { // last elt is barline
-		ret.append( curElt );
+	if ( i<_musElementList.size() ) { // last elt is barline
+		ret.append( _musElementList[i] );
 	}
 
 	return ret;
@@ -714,7 +853,7 @@ CAMusElement *CAVoice::next(CAMusElement *elt) {
 	if(musElementList().isEmpty())
 		return 0;
 	if (elt) {
-		int idx = _musElementList.indexOf(elt);
+		int idx = indexOf(elt);
 
 		if (idx==-1) //the element wasn't found
 			return 0;
@@ -766,7 +905,7 @@ CAMusElement *CAVoice::previous(CAMusElement *elt) {
 	if(musElementList().isEmpty())
 		return 0;
 	if (elt) {
-		int idx = _musElementList.indexOf(elt);
+		int idx = indexOf(elt);
 
 		if (--idx<0) //if the element wasn't found or was the first element
 			return 0;
@@ -783,11 +922,9 @@ CAMusElement *CAVoice::previous(CAMusElement *elt) {
 */
 CANote *CAVoice::nextNote( int timeStart ) {
 	int i;
-	for (i=0;
+	for (i=upperBoundIndex(timeStart);
 	     i<_musElementList.size() &&
-	     	(_musElementList[i]->musElementType()!=CAMusElement::Note ||
-	     	 _musElementList[i]->timeStart()<=timeStart
-	     	);
+	     	_musElementList[i]->musElementType()!=CAMusElement::Note;
 	     i++);
 
 	if (i<_musElementList.size())
@@ -802,11 +939,9 @@ CANote *CAVoice::nextNote( int timeStart ) {
 */
 CANote *CAVoice::previousNote( int timeStart ) {
 	int i;
-	for (i=_musElementList.size()-1;
+	for (i=lowerBoundIndex(timeStart)-1;
 	     i>-1 &&
-	     	(_musElementList[i]->musElementType()!=CAMusElement::Note ||
-	     	 _musElementList[i]->timeStart()>=timeStart
-	     	);
+	     	_musElementList[i]->musElementType()!=CAMusElement::Note;
 	     i--);
 
 	if (i>-1)
@@ -821,11 +956,9 @@ CANote *CAVoice::previousNote( int timeStart ) {
 */
 CARest *CAVoice::nextRest(int timeStart) {
 	int i;
-	for (i=0;
+	for (i=upperBoundIndex(timeStart);
 	     i<_musElementList.size() &&
-	     	(_musElementList[i]->musElementType()!=CAMusElement::Rest ||
-	     	 _musElementList[i]->timeStart()<=timeStart
-	     	);
+	     	_musElementList[i]->musElementType()!=CAMusElement::Rest;
 	     i++);
 
 	if (i<_musElementList.size())
@@ -840,11 +973,9 @@ CARest *CAVoice::nextRest(int timeStart) {
 */
 CARest *CAVoice::previousRest(int timeStart) {
 	int i;
-	for (i=_musElementList.size()-1;
+	for (i=lowerBoundIndex(timeStart)-1;
 	     i>-1 &&
-	     	(_musElementList[i]->musElementType()!=CAMusElement::Rest ||
-	     	 _musElementList[i]->timeStart()>=timeStart
-	     	);
+	     	_musElementList[i]->musElementType()!=CAMusElement::Rest;
 	     i--);
 
 	if (i>-1)
@@ -859,11 +990,9 @@ CARest *CAVoice::previousRest(int timeStart) {
 */
 CAPlayable *CAVoice::nextPlayable(int timeStart) {
 	int i;
-	for (i=0;
+	for (i=upperBoundIndex(timeStart);
 	     i<_musElementList.size() &&
-	     	(!_musElementList[i]->isPlayable() ||
-	     	 _musElementList[i]->timeStart()<=timeStart
-	     	);
+	     	!_musElementList[i]->isPlayable();
 	     i++);
 
 	if (i<_musElementList.size())
@@ -878,11 +1007,9 @@ CAPlayable *CAVoice::nextPlayable(int timeStart) {
 */
 CAPlayable *CAVoice::previousPlayable(int timeStart) {
 	int i;
-	for (i=_musElementList.size()-1;
+	for (i=lowerBoundIndex(timeStart)-1;
 	     i>-1 &&
-	     	(!_musElementList[i]->isPlayable() ||
-	     	 _musElementList[i]->timeStart()>=timeStart
-	     	);
+	     	!_musElementList[i]->isPlayable();
 	     i--);
 
 	if (i>-1)
@@ -897,18 +1024,292 @@ CAPlayable *CAVoice::previousPlayable(int timeStart) {
 
 	This method is usually called when inserting, removing or changing the music elements so they affect
 	others.
+
+	Only the elements in the time block of the first playable element after \a idx are updated one by
+	one. Following blocks are shifted by changing their offsets which takes O(n/TimeBlockSize). Shared
+	signs are kept in time blocks by the staff and shifted the same way.
+
+	\sa CATimeBlock, CAStaff::shiftSigns()
 */
 bool CAVoice::updateTimes( int idx, int length, bool signsToo ) {
-	for (int i=idx; i<musElementList().size(); i++)
-		if ( signsToo || musElementList()[i]->isPlayable() ) {
-			musElementList()[i]->setTimeStart( musElementList()[i]->timeStart() + length );
-			for (int j=0; j<musElementList()[i]->markList().size(); j++) {
-				CAMark *m = musElementList()[i]->markList()[j];
-				if ( !m->isCommon() || musElementList()[i]->musElementType()!=CAMusElement::Note ||
-				     static_cast<CANote*>(musElementList()[i])->isFirstInChord() )
-					m->setTimeStart( musElementList()[i]->timeStart() );
+	if ( staff() && staff()->sheet() )
+		staff()->sheet()->tempoMap()->invalidate(); // tempo marks might have moved
+
+	invalidateTimes( idx>0 && idx<=_musElementList.size() ? _musElementList[idx-1]->timeStart() : 0 );
+
+	invalidateHash(); // offsets of the following blocks change
+
+	// find the end of the time block which contains the first playable element after idx
+	CATimeBlock *block = 0;
+	bool blockFound = false;
+	int end;
+	for (end=idx; end<_musElementList.size(); end++) {
+		if ( _musElementList[end]->isPlayable() ) {
+			if ( !blockFound ) {
+				block = _musElementList[end]->timeBlock();
+				blockFound = true;
+			} else if ( _musElementList[end]->timeBlock()!=block ) {
+				break;
+			}
+		}
+	}
+
+	// shift the shared signs after the block while the times are still consistent
+	if ( signsToo && end<_musElementList.size() ) {
+		if ( staff() ) {
+			staff()->shiftSigns( this, end, length );
+		} else {
+			for (int i=end; i<_musElementList.size(); i++) {
+				if ( !_musElementList[i]->isPlayable() )
+					shiftTime( _musElementList[i], length );
 			}
 		}
+	}
+
+	for (int i=idx; i<end; i++)
+		if ( signsToo || _musElementList[i]->isPlayable() )
+			shiftTime( _musElementList[i], length );
+
+	if ( end<_musElementList.size() ) {
+		for (int i=_timeBlockList.indexOf(block)+1; i<_timeBlockList.size(); i++)
+			_timeBlockList[i]->setOffset( _timeBlockList[i]->offset() + length );
+	}
+
+	return true; // What to return ? Maybe if some music element times were actually set
+}
+
+/*!
+	Shifts the timeStart of the given \a elt and its marks for \a length.
+*/
+void CAVoice::shiftTime( CAMusElement *elt, int length ) {
+	elt->setTimeStart( elt->timeStart() + length );
+	for (int j=0; j<elt->markList().size(); j++) {
+		CAMark *m = elt->markList()[j];
+		if ( !m->isCommon() || elt->musElementType()!=CAMusElement::Note ||
+		     static_cast<CANote*>(elt)->isFirstInChord() )
+			m->setTimeStart( elt->timeStart() );
+	}
+}
+
+/*!
+	Maximum number of playable elements in a time block is twice this number.
+	Bigger blocks are split in halves.
+
+	\sa CATimeBlock, splitTimeBlock()
+*/
+const int CAVoice::TimeBlockSize = 64;
+
+/*!
+	Inserts the \a elt at the given index \a idx in the music elements list.
+
+	Playable elements are added to the time block of their neighbour playable element. If there are no
+	playable elements in the voice yet, a new time block is created.
+
+	\sa removeAt(), CATimeBlock
+*/
+void CAVoice::insertAt( int idx, CAMusElement *elt ) {
+	invalidateTimes( idx>0 ? _musElementList[idx-1]->timeStart() : 0 );
+
+	_musElementList.insert( idx, elt );
+
+	if ( !elt->isPlayable() ) {
+		if ( staff() )
+			staff()->invalidateHash( elt );
+		return;
+	}
+
+	CATimeBlock *block = 0;
+	int i;
+	for (i=idx-1; i>=0 && !_musElementList[i]->isPlayable(); i--);
+	if ( i>=0 ) {
+		block = _musElementList[i]->timeBlock();
+	} else {
+		for (i=idx+1; i<_musElementList.size() && !_musElementList[i]->isPlayable(); i++);
+		if ( i<_musElementList.size() )
+			block = _musElementList[i]->timeBlock();
+	}
+
+	if ( !block ) {
+		block = new CATimeBlock();
+		_timeBlockList.prepend( block );
+	}
+
+	elt->setTimeBlock( block );
+	block->setCount( block->count()+1 );
+	block->invalidateHash( elt );
+	invalidateHash();
+
+	if ( block->count() > 2*TimeBlockSize )
+		splitTimeBlock( idx );
+}
+
+/*!
+	Removes the element at the given index \a idx from the music elements list.
+	Playable element is removed from its time block and gets its absolute time back.
+
+	\sa insertAt()
+*/
+void CAVoice::removeAt( int idx ) {
+	invalidateTimes( idx>0 ? _musElementList[idx-1]->timeStart() : 0 );
+
+	CAMusElement *elt = _musElementList.takeAt( idx );
+	CATimeBlock *block = ( elt->isPlayable() ? elt->timeBlock() : 0 ); // shared signs are in the staff blocks
+
+	if ( block ) {
+		elt->setTimeBlock( 0 );
+		block->setCount( block->count()-1 );
+		if ( !block->count() ) {
+			_timeBlockList.removeAll( block );
+			delete block;
+		} else {
+			// the nearest playable element is part of the same block
+			int i;
+			for (i=idx; i<_musElementList.size() && !_musElementList[i]->isPlayable(); i++);
+			if ( i==_musElementList.size() || _musElementList[i]->timeBlock()!=block )
+				for (i=idx-1; i>=0 && !_musElementList[i]->isPlayable(); i--);
+			block->invalidateHash( i>=0 ? _musElementList[i] : 0 );
+		}
+		invalidateHash();
+	} else if ( staff() ) {
+		staff()->invalidateHash( elt );
+	}
+}
+
+/*!
+	Splits the time block of the element at index \a idx in halves.
+	The new block is inserted after the existing one and has the same offset.
+*/
+void CAVoice::splitTimeBlock( int idx ) {
+	CATimeBlock *block = _musElementList[idx]->timeBlock();
+
+	// find the first element in the block
+	int first = idx;
+	for (int i=idx-1; i>=0; i--) {
+		if ( !_musElementList[i]->isPlayable() )
+			continue;
+		if ( _musElementList[i]->timeBlock()!=block )
+			break;
+		first = i;
+	}
+
+	CATimeBlock *newBlock = new CATimeBlock( block->offset() );
+	_timeBlockList.insert( _timeBlockList.indexOf(block)+1, newBlock );
+
+	int half = block->count()/2;
+	int n = 0;
+	for (int i=first; i<_musElementList.size(); i++) {
+		if ( !_musElementList[i]->isPlayable() )
+			continue;
+		if ( _musElementList[i]->timeBlock()!=block )
+			break;
+		if ( n++ >= half ) {
+			if ( n==half+1 )
+				newBlock->invalidateHash( _musElementList[i] );
+			_musElementList[i]->setTimeBlock( newBlock );
+		}
+	}
+
+	newBlock->setCount( block->count()-half );
+	block->setCount( half );
+	block->invalidateHash( _musElementList[first] );
+	invalidateHash();
+}
+
+/*!
+	Notifies the staff and the lyrics contexts of the voice that the elements starting at
+	\a timeStart or later were changed.
+
+	\sa CAStaff::invalidateVoices(), CALyricsContext::invalidateSyllables()
+*/
+void CAVoice::invalidateTimes( int timeStart ) {
+	if ( staff() ) {
+		staff()->invalidateVoices( timeStart );
+	}
+
+	for (int i=0; i<_lyricsContextList.size(); i++) {
+		_lyricsContextList[i]->invalidateSyllables( timeStart );
+	}
+}
+
+/*!
+	Returns the hash of the voice content and its properties. Shared signs are hashed by the staff.
+
+	Every time block caches the hash of its playable elements relative to its offset. Only the
+	blocks changed since the last call are rehashed, so the hash is updated in O(TimeBlockSize)
+	for a change of a single element plus O(n/TimeBlockSize) for combining the block hashes.
+	Shifting the elements after the changed one only changes the block offsets.
+
+	\sa invalidateHash(), CAStaff::contentHash(), CATimeBlock
+*/
+unsigned int CAVoice::contentHash() {
+	if ( _hashValid ) {
+		return _hash;
+	}
+
+	_hash = CAMusElement::combineHash( qHash(name()), stemDirection() );
+	_hash = CAMusElement::combineHash( _hash, midiChannel() );
+	_hash = CAMusElement::combineHash( _hash, midiProgram() );
+	_hash = CAMusElement::combineHash( _hash, midiPitchOffset() );
+
+	for (int i=0; i<_timeBlockList.size(); i++) {
+		if ( !_timeBlockList[i]->isHashValid() ) {
+			rehashTimeBlock( _timeBlockList[i] );
+		}
+		_hash = CAMusElement::combineHash( _hash, _timeBlockList[i]->hash() );
+		_hash = CAMusElement::combineHash( _hash, _timeBlockList[i]->offset() );
+	}
+	_hashValid = true;
+
+	return _hash;
+}
+
+/*!
+	Invalidates the cached hash of the voice and its staff.
+	Time blocks are invalidated separately by the staff when their elements change.
+
+	\sa contentHash(), CAStaff::invalidateHash()
+*/
+void CAVoice::invalidateHash() {
+	_hashValid = false;
+	if ( staff() ) {
+		staff()->invalidateHash();
+	}
+}
+
+/*!
+	Recalculates the hash of the playable elements in the given time \a block.
+	The block is found by its remembered member element.
+*/
+void CAVoice::rehashTimeBlock( CATimeBlock *block ) {
+	int idx = ( block->member() && block->member()->timeBlock()==block ) ? indexOf( block->member() ) : -1;
+	if ( idx==-1 ) {
+		for (idx=0; idx<_musElementList.size() && _musElementList[idx]->timeBlock()!=block; idx++);
+	}
+
+	// find the first element in the block
+	int first = idx;
+	for (int i=idx-1; i>=0; i--) {
+		if ( !_musElementList[i]->isPlayable() )
+			continue;
+		if ( _musElementList[i]->timeBlock()!=block )
+			break;
+		first = i;
+	}
+
+	unsigned int h = 0;
+	for (int i=first; i<_musElementList.size(); i++) {
+		CAMusElement *elt = _musElementList[i];
+		if ( !elt->isPlayable() )
+			continue;
+		if ( elt->timeBlock()!=block )
+			break;
+		h = CAMusElement::combineHash( h, elt->contentHash() );
+		h = CAMusElement::combineHash( h, elt->timeStart() - block->offset() );
+	}
+
+	block->setHash( h );
+}
+		}
 	return true; // What to return ? Maybe if some music element times were actually set
 }
 
@@ -918,11 +1319,13 @@ bool CAVoice::updateTimes( int idx, int length, bool signsToo ) {
 	   to first note in the chord.
 	   The exception are non-common marks (eg. fingering), which are assigned to each note separately.
 
+	Only the elements starting at \a timeStart or later are checked.
+
 	Returns True, if fixes were made or False otherwise.
 */
-bool CAVoice::synchronizeMusElements() {
+bool CAVoice::synchronizeMusElements( int timeStart ) {
 	bool fixesMade = false;
-	for (int i=0; i<musElementList().size(); i++) {
+	for (int i=lowerBoundIndex(timeStart); i<musElementList().size(); i++) {
 		if ( musElementList()[i]->musElementType()==CAMusElement::Note &&
 		     musElementList()[i]->markList().size() &&
 		     static_cast<CANote*>(musElementList()[i])->isPartOfChord() ) {
@@ -965,9 +1368,8 @@ bool CAVoice::synchronizeMusElements() {
 	are ignored.
 */
 bool CAVoice::containsPitch( int noteName, int timeStart ) {
-	for (int i=0 ;i<_musElementList.size(); i++) {
-		if ( _musElementList[i]->timeStart()==timeStart &&
-		     _musElementList[i]->musElementType()==CAMusElement::Note &&
+	for (int i=lowerBoundIndex(timeStart); i<_musElementList.size() && _musElementList[i]->timeStart()==timeStart; i++) {
+		if ( _musElementList[i]->musElementType()==CAMusElement::Note &&
 		     static_cast<CANote*>(_musElementList[i])->diatonicPitch().noteName()==noteName )
 			return true;
 	}
@@ -983,9 +1385,8 @@ bool CAVoice::containsPitch( int noteName, int timeStart ) {
 	adding a note to a chord and the note is maybe already there.
 */
 bool CAVoice::containsPitch( CADiatonicPitch p, int timeStart ) {
-	for (int i=0 ;i<_musElementList.size(); i++) {
-		if ( _musElementList[i]->timeStart()==timeStart &&
-		     _musElementList[i]->musElementType()==CAMusElement::Note &&
+	for (int i=lowerBoundIndex(timeStart); i<_musElementList.size() && _musElementList[i]->timeStart()==timeStart; i++) {
+		if ( _musElementList[i]->musElementType()==CAMusElement::Note &&
 		     static_cast<CANote*>(_musElementList[i])->diatonicPitch()==p )
 			return true;
 	}
@@ -1002,7 +1403,7 @@ CATempo *CAVoice::getTempo( int time ) {
 	if ( chord.isEmpty() ) {
 		curElt = musElementList().size()-1;
 	} else {
-		curElt = musElementList().indexOf(chord.last());
+		curElt = indexOf(chord.last());
 	}
 
 	CATempo *tempo = 0;
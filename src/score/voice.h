@@ -21,7 +21,8 @@ class CARest;
 class CATempo;
 
 class CAVoice {
-	friend class CAStaff; // used for insertion of music elements and updateTimes() when inserting elements and synchronizing voices
+	friend class CAStaff; // used for insertAt(), removeAt() and updateTimes() when inserting elements and synchronizing voices
+	friend class CAEditTransaction; // used for insertMusElement(), removeMusElement() and updateTimes() when applying edits in batch
 
 public:
 	CAVoice( const QString name, CAStaff *staff, CANote::CAStemDirection stemDirection=CANote::StemNeutral );
@@ -39,7 +40,7 @@ public:
 	bool insert( CAMusElement *eltAfter, CAMusElement *elt, bool addToChord=false );
 	bool remove( CAMusElement *elt, bool updateSignsTimes=true );
 	CAPlayable* insertInTupletAndVoiceAt( CAPlayable *p, CAPlayable *n );
-	bool synchronizeMusElements();
+	bool synchronizeMusElements( int timeStart=0 );
 
 	//////////////////////////////
 	// Voice analysis and query //
@@ -50,6 +51,7 @@ public:
 	QList<CANote*> getNoteList();
 	bool containsPitch( int noteName , int timeStart );
 	bool containsPitch( CADiatonicPitch p, int timeStart );
+	int indexOf( CAMusElement *elt );
 	CAMusElement *next(CAMusElement *elt);
 	CAMusElement *previous(CAMusElement *elt);
 	CAMusElement *nextByType(CAMusElement::CAMusElementType type, CAMusElement *elt);
@@ -63,6 +65,8 @@ public:
 	CAPlayable *previousPlayable(int timeStart);
 
 	bool binarySearch_startTime(int time, int& position);
+	int lowerBoundIndex( int time );
+	int upperBoundIndex( int time );
 
 	CAMusElement *getOneEltByType(CAMusElement::CAMusElementType type, int startTime);
 	QList<CAMusElement*> getEltByType(CAMusElement::CAMusElementType type, int startTime);
@@ -96,19 +100,22 @@ public:
 	inline bool isFirstVoice() { return (voiceNumber()==1); }
 
 	inline CANote::CAStemDirection stemDirection() { return _stemDirection; }
-	inline void setStemDirection( CANote::CAStemDirection direction ) { _stemDirection = direction; }
+	inline void setStemDirection( CANote::CAStemDirection direction ) { _stemDirection = direction; invalidateHash(); }
 
 	inline const QString name() { return _name; }
-	inline void setName(const QString name) { _name = name; }
+	inline void setName(const QString name) { _name = name; invalidateHash(); }
 
 	inline unsigned char midiChannel() { return _midiChannel; }
-	inline void setMidiChannel(const unsigned char ch) { _midiChannel = ch; }
+	inline void setMidiChannel(const unsigned char ch) { _midiChannel = ch; invalidateHash(); }
 
 	inline unsigned char midiProgram() { return _midiProgram; }
-	inline void setMidiProgram(const unsigned char program) { _midiProgram = program; }
+	inline void setMidiProgram(const unsigned char program) { _midiProgram = program; invalidateHash(); }
 
 	inline char midiPitchOffset() { return _midiPitchOffset; }
-	inline void setMidiPitchOffset(const char midiPitchOffset) { _midiPitchOffset = midiPitchOffset; }
+	inline void setMidiPitchOffset(const char midiPitchOffset) { _midiPitchOffset = midiPitchOffset; invalidateHash(); }
+
+	unsigned int contentHash();
+	void invalidateHash();
 
 	inline const QList<CALyricsContext*>& lyricsContextList() { return _lyricsContextList; }
 	inline void addLyricsContext( CALyricsContext *lc ) { _lyricsContextList << lc; }
@@ -119,10 +126,24 @@ public:
 private:
 	bool addNoteToChord(CANote *note, CANote *referenceNote);
 	bool insertMusElement( CAMusElement *before, CAMusElement *elt );
+	bool removeMusElement( CAMusElement *elt, int &idx );
 	bool updateTimes( int idx, int length, bool signsToo=false );
+	void shiftTime( CAMusElement *elt, int length );
+	int chordIndex( int time );
+	int lastIndexOfType( CAMusElement::CAMusElementType type, CAMusElement *elt );
+	void invalidateTimes( int timeStart );
+
+	void insertAt( int idx, CAMusElement *elt );
+	void removeAt( int idx );
+	void splitTimeBlock( int idx );
+	void rehashTimeBlock( CATimeBlock *block );
 
 	// list of all the music elements
 	QList<CAMusElement *> _musElementList;
+	QList<CATimeBlock *> _timeBlockList; // time blocks of playable elements in order of appearance
+	static const int TimeBlockSize;
+	unsigned int _hash; // cached contentHash()
+	bool _hashValid;
 	CAStaff *_staff; // parent staff
 	
 	CANote::CAStemDirection _stemDirection;
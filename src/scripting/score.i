@@ -21,6 +21,7 @@
 #include "score/interval.h"
 #include "score/diatonickey.h"
 #include "core/transpose.h"
+#include "core/edittransaction.h"
 
 #include "score/muselement.h"
 #include "score/playable.h"
@@ -53,6 +54,7 @@
 %include "score/interval.h"
 %include "score/diatonickey.h"
 %include "core/transpose.h"
+%include "core/edittransaction.h"
 
 %include "score/muselement.h"
 %include "score/playable.h"
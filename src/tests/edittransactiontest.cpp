@@ -0,0 +1,202 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QtTest>
+
+#include "core/edittransaction.h"
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/note.h"
+#include "score/clef.h"
+#include "score/timesignature.h"
+#include "score/barline.h"
+
+/*!
+	\class CAEditTransactionTest
+	\brief Unit tests of the batch edits
+
+	The edits are applied to two equal staffs, to one by the CAVoice methods one by one and to the
+	other by a transaction. The resulting voices should be equal.
+	Each staff has two voices with a clef, 4/4 time signature and 100 bars of four quarters.
+*/
+class CAEditTransactionTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void init();
+	void cleanup();
+
+	void insert();
+	void remove();
+	void rollback();
+
+private:
+	CAStaff *createStaff( CADocument *document );
+	CANote *createNote( CAVoice *voice, int pitch, CAPlayableLength::CAMusicLength length=CAPlayableLength::Quarter );
+	QStringList describe( CAStaff *staff );
+
+	CADocument *_document;
+	CAStaff *_staff;      // edited one by one
+	CAStaff *_batchStaff; // edited by a transaction
+};
+
+CAStaff *CAEditTransactionTest::createStaff( CADocument *document ) {
+	CAStaff *staff = document->addSheet()->addStaff();
+	CAVoice *voice1 = staff->voiceList()[0];
+	CAVoice *voice2 = staff->addVoice();
+
+	voice1->append( new CAClef( CAClef::Treble, staff, 0 ) );
+	voice1->append( new CATimeSignature( 4, 4, staff, 0 ) );
+	for (int i=0; i<100; i++) {
+		for (int j=0; j<4; j++) {
+			voice1->append( createNote( voice1, 28+j ) );
+			voice2->append( createNote( voice2, 21+j ) );
+		}
+		voice1->append( new CABarline( CABarline::Single, staff, 0 ) );
+	}
+	staff->synchronizeVoices();
+
+	return staff;
+}
+
+CANote *CAEditTransactionTest::createNote( CAVoice *voice, int pitch, CAPlayableLength::CAMusicLength length ) {
+	return new CANote( CADiatonicPitch(pitch), CAPlayableLength(length), voice, 0 );
+}
+
+/*!
+	Returns the type, time, length and pitch of the elements of all the voices in the \a staff.
+*/
+QStringList CAEditTransactionTest::describe( CAStaff *staff ) {
+	QStringList list;
+	for (int i=0; i<staff->voiceList().size(); i++) {
+		CAVoice *voice = staff->voiceList()[i];
+		for (int j=0; j<voice->musElementList().size(); j++) {
+			CAMusElement *elt = voice->musElementList()[j];
+			list << QString("%1:%2 %3 %4 %5").arg(i).arg(elt->musElementType()).arg(elt->timeStart()).arg(elt->timeLength())
+			        .arg( elt->musElementType()==CAMusElement::Note ? static_cast<CANote*>(elt)->diatonicPitch().noteName() : -1 );
+		}
+	}
+
+	return list;
+}
+
+void CAEditTransactionTest::init() {
+	_document = new CADocument();
+	_staff = createStaff( _document );
+	_batchStaff = createStaff( _document );
+	QCOMPARE( describe(_batchStaff), describe(_staff) );
+}
+
+void CAEditTransactionTest::cleanup() {
+	delete _document;
+}
+
+/*!
+	Inserting notes at several places, also in front of the same element, adding them to existing
+	and inserted chords and appending them should give the same voice as inserting them one by one.
+	The last bars are in other time blocks than the first ones and are only shifted by the block offset.
+*/
+void CAEditTransactionTest::insert() {
+	CAVoice *voice = _staff->voiceList()[0];
+	CAVoice *batchVoice = _batchStaff->voiceList()[0];
+	QList<CAMusElement*> elts = voice->musElementList();
+	QList<CAMusElement*> batchElts = batchVoice->musElementList();
+	QList<int> idx;
+	idx << 3 << 3 << 4 << 7 << 250 << 251 << 498;
+
+	CAEditTransaction transaction(0);
+	for (int i=0; i<idx.size(); i++) {
+		CAPlayableLength::CAMusicLength length = ( i%2 ? CAPlayableLength::Eighth : CAPlayableLength::Half );
+		QVERIFY( voice->insert( elts[idx[i]], createNote( voice, 35+i, length ) ) );
+		transaction.insert( batchVoice, batchElts[idx[i]], createNote( batchVoice, 35+i, length ) );
+	}
+
+	// add to an existing chord and to the inserted one
+	CANote *note = createNote( voice, 40 );
+	CANote *batchNote = createNote( batchVoice, 40 );
+	QVERIFY( voice->insert( elts[5], note ) );
+	transaction.insert( batchVoice, batchElts[5], batchNote );
+	QVERIFY( voice->insert( elts[5], createNote( voice, 42 ), true ) );
+	transaction.insert( batchVoice, batchElts[5], createNote( batchVoice, 42 ), true );
+	QVERIFY( voice->insert( note, createNote( voice, 41 ), true ) );
+	transaction.insert( batchVoice, batchNote, createNote( batchVoice, 41 ), true );
+
+	voice->append( createNote( voice, 30 ) );
+	transaction.append( batchVoice, createNote( batchVoice, 30 ) );
+	voice->append( createNote( voice, 32 ), true );
+	transaction.append( batchVoice, createNote( batchVoice, 32 ), true );
+
+	_staff->synchronizeVoices();
+	QVERIFY( transaction.commit() );
+	QVERIFY( transaction.isCommitted() );
+
+	QCOMPARE( describe(_batchStaff), describe(_staff) );
+	for (int i=0; i<batchVoice->musElementList().size(); i++) {
+		QCOMPARE( batchVoice->indexOf( batchVoice->musElementList()[i] ), i );
+	}
+}
+
+/*!
+	Removing adjacent and distant notes, a shared barline and a note of a chord should give the
+	same voices as removing them one by one.
+*/
+void CAEditTransactionTest::remove() {
+	QList<int> idx;
+	idx << 3 << 4 << 7 << 8 << 300 << 301;
+
+	CAVoice *voice = _staff->voiceList()[0];
+	CAVoice *batchVoice = _batchStaff->voiceList()[0];
+	QVERIFY( voice->insert( voice->musElementList()[100], createNote( voice, 40 ), true ) );
+	QVERIFY( batchVoice->insert( batchVoice->musElementList()[100], createNote( batchVoice, 40 ), true ) );
+	idx << 100;
+
+	QList<CAMusElement*> elts = voice->musElementList();
+	QList<CAMusElement*> batchElts = batchVoice->musElementList();
+
+	CAEditTransaction transaction(0);
+	for (int i=0; i<idx.size(); i++) {
+		QVERIFY( voice->remove( elts[idx[i]] ) );
+		transaction.remove( batchElts[idx[i]] );
+	}
+
+	_staff->synchronizeVoices();
+	QVERIFY( transaction.commit() );
+
+	QCOMPARE( describe(_batchStaff), describe(_staff) );
+	for (int i=0; i<idx.size(); i++) {
+		QCOMPARE( batchVoice->indexOf( batchElts[idx[i]] ), -1 );
+		delete elts[idx[i]];
+		delete batchElts[idx[i]];
+	}
+}
+
+/*!
+	Rolling back should leave the voice unchanged and the queued elements alive.
+*/
+void CAEditTransactionTest::rollback() {
+	CAVoice *voice = _batchStaff->voiceList()[0];
+	CANote *note = createNote( voice, 30 );
+	CAMusElement *removed = voice->musElementList()[3];
+
+	CAEditTransaction *transaction = new CAEditTransaction(0);
+	transaction->insert( voice, voice->musElementList()[3], note );
+	transaction->remove( removed );
+	transaction->rollback();
+	QVERIFY( transaction->isEmpty() );
+	QVERIFY( !transaction->isCommitted() );
+	delete transaction;
+
+	QCOMPARE( describe(_batchStaff), describe(_staff) );
+	QCOMPARE( voice->indexOf(note), -1 );
+	QCOMPARE( voice->indexOf(removed), 3 );
+	delete note;
+}
+
+QTEST_APPLESS_MAIN(CAEditTransactionTest)
+#include "edittransactiontest.moc"
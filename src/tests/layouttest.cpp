@@ -0,0 +1,281 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QtTest>
+#include <QThread>
+
+#include "layout/layout.h"
+#include "layout/layoutengine.h"
+#include "layout/drawablemuselement.h"
+#include "layout/drawableslur.h"
+
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/note.h"
+#include "score/clef.h"
+#include "score/timesignature.h"
+#include "score/barline.h"
+#include "score/slur.h"
+
+/*!
+	Lays out the given sheet into its own layout in a separate thread.
+*/
+class CALayoutThread : public QThread {
+public:
+	CALayoutThread( CASheet *sheet ) { _sheet = sheet; _count = 0; }
+
+	inline int drawableCount() { return _count; }
+
+protected:
+	void run() {
+		CALayout layout( _sheet );
+		CALayoutEngine::reposit( &layout );
+		_count = layout.drawableMList().size();
+	}
+
+private:
+	CASheet *_sheet;
+	int _count;
+};
+
+/*!
+	\class CALayoutTest
+	\brief Unit tests and benchmarks of the headless layout engine
+
+	Each test uses documents with one sheet of StaffCount staffs, each with a clef, 4/4 and
+	BarCount bars of quarter notes. The sheets are laid out into CALayout without any view.
+
+	The benchmarks lay out a single sheet and SheetCount sheets one after another and
+	concurrently, each sheet in its own thread and layout.
+*/
+class CALayoutTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void repositAllElements();
+	void concurrentLayout();
+	void chunkedTies();
+	void recycleUnchanged();
+
+	void benchmarkReposit();
+	void benchmarkRepositSequential();
+	void benchmarkRepositConcurrent();
+
+private:
+	static CADocument *createDocument();
+	static QList<CASlur*> tieBars( CASheet *sheet );
+
+	enum {
+		StaffCount = 4,
+		BarCount = 200,
+		SheetCount = 4
+	};
+
+	QList<CADocument*> _documents; // one per sheet, so the sheets don't share anything
+};
+
+CADocument *CALayoutTest::createDocument() {
+	CADocument *document = new CADocument();
+	CASheet *sheet = document->addSheet();
+	for (int i=0; i<StaffCount; i++) {
+		CAStaff *staff = sheet->addStaff();
+		CAVoice *voice = staff->voiceList()[0];
+
+		voice->append( new CAClef( CAClef::Treble, staff, 0 ) );
+		voice->append( new CATimeSignature( 4, 4, staff, 0 ) );
+		for (int j=0; j<BarCount; j++) {
+			for (int k=0; k<4; k++) {
+				voice->append( new CANote( CADiatonicPitch(28 + (j+k)%8), CAPlayableLength(CAPlayableLength::Quarter), voice, 0 ) );
+			}
+			voice->append( new CABarline( CABarline::Single, staff, 0 ) );
+		}
+	}
+
+	return document;
+}
+
+void CALayoutTest::initTestCase() {
+	for (int i=0; i<SheetCount; i++) {
+		_documents << createDocument();
+	}
+}
+
+void CALayoutTest::cleanupTestCase() {
+	for (int i=0; i<_documents.size(); i++) {
+		delete _documents[i];
+	}
+	_documents.clear();
+}
+
+/*!
+	Every music element should get its drawable and the drawable notes should follow each other
+	from left to right.
+*/
+void CALayoutTest::repositAllElements() {
+	CASheet *sheet = _documents[0]->sheetList()[0];
+	CALayout layout( sheet );
+	CALayoutEngine::reposit( &layout );
+
+	QCOMPARE( layout.drawableCList().size(), static_cast<int>(StaffCount) );
+
+	QList<CAVoice*> voices = sheet->voiceList();
+	for (int i=0; i<voices.size(); i++) {
+		double x = -1;
+		const QList<CAMusElement*>& elts = voices[i]->musElementList();
+		for (int j=0; j<elts.size(); j++) {
+			CADrawableMusElement *d = layout.findMElement( elts[j] );
+			QVERIFY( d );
+			if ( elts[j]->musElementType()==CAMusElement::Note ) {
+				QVERIFY( d->xPos() > x );
+				x = d->xPos();
+			}
+		}
+	}
+}
+
+/*!
+	Sheets laid out concurrently should get the same number of drawables as laid out in the
+	current thread.
+*/
+void CALayoutTest::concurrentLayout() {
+	CALayout layout( _documents[0]->sheetList()[0] );
+	CALayoutEngine::reposit( &layout );
+	int count = layout.drawableMList().size();
+
+	QList<CALayoutThread*> threads;
+	for (int i=0; i<_documents.size(); i++) {
+		threads << new CALayoutThread( _documents[i]->sheetList()[0] );
+		threads.last()->start();
+	}
+
+	for (int i=0; i<threads.size(); i++) {
+		threads[i]->wait();
+		QCOMPARE( threads[i]->drawableCount(), count );
+		delete threads[i];
+	}
+}
+
+/*!
+	Ties the last note of each bar to the first note of the next one in all the voices of the
+	\a sheet. Returns the created ties.
+*/
+QList<CASlur*> CALayoutTest::tieBars( CASheet *sheet ) {
+	QList<CASlur*> ties;
+	QList<CAVoice*> voices = sheet->voiceList();
+	for (int i=0; i<voices.size(); i++) {
+		QList<CANote*> notes = voices[i]->getNoteList();
+		for (int j=3; j+1<notes.size(); j+=4) {
+			CASlur *tie = new CASlur( CASlur::TieType, CASlur::SlurPreferred, voices[i]->staff(), notes[j], notes[j+1] );
+			notes[j]->setTieStart( tie );
+			notes[j+1]->setTieEnd( tie );
+			ties << tie;
+		}
+	}
+
+	return ties;
+}
+
+/*!
+	Ties crossing the borders of the chunks laid out by repositBars() should end at the same
+	notes as when the whole sheet is laid out at once.
+*/
+void CALayoutTest::chunkedTies() {
+	CADocument *document = createDocument();
+	CASheet *sheet = document->sheetList()[0];
+	QList<CASlur*> ties = tieBars( sheet );
+
+	{
+		CALayout layout( sheet );
+		CALayoutEngine::reposit( &layout );
+
+		CALayout chunkedLayout( sheet );
+		CALayoutEngine engine( &chunkedLayout );
+		while ( !engine.repositBars(1) );
+
+		QCOMPARE( chunkedLayout.drawableMList().size(), layout.drawableMList().size() );
+		for (int i=0; i<ties.size(); i++) {
+			CADrawableSlur *dTie = static_cast<CADrawableSlur*>( chunkedLayout.findMElement(ties[i]) );
+			QVERIFY( dTie );
+			QCOMPARE( dTie->x2(), chunkedLayout.findMElement( ties[i]->noteEnd() )->xPos() );
+			QCOMPARE( dTie->x2(), static_cast<CADrawableSlur*>( layout.findMElement(ties[i]) )->x2() );
+		}
+	}
+
+	delete document;
+}
+
+/*!
+	Laying out the sheet again after recycle() should reuse the drawables of the unchanged music
+	elements at the same positions and place the changed note again.
+*/
+void CALayoutTest::recycleUnchanged() {
+	CADocument *document = createDocument();
+	CASheet *sheet = document->sheetList()[0];
+	CAVoice *voice = sheet->voiceList()[0];
+	CANote *changed = static_cast<CANote*>( voice->musElementList()[10] );
+	CANote *unchanged = static_cast<CANote*>( voice->musElementList()[20] );
+
+	{
+		CALayout layout( sheet );
+		layout.setRecycling( true );
+		CALayoutEngine::reposit( &layout );
+		int count = layout.drawableMList().size();
+		CADrawableMusElement *dUnchanged = layout.findMElement( unchanged );
+		double x = dUnchanged->xPos();
+		double y = layout.findMElement( changed )->yPos();
+
+		changed->setDiatonicPitch( CADiatonicPitch( changed->diatonicPitch().noteName()+1 ) );
+		layout.recycle();
+		CALayoutEngine::reposit( &layout );
+
+		QCOMPARE( layout.drawableMList().size(), count );
+		QVERIFY( layout.findMElement( unchanged )==dUnchanged );
+		QCOMPARE( dUnchanged->xPos(), x );
+		QVERIFY( layout.findMElement( changed )->yPos() < y );
+	}
+
+	delete document;
+}
+
+void CALayoutTest::benchmarkReposit() {
+	CASheet *sheet = _documents[0]->sheetList()[0];
+	QBENCHMARK {
+		CALayout layout( sheet );
+		CALayoutEngine::reposit( &layout );
+	}
+}
+
+void CALayoutTest::benchmarkRepositSequential() {
+	QBENCHMARK {
+		for (int i=0; i<_documents.size(); i++) {
+			CALayout layout( _documents[i]->sheetList()[0] );
+			CALayoutEngine::reposit( &layout );
+		}
+	}
+}
+
+void CALayoutTest::benchmarkRepositConcurrent() {
+	QBENCHMARK {
+		QList<CALayoutThread*> threads;
+		for (int i=0; i<_documents.size(); i++) {
+			threads << new CALayoutThread( _documents[i]->sheetList()[0] );
+			threads.last()->start();
+		}
+		for (int i=0; i<threads.size(); i++) {
+			threads[i]->wait();
+			delete threads[i];
+		}
+	}
+}
+
+QTEST_MAIN(CALayoutTest)
+#include "layouttest.moc"
@@ -0,0 +1,76 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QtTest>
+
+#include "score/muselementpool.h"
+
+/*!
+	\class CAMusElementPoolTest
+	\brief Unit tests of the music element memory pool
+*/
+class CAMusElementPoolTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void freeEmptyChunks();
+	void keepChunks();
+
+private:
+	static const int SlotSize = 64;
+	static const int SlotsPerChunk = CAMusElementPool::ChunkSize/SlotSize;
+};
+
+/*!
+	Releasing all the slots of a chunk should free it, even though other slots of the same size
+	are still used, eg. by another document.
+*/
+void CAMusElementPoolTest::freeEmptyChunks() {
+	CAMusElementPool pool(0);
+	QList<void*> first, second;
+	for (int i=0; i<SlotsPerChunk; i++) {
+		first << pool.allocate( SlotSize );
+	}
+	for (int i=0; i<SlotsPerChunk; i++) {
+		second << pool.allocate( SlotSize );
+	}
+	QCOMPARE( pool.chunkCount(), qint64(2) );
+
+	for (int i=0; i<first.size(); i++) {
+		pool.release( first[i], SlotSize );
+	}
+	QCOMPARE( pool.chunkCount(), qint64(1) );
+	QCOMPARE( pool.liveCount(), qint64(SlotsPerChunk) );
+
+	// the released slots of a partly used chunk are reused
+	pool.release( second[0], SlotSize );
+	QVERIFY( pool.allocate( SlotSize )==second[0] );
+	QCOMPARE( pool.chunkCount(), qint64(1) );
+
+	for (int i=0; i<second.size(); i++) {
+		pool.release( second[i], SlotSize );
+	}
+	QCOMPARE( pool.chunkCount(), qint64(0) );
+	QCOMPARE( pool.liveCount(), qint64(0) );
+}
+
+/*!
+	Up to keptChunks() empty chunks should be kept and reused.
+*/
+void CAMusElementPoolTest::keepChunks() {
+	CAMusElementPool pool(1);
+	void *p = pool.allocate( SlotSize );
+	pool.release( p, SlotSize );
+	QCOMPARE( pool.chunkCount(), qint64(1) );
+
+	QVERIFY( pool.allocate( SlotSize )==p );
+	QCOMPARE( pool.chunkCount(), qint64(1) );
+	pool.release( p, SlotSize );
+}
+
+QTEST_APPLESS_MAIN(CAMusElementPoolTest)
+#include "muselementpooltest.moc"
@@ -0,0 +1,257 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QtTest>
+#include <QVector>
+
+#include "score/playablelength.h"
+
+/*!
+	\class CAPlayableLengthTest
+	\brief Unit tests and benchmarks of the playable length tables
+
+	The tables are compared with the previous floating point and bit-walking computations, which
+	are kept here as the reference. The benchmarks run the table lookups and the reference on the
+	same workload, so the difference can be read from the output of the test.
+
+	The workload resembles the MIDI import: note lengths quantized to hundred-twenty-eighths
+	starting at arbitrary positions in a 4/4 bar, split at the barlines.
+*/
+class CAPlayableLengthTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+
+	void timeLengthTable();
+	void decompositionTable();
+	void matchToBarsArray();
+
+	void benchmarkTimeLength();
+	void benchmarkTimeLengthReference();
+	void benchmarkDecomposition();
+	void benchmarkDecompositionReference();
+	void benchmarkMatchToBars();
+	void benchmarkMatchToBarsList();
+
+private:
+	static int referenceTimeLength( CAPlayableLength length );
+	static QList<CAPlayableLength> referenceDecomposition( int t, bool longNotesFirst, int dotsLimit );
+	static bool sameLengths( QList<CAPlayableLength> a, QList<CAPlayableLength> b );
+
+	QVector<int> _lengths;     // time lengths of the imported notes
+	QVector<int> _timeStarts;  // their positions in the bar
+};
+
+static const CAPlayableLength::CAMusicLength MusicLengths[] = {
+	CAPlayableLength::Breve, CAPlayableLength::Whole, CAPlayableLength::Half,
+	CAPlayableLength::Quarter, CAPlayableLength::Eighth, CAPlayableLength::Sixteenth,
+	CAPlayableLength::ThirtySecond, CAPlayableLength::SixtyFourth, CAPlayableLength::HundredTwentyEighth
+};
+
+/*!
+	Time length computed by the factor of the dots as before the table was introduced.
+*/
+int CAPlayableLengthTest::referenceTimeLength( CAPlayableLength length ) {
+	int timeLength = length.musicLength()==CAPlayableLength::Breve ? 2048 : 1024/length.musicLength();
+
+	float factor = 1.0, delta=0.5;
+	for (int i=0; i<length.dotted(); i++, factor+=delta, delta/=2);
+	return qRound(timeLength*factor);
+}
+
+/*!
+	Decomposition walking the bits of the time length as before the table was introduced.
+*/
+QList<CAPlayableLength> CAPlayableLengthTest::referenceDecomposition( int t, bool longNotesFirst, int dotsLimit ) {
+	QList<CAPlayableLength> pl;
+	int workTime = t;
+	const int breveTime = 2048;
+
+	int leadingBreves = workTime & ~(2*breveTime-1);
+	while (leadingBreves>=breveTime) {
+		pl << CAPlayableLength( CAPlayableLength::Breve );
+		leadingBreves -= breveTime;
+	}
+
+	workTime &= 2*breveTime-1;
+	workTime &= ~(8-1);
+	if (dotsLimit > 4) dotsLimit = 4;
+
+	int currentTime = breveTime;
+	int logCurrentMusLenPlusOne = 0;
+	int dots = 0;
+	bool findNote = true;
+	while (workTime && currentTime >= 8) {
+		if (findNote) {
+			if (workTime & currentTime) {
+				pl << CAPlayableLength( CAPlayableLength::CAMusicLength( (1<<logCurrentMusLenPlusOne)/2 ) );
+				dots = dotsLimit;
+				findNote = dotsLimit > 0 ? false : true;
+			} else {
+				findNote = true;
+			}
+		} else {
+			if (workTime & currentTime) {
+				pl.back().setDotted( pl.back().dotted() + 1 );
+				dots--;
+				findNote = dots > 0 ? false : true;
+			} else
+				findNote = true;
+		}
+		workTime &= ~currentTime;
+		currentTime /= 2;
+		logCurrentMusLenPlusOne++;
+	}
+
+	int i,j;
+	if (!longNotesFirst) for( i=0, j=pl.size()-1; i<j ; i++,j-- ) pl.swap(i,j);
+	return pl;
+}
+
+bool CAPlayableLengthTest::sameLengths( QList<CAPlayableLength> a, QList<CAPlayableLength> b ) {
+	if ( a.size()!=b.size() ) {
+		return false;
+	}
+	for (int i=0; i<a.size(); i++) {
+		if ( a[i]!=b[i] ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void CAPlayableLengthTest::initTestCase() {
+	unsigned int seed = 12345; // fixed, so the benchmarks are comparable between runs
+	for (int i=0; i<10000; i++) {
+		seed = seed*1103515245u + 12345u;
+		_lengths << static_cast<int>( (seed>>16) % 512 + 1 ) * 8; // up to four whole notes
+		seed = seed*1103515245u + 12345u;
+		_timeStarts << static_cast<int>( (seed>>16) % 128 ) * 8;  // inside the 4/4 bar
+	}
+}
+
+/*!
+	Every music length with up to MaxDots dots (and a few more computed outside the table) should
+	have the same time length as computed by the factor of the dots.
+*/
+void CAPlayableLengthTest::timeLengthTable() {
+	for (int i=0; i<9; i++) {
+		for (int dots=0; dots<=CAPlayableLength::MaxDots+2; dots++) {
+			CAPlayableLength length( MusicLengths[i], dots );
+			QCOMPARE( CAPlayableLength::playableLengthToTimeLength( length ), referenceTimeLength( length ) );
+		}
+	}
+	QCOMPARE( CAPlayableLength::playableLengthToTimeLength( CAPlayableLength(CAPlayableLength::Undefined) ), 0 );
+}
+
+/*!
+	Decomposition read from the table should be the same as the bit-walking one for every time
+	length up to three breves, every dots limit and both orders.
+*/
+void CAPlayableLengthTest::decompositionTable() {
+	for (int dotsLimit=0; dotsLimit<=CAPlayableLength::MaxDots; dotsLimit++) {
+		for (int t=0; t<3*2048+256; t+=8) {
+			QVERIFY( sameLengths( CAPlayableLength::timeLengthToPlayableLengthList( t, true, dotsLimit ), referenceDecomposition( t, true, dotsLimit ) ) );
+			QVERIFY( sameLengths( CAPlayableLength::timeLengthToPlayableLengthList( t, false, dotsLimit ), referenceDecomposition( t, false, dotsLimit ) ) );
+		}
+	}
+}
+
+/*!
+	Splitting into the stack allocated array should give the same lengths as the list variant and
+	the lengths should add up to the split time length.
+*/
+void CAPlayableLengthTest::matchToBarsArray() {
+	CAPlayableLength::CALengthArray array;
+	for (int i=0; i<_lengths.size(); i++) {
+		array.clear();
+		CAPlayableLength::matchToBars( _lengths[i], _timeStarts[i], 0, 0, array );
+		QList<CAPlayableLength> list = CAPlayableLength::matchToBars( _lengths[i], _timeStarts[i], 0, 0 );
+
+		QCOMPARE( array.size(), list.size() );
+		int sum = 0;
+		for (int j=0; j<array.size(); j++) {
+			QVERIFY( array[j]==list[j] );
+			sum += CAPlayableLength::playableLengthToTimeLength( array[j] );
+		}
+		QCOMPARE( sum, _lengths[i] );
+	}
+}
+
+void CAPlayableLengthTest::benchmarkTimeLength() {
+	int sum = 0;
+	QBENCHMARK {
+		for (int i=0; i<9; i++) {
+			for (int dots=0; dots<=CAPlayableLength::MaxDots; dots++) {
+				sum += CAPlayableLength::playableLengthToTimeLength( CAPlayableLength(MusicLengths[i], dots) );
+			}
+		}
+	}
+	QVERIFY( sum > 0 );
+}
+
+void CAPlayableLengthTest::benchmarkTimeLengthReference() {
+	int sum = 0;
+	QBENCHMARK {
+		for (int i=0; i<9; i++) {
+			for (int dots=0; dots<=CAPlayableLength::MaxDots; dots++) {
+				sum += referenceTimeLength( CAPlayableLength(MusicLengths[i], dots) );
+			}
+		}
+	}
+	QVERIFY( sum > 0 );
+}
+
+void CAPlayableLengthTest::benchmarkDecomposition() {
+	int count = 0;
+	CAPlayableLength::CALengthArray array;
+	QBENCHMARK {
+		for (int i=0; i<_lengths.size(); i++) {
+			array.clear();
+			CAPlayableLength::timeLengthToPlayableLengths( _lengths[i], array );
+			count += array.size();
+		}
+	}
+	QVERIFY( count > 0 );
+}
+
+void CAPlayableLengthTest::benchmarkDecompositionReference() {
+	int count = 0;
+	QBENCHMARK {
+		for (int i=0; i<_lengths.size(); i++) {
+			count += referenceDecomposition( _lengths[i], true, 4 ).size();
+		}
+	}
+	QVERIFY( count > 0 );
+}
+
+void CAPlayableLengthTest::benchmarkMatchToBars() {
+	int count = 0;
+	CAPlayableLength::CALengthArray array;
+	QBENCHMARK {
+		for (int i=0; i<_lengths.size(); i++) {
+			array.clear();
+			CAPlayableLength::matchToBars( _lengths[i], _timeStarts[i], 0, 0, array );
+			count += array.size();
+		}
+	}
+	QVERIFY( count > 0 );
+}
+
+void CAPlayableLengthTest::benchmarkMatchToBarsList() {
+	int count = 0;
+	QBENCHMARK {
+		for (int i=0; i<_lengths.size(); i++) {
+			count += CAPlayableLength::matchToBars( _lengths[i], _timeStarts[i], 0, 0 ).size();
+		}
+	}
+	QVERIFY( count > 0 );
+}
+
+QTEST_APPLESS_MAIN(CAPlayableLengthTest)
+#include "playablelengthtest.moc"
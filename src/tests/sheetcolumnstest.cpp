@@ -0,0 +1,191 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QtTest>
+
+#include "core/notechecker.h"
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/sheetcolumns.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/note.h"
+#include "score/clef.h"
+#include "score/timesignature.h"
+#include "score/barline.h"
+
+/*!
+	\class CASheetColumnsTest
+	\brief Unit tests and benchmarks of the columnar view of the sheet
+
+	The document has one sheet of StaffCount staffs, each with two voices, a clef, 4/4 and BarCount
+	bars of quarter notes.
+
+	The benchmarks count the notes above the given pitch by walking the music elements of all the
+	voices and by scanning the columns.
+*/
+class CASheetColumnsTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void sortedRows();
+	void cached();
+	void noteCheckerRange();
+
+	void benchmarkPointerWalk();
+	void benchmarkColumns();
+
+private:
+	int countHighNotesWalk();
+	int countHighNotesColumns();
+
+	enum {
+		StaffCount = 8,
+		BarCount = 500,
+		HighPitch = 72
+	};
+
+	CADocument *_document;
+	CASheet *_sheet;
+};
+
+void CASheetColumnsTest::initTestCase() {
+	_document = new CADocument();
+	_sheet = _document->addSheet();
+	for (int i=0; i<StaffCount; i++) {
+		CAStaff *staff = _sheet->addStaff();
+		CAVoice *voice = staff->voiceList()[0];
+		CAVoice *voice2 = staff->addVoice();
+
+		voice->append( new CAClef( CAClef::Treble, staff, 0 ) );
+		voice->append( new CATimeSignature( 4, 4, staff, 0 ) );
+		for (int j=0; j<BarCount; j++) {
+			for (int k=0; k<4; k++) {
+				voice->append( new CANote( CADiatonicPitch(28 + (i+j+k)%14), CAPlayableLength(CAPlayableLength::Quarter), voice, 0 ) );
+				voice2->append( new CANote( CADiatonicPitch(21 + (j+k)%7), CAPlayableLength(CAPlayableLength::Quarter), voice2, 0 ) );
+			}
+			voice->append( new CABarline( CABarline::Single, staff, 0 ) );
+		}
+		staff->synchronizeVoices();
+	}
+}
+
+void CASheetColumnsTest::cleanupTestCase() {
+	delete _document;
+}
+
+/*!
+	The columns should contain all the elements of the sheet sorted by their start time.
+	Elements starting at the same time keep the order of the voices.
+*/
+void CASheetColumnsTest::sortedRows() {
+	_sheet->invalidateColumns();
+	QSharedPointer<const CASheetColumns> columns = _sheet->columns();
+
+	int count = 0;
+	QList<CAVoice*> voices = _sheet->voiceList();
+	for (int i=0; i<voices.size(); i++) {
+		count += voices[i]->musElementList().size();
+	}
+	QCOMPARE( columns->size(), count );
+
+	for (int i=1; i<columns->size(); i++) {
+		QVERIFY( columns->timeStartColumn()[i-1] <= columns->timeStartColumn()[i] );
+		if ( columns->timeStartColumn()[i-1]==columns->timeStartColumn()[i] ) {
+			QVERIFY( columns->voiceColumn()[i-1] <= columns->voiceColumn()[i] );
+		}
+	}
+
+	QCOMPARE( countHighNotesColumns(), countHighNotesWalk() );
+	QCOMPARE( columns->lowerBound(0), 0 );
+	QCOMPARE( columns->lowerBound( columns->timeStartColumn().last()+1 ), columns->size() );
+}
+
+/*!
+	The columns should be reused until the document is modified.
+*/
+void CASheetColumnsTest::cached() {
+	QSharedPointer<const CASheetColumns> columns = _sheet->columns();
+	QVERIFY( _sheet->columns()==columns );
+
+	_document->setModified( true );
+	QVERIFY( _sheet->columns()!=columns );
+	QCOMPARE( _sheet->columns()->version(), _document->version() );
+}
+
+/*!
+	The note checker should report the notes out of the MIDI range found in the columns.
+*/
+void CASheetColumnsTest::noteCheckerRange() {
+	CAVoice *voice = _sheet->voiceList()[2];
+	CANote *note = static_cast<CANote*>( voice->musElementList()[5] );
+	CADiatonicPitch pitch = note->diatonicPitch();
+	note->setDiatonicPitch( CADiatonicPitch(80) );
+
+	CANoteChecker checker;
+	checker.checkSheet( _sheet );
+	QCOMPARE( note->noteCheckerErrorList().size(), 1 );
+	QCOMPARE( voice->musElementList()[6]->noteCheckerErrorList().size(), 0 );
+
+	note->setDiatonicPitch( pitch );
+	checker.checkSheet( _sheet );
+	QCOMPARE( note->noteCheckerErrorList().size(), 0 );
+}
+
+int CASheetColumnsTest::countHighNotesWalk() {
+	int count = 0;
+	QList<CAVoice*> voices = _sheet->voiceList();
+	for (int i=0; i<voices.size(); i++) {
+		const QList<CAMusElement*>& elts = voices[i]->musElementList();
+		for (int j=0; j<elts.size(); j++) {
+			if ( elts[j]->musElementType()==CAMusElement::Note &&
+			     CADiatonicPitch::diatonicPitchToMidiPitch( static_cast<CANote*>(elts[j])->diatonicPitch() ) + voices[i]->midiPitchOffset() > HighPitch ) {
+				count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+int CASheetColumnsTest::countHighNotesColumns() {
+	QSharedPointer<const CASheetColumns> columns = _sheet->columns();
+	const QVector<unsigned char>& types = columns->typeColumn();
+	const QVector<short>& pitches = columns->midiPitchColumn();
+
+	int count = 0;
+	for (int i=0; i<columns->size(); i++) {
+		if ( types[i]==CAMusElement::Note && pitches[i]>HighPitch ) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void CASheetColumnsTest::benchmarkPointerWalk() {
+	int count = 0;
+	QBENCHMARK {
+		count = countHighNotesWalk();
+	}
+	QVERIFY( count>0 );
+}
+
+void CASheetColumnsTest::benchmarkColumns() {
+	_sheet->columns(); // built once, the scan is measured
+	int count = 0;
+	QBENCHMARK {
+		count = countHighNotesColumns();
+	}
+	QVERIFY( count>0 );
+}
+
+QTEST_APPLESS_MAIN(CASheetColumnsTest)
+#include "sheetcolumnstest.moc"
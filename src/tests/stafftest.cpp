@@ -0,0 +1,216 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
+*/
+
+#include <QtTest>
+
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/voice.h"
+#include "score/note.h"
+#include "score/clef.h"
+#include "score/timesignature.h"
+#include "score/barline.h"
+#include "score/measuretable.h"
+
+/*!
+	\class CAStaffTest
+	\brief Unit tests of the shared signs, voice synchronization and the table of bars
+
+	Each test starts with a staff of two voices and two bars:
+	treble clef, 4/4, four quarters, barline, bass clef, 3/4, three quarters, barline.
+	The signs are added to the first voice and spread to the second one by synchronizing.
+*/
+class CAStaffTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void init();
+	void cleanup();
+
+	void removeTimeSignature();
+	void removeClefSynchronize();
+	void insertShiftsSigns();
+	void removeAfterShift();
+	void signHash();
+
+private:
+	void appendNotes( CAVoice *voice, int count );
+
+	CADocument *_document;
+	CAStaff *_staff;
+	CAVoice *_voice1;
+	CAVoice *_voice2;
+	CATimeSignature *_timeSig44;
+	CATimeSignature *_timeSig34;
+	CAClef *_bassClef;
+};
+
+void CAStaffTest::appendNotes( CAVoice *voice, int count ) {
+	for (int i=0; i<count; i++) {
+		voice->append( new CANote( CADiatonicPitch(28), CAPlayableLength(CAPlayableLength::Quarter), voice, 0 ) );
+	}
+}
+
+void CAStaffTest::init() {
+	_document = new CADocument();
+	_staff = _document->addSheet()->addStaff();
+	_voice1 = _staff->voiceList()[0];
+	_voice2 = _staff->addVoice();
+
+	_voice1->append( new CAClef( CAClef::Treble, _staff, 0 ) );
+	_voice1->append( _timeSig44 = new CATimeSignature( 4, 4, _staff, 0 ) );
+	appendNotes( _voice1, 4 );
+	_voice1->append( new CABarline( CABarline::Single, _staff, 0 ) );
+	_voice1->append( _bassClef = new CAClef( CAClef::Bass, _staff, 0 ) );
+	_voice1->append( _timeSig34 = new CATimeSignature( 3, 4, _staff, 0 ) );
+	appendNotes( _voice1, 3 );
+	_voice1->append( new CABarline( CABarline::Single, _staff, 0 ) );
+
+	appendNotes( _voice2, 7 );
+	_staff->synchronizeVoices();
+}
+
+void CAStaffTest::cleanup() {
+	delete _document;
+}
+
+/*!
+	Removing a time signature should rebuild the bars from its time on. The bar must not refer to
+	the deleted time signature and the element ranges of all voices must be shifted.
+*/
+void CAStaffTest::removeTimeSignature() {
+	CAMeasureTable *table = _staff->measureTable();
+	QCOMPARE( table->measureCount(), 2 );
+	QVERIFY( table->measure(1).timeSignature==_timeSig34 );
+	QCOMPARE( table->measureElements(1, _voice2).size(), 6 ); // clef, time signature, 3 notes, barline
+
+	delete _timeSig34;
+
+	QCOMPARE( _staff->timeSignatureRefs().size(), 1 );
+	QCOMPARE( table->measureCount(), 2 );
+	QVERIFY( table->measure(1).timeSignature==_timeSig44 );
+	QCOMPARE( table->measureElements(1, _voice1).size(), 5 );
+	QCOMPARE( table->measureElements(1, _voice2).size(), 5 );
+	QVERIFY( table->measureElements(1, _voice2).last()->musElementType()==CAMusElement::Barline );
+}
+
+/*!
+	Removing a clef should mark the voices as changed, so synchronizing them afterwards is not
+	skipped and leaves the shared signs in all the voices.
+*/
+void CAStaffTest::removeClefSynchronize() {
+	QCOMPARE( _staff->dirtyTime(), -1 );
+	int timeStart = _bassClef->timeStart();
+
+	delete _bassClef;
+
+	QVERIFY( _staff->dirtyTime()!=-1 );
+	QVERIFY( _staff->dirtyTime()<=timeStart );
+
+	_staff->synchronizeVoices();
+	QCOMPARE( _staff->dirtyTime(), -1 );
+	QCOMPARE( _staff->clefRefs().size(), 1 );
+	QCOMPARE( _voice1->musElementList().size(), _voice2->musElementList().size() );
+	for (int i=0; i<_voice1->musElementList().size(); i++) {
+		CAMusElement *elt = _voice1->musElementList()[i];
+		QVERIFY( elt->musElementType()!=CAMusElement::Clef || elt->timeStart()==0 );
+		if ( !elt->isPlayable() ) {
+			QVERIFY( _voice2->musElementList()[i]==elt );
+		}
+	}
+}
+
+/*!
+	Inserting a note at the beginning of a long staff should shift all the following shared signs,
+	also the ones in the time blocks shifted by the offset only.
+*/
+void CAStaffTest::insertShiftsSigns() {
+	for (int i=0; i<300; i++) {
+		appendNotes( _voice1, 3 );
+		_voice1->append( new CABarline( CABarline::Single, _staff, 0 ) );
+		appendNotes( _voice2, 3 );
+	}
+	_staff->synchronizeVoices();
+
+	QList<int> times;
+	for (int i=0; i<_staff->barlineRefs().size(); i++) {
+		times << _staff->barlineRefs()[i]->timeStart();
+	}
+	int timeSig34 = _timeSig34->timeStart();
+	int quarter = CAPlayableLength::musicLengthToTimeLength( CAPlayableLength::Quarter );
+
+	_voice1->insert( _voice1->musElementList()[2], new CANote( CADiatonicPitch(30), CAPlayableLength(CAPlayableLength::Quarter), _voice1, 0 ) );
+
+	QCOMPARE( _timeSig34->timeStart(), timeSig34+quarter );
+	QCOMPARE( _staff->barlineRefs().size(), times.size() );
+	for (int i=0; i<times.size(); i++) {
+		QCOMPARE( _staff->barlineRefs()[i]->timeStart(), times[i]+quarter );
+	}
+
+	_staff->synchronizeVoices();
+	for (int i=1; i<_voice2->musElementList().size(); i++) {
+		QVERIFY( _voice2->musElementList()[i-1]->timeStart() <= _voice2->musElementList()[i]->timeStart() );
+	}
+	QCOMPARE( _voice2->indexOf(_staff->barlineRefs().last()), _voice2->musElementList().size()-1 );
+}
+
+/*!
+	Elements should be found and removed right after their times were shifted, before the voices
+	are synchronized again.
+*/
+void CAStaffTest::removeAfterShift() {
+	CAMusElement *note = _voice1->musElementList()[5]; // last quarter of the first bar
+	CAMusElement *barline = _staff->barlineRefs()[0];
+	CAMusElement *note2 = _voice2->musElementList().last();
+	int size1 = _voice1->musElementList().size();
+	int size2 = _voice2->musElementList().size();
+
+	_voice1->insert( _voice1->musElementList()[2], new CANote( CADiatonicPitch(30), CAPlayableLength(CAPlayableLength::Quarter), _voice1, 0 ) );
+	QCOMPARE( _voice1->musElementList().size(), size1+1 );
+
+	QVERIFY( _voice1->remove( note ) );
+	QCOMPARE( _voice1->indexOf(note), -1 );
+	QCOMPARE( _voice1->musElementList().size(), size1 );
+	delete note;
+
+	QVERIFY( _voice2->indexOf(barline)!=-1 );
+	QVERIFY( _voice2->remove( barline ) );
+	QCOMPARE( _voice1->indexOf(barline), -1 );
+	QCOMPARE( _voice2->indexOf(barline), -1 );
+	delete barline;
+
+	QVERIFY( _voice2->remove( note2 ) );
+	QCOMPARE( _voice2->musElementList().size(), size2-2 );
+	delete note2;
+}
+
+/*!
+	Changing a shared sign or shifting it should change the cached hashes of the staff and the
+	sheet. Changing the sign back should give the original hashes again.
+*/
+void CAStaffTest::signHash() {
+	CASheet *sheet = _staff->sheet();
+	unsigned int staffHash = _staff->contentHash();
+	unsigned int sheetHash = sheet->contentHash();
+	QCOMPARE( _staff->contentHash(), staffHash );
+
+	_timeSig34->setBeats( 6 );
+	QVERIFY( _staff->contentHash()!=staffHash );
+	QVERIFY( sheet->contentHash()!=sheetHash );
+
+	_timeSig34->setBeats( 3 );
+	QCOMPARE( _staff->contentHash(), staffHash );
+	QCOMPARE( sheet->contentHash(), sheetHash );
+
+	_voice1->insert( _voice1->musElementList()[2], new CANote( CADiatonicPitch(30), CAPlayableLength(CAPlayableLength::Quarter), _voice1, 0 ) );
+	QVERIFY( _staff->contentHash()!=staffHash );
+	QVERIFY( sheet->contentHash()!=sheetHash );
+}
+
+QTEST_APPLESS_MAIN(CAStaffTest)
+#include "stafftest.moc"
@@ -102,6 +102,7 @@
 #include "core/muselementfactory.h"
 #include "core/mimedata.h"
 #include "core/undo.h"
+#include "core/edittransaction.h"
 #include "core/midirecorder.h"
 
 #include "scripting/swigruby.h"
@@ -1704,7 +1705,7 @@ void CAMainWin::scoreViewMousePress(QMouseEvent *e, const QPoint coords) {
 	int idx=-1;
 
 	if (l.size() > 0) { // multiple elements can share the same coordinates
-		if ( (v->selection().size() > 0) && (!v->selection().contains(l.front())) ) {
+		if ( (v->selection().size() > 0) && (!v->isSelected(l.front())) ) {
 			if (e->modifiers()!=Qt::ShiftModifier)
 				v->clearSelection();
 			v->addToSelection( newlySelectedElement = l[0] );      // if the previous selection was not a single element or if the new list doesn't contain the selection set the first element in the available list to the selection
@@ -1935,7 +1936,7 @@ void CAMainWin::scoreViewMouseMove(QMouseEvent *e, QPoint coords) {
 		musElementFactory()->setNoteAccs( iNoteAccs );
 		c->setShadowNoteAccs(iNoteAccs);
 		c->updateHelpers();
-		c->repaint();
+		c->repaintOverlay(); // only the shadow note moved
 	} else
 	if ( mode()!=InsertMode ) {
 		if (c->resizeDirection()!=CADrawable::Undefined) {
@@ -1976,7 +1977,7 @@ void CAMainWin::scoreViewMouseMove(QMouseEvent *e, QPoint coords) {
 												musEltList.back()->xPos()+musEltList.back()->width()-musEltList.front()->xPos(), dcList[i]->height()) );
 				}
 			}
-			c->repaint();
+			c->repaintOverlay(); // only the selection regions changed
 		}
 	}
 	c->setMouseTracking(true); // re-enable mouse move events, we finished rendering
@@ -2105,7 +2106,7 @@ void CAMainWin::scoreViewWheel(QWheelEvent *e, QPoint coords) {
 			break;
 	}
 
-	sv->repaint();
+	sv->repaintOverlay(); // played notes are drawn as selection in the overlay
 }
 
 /*!
@@ -2296,8 +2297,11 @@ void CAMainWin::scoreViewKeyPress(QKeyEvent *e) {
 								sheet = static_cast<CANote*>(elt)->voice()->staff()->sheet();
 								CACanorus::undo()->createUndoCommand( document(), tr("add sharp", "undo") );
 							}
-							if ( static_cast<CANote*>(elt)->diatonicPitch().accs() < 2 )       // limit the amount of accidentals
-								static_cast<CANote*>(elt)->diatonicPitch().setAccs( static_cast<CANote*>(elt)->diatonicPitch().accs()+1 );
+							if ( static_cast<CANote*>(elt)->diatonicPitch().accs() < 2 ) {     // limit the amount of accidentals
+								CADiatonicPitch pitch = static_cast<CANote*>(elt)->diatonicPitch();
+								pitch.setAccs( pitch.accs()+1 );
+								static_cast<CANote*>(elt)->setDiatonicPitch( pitch );
+							}
 						}
 						eltList << elt;
 					}
@@ -2330,8 +2334,11 @@ void CAMainWin::scoreViewKeyPress(QKeyEvent *e) {
 								sheet = static_cast<CANote*>(elt)->voice()->staff()->sheet();
 								CACanorus::undo()->createUndoCommand( document(), tr("add flat", "undo") );
 							}
-							if ( static_cast<CANote*>(elt)->diatonicPitch().accs() > -2 )       // limit the amount of accidentals
-								static_cast<CANote*>(elt)->diatonicPitch().setAccs( static_cast<CANote*>(elt)->diatonicPitch().accs()-1 );
+							if ( static_cast<CANote*>(elt)->diatonicPitch().accs() > -2 ) {    // limit the amount of accidentals
+								CADiatonicPitch pitch = static_cast<CANote*>(elt)->diatonicPitch();
+								pitch.setAccs( pitch.accs()-1 );
+								static_cast<CANote*>(elt)->setDiatonicPitch( pitch );
+							}
 						}
 						eltList << elt;
 					}
@@ -3019,18 +3026,17 @@ void CAMainWin::on_uiPlayFromSelection_toggled(bool checked) {
 void CAMainWin::onRepaintTimerTimeout() {
 	CAScoreView *sv = static_cast<CAScoreView*>(_playbackView);
 	sv->clearSelection();
-	for (int i=0; i<_playback->curPlaying().size(); i++) {
-		if (_playback->curPlaying().at(i)->musElementType()==CAMusElement::Note) {
-			CADrawableMusElement *elt = sv->addToSelection( _playback->curPlaying()[i] );
-			if ( CACanorus::settings()->lockScrollPlayback() ) {
-				if ( elt && (elt->xPos() > (sv->worldX()+sv->worldWidth()) || elt->xPos() < sv->worldX()) ) {
-					sv->setWorldX( elt->xPos()-50, CACanorus::settings()->animatedScroll() );
-				}
+	QList<CAMusElement*> curPlaying = _playback->curPlayingElements(); // only notes are published by the playback
+	for (int i=0; i<curPlaying.size(); i++) {
+		CADrawableMusElement *elt = sv->addToSelection( curPlaying[i] );
+		if ( CACanorus::settings()->lockScrollPlayback() ) {
+			if ( elt && (elt->xPos() > (sv->worldX()+sv->worldWidth()) || elt->xPos() < sv->worldX()) ) {
+				sv->setWorldX( elt->xPos()-50, CACanorus::settings()->animatedScroll() );
 			}
 		}
 	}
 
-	sv->repaint();
+	sv->repaintOverlay(); // played notes are drawn as selection in the overlay
 }
 
 void CAMainWin::on_uiLockScrollPlayback_toggled(bool val) {
@@ -3329,6 +3335,15 @@ void CAMainWin::on_uiExportDocument_triggered() {
 			_poExp = musicxml;
 		} else if ( uiExportDialog->selectedNameFilter() == CAFileFormats::PDF_FILTER ) {
 			CAPDFExport *ppe = new CAPDFExport;
+			if ( document()->sheetList().size() > 1 && ppe->typesetterJobs() != 1 &&
+			     CACanorus::settings()->typesetter()==CATypesetter::LilyPond ) {
+				// typeset all the sheets concurrently in the background, the progress control deletes the export when done
+				connect( ppe, SIGNAL(exportDone(int)), this, SLOT(onExportDone(int)) );
+				ppe->setStreamToFile( s );
+				ppe->exportDocument( document() );
+				_mainWinProgressCtl.startProgress( ppe );
+				return;
+			}
 			_poExp = ppe;
 		} else if ( uiExportDialog->selectedNameFilter() == CAFileFormats::SVG_FILTER ) {
 			CASVGExport *pse = new CASVGExport;
@@ -3469,7 +3484,14 @@ void CAMainWin::on_uiExportToPdf_triggered() {
 }
 
 void CAMainWin::onExportDone( int status ) {
+	if ( mode()==ProgressMode ) {
+		setMode( EditMode );
+	}
 
+	if ( status ) {
+		QMessageBox::critical( this, tr("Canorus"),
+		                       tr("Error while exporting the document!\nError %1").arg( status ) );
+	}
 }
 
 /*!
@@ -5503,7 +5525,7 @@ void CAMainWin::deleteSelection( CAScoreView *v, bool deleteSyllables, bool dele
 				}
 
 				// stop the playback before deleting the note
-				if (_playback && _playback->curPlaying().contains(p)) {
+				if (_playback && _playback->curPlayingElements().contains(p)) {
 					_playback->stopNow();
 				}
 
@@ -5636,6 +5658,9 @@ void CAMainWin::pasteAt( const QPoint coords, CAScoreView *v ) {
 				for(int i=staff->voiceList().size()-1; i < voice+cbstaff->voiceList().size()-1; i++) {
 					staff->addVoice();
 				}
+				CAEditTransaction transaction( 0 ); // undo command and the GUI are updated below for the whole paste
+				QList< QPair<CATuplet*, QList<CAPlayable*> > > tupletList; // tuplets to clone when the playables are inserted
+				QHash<CAVoice*, QList<CAMusElement*> > syllableMap; // notes inserted in front of other notes need empty syllables
 				for(int i=voice; i<voice+cbstaff->voiceList().size(); i++) {
 					int cbi = i-voice;
 					CADrawableMusElement *drawable = v->nearestRightElement(coords.x(), coords.y(), staff->voiceList()[i]);
@@ -5666,6 +5691,9 @@ void CAMainWin::pasteAt( const QPoint coords, CAScoreView *v ) {
 						}
 					}
 
+					CANote* lastNote = staff->voiceList()[i]->lastNote();
+					bool notesAfter = right && lastNote && staff->voiceList()[i]->indexOf(lastNote) >= staff->voiceList()[i]->indexOf(right);
+
 					QHash<CATuplet*, QList<CAPlayable*> > tupletMap;
 					QHash<CASlur*, CANote*> slurMap;
 					foreach(CAMusElement* elt, cbstaff->voiceList()[cbi]->musElementList()) {
@@ -5704,7 +5732,7 @@ void CAMainWin::pasteAt( const QPoint coords, CAScoreView *v ) {
 							}
 
 						}
-						staff->voiceList()[i]->insert(chord?newEltList.last():right, cloned, chord);
+						transaction.insert(staff->voiceList()[i], chord?newEltList.last():right, cloned, chord);
 						newEltList << cloned;
 						if(elt->isPlayable())
 						{
@@ -5713,25 +5741,36 @@ void CAMainWin::pasteAt( const QPoint coords, CAScoreView *v ) {
 							{
 								tupletMap[pl->tuplet()] << static_cast<CAPlayable*>(cloned);
 								if(tupletMap[pl->tuplet()].size() == pl->tuplet()->noteList().size())
-									pl->tuplet()->clone(tupletMap[pl->tuplet()]);
+									tupletList << qMakePair(pl->tuplet(), tupletMap[pl->tuplet()]);
 							}
 						}
-						// FIXME duplicated from CAMusElementFactory::configureNote.
-						if(n && staff->voiceList()[i]->lastNote() != static_cast<CANote*>(cloned)) {
-							foreach( CALyricsContext* context, staff->voiceList()[i]->lyricsContextList() )
-								context->addEmptySyllable(cloned->timeStart(), cloned->timeLength());
-							foreach( CAContext* context, currentSheet->contextList() )
-								if(context->contextType()==CAContext::FunctionMarkContext)
-									static_cast<CAFunctionMarkContext*>(context)->addEmptyFunction(cloned->timeStart(), cloned->timeLength());
-						}
+						if(n && !chord && notesAfter)
+							syllableMap[staff->voiceList()[i]] << cloned;
+					}
+				}
+				transaction.commit();
+
+				// tuplets need their playables in the voice
+				for(int j=0; j<tupletList.size(); j++)
+					tupletList[j].first->clone(tupletList[j].second);
+				if(!tupletList.isEmpty())
+					staff->synchronizeVoices();
+
+				// FIXME duplicated from CAMusElementFactory::configureNote.
+				for(int i=voice; i<voice+cbstaff->voiceList().size(); i++) {
+					foreach(CAMusElement* cloned, syllableMap[staff->voiceList()[i]]) {
+						foreach( CALyricsContext* context, staff->voiceList()[i]->lyricsContextList() )
+							context->addEmptySyllable(cloned->timeStart(), cloned->timeLength());
+						foreach( CAContext* context, currentSheet->contextList() )
+							if(context->contextType()==CAContext::FunctionMarkContext)
+								static_cast<CAFunctionMarkContext*>(context)->addEmptyFunction(cloned->timeStart(), cloned->timeLength());
 					}
 					foreach( CALyricsContext* context, staff->voiceList()[i]->lyricsContextList() )
 						context->repositSyllables();
-					foreach( CAContext* context, currentSheet->contextList() )
-						if(context->contextType()==CAContext::FunctionMarkContext)
-							static_cast<CAFunctionMarkContext*>(context)->repositFunctions();
 				}
-				staff->synchronizeVoices();
+				foreach( CAContext* context, currentSheet->contextList() )
+					if(context->contextType()==CAContext::FunctionMarkContext)
+						static_cast<CAFunctionMarkContext*>(context)->repositFunctions();
 			} else {
 				// \todo function mark copy&paste unimplemented
 				if(context->contextType() == CAContext::LyricsContext) {
@@ -16,6 +16,7 @@
 #include "interface/mididevice.h"
 #include "widgets/actionseditor.h"
 #include "core/settings.h"
+#include "control/typesetctl.h"
 #include "score/sheet.h"         // needed for preview sheet
 #include "score/staff.h"         // needed for preview sheet
 #include "score/voice.h"         // needed for preview sheet
@@ -116,6 +117,7 @@ void CASettingsDialog::setupPages( CASettingsPage currentPage ) {
 	uiTypesetter->setCurrentIndex( CACanorus::settings()->typesetter()-1 );
 	uiTypesetterLocation->setText( CACanorus::settings()->typesetterLocation() );
 	uiTypesetterDefault->setChecked( CACanorus::settings()->useSystemDefaultTypesetter() );
+	uiTypesetterJobs->setValue( CACanorus::settings()->typesetterJobs() );
 	uiPdfViewerLocation->setText( CACanorus::settings()->pdfViewerLocation() );
 	uiPdfViewerDefault->setChecked( CACanorus::settings()->useSystemDefaultPdfViewer() );
 }
@@ -183,6 +185,8 @@ void CASettingsDialog::applySettings() {
 	CACanorus::settings()->setTypesetter( static_cast<CATypesetter::CATypesetterType>(uiTypesetter->currentIndex()+1) );
 	CACanorus::settings()->setTypesetterLocation( uiTypesetterLocation->text() );
 	CACanorus::settings()->setUseSystemDefaultTypesetter( uiTypesetterDefault->isChecked() );
+	CATypesetCtl::queryVersion( uiTypesetterDefault->isChecked() ? CASettings::DEFAULT_TYPESETTER_LOCATION : uiTypesetterLocation->text() );
+	CACanorus::settings()->setTypesetterJobs( uiTypesetterJobs->value() );
 	CACanorus::settings()->setPdfViewerLocation( uiPdfViewerLocation->text() );
 	CACanorus::settings()->setUseSystemDefaultPdfViewer( uiPdfViewerDefault->isChecked() );
 
@@ -15,12 +15,15 @@
 #include <QColor>
 #include <QTimer>
 
+#include <QSet>
+
+#include <algorithm> // std::lower_bound, std::upper_bound, std::stable_sort
 #include <math.h>	// needed for square root in animated scrolls/zoom
 
 #include <iostream>
 
 #include "widgets/scoreview.h"
-#include "layout/layoutengine.h"
+#include "layout/sheetlayout.h"
 #include "layout/drawable.h"
 #include "layout/drawablecontext.h"
 #include "layout/drawablelyricscontext.h" // syllable edit creation
@@ -36,6 +39,7 @@
 #include "score/context.h"
 #include "score/muselement.h"
 #include "score/staff.h"
+#include "score/measuretable.h"
 #include "score/voice.h"
 #include "score/note.h"
 #include "score/rest.h"
@@ -118,7 +122,11 @@ CAScoreView::CAScoreView( QWidget *parent )
 void CAScoreView::initScoreView( CASheet *sheet ) {
 	setViewType( ScoreView );
 
-	setSheet( sheet );
+	_sheet = 0;
+	_sheetLayout = 0;
+	_currentContext = 0;
+	_savedContextIdx = -1;
+	_shadowNoteLength = CAPlayableLength( CAPlayableLength::Quarter );
 	_worldX = _worldY = 0;
 	_worldW = _worldH = 0;
 	_zoom = 1.0;
@@ -127,7 +135,6 @@ void CAScoreView::initScoreView( CASheet *sheet ) {
 	_vScrollBarDeadLock = false;
 	_checkScrollBarsDeadLock = false;
 	_playing = false;
-	_currentContext = 0;
 	_xCursor = _yCursor = 0;
 	setResizeDirection( CADrawable::Undefined );
 
@@ -143,6 +150,9 @@ void CAScoreView::initScoreView( CASheet *sheet ) {
 	_canvas = new QWidget(this);
 	setMouseTracking(true);
 	_repaintArea = 0;
+	_scoreLayerZoom = 0;
+	_scoreLayerValid = false;
+	_overlayOnly = false;
 
 	// init animation stuff
 	_animationTimer = new QTimer(this);
@@ -194,18 +204,14 @@ void CAScoreView::initScoreView( CASheet *sheet ) {
 	setSelectedContextColor( CACanorus::settings()->selectedContextColor() );
 	setHiddenElementsColor( CACanorus::settings()->hiddenElementsColor() );
 	setDisabledElementsColor( CACanorus::settings()->disabledElementsColor() );
+
+	CASheetLayout::setChunkBars( CACanorus::settings()->lazyLayoutBars() );
+	setSheet( sheet );
 }
 
 CAScoreView::~CAScoreView() {
-	// Delete the drawable elements/contexts
-	_drawableMList.clear(true);
-	_drawableCList.clear(true);
-	_drawableNCEList.clear(true);
-
-	while(!_shadowNote.isEmpty()) {
-		delete _shadowNote.takeFirst();
-		delete _shadowDrawableNote.takeFirst(); // same size
-	}
+	clearShadowNotes();
+	CASheetLayout::release( _sheetLayout );
 
 	_animationTimer->disconnect();
 	_animationTimer->stop();
@@ -262,44 +268,107 @@ CAScoreView *CAScoreView::clone(QWidget *parent) {
 }
 
 /*!
-	Adds a drawable music element \a elt to the score view and selects it, if \a select is true.
+	Sets the \a sheet the view shows and starts sharing its layout with other views of the sheet.
+	If the sheet was already laid out for another view, the drawable elements are reused.
+
+	\sa CASheetLayout
 */
+void CAScoreView::setSheet( CASheet *sheet ) {
+	if ( _sheetLayout ) {
+		on_sheetLayout_aboutToChange();
+		_savedSelection.clear();
+		_savedContextIdx = -1;
+		_sheetLayout->disconnect( this );
+		CASheetLayout::release( _sheetLayout );
+	}
+
+	_sheet = sheet;
+	_sheetLayout = CASheetLayout::acquire( sheet );
+	connect( _sheetLayout, SIGNAL(aboutToChange()), this, SLOT(on_sheetLayout_aboutToChange()) );
+	connect( _sheetLayout, SIGNAL(changed()), this, SLOT(on_sheetLayout_changed()) );
+	connect( _sheetLayout, SIGNAL(grown()), this, SLOT(on_sheetLayout_grown()) );
 
-void CAScoreView::addMElement(CADrawableMusElement *elt, bool select) {
-	_drawableMList.addElement(elt);
-	_mapDrawable.insertMulti(elt->musElement(), elt);
-	if (select) {
-		_selection.clear();
-		addToSelection(elt);
+	if ( _sheetLayout->isValid() ) {
+		on_sheetLayout_changed();
 	}
+}
 
-	elt->drawableContext()->addMElement(elt);
-	emit selectionChanged();
+/*!
+	Called before the shared layout destroys its drawable elements.
+	Stores the selection and the current context as they point to the old drawable elements.
+*/
+void CAScoreView::on_sheetLayout_aboutToChange() {
+	clearShadowNotes();
+
+	_savedSelection = musElementSelection();
+	resetSelection();
+
+	_savedContextIdx = (_currentContext ? drawableCList().list().indexOf(_currentContext) : -1);	// remember the index of last used context
+	_currentContext = 0;
+
+	invalidateScoreLayer();
 }
 
 /*!
-	Adds a drawable music element \a elt to the score view and selects it, if \a select is true.
+	Called when the shared layout created new drawable elements.
+	Recreates the shadow notes and restores the selection and the current context.
 */
-void CAScoreView::addCElement(CADrawableContext *elt, bool select) {
-	_drawableCList.addElement(elt);
-	_mapDrawable.insertMulti(elt->context(), elt);
+void CAScoreView::on_sheetLayout_changed() {
+	createShadowNotes();
 
-	if (select)
-		setCurrentContext(elt);
+	if (_savedContextIdx != -1)	// restore the last used context
+		setCurrentContext((CADrawableContext*)((drawableCList().size() > _savedContextIdx)?drawableCList().list().at(_savedContextIdx):0));
+	else
+		setCurrentContext(0);
+	_savedContextIdx = -1;
+
+	addToSelection(_savedSelection);
+	_savedSelection.clear();
+
+	invalidateScoreLayer();
+	update();
+}
 
-	if (elt->drawableContextType() == CADrawableContext::DrawableStaff &&
-	    static_cast<CAStaff*>(elt->context())->voiceList().size()) {
-		_shadowNote << new CANote( CADiatonicPitch(), CAPlayableLength(CAPlayableLength::Quarter, 0), static_cast<CAStaff*>(elt->context())->voiceList()[0], 0 );
-		_shadowDrawableNote << new CADrawableNote(_shadowNote.back(), elt, 0, 0, true);
+/*!
+	Called when the shared layout placed more music elements of a lazily laid out sheet.
+	Updates the scrollbars to the new width of the layout and repaints the view.
+*/
+void CAScoreView::on_sheetLayout_grown() {
+	double maxX = (getMaxXExtended(drawableMList()) > getMaxXExtended(drawableCList()))?getMaxXExtended(drawableMList()):getMaxXExtended(drawableCList());
+	if ( maxX - _worldW >= 0 ) {
+		_hScrollBarDeadLock = true;
+		_hScrollBar->setMaximum( maxX - _worldW );
+		_hScrollBar->setPageStep( _worldW );
+		_hScrollBarDeadLock = false;
 	}
+	checkScrollBars();
+
+	invalidateScoreLayer();
+	update();
 }
 
 /*!
-	Adds a drawable music element \a elt to the score view and selects it, if \a select is true.
+	Creates a shadow note for every drawable staff in the layout.
 */
-void CAScoreView::addDrawableNoteCheckerError(CADrawableNoteCheckerError *dnce) {
-	_drawableNCEList.addElement(dnce);
-	_mapDrawable.insertMulti(0, dnce);
+void CAScoreView::createShadowNotes() {
+	QList<CADrawableContext*> contexts = drawableCList().list();
+	for (int i=0; i<contexts.size(); i++) {
+		if (contexts[i]->drawableContextType() == CADrawableContext::DrawableStaff &&
+		    static_cast<CAStaff*>(contexts[i]->context())->voiceList().size()) {
+			_shadowNote << new CANote( CADiatonicPitch(), _shadowNoteLength, static_cast<CAStaff*>(contexts[i]->context())->voiceList()[0], 0 );
+			_shadowDrawableNote << new CADrawableNote(_shadowNote.back(), contexts[i], 0, 0, true);
+		}
+	}
+}
+
+/*!
+	Destroys the shadow notes.
+*/
+void CAScoreView::clearShadowNotes() {
+	while(!_shadowNote.isEmpty()) {
+		delete _shadowNote.takeFirst();
+		delete _shadowDrawableNote.takeFirst(); // same size
+	}
 }
 
 /*!
@@ -316,7 +385,7 @@ CADrawableContext *CAScoreView::selectContext(CAContext *context) {
 		return 0;
 	}
 	
-	QList<CADrawableContext*> drawableContexts = _drawableCList.list();
+	QList<CADrawableContext*> drawableContexts = drawableCList().list();
 	for (int i=0; i<drawableContexts.size(); i++) {
 		CAContext *c = drawableContexts[i]->context();
 		if (c == context) {
@@ -334,7 +403,7 @@ CADrawableContext *CAScoreView::selectContext(CAContext *context) {
 void CAScoreView::setLastMousePressCoordsAfter(const QList<CAMusElement*> list) {
 	double maxX = 0;
 	for( int i=0; i < list.size(); i++ ) {
-		QList<CADrawable*> drawables = _mapDrawable.values(list[i]);
+		QList<CADrawable*> drawables = _sheetLayout->drawables(list[i]);
 		for ( int j=0; j<drawables.size(); j++) {
 			maxX = qMax(drawables[j]->xPos() + drawables[j]->width(), maxX);
 		}
@@ -351,7 +420,7 @@ void CAScoreView::setLastMousePressCoordsAfter(const QList<CAMusElement*> list)
 	If no elements are present at the coordinates, clear the selection.
 */
 CADrawableContext* CAScoreView::selectCElement(double x, double y) {
-	QList<CADrawableContext*> l = _drawableCList.findInRange(x,y);
+	QList<CADrawableContext*> l = drawableCList().findInRange(x,y);
 
 	if (l.size()!=0) {
 		setCurrentContext(l.front());
@@ -369,7 +438,7 @@ CADrawableContext* CAScoreView::selectCElement(double x, double y) {
 	If there is a currently selected voice, only elements belonging to this voice are selected.
 */
 QList<CADrawableMusElement*> CAScoreView::musElementsAt(double x, double y) {
-	QList<CADrawableMusElement *> l = _drawableMList.findInRange(x,y);
+	QList<CADrawableMusElement *> l = drawableMList().findInRange(x,y);
 	for (int i=0; i<l.size(); i++)
 		if ( !l[i]->isSelectable() || (selectedVoice() && l[i]->musElement() && l[i]->musElement()->isPlayable() && static_cast<CAPlayable*>(l[i]->musElement())->voice()!=selectedVoice()) )
 			l.removeAt(i--);
@@ -386,9 +455,9 @@ QList<CADrawableMusElement*> CAScoreView::musElementsAt(double x, double y) {
 	\sa selectCElement(CAContext*)
 */
 CADrawableMusElement* CAScoreView::selectMElement(CAMusElement *elt) {
-	_selection.clear();
+	resetSelection();
 	
-	QList<CADrawable*> drawables = _mapDrawable.values(elt);
+	QList<CADrawable*> drawables = _sheetLayout->drawables(elt);
 	for (int i=0; i<drawables.size(); i++) {
 		if ( drawables[i]->drawableType()==CADrawable::DrawableMusElement &&
 		     static_cast<CADrawableMusElement*>(drawables[i])->musElement() == elt &&
@@ -405,44 +474,13 @@ CADrawableMusElement* CAScoreView::selectMElement(CAMusElement *elt) {
 		return 0;
 }
 
-/**!
- * This function clones the given drawable instances of musElements and contexts.
- * 
- * \obsolete This Function was used in the past when cloning the views to also clone the
- * elements. This behaviour was replaced for creating a new drawable instances
- * from the scene from scratch.
- */
-void CAScoreView::importElements(CAKDTree<CADrawableMusElement*> *origDMusElts, CAKDTree<CADrawableContext*> *origDContexts)
-{
-	QList<CADrawableContext*> drawableContexts = origDContexts->list();
-	for (int i=0; i<drawableContexts.size(); i++) {
-		addCElement(drawableContexts[i]->clone());
-	}
-	QList<CADrawableContext*> newDrawableContexts = _drawableCList.list();
-	
-	QList<CADrawableMusElement*> drawableMusElements = origDMusElts->list();
-	for (int i=0; i<drawableMusElements.size(); i++)
-	{
-		int idx = drawableContexts.indexOf(drawableMusElements[i]->drawableContext());
-		if(idx == -1)
-		{
-			std::cerr << "ERROR: Music element " << drawableMusElements[i] << " does not have a drawable context!" << std::endl;
-		} else
-		if (newDrawableContexts.size()<=idx) {
-			std::cerr << "ERROR: Index out of range. " << newDrawableContexts.size() << " new drawable contexts created. Request for idx=" << idx << std::endl;
-		} else {
-			addMElement( drawableMusElements[i]->clone(newDrawableContexts[idx]) );
-		}
-	}
-}
-
 /*!
 	Returns a pointer to the nearest drawable music element left of the current coordinates with the largest startTime.
 	Drawable elements left borders are taken into account.
 	If \a context is non-zero, returns the nearest element in the given context only.
 */
 CADrawableMusElement *CAScoreView::nearestLeftElement(double x, double y, CADrawableContext* context) {
-	return _drawableMList.findNearestLeft(x, true, context);
+	return drawableMList().findNearestLeft(x, true, context);
 }
 
 /*!
@@ -451,7 +489,7 @@ CADrawableMusElement *CAScoreView::nearestLeftElement(double x, double y, CADraw
 	Drawable elements left borders are taken into account.
 */
 CADrawableMusElement *CAScoreView::nearestLeftElement(double x, double y, CAVoice *voice) {
-	return _drawableMList.findNearestLeft(x, true, 0, voice);
+	return drawableMList().findNearestLeft(x, true, 0, voice);
 }
 
 /*!
@@ -460,7 +498,7 @@ CADrawableMusElement *CAScoreView::nearestLeftElement(double x, double y, CAVoic
 	If \a context is non-zero, returns the nearest element in the given context only.
 */
 CADrawableMusElement *CAScoreView::nearestRightElement(double x, double y, CADrawableContext* context) {
-	return _drawableMList.findNearestRight(x, true, context);
+	return drawableMList().findNearestRight(x, true, context);
 }
 
 /*!
@@ -469,7 +507,7 @@ CADrawableMusElement *CAScoreView::nearestRightElement(double x, double y, CADra
 	Drawable elements left borders are taken into account.
 */
 CADrawableMusElement *CAScoreView::nearestRightElement(double x, double y, CAVoice *voice) {
-	return _drawableMList.findNearestRight(x, true, 0, voice);
+	return drawableMList().findNearestRight(x, true, 0, voice);
 }
 
 /*!
@@ -477,7 +515,7 @@ CADrawableMusElement *CAScoreView::nearestRightElement(double x, double y, CAVoi
 	\todo Also look at X coordinate
 */
 CADrawableContext *CAScoreView::nearestUpContext(double x, double y) {
-	return static_cast<CADrawableContext*>(_drawableCList.findNearestUp(y));
+	return static_cast<CADrawableContext*>(drawableCList().findNearestUp(y));
 }
 
 /*!
@@ -485,15 +523,15 @@ CADrawableContext *CAScoreView::nearestUpContext(double x, double y) {
 	\todo Also look at X coordinate
 */
 CADrawableContext *CAScoreView::nearestDownContext(double x, double y) {
-	return static_cast<CADrawableContext*>(_drawableCList.findNearestDown(y));
+	return static_cast<CADrawableContext*>(drawableCList().findNearestDown(y));
 }
 
 /*!
 	Calculates the logical time at the given coordinates \a x and \a y.
 */
 int CAScoreView::calculateTime(double x, double y) {
-	CADrawableMusElement *left = _drawableMList.findNearestLeft(x, true);
-	CADrawableMusElement *right = _drawableMList.findNearestRight(x, true);
+	CADrawableMusElement *left = drawableMList().findNearestLeft(x, true);
+	CADrawableMusElement *right = drawableMList().findNearestRight(x, true);
 
 	if (left)	//the user clicked right of the element - return the nearest left element end time
 		return left->musElement()->timeStart() + left->musElement()->timeLength();
@@ -513,7 +551,8 @@ int CAScoreView::calculateTime(double x, double y) {
 	\return Map of bar number -> drawable barline of the staff with most barlines
 */
 QMap<int, CADrawableBarline*> CAScoreView::computeBarlinePositions(bool dotted) {
-	QList<CADrawableContext*> dContextList = _drawableCList.list();
+	_sheetLayout->finish(); // bars are counted from the beginning
+	QList<CADrawableContext*> dContextList = drawableCList().list();
 	QMap<int, CADrawableBarline*> result;
 
 	// determine staff with most barlines
@@ -563,7 +602,7 @@ QMap<int, CADrawableBarline*> CAScoreView::computeBarlinePositions(bool dotted)
 	If the given coordinates hit any of the contexts, returns that context.
 */
 CAContext *CAScoreView::contextCollision(double x, double y) {
-	QList<CADrawableContext*> l = _drawableCList.findInRange(x, y, 0, 0);
+	QList<CADrawableContext*> l = drawableCList().findInRange(x, y, 0, 0);
 	if (l.size() == 0) {
 		return 0;
 	} else {
@@ -573,46 +612,15 @@ CAContext *CAScoreView::contextCollision(double x, double y) {
 }
 
 /*!
-	Calls the engraver to reposition the music elements on the canvas.
+	Updates the shared layout of the sheet, if the sheet was changed, and the view helpers.
 	Also updates scrollbars.
+
+	\sa CASheetLayout::update()
  */
 void CAScoreView::rebuild() {
-	// clear the shadow notes
-	CAPlayableLength l( CAPlayableLength::Quarter );
-	for (int i=0; i<_shadowNote.size(); i++) {
-		delete _shadowDrawableNote[i];
-		l = _shadowNote[i]->playableLength();
-		delete _shadowNote[i];
-	}
-	_shadowNote.clear();
-	_shadowDrawableNote.clear();
-
-	QList<CAMusElement*> musElementSelection;
-	for (int i=0; i<_selection.size(); i++) {
-		if ( !musElementSelection.contains( _selection[i]->musElement() ) )
-			musElementSelection << _selection[i]->musElement();
-	}
-
-	_selection.clear();
-
-	_drawableMList.clear(true);
-	int contextIdx = (_currentContext ? _drawableCList.list().indexOf(_currentContext) : -1);	// remember the index of last used context
-	_drawableCList.clear(true);
-	_drawableNCEList.clear(true);
-	_mapDrawable.clear();
-
-	CALayoutEngine::reposit(this);
+	invalidateScoreLayer();
 
-	for (int i=0; i<_shadowNote.size(); i++) {
-		_shadowNote[i]->setPlayableLength(l);
-	}
-
-	if (contextIdx != -1)	// restore the last used context
-		setCurrentContext((CADrawableContext*)((_drawableCList.size() > contextIdx)?_drawableCList.list().at(contextIdx):0));
-	else
-		setCurrentContext(0);
-
-	addToSelection(musElementSelection);
+	_sheetLayout->update( _worldX+_worldW );	// lays out the sheet only once for all its views
 
 	setWorldCoords( worldCoords() ); // needed to update the scrollbars
 	checkScrollBars();
@@ -626,8 +634,10 @@ void CAScoreView::rebuild() {
 	\warning Repaint is not done automatically!
 */
 void CAScoreView::setWorldX(double x, bool animate, bool force) {
+	_sheetLayout->layoutTo( x+_worldW ); // lazily laid out sheets grow when scrolled to the right
+
 	if (!force) {
-		double maxX = (getMaxXExtended(_drawableMList) > getMaxXExtended(_drawableCList))?getMaxXExtended(_drawableMList) : getMaxXExtended(_drawableCList);
+		double maxX = (getMaxXExtended(drawableMList()) > getMaxXExtended(drawableCList()))?getMaxXExtended(drawableMList()) : getMaxXExtended(drawableCList());
 		if (x > maxX - _worldW)
 			x = maxX - _worldW;
 		if (x < 0)
@@ -660,7 +670,7 @@ void CAScoreView::setWorldX(double x, bool animate, bool force) {
 */
 void CAScoreView::setWorldY(double y, bool animate, bool force) {
 	if (!force) {
-		int maxY = getMaxYExtended(_drawableMList) > getMaxYExtended(_drawableCList)?getMaxYExtended(_drawableMList) : getMaxYExtended(_drawableCList);
+		int maxY = getMaxYExtended(drawableMList()) > getMaxYExtended(drawableCList())?getMaxYExtended(drawableMList()) : getMaxYExtended(drawableCList());
 		if (y > maxY - _worldH)
 			y = maxY - _worldH;
 		if (y < 0)
@@ -699,8 +709,10 @@ void CAScoreView::setWorldWidth(double w, bool force) {
 	_oldWorldW = _worldW;
 	_worldW = w;
 
+	_sheetLayout->layoutTo( _worldX+_worldW );
+
 	double scrollMax;
-	if ((scrollMax = ((getMaxXExtended(_drawableMList) > getMaxXExtended(_drawableCList))?getMaxXExtended(_drawableMList):getMaxXExtended(_drawableCList)) - _worldW) >= 0) {
+	if ((scrollMax = ((getMaxXExtended(drawableMList()) > getMaxXExtended(drawableCList()))?getMaxXExtended(drawableMList()):getMaxXExtended(drawableCList())) - _worldW) >= 0) {
 		if (scrollMax < _worldX)	//if you resize the widget at a large zoom level and if the getMax border has been reached
 			setWorldX(scrollMax);	//scroll the view away from the border
 
@@ -730,7 +742,7 @@ void CAScoreView::setWorldHeight(double h, bool force) {
 	_worldH = h;
 
 	double scrollMax;
-	if ((scrollMax = ((getMaxYExtended(_drawableMList) > getMaxYExtended(_drawableCList))?getMaxYExtended(_drawableMList):getMaxYExtended(_drawableCList)) - _worldH) >= 0) {
+	if ((scrollMax = ((getMaxYExtended(drawableMList()) > getMaxYExtended(drawableCList()))?getMaxYExtended(drawableMList()):getMaxYExtended(drawableCList())) - _worldH) >= 0) {
 		if (scrollMax < _worldY)	//if you resize the widget at a large zoom level and if the getMax border has been reached
 			setWorldY(scrollMax);	//scroll the view away from the border
 
@@ -814,18 +826,21 @@ void CAScoreView::zoomToSelection(bool animate, bool force) {
 }
 
 void CAScoreView::zoomToWidth(bool animate, bool force) {
-	int maxX = (getMaxXExtended(_drawableCList)>getMaxXExtended(_drawableMList))?getMaxXExtended(_drawableCList):getMaxXExtended(_drawableMList);
+	_sheetLayout->finish();
+	int maxX = (getMaxXExtended(drawableCList())>getMaxXExtended(drawableMList()))?getMaxXExtended(drawableCList()):getMaxXExtended(drawableMList());
 	setWorldCoords(0,0,maxX,0,animate,force);
 }
 
 void CAScoreView::zoomToHeight(bool animate, bool force) {
-	int maxY = (getMaxYExtended(_drawableCList)>getMaxYExtended(_drawableMList))?getMaxYExtended(_drawableCList):getMaxYExtended(_drawableMList);
+	_sheetLayout->finish();
+	int maxY = (getMaxYExtended(drawableCList())>getMaxYExtended(drawableMList()))?getMaxYExtended(drawableCList()):getMaxYExtended(drawableMList());
 	setWorldCoords(0,0,0,maxY,animate,force);
 }
 
 void CAScoreView::zoomToFit(bool animate, bool force) {
-	int maxX = ((_drawableCList.getMaxX() > _drawableMList.getMaxX())?_drawableCList.getMaxX():_drawableMList.getMaxX());
-	int maxY = ((_drawableCList.getMaxY() > _drawableMList.getMaxY())?_drawableCList.getMaxY():_drawableMList.getMaxY());
+	_sheetLayout->finish();
+	int maxX = ((drawableCList().getMaxX() > drawableMList().getMaxX())?drawableCList().getMaxX():drawableMList().getMaxX());
+	int maxY = ((drawableCList().getMaxY() > drawableMList().getMaxY())?drawableCList().getMaxY():drawableMList().getMaxY());
 
 	setWorldCoords(0, 0, maxX, maxY, animate, force);
 }
@@ -911,36 +926,114 @@ void CAScoreView::setZoom(float z, double x, double y, bool animate, bool force)
 
 /*!
 	General Qt's paint event.
-	All the music elements get actually rendered in this method.
+
+	The view is painted in two layers. The score layer contains the contexts, unselected music
+	elements, ruler and note checker errors. It is painted into a pixmap by paintScoreLayer() and
+	only repainted when the view is rebuilt, scrolled, zoomed or resized. When the selection
+	changes, only the area of the (de)selected elements is repainted in the score layer. The
+	overlay contains the selected (and currently played) elements, selection regions, shadow notes
+	and the border. It is painted by paintOverlay() over the cached score layer on every paint event.
+
+	Use repaintOverlay() when only the overlay changed (eg. moving the shadow note).
+
+	\sa repaintOverlay(), invalidateScoreLayer()
 */
-#include <time.h> //benchmarking
-#include <sys/time.h> //benchmarking
 void CAScoreView::paintEvent(QPaintEvent *e) {
 	if (_holdRepaint)
 		return;
 
-	// draw the border
+#if QT_VERSION >= 0x050600
+	const qreal dpr = devicePixelRatioF();
+#else
+	const qreal dpr = 1;
+#endif
+	const QRectF world( _worldX, _worldY, _worldW, _worldH );
+	if ( _scoreLayer.size()!=size()*dpr ) {
+		_scoreLayer = QPixmap( size()*dpr );
+#if QT_VERSION >= 0x050600
+		_scoreLayer.setDevicePixelRatio( dpr );
+#endif
+		_scoreLayerValid = false;
+	}
+	if ( _scoreLayerWorld!=world || _scoreLayerZoom!=_zoom ) {
+		_scoreLayerValid = false;
+	}
+
+	if ( !_overlayOnly || !_scoreLayerValid ) {
+		if ( !_scoreLayerValid ) {
+			clearRepaintArea(); // the whole layer needs to be repainted
+			_scoreLayer.fill( palette().color( backgroundRole() ) );
+		}
+
+		QPainter lp( &_scoreLayer );
+		paintScoreLayer( &lp );
+
+		_scoreLayerWorld = world;
+		_scoreLayerZoom = _zoom;
+		_scoreLayerValid = true;
+	} else if ( !(_selectionArea & world).isEmpty() ) {
+		// only the (de)selected elements changed, repaint their visible area
+		clearRepaintArea();
+		setRepaintArea( new QRect( (_selectionArea & world).toAlignedRect().adjusted(-1, -1, 1, 1) ) );
+
+		QPainter lp( &_scoreLayer );
+		lp.setClipRect( QRectF( (_repaintArea->x() - _worldX)*_zoom, (_repaintArea->y() - _worldY)*_zoom,
+		                        _repaintArea->width()*_zoom, _repaintArea->height()*_zoom ) );
+		paintScoreLayer( &lp );
+	}
+	_overlayOnly = false;
+	_selectionArea = QRectF();
+
 	QPainter p(this);
-	if (_drawBorder) {
-		p.setPen(_borderPen);
-		p.drawRect(0,0,width()-1,height()-1);
+	p.drawPixmap( 0, 0, _scoreLayer );
+	paintOverlay( &p );
+
+	// flush the oldWorld coordinates as they're needed for the first repaint only
+	_oldWorldX = _worldX; _oldWorldY = _worldY;
+	_oldWorldW = _worldW; _oldWorldH = _worldH;
+
+	if (_repaintArea) {
+		delete _repaintArea;
+		_repaintArea = 0;
 	}
+}
+
+/*!
+	Repaints only the overlay over the cached score layer, if the score layer is still valid.
+	This is much faster than repaint() and is used on mouse moves and during the playback.
+	The view is updated on the next paint event, so several calls are painted once.
 
+	\sa paintEvent(), invalidateScoreLayer()
+*/
+void CAScoreView::repaintOverlay() {
+	_overlayOnly = true;
+	update();
+}
+
+/*!
+	\fn void CAScoreView::invalidateScoreLayer()
+	Forces repainting of the score layer on the next paint event, even if repaintOverlay() is
+	called.
+*/
+
+/*!
+	Paints the background, contexts, music elements, ruler and note checker errors using the
+	painter \a p. Only the repaint area is painted, if set.
+*/
+void CAScoreView::paintScoreLayer( QPainter *p ) {
 	// draw the background
 	if (_repaintArea)
-		p.fillRect(qRound((_repaintArea->x() - _worldX)*_zoom), qRound((_repaintArea->y() - _worldY)*_zoom), qRound(_repaintArea->width()*_zoom), qRound(_repaintArea->height()*_zoom), _backgroundColor);
+		p->fillRect(qRound((_repaintArea->x() - _worldX)*_zoom), qRound((_repaintArea->y() - _worldY)*_zoom), qRound(_repaintArea->width()*_zoom), qRound(_repaintArea->height()*_zoom), _backgroundColor);
 	else
-		p.fillRect(_canvas->x(), _canvas->y(), _canvas->width(), _canvas->height(), _backgroundColor);
+		p->fillRect(_canvas->x(), _canvas->y(), _canvas->width(), _canvas->height(), _backgroundColor);
 
 	// draw contexts
-	timeval timeStart, timeEnd, timeEnd2;
-	gettimeofday(&timeStart, NULL);
 	QList<CADrawableContext*> cList;
-	//int j = _drawableCList.size();
+	//int j = drawableCList().size();
 	if (_repaintArea)
-		cList = _drawableCList.findInRange(_repaintArea->x(), _repaintArea->y(), _repaintArea->width(),_repaintArea->height());
+		cList = drawableCList().findInRange(_repaintArea->x(), _repaintArea->y(), _repaintArea->width(),_repaintArea->height());
 	else
-		cList = _drawableCList.findInRange(_worldX, _worldY, _worldW, _worldH);
+		cList = drawableCList().findInRange(_worldX, _worldY, _worldW, _worldH);
 
 	for (int i=0; i<cList.size(); i++) {
 		CADrawSettings s = {
@@ -952,28 +1045,28 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 		               _worldX,
 		               _worldY
 		};
-		cList[i]->draw(&p, s);
+		cList[i]->draw(p, s);
 	}
 
 	// draw music elements
 	QList<CADrawableMusElement*> mList;
 	if (_repaintArea)
-		mList = _drawableMList.findInRange(_repaintArea->x(), _repaintArea->y(), _repaintArea->width(),_repaintArea->height());
+		mList = drawableMList().findInRange(_repaintArea->x(), _repaintArea->y(), _repaintArea->width(),_repaintArea->height());
 	else
-		mList = _drawableMList.findInRange(_worldX, _worldY, _worldW, _worldH);
+		mList = drawableMList().findInRange(_worldX, _worldY, _worldW, _worldH);
 
-	gettimeofday(&timeEnd, NULL);
-
-	p.setRenderHint( QPainter::Antialiasing, CACanorus::settings()->antiAliasing() );
+	p->setRenderHint( QPainter::Antialiasing, CACanorus::settings()->antiAliasing() );
 
 	for (int i=0; i<mList.size(); i++) {
+		// selected elements are only drawn in the overlay, so they don't leave fringes
+		if ( isSelected(mList[i]) ) {
+			continue;
+		}
+
 		QColor color;
 		CAMusElement *elt = mList[i]->musElement();
 		
-		// determine element color (based on selection, current mode, active voice etc.)
-		if ( _selection.contains(mList[i])) {
-			color = selectionColor();
-		} else
+		// determine element color (based on current mode, active voice etc.)
 		if ( (selectedVoice() &&
 		     ((elt &&
 		      ((elt->isPlayable() && static_cast<CAPlayable*>(elt)->voice()==selectedVoice()) ||
@@ -1017,26 +1110,18 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 		               _worldX,
 		               _worldY
 		               };
-		mList[i]->draw(&p, s);
-		if ( _selection.contains(mList[i]) && mList[i]->isHScalable() ) {
-			s.color = foregroundColor();
-			mList[i]->drawHScaleHandles(&p, s);
-		}
-		if ( _selection.contains(mList[i]) && mList[i]->isVScalable() ) {
-			s.color = foregroundColor();
-			mList[i]->drawVScaleHandles(&p, s);
-		}
+		mList[i]->draw(p, s);
 	}
 
 	// draw ruler
 	if (CACanorus::settings()->showRuler()) {
-		p.fillRect(0, 0, width(), RULER_HEIGHT, QColor::fromRgb(200, 200, 200, 128));
-		p.setPen(Qt::lightGray);
+		p->fillRect(0, 0, width(), RULER_HEIGHT, QColor::fromRgb(200, 200, 200, 128));
+		p->setPen(Qt::lightGray);
 
 		QFont font("FreeSans");
 		font.setPixelSize( qRound(RULER_HEIGHT*0.8) );
-		p.setFont(font);
-		p.setPen(Qt::black);
+		p->setFont(font);
+		p->setPen(Qt::black);
 
 		QMap<int, CADrawableBarline*> dBarlineMap = computeBarlinePositions(false);
 
@@ -1051,7 +1136,7 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 				CADrawableBarline *curDBarline = dBarlineMap[curBarlineNumber];
 				if (dBarlineMap.contains(curBarlineNumber+1)) { // don't draw the last bar number
 					double center = qRound((curDBarline->xPos()-_worldX)*_zoom);
-					p.drawText( center-1, RULER_HEIGHT-2, QString::number(curBarlineNumber) );
+					p->drawText( center-1, RULER_HEIGHT-2, QString::number(curBarlineNumber) );
 				}
 			}
 		}
@@ -1061,7 +1146,7 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 	
 	// draw note checker errors
 	{
-		QList<CADrawableNoteCheckerError*> dnceList = _drawableNCEList.findInRange(_worldX, _worldY, _worldW, _worldH);
+		QList<CADrawableNoteCheckerError*> dnceList = _sheetLayout->drawableNCEList().findInRange(_worldX, _worldY, _worldW, _worldH);
 		for (int i=0; i<dnceList.size(); i++) {
 			CADrawSettings c = {
 				_zoom,
@@ -1072,10 +1157,46 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 				_worldX,
 				_worldY
 			};
-			dnceList[i]->draw( &p, c );
+			dnceList[i]->draw( p, c );
 		}
 	}
-	
+}
+
+/*!
+	Paints the selected elements, selection regions, shadow notes and the border using the
+	painter \a p.
+*/
+void CAScoreView::paintOverlay( QPainter *p ) {
+	p->setRenderHint( QPainter::Antialiasing, CACanorus::settings()->antiAliasing() );
+
+	// draw selected elements (also the currently played notes) over the score layer
+	for (int i=0; i<_selection.size(); i++) {
+		CADrawableMusElement *elt = _selection[i];
+		if ( elt->xPos()+elt->width() < _worldX || elt->xPos() > _worldX+_worldW ||
+		     elt->yPos()+elt->height() < _worldY || elt->yPos() > _worldY+_worldH ) {
+			continue;
+		}
+
+		CADrawSettings s = {
+		               _zoom,
+		               qRound((elt->xPos() - _worldX) * _zoom),
+		               qRound((elt->yPos() - _worldY) * _zoom),
+		               drawableWidth(), drawableHeight(),
+		               selectionColor(),
+		               _worldX,
+		               _worldY
+		               };
+		elt->draw(p, s);
+		if ( elt->isHScalable() ) {
+			s.color = foregroundColor();
+			elt->drawHScaleHandles(p, s);
+		}
+		if ( elt->isVScalable() ) {
+			s.color = foregroundColor();
+			elt->drawVScaleHandles(p, s);
+		}
+	}
+
 	// draw selection regions
 	for (int i=0; i<selectionRegionList().size(); i++) {
 		CADrawSettings c = {
@@ -1088,7 +1209,7 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
             _worldX,
             _worldY
 		};
-		drawSelectionRegion( &p, c );
+		drawSelectionRegion( p, c );
 	}
 
 	// draw shadow note
@@ -1105,13 +1226,13 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 	               _worldY
 				};
 
-				_shadowDrawableNote[i]->draw(&p, s);
+				_shadowDrawableNote[i]->draw(p, s);
 
 				if (_drawShadowNoteAccs) {
 					CADrawableAccidental acc(_shadowNoteAccs, 0, 0, 0, _shadowDrawableNote[i]->yCenter());
 					s.x -= qRound((acc.width()+2)*_zoom);
 					s.y = qRound((acc.yPos() - _worldY)*_zoom);
-					acc.draw(&p, s);
+					acc.draw(p, s);
 				}
 			}
 		}
@@ -1120,24 +1241,16 @@ void CAScoreView::paintEvent(QPaintEvent *e) {
 		if (_shadowNote.size()) {
 			QFont font("FreeSans");
 			font.setPixelSize( 20 );
-			p.setFont(font);
-			p.setPen(disabledElementsColor());
-			p.drawText( qRound((_xCursor-_worldX+10) * _zoom), qRound((_yCursor-_worldY-10) * _zoom), CANote::generateNoteName(_shadowNote[0]->diatonicPitch().noteName(), _shadowNoteAccs) );
+			p->setFont(font);
+			p->setPen(disabledElementsColor());
+			p->drawText( qRound((_xCursor-_worldX+10) * _zoom), qRound((_yCursor-_worldY-10) * _zoom), CANote::generateNoteName(_shadowNote[0]->diatonicPitch().noteName(), _shadowNoteAccs) );
 		}
 	}
-	
-	gettimeofday(&timeEnd2, NULL);
-	
-//	std::cout << "finding elements to draw took " << timeEnd.tv_sec-timeStart.tv_sec+(timeEnd.tv_usec-timeStart.tv_usec)/1000000.0 << "s." << std::endl;
-//	std::cout << "painting " << mList.size() << " elements took " << timeEnd2.tv_sec-timeEnd.tv_sec+(timeEnd2.tv_usec-timeEnd.tv_usec)/1000000.0 << "s." << std::endl;
-
-	// flush the oldWorld coordinates as they're needed for the first repaint only
-	_oldWorldX = _worldX; _oldWorldY = _worldY;
-	_oldWorldW = _worldW; _oldWorldH = _worldH;
 
-	if (_repaintArea) {
-		delete _repaintArea;
-		_repaintArea = 0;
+	// draw the border
+	if (_drawBorder) {
+		p->setPen(_borderPen);
+		p->drawRect(0,0,width()-1,height()-1);
 	}
 }
 
@@ -1216,7 +1329,7 @@ void CAScoreView::checkScrollBars() {
 	bool change = false;
 	_holdRepaint = true;	// disable repaint until the scrollbar values are set
 	_checkScrollBarsDeadLock = true;	// disable any further method calls until the method is over
-	if ((((getMaxXExtended(_drawableMList) > getMaxXExtended(_drawableCList))?getMaxXExtended(_drawableMList):getMaxXExtended(_drawableCList)) - worldWidth() > 0) || (_hScrollBar->value()!=0)) { //if scrollbar is needed
+	if ((((getMaxXExtended(drawableMList()) > getMaxXExtended(drawableCList()))?getMaxXExtended(drawableMList()):getMaxXExtended(drawableCList())) - worldWidth() > 0) || (_hScrollBar->value()!=0)) { //if scrollbar is needed
 		if (!_hScrollBar->isVisible()) {
 			_hScrollBar->show();
 			change = true;
@@ -1227,7 +1340,7 @@ void CAScoreView::checkScrollBars() {
 			change = true;
 		}
 
-	if ((((getMaxYExtended(_drawableMList) > getMaxYExtended(_drawableCList))?getMaxYExtended(_drawableMList):getMaxYExtended(_drawableCList)) - worldHeight() > 0) || (_vScrollBar->value()!=0)) { //if scrollbar is needed
+	if ((((getMaxYExtended(drawableMList()) > getMaxYExtended(drawableCList()))?getMaxYExtended(drawableMList()):getMaxYExtended(drawableCList())) - worldHeight() > 0) || (_vScrollBar->value()!=0)) { //if scrollbar is needed
 		if (!_vScrollBar->isVisible()) {
 			_vScrollBar->show();
 			change = true;
@@ -1430,12 +1543,12 @@ void CAScoreView::VScrollBarEvent(int val) {
 void CAScoreView::leaveEvent(QEvent *e) {
 	_shadowNoteVisibleOnLeave = _shadowNoteVisible;
 	_shadowNoteVisible = false;
-	repaint();
+	repaintOverlay();
 }
 
 void CAScoreView::enterEvent(QEvent *e) {
 	_shadowNoteVisible = _shadowNoteVisibleOnLeave;
-	repaint();
+	repaintOverlay();
 }
 
 void CAScoreView::startAnimationTimer() {
@@ -1525,15 +1638,16 @@ CADrawableMusElement *CAScoreView::selectDownMusElement() {
 	return _selection.front();
 }
 
+static bool drawableXLessThan( const CADrawableMusElement *a, const CADrawableMusElement *b ) {
+	return a->xPos() < b->xPos();
+}
+
 /*!
 	Adds the given drawable music element \a elt to the current selection.
+	Elements which are already selected are ignored.
 */
 void CAScoreView::addToSelection( CADrawableMusElement *elt, bool triggerSignal ) {
-	int i;
-	for (i=0; i<_selection.size() && _selection[i]->xPos() < elt->xPos(); i++);
-
-	if ( elt->isSelectable() )
-		_selection.insert( i, elt );
+	insertSelected( elt, true );
 
 	if ( triggerSignal )
 		emit selectionChanged();
@@ -1541,11 +1655,17 @@ void CAScoreView::addToSelection( CADrawableMusElement *elt, bool triggerSignal
 
 /*!
 	Adds the given list of drawable music elements \a list to the current selection.
+	Elements which are not selectable are skipped. The elements are appended and the selection
+	is sorted once, so adding n elements takes O(n log n) time.
 */
-void CAScoreView::addToSelection(const QList<CADrawableMusElement*> list, bool selectableOnly ) {
+void CAScoreView::addToSelection(const QList<CADrawableMusElement*> list ) {
+	bool added = false;
 	for (int i=0; i<list.size(); i++) {
-		if ( !selectableOnly || (selectableOnly && list[i]->isSelectable()) )
-			addToSelection(list[i], false);
+		added |= insertSelected( list[i], false );
+	}
+
+	if ( added ) {
+		sortSelection();
 	}
 
 	emit selectionChanged();
@@ -1556,27 +1676,125 @@ void CAScoreView::addToSelection(const QList<CADrawableMusElement*> list, bool s
 	Returns a pointer to its drawable element or 0, if the music element is not part of this score view.
 */
 CADrawableMusElement *CAScoreView::addToSelection(CAMusElement *elt) {
-	QList<CADrawable*> l = _mapDrawable.values(elt);
+	QList<CADrawable*> l = _sheetLayout->drawables(elt);
 	for (int i=0; i<l.size(); i++) {
-		addToSelection(static_cast<CADrawableMusElement*>(l[i]));
+		addToSelection(static_cast<CADrawableMusElement*>(l[i]), false);
 	}
 
 	emit selectionChanged();
-	return _selection.back();
+	return ( l.size() ? static_cast<CADrawableMusElement*>(l.last()) : 0 );
 }
 
 /*!
 	Adds the given list of abstract music elements to the selection.
 */
 void CAScoreView::addToSelection(const QList<CAMusElement*> elts) {
+	QList<CADrawableMusElement*> drawables;
 	for (int i=0; i<elts.size(); i++) {
-		QList<CADrawable*> l = _mapDrawable.values(elts[i]);
+		QList<CADrawable*> l = _sheetLayout->drawables(elts[i]);
 		for (int j=0; j<l.size(); j++) {
-			addToSelection(static_cast<CADrawableMusElement*>(l[j]), false);
+			drawables << static_cast<CADrawableMusElement*>(l[j]);
 		}
 	}
 
+	addToSelection( drawables );
+}
+
+/*!
+	Removes the given drawable music element \a elt from the selection.
+	Returns True, if the element was selected.
+*/
+bool CAScoreView::removeFromSelection( CADrawableMusElement *elt ) {
+	if ( !eraseSelected(elt) ) {
+		return false;
+	}
+
 	emit selectionChanged();
+	return true;
+}
+
+/*!
+	Deselects all elements.
+*/
+void CAScoreView::clearSelection() {
+	resetSelection();
+	emit selectionChanged();
+}
+
+/*!
+	Deselects all elements without emitting selectionChanged().
+*/
+void CAScoreView::resetSelection() {
+	while ( !_selection.isEmpty() ) {
+		eraseSelected( _selection.last() );
+	}
+}
+
+/*!
+	Adds the drawable element \a elt to the selection list and set. All changes of the selection
+	go through this function and eraseSelected(), so the list and the set always contain the same
+	elements.
+
+	If \a keepSorted is true, the element is inserted at its x position. Otherwise it is appended
+	and the caller sorts the selection by sortSelection() after adding all the elements.
+
+	Returns True, if the element was added. Elements which are not selectable or which are
+	already selected are not added.
+*/
+bool CAScoreView::insertSelected( CADrawableMusElement *elt, bool keepSorted ) {
+	if ( !elt->isSelectable() || _selectionSet.contains(elt) ) {
+		return false;
+	}
+
+	if ( keepSorted ) {
+		_selection.insert( std::upper_bound( _selection.begin(), _selection.end(), elt, drawableXLessThan ), elt );
+	} else {
+		_selection << elt;
+	}
+	_selectionSet.insert( elt );
+	invalidateSelectionArea( elt );
+
+	return true;
+}
+
+/*!
+	Removes the drawable element \a elt from the selection list and set.
+	The element is found in the sorted list by its x position.
+
+	Returns True, if the element was selected.
+
+	\sa insertSelected()
+*/
+bool CAScoreView::eraseSelected( CADrawableMusElement *elt ) {
+	if ( !_selectionSet.remove(elt) ) {
+		return false;
+	}
+
+	int i = std::lower_bound( _selection.begin(), _selection.end(), elt, drawableXLessThan ) - _selection.begin();
+	while ( i<_selection.size() && _selection[i]!=elt ) {
+		i++;
+	}
+	_selection.removeAt( i<_selection.size() ? i : _selection.lastIndexOf(elt) );
+	invalidateSelectionArea( elt );
+
+	return true;
+}
+
+/*!
+	Marks the area of the given (de)selected element \a elt to be repainted in the score layer
+	on the next paint event.
+
+	\sa paintEvent()
+*/
+void CAScoreView::invalidateSelectionArea( CADrawableMusElement *elt ) {
+	_selectionArea |= QRectF( elt->xPos(), elt->yPos(), elt->width(), elt->height() );
+}
+
+/*!
+	Sorts the selection by the x position of the elements.
+*/
+void CAScoreView::sortSelection() {
+	std::stable_sort( _selection.begin(), _selection.end(), drawableXLessThan );
 }
 
 /*!
@@ -1584,13 +1802,9 @@ void CAScoreView::addToSelection(const QList<CAMusElement*> elts) {
 	This function is usually associated with CTRL+A key.
 */
 void CAScoreView::selectAll() {
-	clearSelection();
-
-	QList<CADrawableMusElement*> elts = _drawableMList.list();
-	for(int i=0; i<elts.size(); i++)
-		addToSelection(elts[i], false);
-
-	emit selectionChanged();
+	_sheetLayout->finish();
+	resetSelection();
+	addToSelection( drawableMList().list() );
 }
 
 /*!
@@ -1604,12 +1818,16 @@ void CAScoreView::selectAllCurBar() {
 
 	clearSelection();
 
-	if (selectedVoice()) {
-		addToSelection( selectedVoice()->getBar( coordsToTime(_lastMousePressCoords.x()) ) );
-	} else {
-		QList<CAVoice*> voices = static_cast<CAStaff*>(currentContext()->context())->voiceList();
-		for (int i=0; i<voices.size(); i++) {
-			addToSelection( voices[i]->getBar( coordsToTime(_lastMousePressCoords.x()) ) );
+	CAStaff *staff = static_cast<CAStaff*>(currentContext()->context());
+	int bar = staff->measureTable()->measureIndexAt( coordsToTime(_lastMousePressCoords.x()) );
+	if ( bar!=-1 ) {
+		if (selectedVoice()) {
+			addToSelection( staff->measureTable()->measureElements( bar, selectedVoice() ) );
+		} else {
+			QList<CAVoice*> voices = staff->voiceList();
+			for (int i=0; i<voices.size(); i++) {
+				addToSelection( staff->measureTable()->measureElements( bar, voices[i] ) );
+			}
 		}
 	}
 
@@ -1625,8 +1843,9 @@ void CAScoreView::selectAllCurContext() {
 		return;
 	}
 
+	_sheetLayout->finish();
 	clearSelection();
-	addToSelection( currentContext()->drawableMusElementList(), false );
+	addToSelection( currentContext()->drawableMusElementList() );
 
 	emit selectionChanged();
 }
@@ -1635,15 +1854,17 @@ void CAScoreView::selectAllCurContext() {
 	Inverts the current selection.
 */
 void CAScoreView::invertSelection() {
-	QList<CADrawableMusElement *> oldSelection = selection();
-	clearSelection();
-
-	QList<CADrawableMusElement*> elts = _drawableMList.list();
-	for(int i=0; i<elts.size(); i++)
-		if(!oldSelection.contains(elts[i]))
-			addToSelection(elts[i], false);
+	_sheetLayout->finish();
+	QList<CADrawableMusElement*> elts = drawableMList().list();
+	QList<CADrawableMusElement*> newSelection;
+	for (int i=0; i<elts.size(); i++) {
+		if ( !_selectionSet.contains(elts[i]) ) {
+			newSelection << elts[i];
+		}
+	}
 
-	emit selectionChanged();
+	resetSelection();
+	addToSelection( newSelection );
 }
 
 /*!
@@ -1652,11 +1873,7 @@ void CAScoreView::invertSelection() {
 	\sa findCElement()
 */
 CADrawableMusElement *CAScoreView::findMElement(CAMusElement *elt) {
-	QList<CADrawable*> hits = _mapDrawable.values(elt);
-	if (hits.size()) {
-		return static_cast<CADrawableMusElement*>(hits[0]);
-	}
-	return 0;
+	return _sheetLayout->findMElement(elt);
 }
 
 /*!
@@ -1665,11 +1882,7 @@ CADrawableMusElement *CAScoreView::findMElement(CAMusElement *elt) {
 	\sa findMElement()
 */
 CADrawableContext *CAScoreView::findCElement(CAContext *context) {
-	QList<CADrawable*> hits = _mapDrawable.values(context);
-	if (hits.size()) {
-		return static_cast<CADrawableContext*>(hits[0]);
-	}
-	return 0;
+	return _sheetLayout->findCElement(context);
 }
 
 /*!
@@ -1749,7 +1962,7 @@ double CAScoreView::getMaxYExtended(CAKDTree<T> &v) {
 	bottom border is larger than \a x2.
 */
 QList<CADrawableContext*> CAScoreView::findContextsInRegion( QRect &region ) {
-	return _drawableCList.findInRange(region);
+	return drawableCList().findInRange(region);
 }
 
 /*!
@@ -1759,13 +1972,13 @@ QList<CADrawableContext*> CAScoreView::findContextsInRegion( QRect &region ) {
 */
 int CAScoreView::coordsToTime( double x ) {
 	CADrawableMusElement *d1 = nearestLeftElement( x, 0 );
-	if ( selection().contains(d1) ) {
+	if ( d1 && isSelected(d1) ) {
 		CADrawableMusElement *newD1 = nearestLeftElement( d1->xPos(), 0 );
 		d1 = newD1;
 	}
 
 	CADrawableMusElement *d2 = nearestRightElement( x, 0 );
-	if ( selection().contains(d2) ) {
+	if ( d2 && isSelected(d2) ) {
 		CADrawableMusElement *newD2 = nearestRightElement( d2->xPos()+d2->width(), 0 );
 		d2 = newD2;
 	}
@@ -1812,13 +2025,14 @@ double CAScoreView::timeToCoordsSimpleVersion( int time ) {
 		// get the element still smaller or equal, but nearest to time
 		QList<CAMusElement*>::const_iterator it = qLowerBound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, CAScoreView::musElementTimeLessThan);
 		if (it!=voiceList[i]->musElementList().constEnd()) {
-			if (_mapDrawable.contains(*it)) {
-				CADrawableMusElement *dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).last());
+			QList<CADrawable*> drawables = _sheetLayout->drawables(*it);
+			if (drawables.size()) {
+				CADrawableMusElement *dElt = static_cast<CADrawableMusElement*>(drawables.last());
                 if (leftElt && leftElt->xPos()<dElt->xPos()) {
 					leftElt = dElt;
 				}
 			} else {
-				std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in _mapDrawable!" << std::endl;
+				std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in the layout!" << std::endl;
 			}
 		}
 	}
@@ -1829,53 +2043,15 @@ double CAScoreView::timeToCoordsSimpleVersion( int time ) {
 /*!
 	Returns the X coordinate for the given Canorus \a time.
 	Returns -1, if such a time doesn't exist in the score.
+
+	\sa CASheetLayout::timeToCoords()
 */
 double CAScoreView::timeToCoords( int time ) {
-	CADrawableMusElement *leftElt = 0;
-	CADrawableMusElement *rightElt = 0;
-	
-	QList<CAVoice*> voiceList = _sheet->voiceList();
-	for (int i=0; i<voiceList.size(); i++) {
-		// get the element still smaller or equal, but nearest to time
-		QList<CAMusElement*>::const_iterator it = qLowerBound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, CAScoreView::musElementTimeLessThan);
-		if (it!=voiceList[i]->musElementList().constEnd()) {
-			if (_mapDrawable.contains(*it)) {
-				CADrawableMusElement *dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).last());
-				if (!leftElt || leftElt->xPos()<dElt->xPos()) {
-					leftElt = dElt;
-				}
-			} else {
-				std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in _mapDrawable!" << std::endl;
-			}
-		}
-		
-		// and for the right element
-		it = qUpperBound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, CAScoreView::timeMusElementLessThan);
-		if (it!=voiceList[i]->musElementList().constEnd()) {
-			if (_mapDrawable.contains(*it)) {
-				CADrawableMusElement *dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).first());
-				if (!rightElt || rightElt->xPos()>dElt->xPos()) {
-					rightElt = dElt;
-				}
-			} else {
-				std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in _mapDrawable!" << std::endl;
-			}
-		}
-
-	}
-	
-	// get the relative position between the nearest left and the nearest right elements
-	if ( leftElt && rightElt && leftElt->musElement() && rightElt->musElement() ) {
-		int delta = (rightElt->musElement()->timeStart() - leftElt->musElement()->timeStart());
-		if (!delta) delta=1;
-		return leftElt->xPos() + ( rightElt->xPos() - leftElt->xPos() ) *
-		              ( ((double)time - leftElt->musElement()->timeStart()) / delta );
-	} else {
-		return -1;
-	}
+	return _sheetLayout->timeToCoords( time );
 }
 
 void CAScoreView::setShadowNoteLength( CAPlayableLength l ) {
+	_shadowNoteLength = l;
 	for (int i=0; i<_shadowNote.size(); i++) {
 		_shadowNote[i]->setPlayableLength( l );
 	}
@@ -1889,9 +2065,11 @@ void CAScoreView::setShadowNoteLength( CAPlayableLength l ) {
  */
 QList<CAMusElement*> CAScoreView::musElementSelection() {
 	QList<CAMusElement*> res;
+	QSet<CAMusElement*> found;
 
 	for (int i=0; i<_selection.size(); i++) {
-		if (!res.contains(_selection[i]->musElement())) {
+		if (!found.contains(_selection[i]->musElement())) {
+			found.insert(_selection[i]->musElement());
 			res << _selection[i]->musElement();
 		}
 	}
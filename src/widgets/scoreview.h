@@ -12,12 +12,15 @@
 #include <QPen>
 #include <QBrush>
 #include <QRect>
+#include <QPixmap>
 #include <QLineEdit>
 #include <QTimer>
-#include <QMultiMap>
+#include <QMap>
+#include <QSet>
 
 #include "widgets/view.h"
 #include "layout/kdtree.h"
+#include "layout/sheetlayout.h"
 #include "score/note.h"
 
 class QScrollBar;
@@ -36,7 +39,6 @@ class CAContext;
 class CASheet;
 class CAStaff;
 class CALyricsContext;
-class CADrawableNoteCheckerError;
 
 class CATextEdit : public QLineEdit {
 Q_OBJECT
@@ -71,21 +73,14 @@ public:
 	CAScoreView *clone();
 	CAScoreView *clone(QWidget *parent);
 	inline CASheet  *sheet() { return _sheet; }
-	inline void setSheet( CASheet *sheet ) { _sheet = sheet; }
-
-	////////////////////////////////////////////
-	// Addition, removal of drawable elements //
-	////////////////////////////////////////////
-	void addMElement(CADrawableMusElement *elt, bool select=false);
-	void addCElement(CADrawableContext *elt, bool select=false);
-	void addDrawableNoteCheckerError(CADrawableNoteCheckerError *dnce);
-
-	void importElements(CAKDTree<CADrawableMusElement*> *drawableMList, CAKDTree<CADrawableContext*> *drawableCList);
+	void setSheet( CASheet *sheet );
+	inline CASheetLayout *sheetLayout() { return _sheetLayout; }
 
 	///////////////
 	// Selection //
 	///////////////
 	inline const QList<CADrawableMusElement*>& selection() { return _selection; };
+	inline bool isSelected(CADrawableMusElement *elt) { return _selectionSet.contains(elt); }
 	QList<CAMusElement*>                 musElementSelection();
 	QList<CADrawableMusElement*>         musElementsAt(double x, double y);
 	CADrawableContext                   *selectCElement(double x, double y);
@@ -95,17 +90,17 @@ public:
 	void                                 setLastMousePressCoordsAfter(const QList<CAMusElement*> list);
 
 	inline CADrawableContext *currentContext() { return _currentContext; }
-	inline void setCurrentContext(CADrawableContext *c) { _currentContext = c; }
+	inline void setCurrentContext(CADrawableContext *c) { _currentContext = c; invalidateScoreLayer(); }
 
 	void selectAll();
 	void selectAllCurBar();
 	void selectAllCurContext();
 	void invertSelection();
-	inline void clearSelection() { _selection.clear(); emit selectionChanged(); }
-	inline bool removeFromSelection(CADrawableMusElement *elt) { return _selection.removeAll(elt); emit selectionChanged(); }
+	void clearSelection();
+	bool removeFromSelection(CADrawableMusElement *elt);
 
 	void                  addToSelection(CADrawableMusElement *elt, bool triggerSignal=true );
-	void                  addToSelection( const QList<CADrawableMusElement*> list, bool selectableOnly=true );
+	void                  addToSelection( const QList<CADrawableMusElement*> list );
 	CADrawableMusElement *addToSelection(CAMusElement *elt);
 	void                  addToSelection(const QList<CAMusElement *> elts);
 
@@ -214,11 +209,14 @@ public:
 	inline bool playing() { return _playing; }
 	inline void setPlaying(bool playing) { _playing = playing; }
 
+	void repaintOverlay();
+	inline void invalidateScoreLayer() { _scoreLayerValid = false; }
+
 	inline void setRepaintArea(QRect *area) { _repaintArea = area; }
 	inline void clearRepaintArea() { if (_repaintArea) delete _repaintArea; _repaintArea=0; }
 
 	inline CAVoice *selectedVoice() { return _selectedVoice; }
-	inline void setSelectedVoice( CAVoice *selectedVoice ) { _selectedVoice = selectedVoice; }
+	inline void setSelectedVoice( CAVoice *selectedVoice ) { _selectedVoice = selectedVoice; invalidateScoreLayer(); }
 
 	inline bool shadowNoteVisible() { return _shadowNoteVisible; }
 	inline void setShadowNoteVisible(bool visible) { _shadowNoteVisible = visible; setShadowNoteVisibleOnLeave(visible); }
@@ -260,6 +258,9 @@ private slots:
 	void enterEvent(QEvent *e);
 	void on_animationTimer_timeout();
 	void on_clickTimer_timeout();
+	void on_sheetLayout_aboutToChange();
+	void on_sheetLayout_changed();
+	void on_sheetLayout_grown();
 
 signals:
 	void CATripleClickEvent( QMouseEvent *e, QPoint p );
@@ -276,9 +277,13 @@ protected:
 
 private:
 	void initScoreView( CASheet *s );
-	inline void clearMElements() { _drawableMList.clear(true); }
-	inline void clearCElements() { _drawableCList.clear(true); }
-	inline bool isSelected(CADrawableMusElement *elt) { return (_selection.contains(elt)); }
+	void resetSelection();
+	void sortSelection();
+	bool insertSelected( CADrawableMusElement *elt, bool keepSorted );
+	bool eraseSelected( CADrawableMusElement *elt );
+	void invalidateSelectionArea( CADrawableMusElement *elt );
+	inline CAKDTree<CADrawableMusElement*>& drawableMList() { return _sheetLayout->drawableMList(); }
+	inline CAKDTree<CADrawableContext*>& drawableCList() { return _sheetLayout->drawableCList(); }
 
 	//////////////////
 	// Core Widgets //
@@ -290,15 +295,16 @@ private:
 	////////////////////////
 	// General properties //
 	////////////////////////
-	CAKDTree<CADrawableMusElement*>       _drawableMList;   // The list of music elements stored in a tree for faster lookup and other operations. Every view has its own list of drawable elements and drawable objects themselves!
-	CAKDTree<CADrawableContext*>          _drawableCList;   // The list of context drawable elements (staffs, lyrics etc.). Every view has its own list of drawable elements and drawable objects themselves!
-	CAKDTree<CADrawableNoteCheckerError*> _drawableNCEList; // The list of drawable note checker errors
-	QMultiMap<void*, CADrawable*>         _mapDrawable;     // Mapping of all music elements/contexts in the score -> drawable elements on canvas
-	CASheet                              *_sheet;           // Pointer to the CASheet which the view represents.
+	CASheet       *_sheet;       // Pointer to the CASheet which the view represents.
+	CASheetLayout *_sheetLayout; // Drawable elements and contexts of the sheet, shared by all the views of the sheet. Never changed by the view.
 
-	QList<CADrawableMusElement *>   _selection;      // The set of elements being selected.
+	QList<CADrawableMusElement *>   _selection;      // The elements being selected sorted by their x position.
+	QSet<CADrawableMusElement *>    _selectionSet;   // The same elements as in _selection for constant time lookup. Only changed by insertSelected() and eraseSelected().
 	CADrawableContext              *_currentContext; // The pointer to the currently active context (staff, lyrics).
 
+	QList<CAMusElement*> _savedSelection;  // Selection stored while the shared layout is being recreated
+	int                  _savedContextIdx; // Index of the current context stored while the shared layout is being recreated
+
 	static const int RIGHT_EXTRA_SPACE;	  // Extra space at the right end to insert new music
 	static const int BOTTOM_EXTRA_SPACE;  // Extra space at the bottom end to insert new music
 	static const int RULER_HEIGHT;        // Ruler height in pixels
@@ -326,6 +332,9 @@ private:
 	bool _drawShadowNoteAccs;       // Draw shadow note accs?
 	QList<CANote*> _shadowNote;     // List of all shadow notes - one shadow note per drawable staff
 	QList<CADrawableNote*> _shadowDrawableNote;	// List of drawable shadow notes
+	CAPlayableLength _shadowNoteLength;  // Playable length of the shadow notes
+	void createShadowNotes();
+	void clearShadowNotes();
 
 	// QLineEdit for editing or creating a lyrics syllable
 	CATextEdit *_textEdit;
@@ -341,6 +350,10 @@ private:
 	// Selection regions
 	QList<QRect> _selectionRegionList;
 	void drawSelectionRegion( QPainter *p, CADrawSettings s );
+
+	// Layers
+	void paintScoreLayer( QPainter *p );
+	void paintOverlay( QPainter *p );
 public:
 	static const int SELECTION_REGION_THRESHOLD; // Threshold in px for mouse move until the selection region is activated
 	
@@ -351,6 +364,12 @@ private:
 	bool _grabTabKey;              // Pass the tab key to keyPressEvent() or treat it like the next item key
 	bool _drawBorder;              // Should the border be drawn or not.
 	QRect *_repaintArea;           // Area to be repainted on paintEvent().
+	QPixmap _scoreLayer;           // Cached contexts, music elements and ruler. Overlay is painted over it.
+	QRectF _scoreLayerWorld;       // World coordinates the score layer was painted at.
+	float _scoreLayerZoom;         // Zoom level the score layer was painted at.
+	bool _scoreLayerValid;         // Can the score layer be reused or does it need to be repainted.
+	bool _overlayOnly;             // Only repaint the overlay on the next paintEvent(), if the score layer is valid.
+	QRectF _selectionArea;         // World area of the elements (de)selected since the last paintEvent(). Selected elements are not in the score layer.
 	QPen _borderPen;               // Pen which the border is drawn by.
 	QColor _backgroundColor;       // Color which the background is filled.
 	QColor _foregroundColor;       // Color which the music elements are painted.